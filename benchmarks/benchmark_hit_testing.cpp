@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/scene/surface_stack.h"
+#include "mir/scene/scene_report.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/test/doubles/stub_scene_surface.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace mi = mir::input;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+class BenchSurface : public mtd::StubSceneSurface
+{
+public:
+    BenchSurface(geom::Rectangle const& position)
+        : position{position}
+    {
+    }
+
+    geom::Rectangle input_bounds() const override { return position; }
+    bool input_area_contains(geom::Point const& point) const override { return position.contains(point); }
+
+private:
+    geom::Rectangle const position;
+};
+
+class NullSceneReport : public ms::SceneReport
+{
+public:
+    void surface_created(BasicSurfaceId, std::string const&) override {}
+    void surface_added(BasicSurfaceId, std::string const&) override {}
+    void surface_removed(BasicSurfaceId, std::string const&) override {}
+    void surface_deleted(BasicSurfaceId, std::string const&) override {}
+};
+
+using Clock = std::chrono::steady_clock;
+
+int const desktop_width = 3840;
+int const desktop_height = 2160;
+
+// The way the input dispatcher used to find its target: test every surface
+// from the bottom up and keep the last that accepts the point
+std::shared_ptr<mi::Surface> linear_surface_at(ms::SurfaceStack& stack, geom::Point point)
+{
+    std::shared_ptr<mi::Surface> top_target;
+    stack.for_each(
+        [&](std::shared_ptr<mi::Surface> const& surface)
+        {
+            if (surface->input_area_contains(point))
+                top_target = surface;
+        });
+    return top_target;
+}
+
+template<typename Query>
+double ns_per_query(int queries, Query query)
+{
+    int hits = 0;
+    auto const start = Clock::now();
+    for (int i = 0; i != queries; ++i)
+    {
+        geom::Point const point{(i * 97) % desktop_width, (i * 61) % desktop_height};
+        if (query(point))
+            ++hits;
+    }
+    auto const elapsed = Clock::now() - start;
+
+    // Keep the queries from being optimized away
+    if (hits < 0)
+        std::cout << hits;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / queries;
+}
+
+void run(int surface_count, int queries)
+{
+    ms::SurfaceStack stack{std::make_shared<NullSceneReport>()};
+
+    std::vector<std::shared_ptr<ms::Surface>> surfaces;
+    for (int i = 0; i != surface_count; ++i)
+    {
+        surfaces.push_back(std::make_shared<BenchSurface>(
+            geom::Rectangle{{(i * 37) % desktop_width, (i * 53) % desktop_height}, {320, 240}}));
+        stack.add_surface(surfaces.back(), mi::InputReceptionMode::normal);
+    }
+
+    auto const linear = ns_per_query(queries,
+        [&](geom::Point point) { return linear_surface_at(stack, point) != nullptr; });
+    auto const indexed = ns_per_query(queries,
+        [&](geom::Point point) { return stack.input_surface_at(point) != nullptr; });
+
+    std::cout << surface_count << " surfaces: linear scan " << linear << "ns/query, "
+              << "indexed " << indexed << "ns/query" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const queries{argc > 1 ? std::atoi(argv[1]) : 100000};
+
+    for (int const surface_count : {10, 50, 100, 500, 1000})
+        run(surface_count, queries);
+
+    exit(0);
+}
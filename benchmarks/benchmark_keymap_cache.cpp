@@ -0,0 +1,113 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/frontend_wayland/keymap_cache.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/input/keymap.h"
+
+#include <xkbcommon/xkbcommon.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+using namespace std::chrono;
+
+namespace
+{
+// What each wl_keyboard used to do: compile the keymap in its own context, then
+// serialise it into a fresh file for its client
+void compile_for_one_client(mi::Keymap const& names)
+{
+    std::unique_ptr<xkb_context, void(*)(xkb_context*)> const context{
+        xkb_context_new(XKB_CONTEXT_NO_FLAGS),
+        &xkb_context_unref};
+
+    xkb_rule_names const rule_names = {
+        "evdev",
+        names.model.c_str(),
+        names.layout.c_str(),
+        names.variant.c_str(),
+        names.options.c_str()
+    };
+
+    std::unique_ptr<xkb_keymap, void(*)(xkb_keymap*)> const keymap{
+        xkb_keymap_new_from_names(context.get(), &rule_names, XKB_KEYMAP_COMPILE_NO_FLAGS),
+        &xkb_keymap_unref};
+
+    std::unique_ptr<char, void(*)(void*)> const text{
+        xkb_keymap_get_as_string(keymap.get(), XKB_KEYMAP_FORMAT_TEXT_V1),
+        free};
+
+    auto const length = strlen(text.get());
+    mir::AnonymousShmFile file{length};
+    memcpy(file.base_ptr(), text.get(), length);
+}
+
+// Every client connects at once, each on its own thread as seen by the server, and
+// reports how long the slowest of them waited for its keymap
+template<typename ServeKeymap>
+void connect_clients(char const* mode, int client_count, ServeKeymap serve_keymap)
+{
+    std::vector<steady_clock::duration> latencies(client_count);
+    std::vector<std::thread> clients;
+
+    auto const start = steady_clock::now();
+    for (int i = 0; i != client_count; ++i)
+    {
+        clients.emplace_back(
+            [&, i]()
+            {
+                serve_keymap();
+                latencies[i] = steady_clock::now() - start;
+            });
+    }
+    for (auto& client : clients)
+        client.join();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << mode << ": first client has its keymap after "
+              << duration_cast<microseconds>(latencies.front()).count() << "us, median after "
+              << duration_cast<microseconds>(latencies[latencies.size() / 2]).count() << "us, last after "
+              << duration_cast<microseconds>(latencies.back()).count() << "us" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const client_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+
+    mi::Keymap const names;
+
+    connect_clients("Compiled per client", client_count, [&]() { compile_for_one_client(names); });
+
+    {
+        mf::KeymapCache cache;
+        connect_clients("Shared keymap cache", client_count, [&]() { cache.keymap_for(names); });
+    }
+
+    exit(0);
+}
@@ -72,6 +72,48 @@ private:
 
 thread_local uint64_t TestDispatchable::dispatch_count = 0;
 
+// Stays readable forever, so every dispatch finds it ready again once re-armed
+class AlwaysReadyDispatchable : public md::Dispatchable
+{
+public:
+    AlwaysReadyDispatchable(uint64_t& dispatch_count)
+        : dispatch_count(dispatch_count)
+    {
+        int pipefds[2];
+        if (pipe(pipefds) < 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        }
+
+        read_fd = mir::Fd{pipefds[0]};
+        write_fd = mir::Fd{pipefds[1]};
+
+        char dummy{0};
+        if (::write(write_fd, &dummy, sizeof(dummy)) != sizeof(dummy))
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to mark dispatchable"};
+        }
+    }
+
+    mir::Fd watch_fd() const override
+    {
+        return read_fd;
+    }
+    bool dispatch(md::FdEvents) override
+    {
+        ++dispatch_count;
+        return true;
+    }
+    md::FdEvents relevant_events() const override
+    {
+        return md::FdEvent::readable;
+    }
+
+private:
+    uint64_t& dispatch_count;
+    mir::Fd read_fd, write_fd;
+};
+
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -117,5 +159,31 @@ int main(int argc, char** argv)
 
     auto duration = std::chrono::steady_clock::now() - start;
     std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+
+    // How throughput scales when many sources are ready at once (eg: a burst across
+    // several input devices): one thread keeps dispatching until every source has
+    // been serviced, on average, dispatch_count / ready_fds times.
+    for (int ready_fds = 1; ready_fds <= 64; ready_fds *= 2)
+    {
+        uint64_t dispatched{0};
+        md::MultiplexingDispatchable multiplexer;
+        for (int i = 0; i < ready_fds; ++i)
+        {
+            multiplexer.add_watch(std::make_shared<AlwaysReadyDispatchable>(dispatched));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t wakeups{0};
+        while (dispatched < dispatch_count)
+        {
+            multiplexer.dispatch(md::FdEvent::readable);
+            ++wakeups;
+        }
+        auto duration = std::chrono::steady_clock::now() - start;
+
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        std::cout<<ready_fds<<" ready fds: "<<dispatched<<" dispatches in "<<wakeups<<" wakeups took "
+                 <<ns<<"ns ("<<(dispatched * 1000000000 / ns)<<" dispatches/s)"<<std::endl;
+    }
     exit(0);
 }
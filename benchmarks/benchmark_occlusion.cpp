@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/compositor/occlusion.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+#include "mir/geometry/rectangles.h"
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+class BenchRenderable : public mg::Renderable
+{
+public:
+    BenchRenderable(geom::Rectangle const& position, bool shaped)
+        : position{position},
+          is_shaped{shaped}
+    {
+        if (is_shaped)
+        {
+            // Something like a decorated window with a translucent drop shadow
+            auto const& size = position.size;
+            opaque = geom::Region{{
+                position.top_left + geom::Displacement{8, 8},
+                {size.width.as_int() - 16, size.height.as_int() - 16}}};
+        }
+        else
+        {
+            opaque = geom::Region{position};
+        }
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return {}; }
+    geom::Rectangle screen_position() const override { return position; }
+    geom::Rectangle src_bounds() const override { return {{0, 0}, position.size}; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4{1}; }
+    bool shaped() const override { return is_shaped; }
+    geom::Region opaque_region() const override { return opaque; }
+    unsigned int swap_interval() const override { return 1u; }
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override { return geom::Rectangles{position}; }
+
+private:
+    geom::Rectangle const position;
+    bool const is_shaped;
+    geom::Region opaque;
+};
+
+class BenchSceneElement : public mc::SceneElement
+{
+public:
+    BenchSceneElement(std::shared_ptr<mg::Renderable> const& renderable)
+        : renderable_{renderable}
+    {
+    }
+
+    std::shared_ptr<mg::Renderable> renderable() const override { return renderable_; }
+    void rendered() override {}
+    void occluded() override {}
+
+private:
+    std::shared_ptr<mg::Renderable> const renderable_;
+};
+
+// A deterministic pseudo-random scatter of windows over the output, in
+// bottom-to-top order as the scene would give them to the compositor.
+mc::SceneElementSequence make_scene(int window_count, geom::Rectangle const& output)
+{
+    mc::SceneElementSequence scene;
+    unsigned int seed = 1;
+    auto next = [&seed](int range) { seed = seed * 1103515245u + 12345u; return int((seed >> 16) % range); };
+
+    for (int i = 0; i != window_count; ++i)
+    {
+        int const width = 200 + next(800);
+        int const height = 150 + next(600);
+        geom::Point const top_left{
+            next(output.size.width.as_int() - 100) - 50,
+            next(output.size.height.as_int() - 100) - 50};
+
+        scene.push_back(std::make_shared<BenchSceneElement>(
+            std::make_shared<BenchRenderable>(geom::Rectangle{top_left, {width, height}}, i % 2 == 0)));
+    }
+
+    return scene;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+    geom::Rectangle const output{{0, 0}, {1920, 1080}};
+
+    for (int const window_count : {10, 50, 100, 200, 500})
+    {
+        auto const scene = make_scene(window_count, output);
+        mc::VisibleRegions partly_visible;
+        size_t remaining = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i != iterations; ++i)
+        {
+            auto list = scene;
+            partly_visible.clear();
+            mc::filter_occlusions_from(list, output, partly_visible);
+            remaining = list.size();
+        }
+
+        auto duration = std::chrono::steady_clock::now() - start;
+        std::cout << window_count << " windows: "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / iterations
+                  << "ns per frame (" << remaining << " visible, "
+                  << partly_visible.size() << " partly covered)" << std::endl;
+    }
+
+    exit(0);
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/pixel_kernels.h"
+#include "mir/gl/async_readback.h"
+#include "mir/geometry/rectangle.h"
+
+#include <EGL/egl.h>
+#include MIR_SERVER_GL_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace mgl = mir::gl;
+namespace geom = mir::geometry;
+
+namespace
+{
+// Something to draw into and read back from
+class PbufferContext
+{
+public:
+    PbufferContext(geom::Size const& size)
+        : display{eglGetDisplay(EGL_DEFAULT_DISPLAY)}
+    {
+        if (!eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL"};
+
+        EGLint const config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, MIR_SERVER_EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_NONE};
+        EGLConfig config;
+        EGLint num_configs;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &num_configs) || num_configs < 1)
+            throw std::runtime_error{"No suitable EGL config"};
+
+        EGLint const surface_attribs[] = {
+            EGL_WIDTH, size.width.as_int(),
+            EGL_HEIGHT, size.height.as_int(),
+            EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surface_attribs);
+
+        eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+        EGLint const context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+
+        if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, surface, surface, context))
+            throw std::runtime_error{"Failed to make an EGL context current"};
+    }
+
+    ~PbufferContext()
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+
+private:
+    EGLDisplay const display;
+    EGLSurface surface;
+    EGLContext context;
+};
+
+// Stands in for compositing a frame
+void draw_frame(int frame)
+{
+    glClearColor((frame % 256) / 255.0f, 0.5f, 0.25f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+// What GLPixelBuffer used to do with RGBA readbacks: swap rows in place, converting one pixel at a time
+void flip_per_pixel(std::vector<uint32_t>& pixels, int width, int height)
+{
+    auto const convert = [](uint32_t p)
+        {
+            return ((p << 16) & 0x00ff0000) | (p & 0x0000ff00) | ((p >> 16) & 0x000000ff) | (p & 0xff000000);
+        };
+    std::vector<uint32_t> tmp(width);
+
+    for (int i = 0; i < height / 2; i++)
+    {
+        auto const top = &pixels[i * width];
+        auto const bottom = &pixels[(height - i - 1) * width];
+
+        tmp.assign(top, top + width);
+        for (int n = 0; n < width; n++)
+            top[n] = convert(bottom[n]);
+        for (int n = 0; n < width; n++)
+            bottom[n] = convert(tmp[n]);
+    }
+    if (height % 2 == 1)
+    {
+        auto const middle = &pixels[(height / 2) * width];
+        for (int n = 0; n < width; n++)
+            middle[n] = convert(middle[n]);
+    }
+}
+
+struct Result
+{
+    long frame_us;      // Drawing and capturing each frame
+    long blocked_us;    // The part of that spent waiting for pixels
+};
+
+template<typename Capture>
+Result time_per_frame(int frames, Capture const& capture)
+{
+    std::chrono::steady_clock::duration blocked{};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i != frames; ++i)
+    {
+        draw_frame(i);
+        glFlush();
+        blocked += capture();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    return {duration_cast<microseconds>(duration).count() / frames, duration_cast<microseconds>(blocked).count() / frames};
+}
+
+template<typename Wait>
+auto timed(Wait const& wait) -> std::chrono::steady_clock::duration
+{
+    auto start = std::chrono::steady_clock::now();
+    wait();
+    return std::chrono::steady_clock::now() - start;
+}
+
+void report(char const* name, Result const& result)
+{
+    std::cout << "  " << name << ": " << result.frame_us << "us per frame ("
+              << 1000000 / std::max(result.frame_us, 1l) << " fps), "
+              << result.blocked_us << "us of it waiting for pixels" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 60;
+
+    for (geom::Size const size : {geom::Size{1920, 1080}, geom::Size{3840, 2160}})
+    {
+        PbufferContext const context{size};
+        auto const width = size.width.as_int();
+        auto const height = size.height.as_int();
+        size_t const stride = width * sizeof(uint32_t);
+        std::vector<uint32_t> gl_pixels(width * height);
+        std::vector<uint32_t> pixels(width * height);
+
+        std::cout << "Capturing " << size << " as argb_8888 from " << glGetString(GL_RENDERER) << std::endl;
+
+        report("synchronous, per-pixel flip", time_per_frame(frames, [&]
+            {
+                return timed([&]
+                    {
+                        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+                        flip_per_pixel(pixels, width, height);
+                    });
+            }));
+
+        report("synchronous, vector flip", time_per_frame(frames, [&]
+            {
+                return timed([&]
+                    {
+                        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, gl_pixels.data());
+                        mgl::copy_flipped(
+                            mgl::pixel_kernels(),
+                            reinterpret_cast<unsigned char*>(pixels.data()), stride,
+                            reinterpret_cast<unsigned char const*>(gl_pixels.data()), stride,
+                            width, height, true);
+                    });
+            }));
+
+        if (!mgl::AsyncReadback::available())
+        {
+            std::cout << "  (" << glGetString(GL_VERSION) << " can't read back asynchronously)" << std::endl;
+            continue;
+        }
+
+        for (unsigned int const depth : {1u, 2u, 3u})
+        {
+            mgl::AsyncReadback readback{depth};
+            auto const consume = [&](unsigned char const* rows, geom::Size, geom::Stride gl_stride)
+                {
+                    mgl::copy_flipped(
+                        mgl::pixel_kernels(),
+                        reinterpret_cast<unsigned char*>(pixels.data()), stride,
+                        rows, gl_stride.as_uint32_t(),
+                        width, height, true);
+                };
+
+            auto const result = time_per_frame(frames, [&]
+                {
+                    return timed([&]
+                        {
+                            readback.start({{0, 0}, size}, GL_RGBA);
+                            // Collect the oldest frame only once every buffer is in use
+                            if (readback.pending() == depth)
+                                readback.finish(consume);
+                        });
+                });
+            while (readback.pending())
+                readback.finish(consume);
+
+            std::string const name{"asynchronous, " + std::to_string(depth) + " buffer(s)"};
+            report(name.c_str(), result);
+        }
+    }
+}
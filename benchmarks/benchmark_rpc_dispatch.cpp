@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/frontend/protobuf_message_processor.h"
+#include "src/server/report/null/message_processor_report.h"
+#include "mir/frontend/protobuf_message_sender.h"
+#include "mir/test/doubles/stub_display_server.h"
+
+#include "mir_protobuf_wire.pb.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace mtd = mir::test::doubles;
+namespace mp = mir::protobuf;
+namespace mpw = mir::protobuf::wire;
+namespace gp = google::protobuf;
+
+namespace
+{
+struct CountingMessageSender : mfd::ProtobufMessageSender
+{
+    void send_response(gp::uint32, gp::MessageLite*, mf::FdSets const&) override
+    {
+        ++responses;
+    }
+
+    long responses{0};
+};
+
+struct RespondingDisplayServer : mtd::StubDisplayServer
+{
+    void submit_buffer(
+        mp::BufferRequest const*,
+        mp::Void*,
+        gp::Closure* done) override
+    {
+        done->Run();
+    }
+
+    void pong(
+        mp::PingEvent const*,
+        mp::Void*,
+        gp::Closure* done) override
+    {
+        done->Run();
+    }
+
+    void configure_surface(
+        mp::SurfaceSetting const*,
+        mp::SurfaceSetting*,
+        gp::Closure* done) override
+    {
+        done->Run();
+    }
+
+    void set_base_input_configuration(
+        mp::InputConfigurationRequest const*,
+        mp::Void*,
+        gp::Closure* done) override
+    {
+        done->Run();
+    }
+};
+
+void run(std::string const& method, std::string const& parameters, int calls)
+{
+    auto const sender = std::make_shared<CountingMessageSender>();
+    std::shared_ptr<mfd::MessageProcessor> const processor = std::make_shared<mfd::ProtobufMessageProcessor>(
+        sender,
+        std::make_shared<RespondingDisplayServer>(),
+        std::make_shared<mir::report::null::MessageProcessorReport>());
+
+    mpw::Invocation raw_invocation;
+    raw_invocation.set_method_name(method);
+    raw_invocation.set_parameters(parameters);
+    std::vector<mir::Fd> const no_fds;
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != calls; ++i)
+    {
+        raw_invocation.set_id(i);
+        processor->dispatch(mfd::Invocation{raw_invocation}, no_fds);
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    std::cout << method << ": " << calls / elapsed.count() << " calls/s ("
+              << sender->responses << " responses)" << std::endl;
+}
+
+template<typename Message>
+std::string serialized(Message const& message)
+{
+    std::string result;
+    message.SerializeToString(&result);
+    return result;
+}
+}
+
+// Measures the cost of getting a call from the wire to its handler and
+// its response back out, without the socket in between.
+int main(int argc, char** argv)
+{
+    int const calls{argc > 1 ? std::atoi(argv[1]) : 1000000};
+
+    mp::BufferRequest buffer_request;
+    buffer_request.mutable_id()->set_value(1);
+    buffer_request.mutable_buffer()->set_buffer_id(2);
+
+    mp::SurfaceSetting surface_setting;
+    surface_setting.mutable_surfaceid()->set_value(1);
+    surface_setting.set_attrib(0);
+    surface_setting.set_ivalue(0);
+
+    run("submit_buffer", serialized(buffer_request), calls);
+    run("pong", serialized(mp::PingEvent{}), calls);
+    run("configure_surface", serialized(surface_setting), calls);
+    run("set_base_input_configuration", serialized(mp::InputConfigurationRequest{}), calls);
+
+    exit(0);
+}
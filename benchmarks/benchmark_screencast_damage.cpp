@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+#include "src/utils/dirty_rect_stream.h"
+#include "mir/graphics/buffer_basic.h"
+#include "mir/graphics/renderable.h"
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+int const bytes_per_pixel{4};
+
+class BenchBuffer : public mg::BufferBasic, public mg::NativeBufferBase
+{
+public:
+    BenchBuffer(geom::Size const& size) : size_{size} {}
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override { return nullptr; }
+    geom::Size size() const override { return size_; }
+    MirPixelFormat pixel_format() const override { return mir_pixel_format_argb_8888; }
+    mg::NativeBufferBase* native_buffer_base() override { return this; }
+
+private:
+    geom::Size const size_;
+};
+
+/// A surface whose client submits a new buffer, damaging part of it, when its content changes
+class BenchRenderable : public mg::Renderable
+{
+public:
+    BenchRenderable(geom::Rectangle const& position)
+        : position{position},
+          buffer_{std::make_shared<BenchBuffer>(position.size)}
+    {
+    }
+
+    void submit(geom::Rectangle const& damage)
+    {
+        buffer_ = std::make_shared<BenchBuffer>(position.size);
+        damage_ = damage;
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return buffer_; }
+    geom::Rectangle screen_position() const override { return position; }
+    geom::Rectangle src_bounds() const override { return {{0, 0}, position.size}; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4{1}; }
+    bool shaped() const override { return false; }
+    geom::Region opaque_region() const override { return {position}; }
+    unsigned int swap_interval() const override { return 1; }
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override { return {damage_}; }
+
+    geom::Rectangle position;
+
+private:
+    std::shared_ptr<mg::Buffer> buffer_;
+    geom::Rectangle damage_;
+};
+
+/// Wallpaper, a couple of windows, a video and a cursor
+struct Desktop
+{
+    Desktop(geom::Size const& screen)
+        : wallpaper{std::make_shared<BenchRenderable>(geom::Rectangle{{0, 0}, screen})},
+          browser{std::make_shared<BenchRenderable>(geom::Rectangle{{100, 80}, {960, 720}})},
+          terminal{std::make_shared<BenchRenderable>(geom::Rectangle{{900, 400}, {720, 480}})},
+          video{std::make_shared<BenchRenderable>(geom::Rectangle{{200, 300}, {854, 480}})},
+          cursor{std::make_shared<BenchRenderable>(geom::Rectangle{{960, 540}, {24, 24}})},
+          renderables{wallpaper, browser, terminal, video, cursor}
+    {
+    }
+
+    std::shared_ptr<BenchRenderable> const wallpaper;
+    std::shared_ptr<BenchRenderable> const browser;
+    std::shared_ptr<BenchRenderable> const terminal;
+    std::shared_ptr<BenchRenderable> const video;
+    std::shared_ptr<BenchRenderable> const cursor;
+    mg::RenderableList const renderables;
+};
+
+/// Discards what's written; DirtyRectStream counts the bytes for us
+class NullStreamBuffer : public std::streambuf
+{
+protected:
+    std::streamsize xsputn(char const*, std::streamsize count) override { return count; }
+    int_type overflow(int_type c) override { return c; }
+};
+
+struct Workload
+{
+    char const* name;
+    std::function<void(Desktop&, int frame)> step;
+};
+
+void benchmark(geom::Size const& screen, int fps, int seconds, Workload const& workload)
+{
+    Desktop desktop{screen};
+    mc::DamageTracker damage;
+    geom::Rectangle const view_area{{0, 0}, screen};
+    std::vector<char> pixels(screen.width.as_int() * screen.height.as_int() * bytes_per_pixel);
+
+    NullStreamBuffer null_buffer;
+    std::ostream out{&null_buffer};
+    mir::utils::DirtyRectStream stream{
+        out, screen.width.as_uint32_t(), screen.height.as_uint32_t(), "BGRA", bytes_per_pixel};
+
+    int const frames = fps * seconds;
+    int unchanged = 0;
+    for (int frame = 0; frame != frames; ++frame)
+    {
+        if (frame > 0)
+            workload.step(desktop, frame);
+
+        auto const changed = damage.damage_for(desktop.renderables, view_area, glm::mat2{1});
+        if (changed.size() == 0)
+            ++unchanged;
+
+        stream.write_frame(
+            std::chrono::microseconds{frame * 1000000ll / fps},
+            {changed.begin(), changed.end()},
+            pixels.data(), screen.width.as_int() * bytes_per_pixel);
+    }
+
+    double const full_frames = double(pixels.size()) * fps;
+    double const dirty_rects = double(stream.bytes_written()) / seconds;
+
+    std::cout << std::left << std::setw(16) << workload.name << std::right << std::fixed
+              << std::setprecision(2)
+              << std::setw(10) << full_frames / (1 << 20) << " MiB/s"
+              << std::setw(12) << dirty_rects / (1 << 20) << " MiB/s"
+              << std::setw(9) << std::setprecision(1) << 100.0 * dirty_rects / full_frames << "%"
+              << std::setw(9) << unchanged << "/" << frames << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const fps = argc > 1 ? std::atoi(argv[1]) : 30;
+    int const seconds = argc > 2 ? std::atoi(argv[2]) : 10;
+    geom::Size const screen{
+        argc > 3 ? std::atoi(argv[3]) : 1920,
+        argc > 4 ? std::atoi(argv[4]) : 1080};
+
+    std::vector<Workload> const workloads{
+        {"idle", [](Desktop&, int) {}},
+        {"typing", [](Desktop& desktop, int frame)
+            {
+                // A character every 100ms and the caret blinking every 500ms
+                auto const column = frame / 3 % 70;
+                if (frame % 3 == 0)
+                    desktop.terminal->submit({{10 + column * 10, 200}, {10, 20}});
+                else if (frame % 15 == 0)
+                    desktop.terminal->submit({{20 + column * 10, 200}, {2, 20}});
+            }},
+        {"pointer", [](Desktop& desktop, int frame)
+            {
+                desktop.cursor->position.top_left = {400 + frame % 120 * 8, 300 + frame % 120 * 4};
+            }},
+        {"scrolling", [](Desktop& desktop, int)
+            {
+                desktop.browser->submit({{0, 0}, desktop.browser->position.size});
+            }},
+        {"video", [](Desktop& desktop, int)
+            {
+                desktop.video->submit({{0, 0}, desktop.video->position.size});
+            }},
+        {"window drag", [](Desktop& desktop, int frame)
+            {
+                desktop.terminal->position.top_left = {100 + frame % 80 * 12, 400};
+            }},
+    };
+
+    std::cout << "Screencasting " << screen << " at " << fps << "fps for " << seconds << "s" << std::endl
+              << "workload         full frames     dirty rects    ratio  unchanged" << std::endl;
+
+    for (auto const& workload : workloads)
+        benchmark(screen, fps, seconds, workload);
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/sw/renderer.h"
+#include "src/renderers/gl/renderer.h"
+#include "src/platforms/common/server/shm_buffer.h"
+#include "src/server/graphics/offscreen/display_buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/surfaceless_egl_context.h"
+#include "mir/anonymous_shm_file.h"
+
+#include <EGL/egl.h>
+#include MIR_SERVER_GL_H
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace mgo = mir::graphics::offscreen;
+namespace mrs = mir::renderer::software;
+namespace mrg = mir::renderer::gl;
+namespace geom = mir::geometry;
+
+namespace
+{
+class BenchShmBuffer : public mgc::ShmBuffer
+{
+public:
+    BenchShmBuffer(geom::Size const& size, MirPixelFormat format, std::vector<uint32_t> const& pixels)
+        : ShmBuffer(
+              std::make_unique<mir::AnonymousShmFile>(size.width.as_int() * size.height.as_int() * 4),
+              size,
+              format)
+    {
+        write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return nullptr;
+    }
+};
+
+class BenchRenderable : public mg::Renderable
+{
+public:
+    BenchRenderable(
+        geom::Rectangle const& position,
+        std::shared_ptr<mg::Buffer> const& buffer,
+        float alpha,
+        geom::Region const& opaque)
+        : position{position},
+          buffer_{buffer},
+          alpha_{alpha},
+          opaque{opaque}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return buffer_; }
+    geom::Rectangle screen_position() const override { return position; }
+    geom::Rectangle src_bounds() const override { return {{0, 0}, buffer_->size()}; }
+    float alpha() const override { return alpha_; }
+    glm::mat4 transformation() const override { return glm::mat4{1}; }
+    bool shaped() const override { return buffer_->pixel_format() == mir_pixel_format_argb_8888; }
+    geom::Region opaque_region() const override { return opaque; }
+    unsigned int swap_interval() const override { return 1; }
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override { return {src_bounds()}; }
+
+    geom::Rectangle position;
+
+private:
+    std::shared_ptr<mg::Buffer> const buffer_;
+    float const alpha_;
+    geom::Region const opaque;
+};
+
+/// EGL for the offscreen display buffers that are drawn through GL
+struct EGLDisplayHandle
+{
+    EGLDisplayHandle()
+        : display{eglGetDisplay(EGL_DEFAULT_DISPLAY)}
+    {
+        if (!eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL"};
+        eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+    }
+
+    ~EGLDisplayHandle()
+    {
+        eglTerminate(display);
+    }
+
+    EGLDisplay const display;
+};
+
+auto pixels_of(geom::Size const& size, uint32_t colour, int translucent_border = 0) -> std::vector<uint32_t>
+{
+    int const width = size.width.as_int();
+    int const height = size.height.as_int();
+    std::vector<uint32_t> pixels(width * height, colour);
+
+    // A shadow fading out towards the edges
+    for (int y = 0; y != height; ++y)
+    {
+        for (int x = 0; x != width; ++x)
+        {
+            auto const edge = std::min(std::min(x, width - 1 - x), std::min(y, height - 1 - y));
+            if (edge < translucent_border)
+            {
+                uint32_t const alpha = 0xff * edge / translucent_border;
+                pixels[y * width + x] = alpha << 24;
+            }
+        }
+    }
+    return pixels;
+}
+
+/// A typical desktop: wallpaper, some overlapping windows with shadows, a panel and a cursor
+struct Desktop
+{
+    Desktop(geom::Size const& screen)
+    {
+        auto const add = [this](geom::Rectangle const& position, MirPixelFormat format,
+                                std::vector<uint32_t> const& pixels, float alpha, geom::Region const& opaque)
+            {
+                auto const buffer = std::make_shared<BenchShmBuffer>(position.size, format, pixels);
+                auto const renderable = std::make_shared<BenchRenderable>(position, buffer, alpha, opaque);
+                renderables.push_back(renderable);
+                return renderable;
+            };
+
+        geom::Rectangle const everything{{0, 0}, screen};
+        add(everything, mir_pixel_format_xrgb_8888, pixels_of(screen, 0xff3060a0), 1.0f, {everything});
+
+        int const shadow = 16;
+        geom::Size const window{screen.width.as_int() * 3 / 8, screen.height.as_int() / 2};
+        for (int i = 0; i != 4; ++i)
+        {
+            geom::Rectangle const position{
+                {screen.width.as_int() / 8 + i * screen.width.as_int() / 8, screen.height.as_int() / 10 + i * 60},
+                window};
+            geom::Rectangle const inside{
+                position.top_left + geom::Displacement{shadow, shadow},
+                {window.width.as_int() - 2 * shadow, window.height.as_int() - 2 * shadow}};
+            auto const last = add(
+                position, mir_pixel_format_argb_8888, pixels_of(window, 0xffe0e0e0 - i * 0x101010, shadow),
+                1.0f, {inside});
+            if (i == 3)
+                focused = last;
+        }
+
+        geom::Rectangle const panel{{0, 0}, {screen.width, 32}};
+        add(panel, mir_pixel_format_xrgb_8888, pixels_of(panel.size, 0xff202020), 0.9f, {});
+
+        cursor = add(
+            {{screen.width.as_int() / 2, screen.height.as_int() / 2}, {24, 24}},
+            mir_pixel_format_argb_8888, pixels_of({24, 24}, 0xffffffff, 4), 1.0f, {});
+    }
+
+    /// Tells the renderer what is hidden under opaque windows, as the compositor would
+    void set_visible_regions(mir::renderer::Renderer& renderer) const
+    {
+        geom::Region covered;
+        for (auto r = renderables.rbegin(); r != renderables.rend(); ++r)
+        {
+            auto const& renderable = *r;
+            geom::Region visible{renderable->screen_position()};
+            visible.subtract(covered);
+            if (visible != geom::Region{renderable->screen_position()})
+                renderer.set_visible_region(renderable->id(), visible);
+            covered.unite(renderable->opaque_region());
+        }
+    }
+
+    mg::RenderableList renderables;
+    std::shared_ptr<BenchRenderable> focused;
+    std::shared_ptr<BenchRenderable> cursor;
+};
+
+template<typename Frame>
+auto time_per_frame(int frames, Frame const& frame)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i != frames; ++i)
+        frame(i);
+    auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / frames;
+}
+
+void benchmark(char const* name, mir::renderer::Renderer& renderer, Desktop& desktop, int frames)
+{
+    geom::Rectangle const screen{{0, 0}, desktop.renderables.front()->screen_position().size};
+    renderer.set_viewport(screen);
+
+    // Fill the caches and targets first
+    renderer.render(desktop.renderables);
+
+    auto const full = time_per_frame(frames, [&](int)
+        {
+            desktop.set_visible_regions(renderer);
+            renderer.render(desktop.renderables);
+        });
+
+    // One character cell of the focused window changing
+    auto const typing = time_per_frame(frames, [&](int i)
+        {
+            auto const top_left = desktop.focused->position.top_left + geom::Displacement{40 + (i % 40) * 10, 60};
+            renderer.set_damage(geom::Rectangles{{top_left, {10, 20}}});
+            desktop.set_visible_regions(renderer);
+            renderer.render(desktop.renderables);
+        });
+
+    auto const pointer = time_per_frame(frames, [&](int i)
+        {
+            auto const before = desktop.cursor->position;
+            desktop.cursor->position.top_left = {400 + (i % 100) * 8, 300 + (i % 100) * 4};
+            renderer.set_damage(geom::Rectangles{{before, desktop.cursor->position}});
+            desktop.set_visible_regions(renderer);
+            renderer.render(desktop.renderables);
+        });
+
+    std::cout << name << ": "
+              << "full redraw " << full << "us per frame, "
+              << "typing " << typing << "us per frame, "
+              << "pointer motion " << pointer << "us per frame" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 100;
+    geom::Size const size{
+        argc > 2 ? std::atoi(argv[2]) : 1920,
+        argc > 3 ? std::atoi(argv[3]) : 1080};
+
+    std::cout << "Compositing a desktop of " << size << std::endl;
+
+    // Each renderer draws into an offscreen output, and is timed until that output has the frame
+    geom::Rectangle const screen{{0, 0}, size};
+
+    {
+        Desktop desktop{size};
+        mgo::CPUDisplayBuffer display_buffer{screen};
+        mrs::Renderer renderer{display_buffer};
+        benchmark("software renderer (--renderer=software)", renderer, desktop, frames);
+    }
+
+    EGLDisplayHandle const egl;
+    mg::SurfacelessEGLContext const shared_context{egl.display, EGL_NO_CONTEXT};
+
+    // As with the offscreen display, the shared context is current when each display buffer is created
+    {
+        Desktop desktop{size};
+        shared_context.make_current();
+        mgo::DisplayBuffer display_buffer{mg::SurfacelessEGLContext{egl.display, shared_context}, screen};
+        mrs::Renderer renderer{display_buffer};
+        benchmark("software renderer, uploaded to GL", renderer, desktop, frames);
+    }
+
+    {
+        Desktop desktop{size};
+        shared_context.make_current();
+        mgo::DisplayBuffer display_buffer{mg::SurfacelessEGLContext{egl.display, shared_context}, screen};
+        mrg::Renderer renderer{display_buffer};
+        benchmark(reinterpret_cast<char const*>(glGetString(GL_RENDERER)), renderer, desktop, frames);
+    }
+
+    exit(0);
+}
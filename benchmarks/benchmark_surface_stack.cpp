@@ -0,0 +1,227 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/scene/surface_stack.h"
+#include "mir/scene/scene_report.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/test/doubles/stub_scene_surface.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mi = mir::input;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+class BenchRenderable : public mg::Renderable
+{
+public:
+    BenchRenderable(geom::Rectangle const& position)
+        : position{position}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return {}; }
+    geom::Rectangle screen_position() const override { return position; }
+    geom::Rectangle src_bounds() const override { return {{0, 0}, position.size}; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4{1}; }
+    bool shaped() const override { return false; }
+    geom::Region opaque_region() const override { return geom::Region{position}; }
+    unsigned int swap_interval() const override { return 1u; }
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override { return geom::Rectangles{position}; }
+
+private:
+    geom::Rectangle const position;
+};
+
+class BenchSurface : public mtd::StubSceneSurface
+{
+public:
+    BenchSurface(geom::Rectangle const& position)
+        : position{position},
+          renderable{std::make_shared<BenchRenderable>(position)}
+    {
+    }
+
+    geom::Rectangle input_bounds() const override { return position; }
+    bool input_area_contains(geom::Point const& point) const override { return position.contains(point); }
+
+    void append_renderables(mc::CompositorID, mg::RenderableList& renderables) const override
+    {
+        renderables.push_back(renderable);
+    }
+
+    mg::RenderableList generate_renderables(mc::CompositorID) const override { return {renderable}; }
+    int buffers_ready_for_compositor(void const*) const override { return 1; }
+
+private:
+    geom::Rectangle const position;
+    std::shared_ptr<mg::Renderable> const renderable;
+};
+
+class NullSceneReport : public ms::SceneReport
+{
+public:
+    void surface_created(BasicSurfaceId, std::string const&) override {}
+    void surface_added(BasicSurfaceId, std::string const&) override {}
+    void surface_removed(BasicSurfaceId, std::string const&) override {}
+    void surface_deleted(BasicSurfaceId, std::string const&) override {}
+};
+
+std::shared_ptr<ms::Surface> make_surface(int i)
+{
+    return std::make_shared<BenchSurface>(
+        geom::Rectangle{{(i * 37) % 1800, (i * 53) % 1000}, {320, 240}});
+}
+
+using Clock = std::chrono::steady_clock;
+
+struct Counts
+{
+    std::atomic<long> frames{0};
+    std::atomic<long> frame_ns{0};
+    std::atomic<long> worst_frame_ns{0};
+    std::atomic<long> input_queries{0};
+    std::atomic<long> stack_changes{0};
+};
+
+void record_frame(Counts& counts, Clock::duration duration)
+{
+    long const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    counts.frames += 1;
+    counts.frame_ns += ns;
+
+    auto worst = counts.worst_frame_ns.load();
+    while (ns > worst && !counts.worst_frame_ns.compare_exchange_weak(worst, ns))
+        ;
+}
+
+// Drive the stack like a busy desktop: a compositor thread per output building
+// its scene, the input dispatcher hit-testing, and clients coming and going and
+// the window manager raising windows, all at once.
+void run(int outputs, int clients, std::chrono::milliseconds duration)
+{
+    ms::SurfaceStack stack{std::make_shared<NullSceneReport>()};
+    std::vector<int> compositor_ids(outputs);
+    for (auto& id : compositor_ids)
+        stack.register_compositor(&id);
+
+    std::vector<std::shared_ptr<ms::Surface>> surfaces;
+    for (int i = 0; i != clients; ++i)
+    {
+        surfaces.push_back(make_surface(i));
+        stack.add_surface(surfaces.back(), mi::InputReceptionMode::normal);
+    }
+
+    Counts counts;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+
+    for (auto& id : compositor_ids)
+    {
+        threads.emplace_back([&, cid = &id]
+            {
+                while (!done)
+                {
+                    auto const start = Clock::now();
+                    if (stack.frames_pending(cid))
+                    {
+                        for (auto const& element : stack.scene_elements_for(cid))
+                            element->rendered();
+                    }
+                    record_frame(counts, Clock::now() - start);
+                }
+            });
+    }
+
+    threads.emplace_back([&]
+        {
+            int x = 0;
+            while (!done)
+            {
+                stack.surface_at({x, x / 2});
+                stack.for_each([](std::shared_ptr<mi::Surface> const&) {});
+                x = (x + 7) % 1920;
+                counts.input_queries += 1;
+            }
+        });
+
+    threads.emplace_back([&]
+        {
+            int i = 0;
+            while (!done)
+            {
+                auto& surface = surfaces[i % clients];
+                if (i % 4 == 0)
+                {
+                    stack.remove_surface(surface);
+                    surface = make_surface(i);
+                    stack.add_surface(surface, mi::InputReceptionMode::normal);
+                }
+                else
+                {
+                    stack.raise(surface);
+                }
+                ++i;
+                counts.stack_changes += 1;
+            }
+        });
+
+    std::this_thread::sleep_for(duration);
+    done = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& id : compositor_ids)
+        stack.unregister_compositor(&id);
+
+    auto const seconds = std::chrono::duration<double>(duration).count();
+    std::cout << outputs << " outputs, " << clients << " clients: "
+              << counts.frames / seconds << " frames/s ("
+              << counts.frame_ns / std::max(1L, counts.frames.load()) << "ns mean, "
+              << counts.worst_frame_ns << "ns worst), "
+              << counts.input_queries / seconds << " input queries/s, "
+              << counts.stack_changes / seconds << " stack changes/s" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    std::chrono::milliseconds const duration{argc > 1 ? std::atoi(argv[1]) : 2000};
+
+    for (int const outputs : {1, 2, 4})
+    {
+        for (int const clients : {10, 100, 500})
+            run(outputs, clients, duration);
+    }
+
+    exit(0);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/platforms/common/server/shm_buffer.h"
+#include "mir/anonymous_shm_file.h"
+#include "mir/geometry/rectangles.h"
+
+#include <EGL/egl.h>
+#include MIR_SERVER_GL_H
+
+#include <iostream>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace geom = mir::geometry;
+
+namespace
+{
+class BenchShmBuffer : public mgc::ShmBuffer
+{
+public:
+    BenchShmBuffer(geom::Size const& size)
+        : ShmBuffer(
+              std::make_unique<mir::AnonymousShmFile>(size.width.as_int() * size.height.as_int() * 4),
+              size,
+              mir_pixel_format_argb_8888)
+    {
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return nullptr;
+    }
+};
+
+// Just enough of a GL context to upload textures with
+class PbufferContext
+{
+public:
+    PbufferContext()
+        : display{eglGetDisplay(EGL_DEFAULT_DISPLAY)}
+    {
+        if (!eglInitialize(display, nullptr, nullptr))
+            throw std::runtime_error{"Failed to initialise EGL"};
+
+        EGLint const config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, MIR_SERVER_EGL_OPENGL_BIT,
+            EGL_NONE};
+        EGLConfig config;
+        EGLint num_configs;
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &num_configs) || num_configs < 1)
+            throw std::runtime_error{"No suitable EGL config"};
+
+        EGLint const surface_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        surface = eglCreatePbufferSurface(display, config, surface_attribs);
+
+        eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+        EGLint const context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+
+        if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, surface, surface, context))
+            throw std::runtime_error{"Failed to make an EGL context current"};
+    }
+
+    ~PbufferContext()
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglDestroySurface(display, surface);
+        eglTerminate(display);
+    }
+
+private:
+    EGLDisplay const display;
+    EGLSurface surface;
+    EGLContext context;
+};
+
+template<typename Upload>
+auto time_per_frame(int frames, Upload const& upload)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i != frames; ++i)
+    {
+        upload();
+        glFinish();
+    }
+    auto duration = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / frames;
+}
+}
+
+int main(int argc, char** argv)
+{
+    int const frames = argc > 1 ? std::atoi(argv[1]) : 100;
+    geom::Size const size{
+        argc > 2 ? std::atoi(argv[2]) : 3840,
+        argc > 3 ? std::atoi(argv[3]) : 2160};
+
+    PbufferContext const context;
+    BenchShmBuffer buffer{size};
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    for (auto const damaged_fraction : {0.01, 0.1, 1.0})
+    {
+        // A centred square(ish) damaged area covering the given fraction of the buffer
+        auto const scale = std::sqrt(damaged_fraction);
+        geom::Size const damaged_size{
+            std::lround(size.width.as_int() * scale),
+            std::lround(size.height.as_int() * scale)};
+        geom::Rectangles const damage{{
+            {(size.width.as_int() - damaged_size.width.as_int()) / 2,
+             (size.height.as_int() - damaged_size.height.as_int()) / 2},
+            damaged_size}};
+
+        auto const reallocating = time_per_frame(frames, [&] { buffer.gl_bind_to_texture(); });
+
+        buffer.gl_bind_to_texture();
+        auto const incremental = time_per_frame(frames, [&] { buffer.update_texture(damage); });
+
+        std::cout << damaged_fraction * 100 << "% damage of " << size << ": "
+                  << "full upload " << reallocating << "us per frame, "
+                  << "damaged area only " << incremental << "us per frame" << std::endl;
+    }
+
+    glDeleteTextures(1, &texture);
+    exit(0);
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <miral/test_server.h>
+
+#include <wayland-client.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+
+namespace
+{
+char const* const socket_name = "mir-benchmark-wayland-commits";
+
+// A real Wayland client with one wl_shell toplevel and one wl_shm buffer, so each commit
+// goes through wl_surface.commit, wl_shm import, damage clipping and the buffer stream
+class Client
+{
+public:
+    Client(int width, int height)
+        : width{width},
+          height{height},
+          display{wl_display_connect(socket_name)}
+    {
+        if (!display)
+            throw std::runtime_error{"Failed to connect to the server"};
+
+        registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        wl_display_roundtrip(display);
+
+        if (!compositor || !shm || !shell)
+            throw std::runtime_error{"Server is missing wl_compositor, wl_shm or wl_shell"};
+
+        auto const stride = width * 4;
+        auto const pool_bytes = stride * height;
+
+        auto const fd = open("/dev/shm", O_TMPFILE | O_RDWR | O_EXCL, S_IRWXU);
+        if (fd < 0 || posix_fallocate(fd, 0, pool_bytes))
+            throw std::runtime_error{"Failed to create shm pool"};
+
+        pixels = mmap(nullptr, pool_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (pixels == MAP_FAILED)
+            throw std::runtime_error{"Failed to map shm pool"};
+        memset(pixels, 0x7f, pool_bytes);
+
+        pool = wl_shm_create_pool(shm, fd, pool_bytes);
+        close(fd);
+        buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = wl_shell_get_shell_surface(shell, surface);
+        wl_shell_surface_set_toplevel(shell_surface);
+        wl_display_roundtrip(display);
+    }
+
+    ~Client()
+    {
+        wl_shell_surface_destroy(shell_surface);
+        wl_surface_destroy(surface);
+        wl_buffer_destroy(buffer);
+        wl_shm_pool_destroy(pool);
+        munmap(pixels, width * height * 4);
+        wl_shell_destroy(shell);
+        wl_shm_destroy(shm);
+        wl_compositor_destroy(compositor);
+        wl_registry_destroy(registry);
+        wl_display_disconnect(display);
+    }
+
+    /// A full-buffer update, waiting until the server has handled it like a client pacing itself would
+    void commit()
+    {
+        wl_surface_attach(surface, buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, width, height);
+        wl_surface_commit(surface);
+        wl_display_roundtrip(display);
+    }
+
+private:
+    Client(Client const&) = delete;
+    Client& operator=(Client const&) = delete;
+
+    static void new_global(void* data, wl_registry* registry, uint32_t id, char const* interface, uint32_t)
+    {
+        auto const self = static_cast<Client*>(data);
+
+        if (strcmp(interface, wl_compositor_interface.name) == 0)
+            self->compositor = static_cast<wl_compositor*>(wl_registry_bind(registry, id, &wl_compositor_interface, 3));
+        else if (strcmp(interface, wl_shm_interface.name) == 0)
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
+        else if (strcmp(interface, wl_shell_interface.name) == 0)
+            self->shell = static_cast<wl_shell*>(wl_registry_bind(registry, id, &wl_shell_interface, 1));
+    }
+
+    static void global_remove(void*, wl_registry*, uint32_t) {}
+
+    static wl_registry_listener const registry_listener;
+
+    int const width;
+    int const height;
+    wl_display* const display;
+    wl_registry* registry{nullptr};
+    wl_compositor* compositor{nullptr};
+    wl_shm* shm{nullptr};
+    wl_shell* shell{nullptr};
+    void* pixels{nullptr};
+    wl_shm_pool* pool{nullptr};
+    wl_buffer* buffer{nullptr};
+    wl_surface* surface{nullptr};
+    wl_shell_surface* shell_surface{nullptr};
+};
+
+wl_registry_listener const Client::registry_listener{&Client::new_global, &Client::global_remove};
+
+struct Result
+{
+    steady_clock::duration total;
+    steady_clock::duration slowest_commit;
+};
+
+// Every client connects before any of them starts committing, so the commits are interleaved
+class StartingLine
+{
+public:
+    explicit StartingLine(int runners) : waiting{runners} {}
+
+    auto wait() -> steady_clock::time_point
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        if (--waiting == 0)
+        {
+            start = steady_clock::now();
+            cv.notify_all();
+        }
+        cv.wait(lock, [this] { return waiting == 0; });
+        return start;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    int waiting;
+    steady_clock::time_point start;
+};
+
+void run_client(int width, int height, int commits, StartingLine& starting_line, Result& result)
+{
+    Client client{width, height};
+
+    auto const start = starting_line.wait();
+    steady_clock::duration slowest{0};
+
+    for (int i = 0; i != commits; ++i)
+    {
+        auto const before = steady_clock::now();
+        client.commit();
+        slowest = std::max(slowest, steady_clock::now() - before);
+    }
+
+    result = {steady_clock::now() - start, slowest};
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "Usage: " << argv[0] << " <number of clients> <commits per client>" << std::endl;
+        exit(1);
+    }
+
+    int const client_count = std::max(2, std::atoi(argv[1]));
+    int const commits = std::max(1, std::atoi(argv[2]));
+
+    miral::TestDisplayServer server;
+    server.add_to_environment("MIR_SERVER_WAYLAND_SOCKET_NAME", socket_name);
+    server.start_server();
+
+    std::vector<Result> results(client_count);
+    {
+        StartingLine starting_line{client_count};
+        std::vector<std::thread> clients;
+
+        // One client pushing large (4K) commits...
+        clients.emplace_back(
+            [&] { run_client(3840, 2160, commits, starting_line, results[0]); });
+
+        // ...and the rest updating something small, like a clock or a terminal line
+        for (int i = 1; i < client_count; ++i)
+        {
+            clients.emplace_back(
+                [&, i] { run_client(256, 64, commits, starting_line, results[i]); });
+        }
+
+        for (auto& client : clients)
+            client.join();
+    }
+
+    server.stop_server();
+
+    auto const small_clients = std::max_element(
+        results.begin() + 1, results.end(),
+        [](Result const& lhs, Result const& rhs) { return lhs.total < rhs.total; });
+    auto const slowest_small_commit = std::max_element(
+        results.begin() + 1, results.end(),
+        [](Result const& lhs, Result const& rhs) { return lhs.slowest_commit < rhs.slowest_commit; });
+
+    std::cout << "Large client: " << commits << " commits in "
+              << duration_cast<microseconds>(results[0].total).count() << "us" << std::endl;
+    std::cout << "Small clients: " << commits << " commits in at most "
+              << duration_cast<microseconds>(small_clients->total).count() << "us, slowest commit round trip "
+              << duration_cast<microseconds>(slowest_small_commit->slowest_commit).count() << "us" << std::endl;
+
+    exit(0);
+}
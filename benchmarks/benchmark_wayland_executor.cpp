@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/frontend_wayland/wayland_executor.h"
+
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace mf = mir::frontend;
+using namespace std::chrono;
+
+namespace
+{
+// Runs a wl_event_loop on its own thread, as the Wayland frontend does
+class EventLoopThread
+{
+public:
+    EventLoopThread()
+        : loop{wl_event_loop_create()},
+          executor{std::make_unique<mf::WaylandExecutor>(loop)},
+          thread{[this]()
+              {
+                  while (running)
+                  {
+                      wl_event_loop_dispatch(loop, -1);
+                      ++dispatches;
+                  }
+              }}
+    {
+    }
+
+    ~EventLoopThread()
+    {
+        executor->spawn([this]() { running = false; });
+        thread.join();
+        executor.reset();
+        wl_event_loop_destroy(loop);
+    }
+
+    mf::WaylandExecutor& spawner() { return *executor; }
+
+    /// Only meaningful on the event loop thread: how many times the loop has woken, including this one
+    long wakeups() const { return dispatches + 1; }
+
+private:
+    wl_event_loop* const loop;
+    std::unique_ptr<mf::WaylandExecutor> executor;
+    std::atomic<bool> running{true};
+    std::atomic<long> dispatches{0};
+    std::thread thread;
+};
+
+void measure_latency(int samples)
+{
+    EventLoopThread loop;
+    std::vector<nanoseconds> latencies;
+    latencies.reserve(samples);
+
+    for (int i = 0; i != samples; ++i)
+    {
+        std::promise<steady_clock::time_point> ran;
+        auto const spawned = steady_clock::now();
+        loop.spawner().spawn([&ran]() { ran.set_value(steady_clock::now()); });
+        latencies.push_back(ran.get_future().get() - spawned);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto const percentile = [&](int p) { return latencies[(latencies.size() - 1) * p / 100].count(); };
+
+    std::cout << "Spawn to execution latency over " << samples << " spawns: median " << percentile(50)
+              << "ns, 99th percentile " << percentile(99) << "ns" << std::endl;
+}
+
+void measure_throughput(int threads, int spawns_per_thread)
+{
+    EventLoopThread loop;
+    std::atomic<int> remaining{threads * spawns_per_thread};
+    std::promise<long> all_done;
+
+    auto const start = steady_clock::now();
+    {
+        std::vector<std::thread> producers;
+        for (int i = 0; i != threads; ++i)
+        {
+            producers.emplace_back(
+                [&]()
+                {
+                    for (int spawn = 0; spawn != spawns_per_thread; ++spawn)
+                    {
+                        loop.spawner().spawn(
+                            [&]()
+                            {
+                                if (--remaining == 0)
+                                    all_done.set_value(loop.wakeups());
+                            });
+                    }
+                });
+        }
+        for (auto& producer : producers)
+            producer.join();
+    }
+    auto const wakeups = all_done.get_future().get();
+    auto const ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    std::cout << threads << " spawning threads: " << threads * spawns_per_thread << " work items in "
+              << wakeups << " event loop wakeups took " << ns << "ns ("
+              << (int64_t{threads} * spawns_per_thread * 1000000000 / ns) << " items/s)" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout << "Usage: " << argv[0] << " <spawns per thread>" << std::endl;
+        exit(1);
+    }
+
+    int const spawns = std::max(1, std::atoi(argv[1]));
+
+    measure_latency(std::min(spawns, 10000));
+
+    // Like the compositor and input threads posting frame callbacks and buffer releases
+    for (int threads = 1; threads <= 8; threads *= 2)
+        measure_throughput(threads, spawns);
+
+    exit(0);
+}
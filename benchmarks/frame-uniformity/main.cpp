@@ -105,6 +105,35 @@ Results compute_frame_uniformity(std::vector<TouchSamples::Sample> const& result
     return {average_pixel_offset, uniformity};
 }
 
+Results measure_frame_uniformity(geom::Size screen_size, geom::Point touch_start_point, geom::Point touch_end_point,
+    std::chrono::milliseconds touch_duration, int run_count)
+{
+    Results average{0, 0};
+
+    for (int i = 0; i < run_count; i++)
+    {
+        FrameUniformityTest t({screen_size, touch_start_point, touch_end_point, touch_duration});
+
+        t.run_test();
+  
+        auto touch_timings = t.server_timings();
+        auto touch_start_time = touch_timings.touch_start;
+        auto touch_end_time = touch_timings.touch_end;
+        auto samples = t.client_results()->get();
+
+        auto results = compute_frame_uniformity(samples, touch_start_point, touch_end_point,
+            touch_start_time, touch_end_time);
+        
+        average.average_pixel_offset += results.average_pixel_offset;
+        average.frame_uniformity += results.frame_uniformity;
+    }
+    
+    average.average_pixel_offset /= run_count;
+    average.frame_uniformity /= run_count;
+
+    return average;
+}
+
 }
 
 // Main is inside a test to work around mir_test_framework 'issues' (e.g. mir_test_framework contains
@@ -117,35 +146,26 @@ TEST(FrameUniformity, average_frame_offset)
     std::chrono::milliseconds touch_duration{1000};
     
     int const run_count = 1;
-    double average_lag = 0, average_uniformity = 0;
 
     // Ensure we load the correct platform libraries
     setenv("MIR_CLIENT_PLATFORM_PATH",
            (mtf::library_path() + "/client-modules").c_str(),
            true);
-    
-    for (int i = 0; i < run_count; i++)
+
+    // Once with every touch delivered as it arrives, once coalesced and resampled to
+    // the (simulated) 60Hz display
+    for (auto const coalesce_rate : {"0", "60"})
     {
-        FrameUniformityTest t({screen_size, touch_start_point, touch_end_point, touch_duration});
+        setenv("MIR_SERVER_COALESCE_INPUT", coalesce_rate, true);
 
-        t.run_test();
-  
-        auto touch_timings = t.server_timings();
-        auto touch_start_time = touch_timings.touch_start;
-        auto touch_end_time = touch_timings.touch_end;
-        auto samples = t.client_results()->get();
+        auto const results = measure_frame_uniformity(screen_size, touch_start_point, touch_end_point,
+            touch_duration, run_count);
 
-        auto results = compute_frame_uniformity(samples, touch_start_point, touch_end_point,
-            touch_start_time, touch_end_time);
-        
-        average_lag += results.average_pixel_offset;
-        average_uniformity += results.frame_uniformity;
+        std::cout << "Input coalescing rate: " << coalesce_rate << "Hz" << std::endl;
+        std::cout << "Average pixel lag: " << results.average_pixel_offset << "px" << std::endl;
+        std::cout << "Frame Uniformity (smaller scores are more uniform): " << results.frame_uniformity << "px per sample\n"
+            << std::endl;
     }
-    
-    average_lag /= run_count;
-    average_uniformity /= run_count;
-    
-    std::cout << "Average pixel lag: " << average_lag << "px" << std::endl;
-    std::cout << "Frame Uniformity (smaller scores are more uniform): " << average_uniformity << "px per sample\n"
-        << std::endl;
+
+    unsetenv("MIR_SERVER_COALESCE_INPUT");
 }
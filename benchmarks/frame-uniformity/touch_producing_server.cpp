@@ -65,9 +65,9 @@ std::shared_ptr<mg::Platform> TouchProducingServer::the_graphics_platform()
     return graphics_platform;
 }
 
-void TouchProducingServer::synthesize_event_at(geom::Point const& point)
+void TouchProducingServer::synthesize_event_at(geom::Point const& point, mis::TouchParameters::Action action)
 {
-    touch_screen->emit_event(mis::a_touch_event().at_position(point));
+    touch_screen->emit_event(mis::a_touch_event().at_position(point).with_action(action));
 }
 
 void TouchProducingServer::thread_function()
@@ -93,7 +93,9 @@ void TouchProducingServer::thread_function()
         
         double alpha = (now.time_since_epoch().count()-start.time_since_epoch().count()) / static_cast<double>(end.time_since_epoch().count()-start.time_since_epoch().count());
         auto point = touch_start + alpha*(touch_end-touch_start);
-        synthesize_event_at(point);
+        // A finger put down once and dragged, so the server sees a continuous motion
+        synthesize_event_at(point, touch_start_time == now ?
+            mis::TouchParameters::Action::Tap : mis::TouchParameters::Action::Move);
     }
 }
 
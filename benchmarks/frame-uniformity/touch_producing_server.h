@@ -22,6 +22,7 @@
 #include "mir_test_framework/fake_input_server_configuration.h"
 #include "mir_test_framework/fake_input_device.h"
 #include "mir/test/barrier.h"
+#include "mir/test/event_factory.h"
 
 #include "mir/geometry/rectangle.h"
 #include "mir/geometry/point.h"
@@ -58,7 +59,8 @@ private:
     
     std::shared_ptr<mir::graphics::Platform> graphics_platform;
     
-    void synthesize_event_at(mir::geometry::Point const& point);
+    void synthesize_event_at(mir::geometry::Point const& point,
+        mir::input::synthesis::TouchParameters::Action action);
     void thread_function();
 
     std::unique_ptr<mir_test_framework::FakeInputDevice> const touch_screen;
@@ -5,6 +5,7 @@ import time
 import evdev
 import statistics
 import subprocess
+import argparse
 
 ###### Helper classes ######
 
@@ -57,7 +58,12 @@ class TouchScreen:
 
 ####### TEST #######
 
-host = Server(reports=["input"])
+parser = argparse.ArgumentParser(description="Measure kernel to client touch event latency")
+parser.add_argument("--coalesce-input", type=int, default=0, metavar="HZ",
+                    help="Have the host server coalesce input at this rate (0 to deliver events as they arrive)")
+args = parser.parse_args()
+
+host = Server(reports=["input"], options=["--coalesce-input=%d" % args.coalesce_input])
 nested = Server(host=host, reports=["client-input-receiver"])
 client = Client(server=nested, reports=["client-input-receiver"], options=["-f"])
 
@@ -98,7 +104,7 @@ for event in trace.events:
         data[pid].append((event.timestamp - event["event_time"]) / 1000000.0)
 
 
-print("=== Results ===")
+print("=== Results (input coalescing rate: %d Hz) ===" % args.coalesce_input)
 
 nested_data = data[pids["nested"]]
 print("Nested server received %d events" % len(nested_data))
@@ -200,6 +200,26 @@ void mir_screencast_capture_to_buffer(
  **/
 MirScreencastResult mir_screencast_capture_to_buffer_sync(MirScreencast* screencast, MirBuffer* buffer);
 
+/** Retrieve the parts of the buffer that changed in the most recently
+ *  completed capture, relative to the capture before it.
+ *
+ *  Call this from the available_callback of mir_screencast_capture_to_buffer
+ *  or after mir_screencast_capture_to_buffer_sync returns. If nothing
+ *  changed there are no rectangles, and a buffer that already held the
+ *  previous capture is left as it was.
+ *
+ *   \param [in]  screencast       The screencast
+ *   \param [out] damage           Receives up to max_rectangles rectangles,
+ *                                 in buffer coordinates
+ *   \param [in]  max_rectangles   The capacity of damage
+ *   \return                       The number of damaged rectangles (which
+ *                                 may exceed max_rectangles), or -1 if the
+ *                                 server doesn't report damage and the whole
+ *                                 buffer should be considered changed
+ **/
+int mir_screencast_get_damage(
+    MirScreencast* screencast, MirRectangle* damage, unsigned int max_rectangles);
+
 #ifdef __cplusplus
 }
 /**@}*/
@@ -22,6 +22,7 @@
 #include "mir/dispatch/dispatchable.h"
 #include "mir/posix_rw_mutex.h"
 
+#include <atomic>
 #include <functional>
 #include <initializer_list>
 #include <list>
@@ -49,6 +50,9 @@ enum class DispatchReentrancy
 /**
  * \brief An adaptor that combines multiple Dispatchables into a single Dispatchable
  * \note Instances are fully thread-safe.
+ * \note A single dispatch() services (up to a small limit) every source that is
+ *       ready at the time, each at most once. If another thread finds nothing to
+ *       dispatch meanwhile, the sources not yet reached are handed back to it.
  */
 class MultiplexingDispatchable final : public Dispatchable
 {
@@ -95,10 +99,15 @@ public:
      */
     void remove_watch(Fd const& fd);
 private:
+    bool is_watched(void const* holder);
+
     PosixRWMutex lifetime_mutex;
     std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
 
     Fd epoll_fd;
+
+    // Set when a dispatch() finds every ready source taken by a batch in progress
+    std::atomic<bool> starved{false};
 };
 }
 }
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_GEOMETRY_REGION_H_
+#define MIR_GEOMETRY_REGION_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/displacement.h"
+
+#include <vector>
+#include <initializer_list>
+#include <iosfwd>
+
+namespace mir
+{
+namespace geometry
+{
+
+/**
+ * A set of pixels, held as a sorted list of non-overlapping rectangles.
+ *
+ * The rectangles are organised in bands: rectangles in the same band share
+ * their top and bottom and are sorted left to right without touching, bands
+ * are sorted top to bottom. This makes the representation of any set of
+ * pixels unique, so regions can be compared rectangle by rectangle.
+ */
+class Region
+{
+public:
+    Region();
+    Region(Rectangle const& rect);
+    Region(std::initializer_list<Rectangle> const& rects);
+
+    bool empty() const;
+    Rectangle bounding_rectangle() const;
+    bool contains(Point const& point) const;
+    /// True if every pixel of rect is in the region
+    bool contains(Rectangle const& rect) const;
+
+    void unite(Region const& other);
+    void subtract(Region const& other);
+    void intersect(Region const& other);
+    void translate(Displacement const& offset);
+    void clear();
+
+    typedef std::vector<Rectangle>::const_iterator const_iterator;
+    typedef std::vector<Rectangle>::size_type size_type;
+    const_iterator begin() const;
+    const_iterator end() const;
+    /// The number of rectangles (not pixels) in the region
+    size_type size() const;
+
+    bool operator==(Region const& other) const;
+    bool operator!=(Region const& other) const;
+
+private:
+    std::vector<Rectangle> rects;
+};
+
+std::ostream& operator<<(std::ostream& out, Region const& value);
+
+}
+}
+
+#endif /* MIR_GEOMETRY_REGION_H_ */
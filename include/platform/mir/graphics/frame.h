@@ -40,6 +40,7 @@ struct Frame
 
     int64_t msc = 0;   /**< Media Stream Counter */
     Timestamp ust;     /**< Unadjusted System Time */
+    bool vsync = false; /**< Shown at vblank, with msc and ust from the hardware (as for a KMS page flip) */
 };
 
 }} // namespace mir::graphics
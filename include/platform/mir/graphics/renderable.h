@@ -19,7 +19,9 @@
 #ifndef MIR_GRAPHICS_RENDERABLE_H_
 #define MIR_GRAPHICS_RENDERABLE_H_
 
-#include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/geometry/region.h>
+#include <mir/graphics/buffer_id.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -50,6 +52,12 @@ public:
 
     virtual geometry::Rectangle screen_position() const = 0;
 
+    /**
+     * The part of buffer() (in buffer coordinates) that is drawn, scaled to
+     * fill screen_position(). Usually the whole of buffer().
+     */
+    virtual geometry::Rectangle src_bounds() const = 0;
+
     // These are from the old CompositingCriteria. There is a little bit
     // of function overlap with the above functions still.
     virtual float alpha() const = 0;
@@ -70,7 +78,22 @@ public:
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
+    /**
+     * The parts of screen_position() that are drawn fully opaque, and so
+     * completely hide anything beneath them. Empty if the renderable is
+     * translucent, the whole of screen_position() if it is not shaped() and
+     * alpha() is 1.
+     */
+    virtual geometry::Region opaque_region() const = 0;
+
     virtual unsigned int swap_interval() const = 0;
+
+    /**
+     * The parts of buffer() (in buffer coordinates) whose content differs
+     * from the buffer with id \a previous. When that can't be determined
+     * this is the whole of buffer().
+     */
+    virtual geometry::Rectangles buffer_damage_since(BufferID previous) const = 0;
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
@@ -20,8 +20,12 @@
 #ifndef MIR_PLATFORM_GRAPHICS_WAYLAND_ALLOCATOR_H_
 #define MIR_PLATFORM_GRAPHICS_WAYLAND_ALLOCATOR_H_
 
+#include "mir/fd.h"
+#include "mir/geometry/size.h"
+
 #include <memory>
 #include <functional>
+#include <vector>
 
 #include <wayland-server-core.h>
 
@@ -33,6 +37,50 @@ namespace graphics
 {
 class Buffer;
 
+/// A DRM fourcc format and layout modifier that can be imported from a dma-buf
+struct DmaBufFormat
+{
+    uint32_t fourcc;
+    uint64_t modifier;
+};
+
+/// The planes (and their layout) making up a client-allocated dma-buf
+struct DmaBufAttributes
+{
+    struct Plane
+    {
+        Fd fd;
+        uint32_t offset;
+        uint32_t stride;
+    };
+
+    geometry::Size size;
+    uint32_t fourcc;
+    uint64_t modifier;
+    std::vector<Plane> planes;
+};
+
+/**
+ * A client dma-buf imported by the graphics platform.
+ *
+ * The import is kept for as long as the client's wl_buffer, so the cost of
+ * importing is paid once rather than on every commit.
+ */
+class ImportedDmaBuf
+{
+public:
+    ImportedDmaBuf() = default;
+    virtual ~ImportedDmaBuf() = default;
+
+    ImportedDmaBuf(ImportedDmaBuf const&) = delete;
+    ImportedDmaBuf& operator=(ImportedDmaBuf const&) = delete;
+
+    /// A Buffer for one commit of the dma-buf, sharing the import with every other commit
+    virtual std::shared_ptr<Buffer> buffer(
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release) = 0;
+};
+
 class WaylandAllocator
 {
 public:
@@ -47,6 +95,21 @@ public:
         wl_resource* buffer,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release) = 0;
+
+    /**
+     * The dma-buf formats this allocator can import.
+     *
+     * The default implementation supports none.
+     */
+    virtual std::vector<DmaBufFormat> dmabuf_formats();
+
+    /**
+     * Import a client dma-buf
+     *
+     * \throws std::runtime_error if the dma-buf cannot be imported; the
+     *         caller may then fall back to reading it with the CPU.
+     */
+    virtual std::shared_ptr<ImportedDmaBuf> import_dmabuf(DmaBufAttributes const& attributes);
 };
 }
 }
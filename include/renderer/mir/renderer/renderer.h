@@ -20,6 +20,8 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/region.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
@@ -36,6 +38,17 @@ public:
 
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     virtual void set_output_transform(glm::mat2 const&) = 0;
+    /**
+     * Restricts the next render() to the damaged parts of the viewport.
+     * An empty damage list means nothing changed. If set_damage() is not
+     * called before render() the whole viewport is redrawn.
+     */
+    virtual void set_damage(geometry::Rectangles const& damage) = 0;
+    /**
+     * Restricts drawing of the renderable with the given id in the next
+     * render() to region, typically because the rest of it is hidden.
+     */
+    virtual void set_visible_region(graphics::Renderable::ID id, geometry::Region const& region) = 0;
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
@@ -0,0 +1,60 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_
+#define MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_
+
+#include "mir/geometry/rectangles.h"
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * A TextureSource whose content can be uploaded into a texture piecemeal.
+ *
+ * This allows a texture that already holds an earlier image of the same size
+ * and format (typically the previous buffer of the same stream) to be kept,
+ * updating only the parts that have changed rather than reallocating its
+ * storage and uploading every texel.
+ */
+class IncrementalTextureSource
+{
+public:
+    virtual ~IncrementalTextureSource() = default;
+
+    /**
+     * Replace the damaged parts of the bound texture's image with our content.
+     * The texture must already have storage of our size and pixel format.
+     *   \param [in] damage  The areas to upload, in buffer coordinates.
+     */
+    virtual void update_texture(geometry::Rectangles const& damage) = 0;
+
+protected:
+    IncrementalTextureSource() = default;
+    IncrementalTextureSource(IncrementalTextureSource const&) = delete;
+    IncrementalTextureSource& operator=(IncrementalTextureSource const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_GL_INCREMENTAL_TEXTURE_SOURCE_H_ */
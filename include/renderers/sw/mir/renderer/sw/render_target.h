@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/geometry/dimensions.h"
+#include "mir/geometry/size.h"
+#include "mir/geometry/region.h"
+#include "mir_toolkit/common.h"
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/**
+ * A display buffer that can be drawn into by the CPU.
+ */
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    /**
+     * Maps the buffer to draw the next frame into. The mapping is valid
+     * until swap_buffers().
+     */
+    virtual unsigned char* map_for_write() = 0;
+    virtual geometry::Size size() const = 0;
+    virtual geometry::Stride stride() const = 0;
+    virtual MirPixelFormat pixel_format() const = 0;
+    /**
+     * How many frames ago the mapped buffer was drawn, as with
+     * EGL_EXT_buffer_age. Zero means its contents are undefined.
+     */
+    virtual int buffer_age() const = 0;
+    /**
+     * Presents what has been drawn since map_for_write(). Only \a damage
+     * (in buffer coordinates) was drawn; the rest is as buffer_age() said.
+     */
+    virtual void swap_buffers(geometry::Region const& damage) = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_SW_RENDER_TARGET_H_ */
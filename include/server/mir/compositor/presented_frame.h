@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_PRESENTED_FRAME_H_
+#define MIR_COMPOSITOR_PRESENTED_FRAME_H_
+
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+
+namespace mir
+{
+namespace compositor
+{
+
+/// A frame that has been presented, as timed by the output that showed it
+struct PresentedFrame
+{
+    /// The output's frame counter (0 if it has none) and when the frame was shown (on CLOCK_MONOTONIC)
+    graphics::Frame frame;
+    /// The output's refresh period, or zero if that isn't known
+    std::chrono::nanoseconds refresh{0};
+
+    /// A frame without an output to time it, such as a throttled frame, shown \a now
+    static PresentedFrame untimed(std::chrono::steady_clock::time_point now)
+    {
+        // std::chrono::steady_clock is CLOCK_MONOTONIC
+        return {{0, {CLOCK_MONOTONIC, now.time_since_epoch()}}, std::chrono::nanoseconds{0}};
+    }
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_PRESENTED_FRAME_H_
@@ -20,7 +20,9 @@
 #define MIR_COMPOSITOR_SCENE_H_
 
 #include "compositor_id.h"
+#include "presented_frame.h"
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -65,6 +67,15 @@ public:
      */
     virtual int frames_pending(CompositorID id) const = 0;
 
+    /**
+     * Notify the scene that the frame most recently composited for \a id
+     * has been posted to the display (that is, post() has completed).
+     * \param [in] frame  When the frame reached the screen, as timed by its output.
+     */
+    virtual void frame_presented(
+        CompositorID id,
+        PresentedFrame const& frame) = 0;
+
     virtual void register_compositor(CompositorID id) = 0;
     virtual void unregister_compositor(CompositorID id) = 0;
 
@@ -21,7 +21,12 @@
 
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
+#include "mir/compositor/presented_frame.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/region.h"
+#include "mir/optional_value.h"
+#include <chrono>
 #include <functional>
 #include <memory>
 
@@ -43,9 +48,29 @@ public:
     
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
 
+    /**
+     * Submit a buffer of which only the damaged parts (in buffer coordinates)
+     * differ from the previously submitted one.
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) = 0;
+
     virtual void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) = 0;
 
+    /**
+     * Called once a frame including a buffer submitted since the last call
+     * has been presented: on screen, or (throttled) while the stream was hidden.
+     * Also called when a frame first shows a buffer that was submitted earlier.
+     *
+     * Submitted buffers are numbered from 1 in the order they are submitted;
+     * \a shown is the number of the latest buffer the compositor has shown, or
+     * 0 if it has shown none.
+     */
+    virtual void set_frame_presented_callback(
+        std::function<void(compositor::PresentedFrame const&, bool on_screen, uint64_t shown)> const& callback) = 0;
+
     virtual void with_most_recent_buffer_do(
         std::function<void(graphics::Buffer&)> const& exec) = 0;
 
@@ -55,6 +80,22 @@ public:
     //      side once we only support the NBS system.
     virtual void allow_framedropping(bool) = 0;
     virtual void set_scale(float scale) = 0;
+
+    /**
+     * The parts of submitted buffers the client promises are fully opaque,
+     * whatever the pixel format's alpha channel. This is in buffer
+     * coordinates, or those of the destination if set_viewport() is used.
+     */
+    virtual void set_opaque_region(geometry::Region const& region) = 0;
+
+    /**
+     * Show only \a source (in buffer coordinates) of submitted buffers, scaled
+     * to \a destination. An unset source is the whole buffer, and an unset
+     * destination is the size of the source.
+     */
+    virtual void set_viewport(
+        optional_value<geometry::Rectangle> const& source,
+        optional_value<geometry::Size> const& destination) = 0;
 protected:
     BufferStream() = default;
     BufferStream(BufferStream const&) = delete;
@@ -23,8 +23,10 @@
 #include "mir/input/surface.h"
 #include "mir/frontend/surface.h"
 #include "mir/compositor/compositor_id.h"
+#include "mir/compositor/presented_frame.h"
 #include "mir/optional_value.h"
 
+#include <chrono>
 #include <vector>
 #include <list>
 
@@ -64,7 +66,15 @@ public:
     virtual geometry::Size size() const = 0;
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
+    /// As generate_renderables(), but appends to a list whose storage the caller can reuse
+    virtual void append_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const = 0;
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
+    /**
+     * A frame has reached the screen. That's one showing this surface when \a on_screen,
+     * otherwise a throttled one the surface was hidden from (or no frame at all while the
+     * scene is idle), so its client can pace itself without its content being presented.
+     */
+    virtual void frame_presented(compositor::PresentedFrame const& frame, bool on_screen) = 0;
 
     virtual MirWindowType type() const = 0;
     virtual MirWindowState state() const = 0;
@@ -85,6 +95,8 @@ public:
      * set_input_region({Rectangle{}}).
      */
     virtual void set_input_region(std::vector<geometry::Rectangle> const& region) = 0;
+    /// Bounding box of input_bounds() and the input region, which may reach beyond it
+    virtual geometry::Rectangle input_area_bounds() const = 0;
     virtual void resize(geometry::Size const& size) = 0;
     virtual void set_transformation(glm::mat4 const& t) = 0;
     virtual void set_alpha(float alpha) = 0;
@@ -53,6 +53,8 @@ public:
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const&) override;
     void configure(mir::graphics::DisplayConfiguration const&) override;
 
+    mir::graphics::Frame last_frame_on(unsigned output_id) const override;
+
     void emit_configuration_change_event(
         std::shared_ptr<mir::graphics::DisplayConfiguration> const& new_config);
 
@@ -20,6 +20,7 @@
 #define MIR_TEST_DOUBLES_NULL_DISPLAY_SYNC_GROUP_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/atomic_frame.h"
 #include "mir/geometry/size.h"
 #include "mir/test/doubles/null_display_buffer.h"
 #include "mir/test/doubles/stub_display_buffer.h"
@@ -51,6 +52,7 @@ public:
 
     void post() override
     {
+        last_frame_.increment_now();
         /* yield() is needed to ensure reasonable runtime under valgrind for some tests */
         std::this_thread::yield();
     }
@@ -60,9 +62,16 @@ public:
         return std::chrono::milliseconds::zero();
     }
 
+    /// Each post() counts as a frame, shown when it happens
+    graphics::Frame last_frame() const
+    {
+        return last_frame_.load();
+    }
+
 private:
     std::vector<geometry::Rectangle> const output_rects;
     std::vector<StubDisplayBuffer> display_buffers;
+    graphics::AtomicFrame last_frame_;
 };
 
 struct NullDisplaySyncGroup : graphics::DisplaySyncGroup
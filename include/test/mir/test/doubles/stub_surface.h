@@ -39,6 +39,7 @@ struct StubSurface : scene::Surface
     input::InputReceptionMode reception_mode() const override;
     void set_reception_mode(input::InputReceptionMode mode) override;
     void set_input_region(std::vector<geometry::Rectangle> const& input_rectangles) override;
+    geometry::Rectangle input_area_bounds() const override;
     void resize(geometry::Size const& size) override;
     geometry::Point top_left() const override;
     geometry::Rectangle input_bounds() const override;
@@ -49,7 +50,9 @@ struct StubSurface : scene::Surface
     void set_transformation(glm::mat4 const&) override;
     bool visible() const override;
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    void append_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
+    void frame_presented(compositor::PresentedFrame const& frame, bool on_screen) override;
     MirWindowType type() const override;
     MirWindowState state() const override;
     int configure(MirWindowAttrib attrib, int value) override;
@@ -263,6 +263,11 @@ void MirScreencast::screencast_done(ScreencastRequest* request)
             request_holder = std::move(*it);
             requests.erase(it);
         }
+
+        damage_reported = status == mir_screencast_success && request->response.damage_reported();
+        damage.clear();
+        for (auto const& rect : request->response.damage())
+            damage.push_back(MirRectangle{rect.left(), rect.top(), rect.width(), rect.height()});
     }
 
     request->available_callback(status, reinterpret_cast<MirBuffer*>(request->buffer), request->available_context);
@@ -289,3 +294,13 @@ void MirScreencast::screencast_to_buffer(
         &(requests.back()->response),
         google::protobuf::NewCallback(this, &MirScreencast::screencast_done, requests.back().get()));
 }
+
+int MirScreencast::get_damage(MirRectangle* rects, unsigned int max_rectangles) const
+{
+    std::lock_guard<decltype(mutex)> lock(mutex);
+    if (!damage_reported)
+        return -1;
+
+    std::copy_n(damage.begin(), std::min<size_t>(damage.size(), max_rectangles), rects);
+    return damage.size();
+}
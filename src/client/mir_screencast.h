@@ -92,6 +92,9 @@ public:
         MirScreencastBufferCallback available_callback,
         void* available_context);
 
+    /// The damage of the last capture to complete, or -1 if the server didn't say
+    int get_damage(MirRectangle* damage, unsigned int max_rectangles) const;
+
 private:
     void screencast_created(
         MirScreencastCallback callback, void* context);
@@ -123,9 +126,11 @@ private:
         mir::client::MirBuffer* buffer;
         MirScreencastBufferCallback available_callback;
         void* available_context;
-        mir::protobuf::Void response;
+        mir::protobuf::ScreencastCapture response;
     };
     std::vector<std::unique_ptr<ScreencastRequest>> requests;
+    bool damage_reported{false};
+    std::vector<MirRectangle> damage;
     void screencast_done(ScreencastRequest* request);
 };
 
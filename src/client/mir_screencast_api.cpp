@@ -168,3 +168,17 @@ catch (std::exception const& ex)
     MIR_LOG_UNCAUGHT_EXCEPTION(ex);
     return mir_screencast_error_failure;
 }
+
+int mir_screencast_get_damage(MirScreencast* screencast, MirRectangle* damage, unsigned int max_rectangles)
+try
+{
+    mir::require(screencast);
+    mir::require(damage || max_rectangles == 0);
+
+    return screencast->get_damage(damage, max_rectangles);
+}
+catch (std::exception const& ex)
+{
+    MIR_LOG_UNCAUGHT_EXCEPTION(ex);
+    return -1;
+}
@@ -31,11 +31,19 @@
 #include <string.h>
 #include <system_error>
 #include <algorithm>
+#include <array>
+#include <utility>
 
 namespace md = mir::dispatch;
 
 namespace
 {
+std::size_t const max_events_per_dispatch{16};
+
+// Set by remove_watch() so a batch in progress on this thread knows to check
+// that the sources it has yet to dispatch are still wanted.
+thread_local bool watch_removed{false};
+
 class DispatchableAdaptor : public md::Dispatchable
 {
 public:
@@ -108,48 +116,121 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    // Harvest every source that's ready (up to a limit) with a single epoll_wait()
+    // rather than paying a wakeup per source. Each harvested source is dispatched
+    // once; sequential sources are one-shot, so a busy source is only re-armed
+    // after the others have had their turn. When several threads dispatch us the
+    // rest of a batch is re-armed for them as soon as one of them runs dry.
+    std::array<epoll_event, max_events_per_dispatch> ready;
+    std::array<std::shared_ptr<md::Dispatchable>, max_events_per_dispatch> sources;
+    std::array<bool, max_events_per_dispatch> rearm_source;
+    int ready_count;
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        ready_count = epoll_wait(epoll_fd, ready.data(), static_cast<int>(ready.size()), 0);
 
-        if (result < 0)
+        if (ready_count < 0)
         {
             BOOST_THROW_EXCEPTION((std::system_error{errno,
                                                      std::system_category(),
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        // If ready_count is 0 some other thread must have stolen the event
+        // we were woken for; that's ok, we just don't dispatch anything. If it
+        // was harvested into a batch that thread is still working through, it
+        // hands the sources it hasn't reached back to us.
+        if (ready_count == 0)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            starved = true;
         }
 
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
+        for (int i = 0; i != ready_count; ++i)
+        {
+            auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(ready[i].data.ptr);
 
-        source = event_source->first;
-        rearm_source = event_source->second;
+            sources[i] = event_source->first;
+            rearm_source[i] = event_source->second;
+        }
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
+    int next{0};
+
+    auto const rearm = [this, &ready, &sources](int i)
+        {
+            ready[i].events = fd_event_to_epoll(sources[i]->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sources[i]->watch_fd(), &ready[i]);
+        };
+
+    // Sources may themselves be MultiplexingDispatchables running a batch of
+    // their own on this thread; start ours clean and hand any removals back to
+    // the batch enclosing us.
+    auto const enclosing_watch_removed = std::exchange(watch_removed, false);
+
+    auto const hand_back = [this, &ready, &rearm_source, &rearm, ready_count](int from)
+        {
+            for (auto i = from; i < ready_count; ++i)
+            {
+                if (rearm_source[i] && (!watch_removed || is_watched(ready[i].data.ptr)))
+                {
+                    rearm(i);
+                }
+            }
+        };
+
+    try
     {
-        remove_watch(source);
+        for (; next != ready_count; ++next)
+        {
+            // Don't keep another thread idle behind a slow dispatch earlier in the batch
+            if (next != 0 && starved.exchange(false))
+            {
+                hand_back(next);
+                break;
+            }
+
+            // A dispatch earlier in this batch may have removed a later source
+            if (watch_removed && !is_watched(ready[next].data.ptr))
+            {
+                continue;
+            }
+
+            if (!sources[next]->dispatch(epoll_to_fd_event(ready[next])))
+            {
+                remove_watch(sources[next]);
+            }
+            else if (rearm_source[next])
+            {
+                rearm(next);
+            }
+        }
     }
-    else if (rearm_source)
+    catch (...)
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        // Sources we harvested but never reached would otherwise stay disarmed forever
+        hand_back(next + 1);
+        watch_removed |= enclosing_watch_removed;
+        throw;
     }
 
+    watch_removed |= enclosing_watch_removed;
+
     return true;
 }
 
+bool md::MultiplexingDispatchable::is_watched(void const* holder)
+{
+    std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+
+    return std::any_of(dispatchee_holder.begin(), dispatchee_holder.end(),
+        [holder](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
+        {
+            return &candidate == holder;
+        });
+}
+
 md::FdEvents md::MultiplexingDispatchable::relevant_events() const
 {
     return md::FdEvent::readable;
@@ -222,6 +303,8 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
                                                  "Failed to remove fd monitor"}));
     }
 
+    watch_removed = true;
+
     std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
     dispatchee_holder.remove_if([&fd](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
     {
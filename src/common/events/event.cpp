@@ -35,7 +35,11 @@
 #include "mir/events/surface_placement_event.h"
 
 #include <capnp/serialize.h>
+#include <kj/io.h>
 
+#include <mutex>
+#include <new>
+#include <vector>
 
 namespace ml = mir::logging;
 
@@ -54,6 +58,75 @@ MirEvent& MirEvent::operator=(MirEvent const& e)
     return *this;
 }
 
+namespace
+{
+// Every concrete event type shares MirEvent's layout, so one block size serves them all.
+class EventStoragePool
+{
+public:
+    void* allocate()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (!free_blocks.empty())
+            {
+                auto const block = free_blocks.back();
+                free_blocks.pop_back();
+                return block;
+            }
+        }
+
+        return ::operator new(sizeof(MirEvent));
+    }
+
+    void release(void* block)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (free_blocks.size() < max_free_blocks)
+            {
+                free_blocks.push_back(block);
+                return;
+            }
+        }
+
+        ::operator delete(block);
+    }
+
+private:
+    static std::size_t const max_free_blocks = 256;
+
+    std::mutex mutex;
+    std::vector<void*> free_blocks;
+};
+
+// Deliberately leaked: events may still be released while other statics are destroyed
+EventStoragePool& storage_pool()
+{
+    static auto const pool = new EventStoragePool;
+    return *pool;
+}
+}
+
+void* MirEvent::operator new(std::size_t size)
+{
+    if (size != sizeof(MirEvent))
+        return ::operator new(size);
+
+    return storage_pool().allocate();
+}
+
+void MirEvent::operator delete(void* block, std::size_t size)
+{
+    if (!block)
+        return;
+
+    if (size != sizeof(MirEvent))
+        ::operator delete(block);
+    else
+        storage_pool().release(block);
+}
+
 // TODO Look at replacing the surface event serializer with a capnproto layer
 mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
 {
@@ -69,10 +142,14 @@ mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
 
 std::string MirEvent::serialize(MirEvent const* event)
 {
-    std::string output;
-    auto flat_event = ::capnp::messageToFlatArray(const_cast<MirEvent*>(event)->message);
+    // Write straight into the result rather than via an intermediate flat array
+    auto const segments = const_cast<MirEvent*>(event)->message.getSegmentsForOutput();
+    std::string output(::capnp::computeSerializedSizeInWords(segments) * sizeof(::capnp::word), '\0');
+
+    kj::ArrayOutputStream stream{kj::arrayPtr(reinterpret_cast<kj::byte*>(&output[0]), output.size())};
+    ::capnp::writeMessage(stream, segments);
 
-    return {reinterpret_cast<char*>(flat_event.asBytes().begin()), flat_event.asBytes().size()};
+    return output;
 }
 
 MirEventType MirEvent::type() const
@@ -0,0 +1,294 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/geometry/region.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace geom = mir::geometry;
+
+namespace
+{
+struct Span
+{
+    int left;
+    int right;
+};
+
+enum class Op { unite, subtract, intersect };
+
+bool in_result(Op op, bool in_a, bool in_b)
+{
+    switch (op)
+    {
+    case Op::unite:     return in_a || in_b;
+    case Op::subtract:  return in_a && !in_b;
+    case Op::intersect: return in_a && in_b;
+    }
+    return false;
+}
+
+/// The spans of the band of rects covering row y, advancing index past bands above y
+void spans_at(
+    std::vector<geom::Rectangle> const& rects,
+    size_t& index,
+    int y,
+    std::vector<Span>& spans)
+{
+    spans.clear();
+
+    while (index < rects.size() && rects[index].bottom().as_int() <= y)
+        ++index;
+
+    for (auto i = index; i < rects.size() && rects[i].top_left.y.as_int() <= y; ++i)
+    {
+        if (rects[i].bottom().as_int() > y)
+            spans.push_back({rects[i].top_left.x.as_int(), rects[i].right().as_int()});
+    }
+}
+
+/// Combines two sorted lists of disjoint spans
+void combine_spans(Op op, std::vector<Span> const& a, std::vector<Span> const& b, std::vector<Span>& result)
+{
+    result.clear();
+
+    size_t ia = 0, ib = 0;
+    int x = std::numeric_limits<int>::min();
+
+    while (ia < a.size() || ib < b.size())
+    {
+        // Skip spans that end at or before x
+        while (ia < a.size() && a[ia].right <= x) ++ia;
+        while (ib < b.size() && b[ib].right <= x) ++ib;
+        if (ia == a.size() && ib == b.size())
+            break;
+
+        bool const in_a = ia < a.size() && a[ia].left <= x;
+        bool const in_b = ib < b.size() && b[ib].left <= x;
+
+        // The next x at which membership of either list changes
+        int next = std::numeric_limits<int>::max();
+        if (ia < a.size()) next = std::min(next, in_a ? a[ia].right : a[ia].left);
+        if (ib < b.size()) next = std::min(next, in_b ? b[ib].right : b[ib].left);
+
+        if (in_result(op, in_a, in_b) && x != std::numeric_limits<int>::min())
+        {
+            if (!result.empty() && result.back().right == x)
+                result.back().right = next;
+            else
+                result.push_back({x, next});
+        }
+
+        x = next;
+    }
+}
+
+bool same_spans(std::vector<geom::Rectangle> const& rects, size_t band_start, std::vector<Span> const& spans)
+{
+    if (rects.size() - band_start != spans.size())
+        return false;
+
+    for (size_t i = 0; i != spans.size(); ++i)
+    {
+        auto const& rect = rects[band_start + i];
+        if (rect.top_left.x.as_int() != spans[i].left || rect.right().as_int() != spans[i].right)
+            return false;
+    }
+    return true;
+}
+
+std::vector<geom::Rectangle> combine(
+    Op op,
+    std::vector<geom::Rectangle> const& a,
+    std::vector<geom::Rectangle> const& b)
+{
+    std::vector<int> ys;
+    ys.reserve(2 * (a.size() + b.size()));
+    for (auto const& rects : {&a, &b})
+    {
+        for (auto const& rect : *rects)
+        {
+            ys.push_back(rect.top_left.y.as_int());
+            ys.push_back(rect.bottom().as_int());
+        }
+    }
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+    std::vector<geom::Rectangle> result;
+    std::vector<Span> spans_a, spans_b, spans;
+    size_t index_a = 0, index_b = 0;
+    size_t band_start = 0;
+    int band_bottom = std::numeric_limits<int>::min();
+
+    for (size_t i = 0; i + 1 < ys.size(); ++i)
+    {
+        int const top = ys[i];
+        int const bottom = ys[i + 1];
+
+        spans_at(a, index_a, top, spans_a);
+        spans_at(b, index_b, top, spans_b);
+        combine_spans(op, spans_a, spans_b, spans);
+
+        if (spans.empty())
+            continue;
+
+        // Extend the band above if it is adjacent and identical
+        if (band_bottom == top && same_spans(result, band_start, spans))
+        {
+            for (auto r = band_start; r != result.size(); ++r)
+                result[r].size.height = geom::Height{bottom - result[r].top_left.y.as_int()};
+        }
+        else
+        {
+            band_start = result.size();
+            for (auto const& span : spans)
+                result.push_back({{span.left, top}, {span.right - span.left, bottom - top}});
+        }
+        band_bottom = bottom;
+    }
+
+    return result;
+}
+}
+
+geom::Region::Region()
+{
+}
+
+geom::Region::Region(Rectangle const& rect)
+{
+    if (rect.size.width > Width{0} && rect.size.height > Height{0})
+        rects.push_back(rect);
+}
+
+geom::Region::Region(std::initializer_list<Rectangle> const& rects)
+{
+    for (auto const& rect : rects)
+        unite(rect);
+}
+
+bool geom::Region::empty() const
+{
+    return rects.empty();
+}
+
+geom::Rectangle geom::Region::bounding_rectangle() const
+{
+    if (rects.empty())
+        return {};
+
+    // Bands are sorted vertically, but any band may be widest
+    int left = rects.front().top_left.x.as_int();
+    int right = rects.front().right().as_int();
+    for (auto const& rect : rects)
+    {
+        left = std::min(left, rect.top_left.x.as_int());
+        right = std::max(right, rect.right().as_int());
+    }
+
+    int const top = rects.front().top_left.y.as_int();
+    int const bottom = rects.back().bottom().as_int();
+    return {{left, top}, {right - left, bottom - top}};
+}
+
+bool geom::Region::contains(Point const& point) const
+{
+    for (auto const& rect : rects)
+    {
+        if (rect.top_left.y > point.y)
+            break;
+        if (rect.contains(point))
+            return true;
+    }
+    return false;
+}
+
+bool geom::Region::contains(Rectangle const& rect) const
+{
+    Region uncovered{rect};
+    uncovered.subtract(*this);
+    return uncovered.empty();
+}
+
+void geom::Region::unite(Region const& other)
+{
+    if (other.rects.empty())
+        return;
+    if (rects.empty())
+    {
+        rects = other.rects;
+        return;
+    }
+    rects = combine(Op::unite, rects, other.rects);
+}
+
+void geom::Region::subtract(Region const& other)
+{
+    if (rects.empty() || other.rects.empty())
+        return;
+    rects = combine(Op::subtract, rects, other.rects);
+}
+
+void geom::Region::intersect(Region const& other)
+{
+    if (rects.empty())
+        return;
+    if (other.rects.empty())
+    {
+        rects.clear();
+        return;
+    }
+    rects = combine(Op::intersect, rects, other.rects);
+}
+
+void geom::Region::translate(Displacement const& offset)
+{
+    for (auto& rect : rects)
+        rect.top_left = rect.top_left + offset;
+}
+
+void geom::Region::clear()
+{
+    rects.clear();
+}
+
+geom::Region::const_iterator geom::Region::begin() const
+{
+    return rects.begin();
+}
+
+geom::Region::const_iterator geom::Region::end() const
+{
+    return rects.end();
+}
+
+geom::Region::size_type geom::Region::size() const
+{
+    return rects.size();
+}
+
+bool geom::Region::operator==(Region const& other) const
+{
+    return rects == other.rects;
+}
+
+bool geom::Region::operator!=(Region const& other) const
+{
+    return rects != other.rects;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/async_readback.h"
+
+#include <EGL/egl.h>
+#include MIR_SERVER_GLEXT_H
+
+#include <boost/throw_exception.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+
+namespace mgl = mir::gl;
+namespace geom = mir::geometry;
+
+// The GLES 3.0 (and OpenGL 3.2) names we need, for building against GLES2 headers
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+
+namespace
+{
+typedef struct __GLsync* Sync;
+
+// Long enough not to spin, short enough to notice a lost context
+uint64_t const fence_timeout_ns{1000000000};
+
+bool gl_version_at_least(int es_major, int es_minor, int major, int minor)
+{
+    auto const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+    if (!version)
+        return false;
+
+    int found_major{0}, found_minor{0};
+    if (sscanf(version, "OpenGL ES %d.%d", &found_major, &found_minor) == 2)
+        return found_major > es_major || (found_major == es_major && found_minor >= es_minor);
+    if (sscanf(version, "%d.%d", &found_major, &found_minor) == 2)
+        return found_major > major || (found_major == major && found_minor >= minor);
+
+    return false;
+}
+
+template<typename Function>
+Function lookup(char const* name)
+{
+    return reinterpret_cast<Function>(eglGetProcAddress(name));
+}
+}
+
+struct mgl::AsyncReadback::Functions
+{
+    Functions() :
+        glMapBufferRange{lookup<void* (*)(GLenum, GLintptr, GLsizeiptr, GLbitfield)>("glMapBufferRange")},
+        glUnmapBuffer{lookup<GLboolean (*)(GLenum)>("glUnmapBuffer")},
+        glFenceSync{lookup<Sync (*)(GLenum, GLbitfield)>("glFenceSync")},
+        glClientWaitSync{lookup<GLenum (*)(Sync, GLbitfield, uint64_t)>("glClientWaitSync")},
+        glDeleteSync{lookup<void (*)(Sync)>("glDeleteSync")}
+    {
+        if (!glMapBufferRange || !glUnmapBuffer || !glFenceSync || !glClientWaitSync || !glDeleteSync)
+            BOOST_THROW_EXCEPTION(std::runtime_error("GL implementation doesn't support buffer mapping and fences"));
+    }
+
+    void* (* const glMapBufferRange)(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+    GLboolean (* const glUnmapBuffer)(GLenum target);
+    Sync (* const glFenceSync)(GLenum condition, GLbitfield flags);
+    GLenum (* const glClientWaitSync)(Sync sync, GLbitfield flags, uint64_t timeout);
+    void (* const glDeleteSync)(Sync sync);
+};
+
+bool mgl::AsyncReadback::available()
+{
+    if (!gl_version_at_least(3, 0, 3, 2))
+        return false;
+
+    try
+    {
+        Functions const check;
+        return true;
+    }
+    catch (std::runtime_error const&)
+    {
+        return false;
+    }
+}
+
+mgl::AsyncReadback::AsyncReadback(unsigned int depth)
+    : gl{std::make_unique<Functions>()},
+      slots(depth, Slot{0, nullptr, 0, {}})
+{
+    if (depth == 0)
+        BOOST_THROW_EXCEPTION(std::logic_error("AsyncReadback needs at least one buffer"));
+
+    for (auto& slot : slots)
+        glGenBuffers(1, &slot.buffer);
+}
+
+mgl::AsyncReadback::~AsyncReadback() noexcept
+{
+    for (auto& slot : slots)
+    {
+        if (slot.fence)
+            gl->glDeleteSync(static_cast<Sync>(slot.fence));
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+bool mgl::AsyncReadback::start(geom::Rectangle const& area, GLenum format)
+{
+    if (in_flight == slots.size())
+        BOOST_THROW_EXCEPTION(std::logic_error("No buffer free to read back into"));
+
+    auto& slot = slots[(oldest + in_flight) % slots.size()];
+    size_t const size = area.size.width.as_uint32_t() * area.size.height.as_uint32_t() * sizeof(uint32_t);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+
+    // Rows of 32 bit pixels are always 4-byte aligned, so they're packed tightly
+    glGetError();
+    glReadPixels(
+        area.top_left.x.as_int(), area.top_left.y.as_int(),
+        area.size.width.as_int(), area.size.height.as_int(),
+        format, GL_UNSIGNED_BYTE, nullptr);
+    auto const error = glGetError();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (error != GL_NO_ERROR)
+        return false;
+
+    slot.fence = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size = area.size;
+    ++in_flight;
+    return true;
+}
+
+unsigned int mgl::AsyncReadback::pending() const
+{
+    return in_flight;
+}
+
+void mgl::AsyncReadback::finish(
+    std::function<void(unsigned char const* pixels, geom::Size size, geom::Stride stride)> const& consume)
+{
+    if (in_flight == 0)
+        BOOST_THROW_EXCEPTION(std::logic_error("No readback to finish"));
+
+    auto& slot = slots[oldest];
+    oldest = (oldest + 1) % slots.size();
+    --in_flight;
+
+    auto const fence = static_cast<Sync>(slot.fence);
+    slot.fence = nullptr;
+
+    GLenum status;
+    do
+    {
+        status = gl->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fence_timeout_ns);
+    }
+    while (status == GL_TIMEOUT_EXPIRED);
+    gl->glDeleteSync(fence);
+
+    if (status == GL_WAIT_FAILED)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to wait for pixel readback"));
+
+    auto const width = slot.size.width.as_uint32_t();
+    size_t const size = width * slot.size.height.as_uint32_t() * sizeof(uint32_t);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    auto const pixels = gl->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (!pixels)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to map pixel readback buffer"));
+    }
+
+    try
+    {
+        consume(static_cast<unsigned char const*>(pixels), slot.size, geom::Stride{width * sizeof(uint32_t)});
+    }
+    catch (...)
+    {
+        gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        throw;
+    }
+
+    gl->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
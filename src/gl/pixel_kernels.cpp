@@ -0,0 +1,585 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/pixel_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MIR_GL_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace mgl = mir::gl;
+
+namespace
+{
+uint32_t const alpha_mask = 0xff000000;
+uint32_t const red_blue_mask = 0x00ff00ff;
+
+/// x / 255, correctly rounded, for x in [0, 255 * 255]
+inline uint32_t div255(uint32_t x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+inline uint32_t scale(uint32_t pixel, uint32_t alpha)
+{
+    uint32_t result = 0;
+    for (int shift = 0; shift != 32; shift += 8)
+        result |= div255(((pixel >> shift) & 0xff) * alpha) << shift;
+    return result;
+}
+
+inline uint32_t blend_pixel(uint32_t dst, uint32_t src, uint8_t alpha)
+{
+    if (alpha != 255)
+        src = scale(src, alpha);
+
+    auto const inverse = 255 - (src >> 24);
+    uint32_t result = 0;
+    for (int shift = 0; shift != 32; shift += 8)
+    {
+        auto const channel = ((src >> shift) & 0xff) + div255(((dst >> shift) & 0xff) * inverse);
+        result |= std::min(channel, 255u) << shift;
+    }
+    return result;
+}
+
+inline uint32_t swap_red_blue(uint32_t pixel)
+{
+    auto const red_blue = pixel & red_blue_mask;
+    return (pixel & ~red_blue_mask) | (red_blue << 16) | (red_blue >> 16);
+}
+
+inline uint32_t pack(uint32_t a, uint32_t r, uint32_t g, uint32_t b, bool to_abgr)
+{
+    return to_abgr ?
+        (a << 24) | (b << 16) | (g << 8) | r :
+        (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+inline uint32_t expand_5(uint32_t c) { return (c << 3) | (c >> 2); }
+inline uint32_t expand_6(uint32_t c) { return (c << 2) | (c >> 4); }
+inline uint32_t expand_4(uint32_t c) { return c * 17; }
+
+inline uint32_t convert_565_pixel(uint16_t pixel, bool swap_rb)
+{
+    return pack(255, expand_5(pixel >> 11), expand_6((pixel >> 5) & 0x3f), expand_5(pixel & 0x1f), swap_rb);
+}
+
+void blend_portable(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = blend_pixel(dst[i], src[i], alpha);
+}
+
+void convert_32_portable(uint32_t* dst, uint32_t const* src, size_t count, bool swap_rb, bool set_opaque)
+{
+    uint32_t const opaque = set_opaque ? alpha_mask : 0;
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = (swap_rb ? swap_red_blue(src[i]) : src[i]) | opaque;
+}
+
+void convert_565_portable(uint32_t* dst, uint16_t const* src, size_t count, bool swap_rb)
+{
+    for (size_t i = 0; i != count; ++i)
+        dst[i] = convert_565_pixel(src[i], swap_rb);
+}
+
+mgl::PixelKernels const portable{
+    "portable",
+    &blend_portable,
+    &convert_32_portable,
+    &convert_565_portable};
+
+#if defined(__SSE2__)
+/*
+ * Each 128-bit register holds four pixels. Blending widens them to 16 bits
+ * per channel, two pixels per register, which leaves room for the products.
+ */
+inline __m128i div255_epi16(__m128i x)
+{
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+inline __m128i blend_wide_sse2(__m128i dst, __m128i src)
+{
+    auto const src_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xff), 0xff);
+    auto const inverse = _mm_sub_epi16(_mm_set1_epi16(255), src_alpha);
+    return _mm_add_epi16(src, div255_epi16(_mm_mullo_epi16(dst, inverse)));
+}
+
+void blend_sse2(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const zero = _mm_setzero_si128();
+    auto const alphas = _mm_set1_epi32(alpha_mask);
+    auto const constant = _mm_set1_epi16(alpha);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+
+        // Windows are mostly either opaque or entirely clear, which we needn't blend
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+            continue;
+        if (alpha == 255 && _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphas), alphas)) == 0xffff)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+
+        auto const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst + i));
+        auto s_low = _mm_unpacklo_epi8(s, zero);
+        auto s_high = _mm_unpackhi_epi8(s, zero);
+        if (alpha != 255)
+        {
+            s_low = div255_epi16(_mm_mullo_epi16(s_low, constant));
+            s_high = div255_epi16(_mm_mullo_epi16(s_high, constant));
+        }
+
+        auto const low = blend_wide_sse2(_mm_unpacklo_epi8(d, zero), s_low);
+        auto const high = blend_wide_sse2(_mm_unpackhi_epi8(d, zero), s_high);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(low, high));
+    }
+
+    blend_portable(dst + i, src + i, count - i, alpha);
+}
+
+void convert_32_sse2(uint32_t* dst, uint32_t const* src, size_t count, bool swap_rb, bool set_opaque)
+{
+    auto const red_blue = _mm_set1_epi32(red_blue_mask);
+    auto const opaque = _mm_set1_epi32(set_opaque ? alpha_mask : 0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        if (swap_rb)
+        {
+            auto const swapped = _mm_and_si128(pixels, red_blue);
+            pixels = _mm_or_si128(
+                _mm_andnot_si128(red_blue, pixels),
+                _mm_or_si128(_mm_slli_epi32(swapped, 16), _mm_srli_epi32(swapped, 16)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(pixels, opaque));
+    }
+
+    convert_32_portable(dst + i, src + i, count - i, swap_rb, set_opaque);
+}
+
+void convert_565_sse2(uint32_t* dst, uint16_t const* src, size_t count, bool swap_rb)
+{
+    auto const six_bits = _mm_set1_epi16(0x3f);
+    auto const five_bits = _mm_set1_epi16(0x1f);
+    auto const opaque = _mm_set1_epi16(static_cast<short>(0xff00));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+
+        auto const r5 = _mm_srli_epi16(pixels, 11);
+        auto const g6 = _mm_and_si128(_mm_srli_epi16(pixels, 5), six_bits);
+        auto const b5 = _mm_and_si128(pixels, five_bits);
+
+        auto const r = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+        auto const g = _mm_or_si128(_mm_slli_epi16(g6, 2), _mm_srli_epi16(g6, 4));
+        auto const b = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+        // The low and high halves of each output pixel
+        auto const low = _mm_or_si128(swap_rb ? r : b, _mm_slli_epi16(g, 8));
+        auto const high = _mm_or_si128(swap_rb ? b : r, opaque);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(low, high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(low, high));
+    }
+
+    convert_565_portable(dst + i, src + i, count - i, swap_rb);
+}
+
+mgl::PixelKernels const sse2{
+    "sse2",
+    &blend_sse2,
+    &convert_32_sse2,
+    &convert_565_sse2};
+#endif
+
+#if defined(MIR_GL_HAVE_AVX2)
+// As SSE2, but eight pixels at a time. These are only called if the CPU supports AVX2.
+__attribute__((target("avx2")))
+inline __m256i div255_epi16_avx2(__m256i x)
+{
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+__attribute__((target("avx2")))
+inline __m256i blend_wide_avx2(__m256i dst, __m256i src)
+{
+    auto const src_alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, 0xff), 0xff);
+    auto const inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), src_alpha);
+    return _mm256_add_epi16(src, div255_epi16_avx2(_mm256_mullo_epi16(dst, inverse)));
+}
+
+__attribute__((target("avx2")))
+void blend_avx2(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const zero = _mm256_setzero_si256();
+    auto const alphas = _mm256_set1_epi32(alpha_mask);
+    auto const constant = _mm256_set1_epi16(alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const s = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+            continue;
+        if (alpha == 255 &&
+            _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, alphas), alphas)) == -1)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            continue;
+        }
+
+        // Unpacking and packing both work within 128-bit lanes, so pixels stay in order
+        auto const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(dst + i));
+        auto s_low = _mm256_unpacklo_epi8(s, zero);
+        auto s_high = _mm256_unpackhi_epi8(s, zero);
+        if (alpha != 255)
+        {
+            s_low = div255_epi16_avx2(_mm256_mullo_epi16(s_low, constant));
+            s_high = div255_epi16_avx2(_mm256_mullo_epi16(s_high, constant));
+        }
+
+        auto const low = blend_wide_avx2(_mm256_unpacklo_epi8(d, zero), s_low);
+        auto const high = blend_wide_avx2(_mm256_unpackhi_epi8(d, zero), s_high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(low, high));
+    }
+
+    blend_portable(dst + i, src + i, count - i, alpha);
+}
+
+__attribute__((target("avx2")))
+void convert_32_avx2(uint32_t* dst, uint32_t const* src, size_t count, bool swap_rb, bool set_opaque)
+{
+    auto const red_blue = _mm256_set1_epi32(red_blue_mask);
+    auto const opaque = _mm256_set1_epi32(set_opaque ? alpha_mask : 0);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        if (swap_rb)
+        {
+            auto const swapped = _mm256_and_si256(pixels, red_blue);
+            pixels = _mm256_or_si256(
+                _mm256_andnot_si256(red_blue, pixels),
+                _mm256_or_si256(_mm256_slli_epi32(swapped, 16), _mm256_srli_epi32(swapped, 16)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(pixels, opaque));
+    }
+
+    convert_32_portable(dst + i, src + i, count - i, swap_rb, set_opaque);
+}
+
+__attribute__((target("avx2")))
+void convert_565_avx2(uint32_t* dst, uint16_t const* src, size_t count, bool swap_rb)
+{
+    auto const six_bits = _mm256_set1_epi32(0x3f);
+    auto const five_bits = _mm256_set1_epi32(0x1f);
+    auto const opaque = _mm256_set1_epi32(alpha_mask);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // Widen to a pixel per 32 bits, and build each pixel in place
+        auto const pixels = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i)));
+
+        auto const r5 = _mm256_srli_epi32(pixels, 11);
+        auto const g6 = _mm256_and_si256(_mm256_srli_epi32(pixels, 5), six_bits);
+        auto const b5 = _mm256_and_si256(pixels, five_bits);
+
+        auto const r = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+        auto const g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+        auto const b = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+
+        auto const top = _mm256_slli_epi32(swap_rb ? b : r, 16);
+        auto const bottom = swap_rb ? r : b;
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + i),
+            _mm256_or_si256(_mm256_or_si256(opaque, top), _mm256_or_si256(_mm256_slli_epi32(g, 8), bottom)));
+    }
+
+    convert_565_portable(dst + i, src + i, count - i, swap_rb);
+}
+
+mgl::PixelKernels const avx2{
+    "avx2",
+    &blend_avx2,
+    &convert_32_avx2,
+    &convert_565_avx2};
+#endif
+
+#if defined(__ARM_NEON)
+/*
+ * NEON loads eight pixels de-interleaved into one register per channel, so
+ * the channels widen to 16 bits only for the multiplies.
+ */
+inline uint8x8_t div255_neon(uint16x8_t x)
+{
+    // (x + 128 + ((x + 128) >> 8)) >> 8, as div255()
+    return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+}
+
+void blend_neon(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha)
+{
+    auto const constant = vdup_n_u8(alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto s = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        auto d = vld4_u8(reinterpret_cast<uint8_t const*>(dst + i));
+
+        if (alpha != 255)
+        {
+            for (int c = 0; c != 4; ++c)
+                s.val[c] = div255_neon(vmull_u8(s.val[c], constant));
+        }
+
+        auto const inverse = vmvn_u8(s.val[3]);
+        for (int c = 0; c != 4; ++c)
+            d.val[c] = vqadd_u8(s.val[c], div255_neon(vmull_u8(d.val[c], inverse)));
+
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+
+    blend_portable(dst + i, src + i, count - i, alpha);
+}
+
+void convert_32_neon(uint32_t* dst, uint32_t const* src, size_t count, bool swap_rb, bool set_opaque)
+{
+    auto const red_blue = vdupq_n_u32(red_blue_mask);
+    auto const opaque = vdupq_n_u32(set_opaque ? alpha_mask : 0);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        auto pixels = vld1q_u32(src + i);
+        if (swap_rb)
+        {
+            auto const swapped = vandq_u32(pixels, red_blue);
+            pixels = vorrq_u32(
+                vbicq_u32(pixels, red_blue),
+                vorrq_u32(vshlq_n_u32(swapped, 16), vshrq_n_u32(swapped, 16)));
+        }
+        vst1q_u32(dst + i, vorrq_u32(pixels, opaque));
+    }
+
+    convert_32_portable(dst + i, src + i, count - i, swap_rb, set_opaque);
+}
+
+void convert_565_neon(uint32_t* dst, uint16_t const* src, size_t count, bool swap_rb)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto const pixels = vld1q_u16(src + i);
+
+        auto const r5 = vshrq_n_u16(pixels, 11);
+        auto const g6 = vandq_u16(vshrq_n_u16(pixels, 5), vdupq_n_u16(0x3f));
+        auto const b5 = vandq_u16(pixels, vdupq_n_u16(0x1f));
+
+        auto const r = vmovn_u16(vorrq_u16(vshlq_n_u16(r5, 3), vshrq_n_u16(r5, 2)));
+        auto const g = vmovn_u16(vorrq_u16(vshlq_n_u16(g6, 2), vshrq_n_u16(g6, 4)));
+        auto const b = vmovn_u16(vorrq_u16(vshlq_n_u16(b5, 3), vshrq_n_u16(b5, 2)));
+
+        uint8x8x4_t result;
+        result.val[0] = swap_rb ? r : b;
+        result.val[1] = g;
+        result.val[2] = swap_rb ? b : r;
+        result.val[3] = vdup_n_u8(255);
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), result);
+    }
+
+    convert_565_portable(dst + i, src + i, count - i, swap_rb);
+}
+
+mgl::PixelKernels const neon{
+    "neon",
+    &blend_neon,
+    &convert_32_neon,
+    &convert_565_neon};
+#endif
+
+template<typename Pixel>
+inline Pixel load(unsigned char const* src)
+{
+    Pixel pixel;
+    memcpy(&pixel, src, sizeof pixel);
+    return pixel;
+}
+}
+
+auto mgl::supported_pixel_kernels() -> std::vector<PixelKernels const*>
+{
+    std::vector<PixelKernels const*> kernels{&portable};
+
+#if defined(__SSE2__)
+    kernels.push_back(&sse2);
+#endif
+#if defined(MIR_GL_HAVE_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(&avx2);
+#endif
+#if defined(__ARM_NEON)
+    kernels.push_back(&neon);
+#endif
+
+    return kernels;
+}
+
+auto mgl::pixel_kernels() -> PixelKernels const&
+{
+    static PixelKernels const& best = *supported_pixel_kernels().back();
+    return best;
+}
+
+bool mgl::can_convert(MirPixelFormat format)
+{
+    switch (format)
+    {
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+    case mir_pixel_format_bgr_888:
+    case mir_pixel_format_rgb_888:
+    case mir_pixel_format_rgb_565:
+    case mir_pixel_format_rgba_5551:
+    case mir_pixel_format_rgba_4444:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void mgl::convert_row(
+    PixelKernels const& kernels,
+    uint32_t* dst,
+    unsigned char const* src,
+    MirPixelFormat format,
+    bool to_abgr,
+    size_t count)
+{
+    // The byte layouts are those of the GL formats ShmBuffer uploads each MirPixelFormat as
+    switch (format)
+    {
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        kernels.convert_32(
+            dst, reinterpret_cast<uint32_t const*>(src), count, !to_abgr, format == mir_pixel_format_xbgr_8888);
+        break;
+
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        kernels.convert_32(
+            dst, reinterpret_cast<uint32_t const*>(src), count, to_abgr, format == mir_pixel_format_xrgb_8888);
+        break;
+
+    case mir_pixel_format_rgb_565:
+        kernels.convert_565(dst, reinterpret_cast<uint16_t const*>(src), count, to_abgr);
+        break;
+
+    case mir_pixel_format_rgb_888:
+        for (size_t i = 0; i != count; ++i, src += 3)
+            dst[i] = pack(255, src[0], src[1], src[2], to_abgr);
+        break;
+
+    case mir_pixel_format_bgr_888:
+        for (size_t i = 0; i != count; ++i, src += 3)
+            dst[i] = pack(255, src[2], src[1], src[0], to_abgr);
+        break;
+
+    case mir_pixel_format_rgba_5551:
+        for (size_t i = 0; i != count; ++i, src += 2)
+        {
+            auto const pixel = load<uint16_t>(src);
+            dst[i] = pack(
+                (pixel & 1) ? 255 : 0,
+                expand_5(pixel >> 11), expand_5((pixel >> 6) & 0x1f), expand_5((pixel >> 1) & 0x1f),
+                to_abgr);
+        }
+        break;
+
+    case mir_pixel_format_rgba_4444:
+        for (size_t i = 0; i != count; ++i, src += 2)
+        {
+            auto const pixel = load<uint16_t>(src);
+            dst[i] = pack(
+                expand_4(pixel & 0xf),
+                expand_4(pixel >> 12), expand_4((pixel >> 8) & 0xf), expand_4((pixel >> 4) & 0xf),
+                to_abgr);
+        }
+        break;
+
+    default:
+        std::fill(dst, dst + count, 0);
+        break;
+    }
+}
+
+void mgl::copy_flipped(
+    PixelKernels const& kernels,
+    unsigned char* dst,
+    size_t dst_stride,
+    unsigned char const* src,
+    size_t src_stride,
+    size_t width,
+    size_t height,
+    bool swap_rb)
+{
+    for (size_t row = 0; row != height; ++row)
+    {
+        auto const from = src + (height - 1 - row) * src_stride;
+        auto const to = dst + row * dst_stride;
+
+        if (swap_rb)
+        {
+            kernels.convert_32(
+                reinterpret_cast<uint32_t*>(to), reinterpret_cast<uint32_t const*>(from), width, true, false);
+        }
+        else
+        {
+            memcpy(to, from, width * sizeof(uint32_t));
+        }
+    }
+}
@@ -20,6 +20,7 @@
 #include "recently_used_cache.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/gl/incremental_texture_source.h"
 
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
@@ -42,7 +43,31 @@ std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const&
 
     if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding))
     {
-        texture_source->bind();
+        auto const incremental = dynamic_cast<mrgl::IncrementalTextureSource*>(buffer->native_buffer_base());
+
+        if (incremental &&
+            texture.valid_binding &&
+            texture.storage_size == buffer->size() &&
+            texture.storage_format == buffer->pixel_format())
+        {
+            // The texture holds the previous buffer's image, so only upload what has changed since
+            incremental->update_texture(renderable.buffer_damage_since(texture.last_bound_buffer));
+        }
+        else
+        {
+            texture_source->bind();
+        }
+
+        if (incremental)
+        {
+            texture.storage_size = buffer->size();
+            texture.storage_format = buffer->pixel_format();
+        }
+        else
+        {
+            texture.storage_format = mir_pixel_format_invalid;
+        }
+
         texture.resource = buffer;
         texture.last_bound_buffer = buffer_id;
     }
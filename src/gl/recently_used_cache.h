@@ -24,6 +24,8 @@
 #include "mir/gl/texture.h"
 #include "mir/graphics/buffer_id.h"
 #include "mir/graphics/renderable.h"
+#include "mir/geometry/size.h"
+#include "mir_toolkit/common.h"
 #include <unordered_map>
 
 namespace mir
@@ -49,6 +51,9 @@ private:
         bool used{true};
         bool valid_binding{false};
         std::shared_ptr<graphics::Buffer> resource;
+        // The texture storage we allocated by uploading an IncrementalTextureSource
+        geometry::Size storage_size;
+        MirPixelFormat storage_format{mir_pixel_format_invalid};
     };
 
     std::unordered_map<graphics::Renderable::ID, Entry> textures;
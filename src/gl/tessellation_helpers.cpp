@@ -25,9 +25,16 @@ namespace mgl = mir::gl;
 namespace geom = mir::geometry;
 mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mg::Renderable const& renderable, geom::Displacement const& offset)
+{
+    return tessellate_renderable_into_rectangle(renderable, renderable.screen_position(), offset);
+}
+
+mgl::Primitive mgl::tessellate_renderable_into_rectangle(
+    mg::Renderable const& renderable, geom::Rectangle const& area, geom::Displacement const& offset)
 {
     auto const& buf_size = renderable.buffer()->size();
-    auto rect = renderable.screen_position();
+    auto const& position = renderable.screen_position();
+    auto rect = area;
     rect.top_left = rect.top_left - offset;
     GLfloat left = rect.top_left.x.as_int();
     GLfloat right = left + rect.size.width.as_int();
@@ -37,15 +44,25 @@ mgl::Primitive mgl::tessellate_renderable_into_rectangle(
     mgl::Primitive rectangle;
     rectangle.type = GL_TRIANGLE_STRIP;
 
-    GLfloat tex_right = static_cast<GLfloat>(rect.size.width.as_int()) /
-                        buf_size.width.as_int();
-    GLfloat tex_bottom = static_cast<GLfloat>(rect.size.height.as_int()) /
-                         buf_size.height.as_int();
+    // src_bounds() is stretched over the whole of position, so map the
+    // corners of area proportionally into it
+    auto const src = renderable.src_bounds();
+    GLfloat const x_scale = static_cast<GLfloat>(src.size.width.as_int()) / position.size.width.as_int();
+    GLfloat const y_scale = static_cast<GLfloat>(src.size.height.as_int()) / position.size.height.as_int();
+    GLfloat const src_left = src.top_left.x.as_int() +
+                             (area.top_left.x.as_int() - position.top_left.x.as_int()) * x_scale;
+    GLfloat const src_top = src.top_left.y.as_int() +
+                            (area.top_left.y.as_int() - position.top_left.y.as_int()) * y_scale;
+
+    GLfloat tex_left = src_left / buf_size.width.as_int();
+    GLfloat tex_top = src_top / buf_size.height.as_int();
+    GLfloat tex_right = (src_left + rect.size.width.as_int() * x_scale) / buf_size.width.as_int();
+    GLfloat tex_bottom = (src_top + rect.size.height.as_int() * y_scale) / buf_size.height.as_int();
 
     auto& vertices = rectangle.vertices;
-    vertices[0] = {{left,  top,    0.0f}, {0.0f,      0.0f}};
-    vertices[1] = {{left,  bottom, 0.0f}, {0.0f,      tex_bottom}};
-    vertices[2] = {{right, top,    0.0f}, {tex_right, 0.0f}};
+    vertices[0] = {{left,  top,    0.0f}, {tex_left,  tex_top}};
+    vertices[1] = {{left,  bottom, 0.0f}, {tex_left,  tex_bottom}};
+    vertices[2] = {{right, top,    0.0f}, {tex_right, tex_top}};
     vertices[3] = {{right, bottom, 0.0f}, {tex_right, tex_bottom}};
     return rectangle;
 }
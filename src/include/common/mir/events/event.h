@@ -25,6 +25,7 @@
 
 #include <capnp/message.h>
 
+#include <cstddef>
 #include <cstring>
 
 struct MirEvent
@@ -73,10 +74,20 @@ struct MirEvent
     static mir::EventUPtr deserialize(std::string const& bytes);
     static std::string serialize(MirEvent const* event);
 
+    // Events are created and destroyed for every input sample, so their storage is
+    // recycled through a small free list rather than going back to the heap each time.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* block, std::size_t size);
+
 protected:
     MirEvent() = default;
 
-    ::capnp::MallocMessageBuilder message;
+    // Large enough for any event we build ourselves; only oversized payloads
+    // (keymaps, drag and drop handles) spill into heap-allocated segments.
+    static std::size_t const inline_segment_words = 64;
+
+    ::capnp::word inline_segment[inline_segment_words]{};
+    ::capnp::MallocMessageBuilder message{kj::arrayPtr(inline_segment, inline_segment_words)};
     mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
 };
 
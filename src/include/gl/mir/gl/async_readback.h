@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GL_ASYNC_READBACK_H_
+#define MIR_GL_ASYNC_READBACK_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/dimensions.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include MIR_SERVER_GL_H
+
+namespace mir
+{
+namespace gl
+{
+/**
+ * Reads pixels back from the bound framebuffer through a ring of pixel pack
+ * buffers. start() returns as soon as the copy is queued, and finish() waits
+ * on that readback's fence alone, so a copy can proceed while later frames
+ * are drawn.
+ *
+ * Needs OpenGL ES 3.0 or OpenGL 3.2; check available() first. Everything must
+ * be done with the same context current, including destruction. Rows come
+ * back bottom first, as from glReadPixels().
+ */
+class AsyncReadback
+{
+public:
+    /// Whether the current context can read back asynchronously
+    static bool available();
+
+    /// \param [in] depth  How many readbacks can be in flight at once
+    explicit AsyncReadback(unsigned int depth);
+    ~AsyncReadback() noexcept;
+
+    /**
+     * Starts reading area of the bound framebuffer as 32 bit pixels of format
+     * (GL_RGBA, or GL_BGRA_EXT where supported). Returns false if GL can't
+     * read in that format.
+     * \throws std::logic_error if pending() readbacks already fill the ring
+     */
+    bool start(geometry::Rectangle const& area, GLenum format);
+
+    /// The number of readbacks started but not yet finished
+    unsigned int pending() const;
+
+    /**
+     * Waits for the oldest pending readback and calls consume with its pixels,
+     * which are only valid until consume returns.
+     * \throws std::logic_error if nothing is pending
+     */
+    void finish(
+        std::function<void(unsigned char const* pixels, geometry::Size size, geometry::Stride stride)> const& consume);
+
+private:
+    AsyncReadback(AsyncReadback const&) = delete;
+    AsyncReadback& operator=(AsyncReadback const&) = delete;
+
+    struct Functions;
+
+    struct Slot
+    {
+        GLuint buffer;
+        void* fence;        ///< A GLsync; not every GLES2 header declares the type
+        size_t capacity;
+        geometry::Size size;
+    };
+
+    std::unique_ptr<Functions const> const gl;
+    std::vector<Slot> slots;
+    unsigned int oldest{0};
+    unsigned int in_flight{0};
+};
+}
+}
+
+#endif /* MIR_GL_ASYNC_READBACK_H_ */
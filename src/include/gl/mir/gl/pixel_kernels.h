@@ -0,0 +1,92 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GL_PIXEL_KERNELS_H_
+#define MIR_GL_PIXEL_KERNELS_H_
+
+#include "mir_toolkit/common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace gl
+{
+
+/**
+ * The row operations the software renderer composites with, and GL readback
+ * is turned the right way up with.
+ *
+ * Pixels are 32 bits, premultiplied, with alpha in the top byte. Whether red
+ * or blue is in the bottom byte is up to the caller; only the conversions care.
+ * Every implementation gives bit-identical results to the portable one.
+ */
+struct PixelKernels
+{
+    char const* name;
+
+    /// dst = src over dst, with src first scaled by a constant alpha (255 is opaque)
+    void (*blend)(uint32_t* dst, uint32_t const* src, size_t count, uint8_t alpha);
+
+    /// Copies pixels, exchanging red and blue if swap_rb and forcing alpha opaque if set_opaque
+    void (*convert_32)(uint32_t* dst, uint32_t const* src, size_t count, bool swap_rb, bool set_opaque);
+
+    /// Expands RGB 5:6:5 to opaque pixels, with red at the top unless swap_rb
+    void (*convert_565)(uint32_t* dst, uint16_t const* src, size_t count, bool swap_rb);
+};
+
+/// The fastest kernels this CPU supports
+auto pixel_kernels() -> PixelKernels const&;
+
+/// Every set of kernels this CPU supports, the portable ones first
+auto supported_pixel_kernels() -> std::vector<PixelKernels const*>;
+
+/// True for the formats convert_row() can read (those ShmBuffer supports, and bgr_888)
+bool can_convert(MirPixelFormat format);
+
+/**
+ * Converts count pixels of format to premultiplied pixels with red at the top
+ * (as in argb_8888) or, if to_abgr, blue at the top (as in abgr_8888). Formats
+ * without alpha are made opaque.
+ */
+void convert_row(
+    PixelKernels const& kernels,
+    uint32_t* dst,
+    unsigned char const* src,
+    MirPixelFormat format,
+    bool to_abgr,
+    size_t count);
+
+/**
+ * Copies height rows of width 32 bit pixels, the last row first, exchanging
+ * red and blue if swap_rb. This turns a GL readback (bottom row first, often
+ * RGBA) the right way up. src and dst must not overlap.
+ */
+void copy_flipped(
+    PixelKernels const& kernels,
+    unsigned char* dst,
+    size_t dst_stride,
+    unsigned char const* src,
+    size_t src_stride,
+    size_t width,
+    size_t height,
+    bool swap_rb);
+}
+}
+
+#endif /* MIR_GL_PIXEL_KERNELS_H_ */
@@ -45,6 +45,7 @@ struct Primitive
     GLenum type; // GL_TRIANGLE_STRIP, GL_TRIANGLE_FAN, GL_TRIANGLES etc
     int nvertices;
     Vertex vertices[max_vertices];
+    bool opaque{false}; // Covers only opaque texels, so needs no blending
 };
 }
 }
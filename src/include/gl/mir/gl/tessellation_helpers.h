@@ -20,6 +20,7 @@
 #define MIR_GL_TESSELLATION_HELPERS_H_
 #include "mir/gl/primitive.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 
 namespace mir
 {
@@ -30,6 +31,12 @@ namespace gl
 Primitive tessellate_renderable_into_rectangle(
     graphics::Renderable const& renderable, geometry::Displacement const& offset);
 
+/// As above, but only the part of the renderable within area (in screen coordinates)
+Primitive tessellate_renderable_into_rectangle(
+    graphics::Renderable const& renderable,
+    geometry::Rectangle const& area,
+    geometry::Displacement const& offset);
+
 }
 }
 #endif /* MIR_GL_TESSELLATION_HELPERS_H_ */
@@ -44,11 +44,26 @@ public:
 
     virtual std::shared_ptr<graphics::Buffer>
         lock_compositor_buffer(void const* user_id) = 0;
+    /// The size the stream is shown at, after any viewport is applied
     virtual geometry::Size stream_size() = 0;
+    /// The part of the most recently submitted buffer that is shown
+    virtual geometry::Rectangle src_bounds() const = 0;
     virtual int buffers_ready_for_compositor(void const* user_id) const = 0;
     virtual void drop_old_buffers() = 0;
+    /// \a frame has been presented; it showed this stream if \a on_screen
+    virtual void frame_presented(PresentedFrame const& frame, bool on_screen) = 0;
     virtual bool has_submitted_buffer() const = 0;
     virtual bool framedropping() const = 0;
+
+    /**
+     * The parts of \a buffer that changed since the buffer with id \a previous
+     * was submitted. If that isn't known, the whole of \a buffer.
+     */
+    virtual geometry::Rectangles buffer_damage(
+        graphics::BufferID previous,
+        graphics::Buffer const& buffer) const = 0;
+
+    virtual geometry::Region opaque_region() const = 0;
 };
 
 }
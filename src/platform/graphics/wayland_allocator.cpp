@@ -19,6 +19,20 @@
 
 #include "mir/graphics/wayland_allocator.h"
 
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
+
 // Define a key function to ensure libmirplatform contains the vtbl and typeinfo
 mir::graphics::WaylandAllocator::~WaylandAllocator() = default;
 mir::graphics::WaylandAllocator::WaylandAllocator() = default;
+
+auto mir::graphics::WaylandAllocator::dmabuf_formats() -> std::vector<DmaBufFormat>
+{
+    return {};
+}
+
+auto mir::graphics::WaylandAllocator::import_dmabuf(DmaBufAttributes const&) -> std::shared_ptr<ImportedDmaBuf>
+{
+    BOOST_THROW_EXCEPTION((std::runtime_error{"Platform does not support importing dma-bufs"}));
+}
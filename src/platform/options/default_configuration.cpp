@@ -49,15 +49,17 @@ char const* const mo::nested_passthrough_opt      = "nested-passthrough";
 char const* const mo::frontend_threads_opt        = "ipc-thread-pool";
 char const* const mo::name_opt                    = "name";
 char const* const mo::offscreen_opt               = "offscreen";
+char const* const mo::renderer_opt                = "renderer";
 char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
+char const* const mo::coalesce_input_opt          = "coalesce-input";
 char const* const mo::x11_display_opt             = "x11-display-experimental";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
-char const* const mo::wayland_extensions_value    = "wl_shell:xdg_wm_base:zxdg_shell_v6";
+char const* const mo::wayland_extensions_value    = "wl_shell:xdg_wm_base:zxdg_shell_v6:wp_presentation:wp_viewporter:zwp_linux_dmabuf_v1";
 
 char const* const mo::off_opt_value = "off";
 char const* const mo::log_opt_value = "log";
@@ -203,6 +205,10 @@ mo::DefaultConfiguration::DefaultConfiguration(
             " to avoid a composition pass")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
+        (renderer_opt,
+            po::value<std::string>()->default_value("gl"),
+            "Renderer to composite with [{gl,software}]. The software renderer needs"
+            " outputs the CPU can draw into, such as --offscreen ones.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -210,6 +216,10 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "Cursor (mouse pointer) to use [{auto,null,software}]")
         (enable_key_repeat_opt, po::value<bool>()->default_value(true),
              "Enable server generated key repeat")
+        (coalesce_input_opt, po::value<int>()->default_value(0),
+            "Rate in Hz (normally the display refresh rate) at which to deliver "
+            "merged pointer motion and scroll events and resampled touch "
+            "contacts. 0 delivers every event as it arrives.")
         (fatal_except_opt, "On \"fatal error\" conditions [e.g. drivers behaving "
             "in unexpected ways] throw an exception (instead of a core dump)")
         (debug_opt, "Enable extra development debugging. "
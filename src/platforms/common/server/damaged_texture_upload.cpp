@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damaged_texture_upload.h"
+#include "mir/graphics/gl_format.h"
+#include "mir/geometry/region.h"
+
+#include MIR_SERVER_GL_H
+#include MIR_SERVER_GLEXT_H
+
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+void mg::common::upload_damaged_pixels(
+    unsigned char const* pixels,
+    geom::Size const& size,
+    geom::Stride const& stride,
+    MirPixelFormat pixel_format,
+    geom::Rectangles const& damage)
+{
+    GLenum format, type;
+
+    if (!mg::get_gl_pixel_format(pixel_format, format, type))
+        return;
+
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(pixel_format);
+    geom::Rectangle const whole{{}, size};
+
+    geom::Region area;
+    for (auto const& rect : damage)
+    {
+        auto const clipped = rect.intersection_with(whole);
+#ifdef GL_UNPACK_ROW_LENGTH
+        area.unite(clipped);
+#else
+        // Without GL_UNPACK_ROW_LENGTH (GLES2) only whole rows can be uploaded
+        area.unite(geom::Rectangle{{0, clipped.top()}, {size.width, clipped.size.height}});
+#endif
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+#ifdef GL_UNPACK_ROW_LENGTH
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride.as_int() / bytes_per_pixel);
+#endif
+
+    for (auto const& rect : area)
+    {
+        auto const offset =
+            rect.top().as_int() * stride.as_int() + rect.left().as_int() * bytes_per_pixel;
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0,
+                        rect.left().as_int(), rect.top().as_int(),
+                        rect.size.width.as_int(), rect.size.height.as_int(),
+                        format, type, pixels + offset);
+    }
+
+#ifdef GL_UNPACK_ROW_LENGTH
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+}
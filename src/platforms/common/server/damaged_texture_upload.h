@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_DAMAGED_TEXTURE_UPLOAD_H_
+#define MIR_GRAPHICS_COMMON_DAMAGED_TEXTURE_UPLOAD_H_
+
+#include "mir/geometry/dimensions.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/geometry/size.h"
+#include "mir_toolkit/common.h"
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+/**
+ * Upload the damaged parts of a CPU pixel buffer into the currently bound
+ * GL_TEXTURE_2D, which must already hold the rest of the buffer.
+ *
+ * Damage is clipped to the buffer; without GL_UNPACK_ROW_LENGTH (GLES2) it
+ * is widened to whole rows.
+ */
+void upload_damaged_pixels(
+    unsigned char const* pixels,
+    geometry::Size const& size,
+    geometry::Stride const& stride,
+    MirPixelFormat format,
+    geometry::Rectangles const& damage);
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_COMMON_DAMAGED_TEXTURE_UPLOAD_H_ */
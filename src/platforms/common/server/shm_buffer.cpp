@@ -21,6 +21,7 @@
 #include "mir/shm_file.h"
 #include "shm_buffer.h"
 #include "buffer_texture_binder.h"
+#include "damaged_texture_upload.h"
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
 
@@ -186,6 +187,11 @@ void mgc::ShmBuffer::upload_to_texture()
     gl_bind_to_texture();
 }
 
+void mgc::ShmBuffer::update_texture(geom::Rectangles const& damage)
+{
+    upload_damaged_pixels(static_cast<unsigned char const*>(pixels), size_, stride_, pixel_format_, damage);
+}
+
 void mgc::ShmBuffer::secure_for_render()
 {
 }
@@ -207,6 +213,9 @@ void mir::graphics::common::ShmBuffer::commit()
 
 void mgc::ShmBuffer::tex_bind()
 {
+    // Outputs may be composited concurrently, each in its own (shared) context
+    std::lock_guard<std::mutex> lock{tex_mutex};
+
     bool const needs_initialisation = tex_id == 0;
     if (needs_initialisation)
     {
@@ -221,6 +230,8 @@ void mgc::ShmBuffer::tex_bind()
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         gl_bind_to_texture();
+        // Make the upload visible to the other contexts sharing the texture
+        glFlush();
     }
 }
 
@@ -26,10 +26,13 @@
 #include "mir_toolkit/common.h"
 #include "mir/renderer/gl/texture_source.h"
 #include "mir/renderer/gl/texture_target.h"
+#include "mir/renderer/gl/incremental_texture_source.h"
 #include "mir_toolkit/mir_native_buffer.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/graphics/texture.h"
 
+#include <mutex>
+
 #include MIR_SERVER_GL_H
 
 namespace mir
@@ -79,6 +82,7 @@ protected:
 
 class ShmBuffer : public BufferBasic, public NativeBufferBase,
                   public BindResolverTexTarget,
+                  public renderer::gl::IncrementalTextureSource,
                   public renderer::gl::TextureTarget,
                   public renderer::software::PixelSource,
                   public BindResolverTex
@@ -93,6 +97,7 @@ public:
     MirPixelFormat pixel_format() const override;
     void gl_bind_to_texture() override;
     void upload_to_texture() override;
+    void update_texture(geometry::Rectangles const& damage) override;
     void secure_for_render() override;
     void write(unsigned char const* data, size_t size) override;
     void read(std::function<void(unsigned char const*)> const& do_with_pixels) override;
@@ -125,6 +130,7 @@ private:
     MirPixelFormat const pixel_format_;
     geometry::Stride const stride_;
     void* const pixels;
+    std::mutex tex_mutex;
     GLuint tex_id{0};
 };
 
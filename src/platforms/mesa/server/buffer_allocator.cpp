@@ -49,6 +49,7 @@
 #include <stdexcept>
 #include <system_error>
 #include <gbm.h>
+#include <drm_fourcc.h>
 #include <cassert>
 #include <fcntl.h>
 
@@ -63,6 +64,13 @@ namespace mgm = mg::mesa;
 namespace mgc = mg::common;
 namespace geom = mir::geometry;
 
+#ifndef DRM_FORMAT_MOD_LINEAR
+#define DRM_FORMAT_MOD_LINEAR 0
+#endif
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
 namespace
 {
 
@@ -627,3 +635,227 @@ std::shared_ptr<mg::Buffer> mgm::BufferAllocator::buffer_from_resource(
         std::move(on_release),
         wayland_executor);
 }
+
+namespace
+{
+/*
+ * A client dma-buf imported into GBM.
+ *
+ * The bo, its EGLImage and the texture are made once per wl_buffer and shared
+ * by the DmaBufGBMBuffer of every commit; the texture is an EGLImage sibling,
+ * so it always shows the dma-buf's current contents.
+ */
+class DmaBufImport : public mg::ImportedDmaBuf, public std::enable_shared_from_this<DmaBufImport>
+{
+public:
+    DmaBufImport(
+        std::shared_ptr<mir::renderer::gl::Context> ctx,
+        std::shared_ptr<gbm_bo> const& bo,
+        uint32_t bo_flags,
+        std::shared_ptr<mg::EGLExtensions> const& egl_extensions,
+        std::shared_ptr<mir::Executor> wayland_executor)
+        : ctx{std::move(ctx)},
+          bo{bo},
+          bo_flags{bo_flags},
+          image{bo, egl_extensions},
+          wayland_executor{std::move(wayland_executor)}
+    {
+    }
+
+    ~DmaBufImport()
+    {
+        if (tex != 0)
+        {
+            wayland_executor->spawn(
+                [context = ctx, tex = tex]()
+                {
+                    context->make_current();
+
+                    glDeleteTextures(1, &tex);
+
+                    context->release_current();
+                });
+        }
+    }
+
+    std::shared_ptr<mg::Buffer> buffer(
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release) override;
+
+    /// Binds the EGLImage to the currently bound texture
+    void gl_bind_to_texture()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        image.gl_bind_to_texture();
+    }
+
+    /// Binds the shared texture, creating it on first use
+    void tex_bind()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        bool const needs_initialisation = tex == 0;
+        if (needs_initialisation)
+        {
+            glGenTextures(1, &tex);
+        }
+        glBindTexture(GL_TEXTURE_2D, tex);
+        if (needs_initialisation)
+        {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            image.gl_bind_to_texture();
+        }
+    }
+
+    std::shared_ptr<mir::renderer::gl::Context> const ctx;
+    std::shared_ptr<gbm_bo> const bo;
+    uint32_t const bo_flags;
+
+private:
+    std::mutex mutex;
+    DMABufTextureBinder image;
+    GLuint tex{0};
+
+    std::shared_ptr<mir::Executor> const wayland_executor;
+};
+
+class DmaBufImportTextureBinder : public mgc::BufferTextureBinder
+{
+public:
+    DmaBufImportTextureBinder(std::shared_ptr<DmaBufImport> const& import)
+        : import{import}
+    {
+    }
+
+    void gl_bind_to_texture() override
+    {
+        import->gl_bind_to_texture();
+    }
+
+private:
+    std::shared_ptr<DmaBufImport> const import;
+};
+
+/*
+ * One commit of an imported dma-buf.
+ */
+class DmaBufGBMBuffer : public mgm::GBMBuffer
+{
+public:
+    DmaBufGBMBuffer(
+        std::shared_ptr<DmaBufImport> const& import,
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release)
+        : GBMBuffer(import->bo, import->bo_flags, std::make_unique<DmaBufImportTextureBinder>(import)),
+          import{import},
+          on_consumed{std::move(on_consumed)},
+          on_release{std::move(on_release)}
+    {
+    }
+
+    ~DmaBufGBMBuffer()
+    {
+        on_release();
+    }
+
+protected:
+    void tex_bind() override
+    {
+        import->tex_bind();
+
+        on_consumed();
+        on_consumed = [](){};
+    }
+
+private:
+    std::shared_ptr<DmaBufImport> const import;
+
+    std::function<void()> on_consumed;
+    std::function<void()> const on_release;
+};
+
+std::shared_ptr<mg::Buffer> DmaBufImport::buffer(
+    std::function<void()>&& on_consumed,
+    std::function<void()>&& on_release)
+{
+    return std::make_shared<DmaBufGBMBuffer>(shared_from_this(), std::move(on_consumed), std::move(on_release));
+}
+
+uint32_t const dmabuf_fourccs[] = {
+    GBM_FORMAT_ARGB8888,
+    GBM_FORMAT_XRGB8888,
+    GBM_FORMAT_ABGR8888,
+    GBM_FORMAT_XBGR8888
+};
+}
+
+auto mgm::BufferAllocator::dmabuf_formats() -> std::vector<DmaBufFormat>
+{
+    std::vector<DmaBufFormat> formats;
+
+    for (auto const fourcc : dmabuf_fourccs)
+    {
+        if (gbm_device_is_format_supported(device, fourcc, GBM_BO_USE_RENDERING))
+        {
+            // gbm_bo_import() with GBM_BO_IMPORT_FD has no way to pass an explicit modifier
+            formats.push_back({fourcc, DRM_FORMAT_MOD_LINEAR});
+            formats.push_back({fourcc, DRM_FORMAT_MOD_INVALID});
+        }
+    }
+
+    return formats;
+}
+
+auto mgm::BufferAllocator::import_dmabuf(DmaBufAttributes const& attributes) -> std::shared_ptr<ImportedDmaBuf>
+{
+    if (!wayland_executor)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Cannot import dma-bufs without a bound Wayland display"}));
+    }
+
+    if (attributes.planes.size() != 1 || attributes.planes[0].offset != 0)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Only single-plane dma-bufs at offset 0 can be imported"}));
+    }
+
+    if (attributes.modifier != DRM_FORMAT_MOD_LINEAR && attributes.modifier != DRM_FORMAT_MOD_INVALID)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Cannot import dma-buf with explicit layout modifier"}));
+    }
+
+    gbm_import_fd_data import_data;
+    import_data.fd = attributes.planes[0].fd;
+    import_data.width = attributes.size.width.as_uint32_t();
+    import_data.height = attributes.size.height.as_uint32_t();
+    import_data.stride = attributes.planes[0].stride;
+    import_data.format = attributes.fourcc;
+
+    /*
+     * Ask for a scanout-capable import first so that fullscreen clients can
+     * be bypassed; not every buffer a client allocates can be scanned out.
+     */
+    uint32_t bo_flags{GBM_BO_USE_RENDERING};
+    if (bypass_option == mgm::BypassOption::allowed)
+    {
+        bo_flags |= GBM_BO_USE_SCANOUT;
+    }
+
+    gbm_bo* bo_raw = gbm_bo_import(device, GBM_BO_IMPORT_FD, &import_data, bo_flags);
+    if (!bo_raw && (bo_flags & GBM_BO_USE_SCANOUT))
+    {
+        bo_flags = GBM_BO_USE_RENDERING;
+        bo_raw = gbm_bo_import(device, GBM_BO_IMPORT_FD, &import_data, bo_flags);
+    }
+
+    if (!bo_raw)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to import dma-buf"}));
+    }
+
+    std::shared_ptr<gbm_bo> bo{bo_raw, GBMBODeleter()};
+
+    return std::make_shared<DmaBufImport>(ctx, bo, bo_flags, egl_extensions, wayland_executor);
+}
@@ -80,6 +80,8 @@ public:
         wl_resource* buffer,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release) override;
+    std::vector<DmaBufFormat> dmabuf_formats() override;
+    std::shared_ptr<ImportedDmaBuf> import_dmabuf(DmaBufAttributes const& attributes) override;
 private:
     std::shared_ptr<Buffer> alloc_hardware_buffer(
         graphics::BufferProperties const& buffer_properties);
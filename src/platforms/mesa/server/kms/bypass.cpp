@@ -42,7 +42,9 @@ bool mgm::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
 
     auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
+    // Scanning out a buffer can't scale it or crop anything but its top-left corner
+    auto const unscaled = (renderable->src_bounds() == geometry::Rectangle{{0, 0}, view_area.size});
     auto const is_orthogonal = (renderable->transformation() == identity);
-    bypass_is_feasible = (is_opaque && fits && is_orthogonal);
+    bypass_is_feasible = (is_opaque && fits && unscaled && is_orthogonal);
     return bypass_is_feasible;
 }
@@ -184,6 +184,7 @@ void mgm::KMSPageFlipper::notify_page_flip(uint32_t crtc_id, int64_t msc,
         auto& frame = completed_page_flips[crtc_id];
         frame.msc = msc;
         frame.ust = {clock_id, ust};
+        frame.vsync = true;
         report->report_vsync(pending->second.connector_id, frame);
         pending_page_flips.erase(pending);
     }
@@ -38,10 +38,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <algorithm>
+#include <limits>
 #include <cmath>
+#include <cstring>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -125,6 +129,9 @@ const GLchar* const mrg::Renderer::default_fshader =
 
 namespace
 {
+/// How many frames of damage we remember for repairing older back buffers
+size_t const max_damage_history = 4;
+
 template<void (* deleter)(GLuint)>
 class GLHandle
 {
@@ -358,6 +365,9 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
             auto val = eglQueryString(disp, s.id);
             mir::log_info(std::string(s.label) + ": " + (val ? val : ""));
         }
+
+        auto const extensions = eglQueryString(disp, EGL_EXTENSIONS);
+        buffer_age_supported = extensions && strstr(extensions, "EGL_EXT_buffer_age");
     }
 
     struct {GLenum id; char const* label;} const glstrings[] =
@@ -401,14 +411,76 @@ mrg::Renderer::~Renderer()
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
                                 mg::Renderable const& renderable) const
 {
-    primitives.resize(1);
-    primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
+    static glm::mat4 const identity(1);
+    auto const position = renderable.screen_position();
+    auto const clip = visible_regions.find(renderable.id());
+
+    // A transformed renderable isn't drawn over its screen_position(), so
+    // regions in screen coordinates don't tell us anything about it
+    if (renderable.transformation() != identity)
+    {
+        primitives.resize(1);
+        primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
+        return;
+    }
+
+    geom::Region opaque = renderable.opaque_region();
+    geom::Region const whole{position};
+
+    if (clip == visible_regions.end() && (opaque.empty() || opaque == whole))
+    {
+        primitives.resize(1);
+        primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
+        primitives[0].opaque = !opaque.empty();
+        return;
+    }
+
+    // Shaped renderables are blended, but we can avoid that for any part
+    // the client has told us is opaque anyway
+    geom::Region translucent = whole;
+    if (clip != visible_regions.end())
+        translucent.intersect(clip->second);
+    opaque.intersect(translucent);
+    translucent.subtract(opaque);
+
+    primitives.clear();
+    for (auto const& rect : opaque)
+    {
+        primitives.push_back(mgl::tessellate_renderable_into_rectangle(renderable, rect, geom::Displacement{0,0}));
+        primitives.back().opaque = true;
+    }
+    for (auto const& rect : translucent)
+        primitives.push_back(mgl::tessellate_renderable_into_rectangle(renderable, rect, geom::Displacement{0,0}));
+}
+
+void mrg::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage.bounding_rectangle();
+    damage_set = true;
+}
+
+void mrg::Renderer::set_visible_region(mg::Renderable::ID id, geom::Region const& region)
+{
+    visible_regions[id] = region;
 }
 
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
     render_target.bind();
 
+    geom::Rectangle redraw_area;
+    bool const partial = area_to_redraw(redraw_area);
+    if (partial)
+    {
+        /*
+         * Renderables outside the scissor are still drawn (and so their
+         * buffers consumed and textures kept), but GL discards their
+         * fragments before any shading or blending happens.
+         */
+        glEnable(GL_SCISSOR_TEST);
+        scissor_to(redraw_area);
+    }
+
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT);
@@ -419,6 +491,11 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         draw(*r);
     }
 
+    if (partial)
+        glDisable(GL_SCISSOR_TEST);
+
+    visible_regions.clear();
+
     render_target.swap_buffers();
 
     // Deleting unused textures only requires the GL context. This clean-up
@@ -429,6 +506,99 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
+int mrg::Renderer::buffer_age() const
+{
+    if (!buffer_age_supported)
+        return 0;
+
+    // Rendering to an FBO? Then the age of the EGL surface tells us nothing.
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    if (framebuffer != 0)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age))
+        return 0;
+
+    return age;
+}
+
+bool mrg::Renderer::area_to_redraw(geom::Rectangle& area) const
+{
+    bool const have_damage = damage_set;
+    damage_set = false;
+
+    auto const this_frame = have_damage ? damage : viewport;
+    auto const age = buffer_age();
+
+    /*
+     * A back buffer of age N last held the frame from N frames ago. To bring
+     * it up to date we redraw what changed in this frame and in the N-1
+     * frames since. An age of zero means the contents are undefined, and
+     * a buffer older than our history predates a viewport change.
+     */
+    bool partial = have_damage && gl_viewport_known &&
+                   age > 0 && static_cast<size_t>(age) <= damage_history.size();
+
+    if (partial)
+    {
+        geom::Rectangles repair;
+        if (this_frame.size.width.as_int() > 0 && this_frame.size.height.as_int() > 0)
+            repair.add(this_frame);
+        for (auto i = 0; i < age - 1; ++i)
+        {
+            auto const& old = damage_history[i];
+            if (old.size.width.as_int() > 0 && old.size.height.as_int() > 0)
+                repair.add(old);
+        }
+
+        area = repair.bounding_rectangle();
+        partial = !area.contains(viewport);
+    }
+
+    damage_history.insert(damage_history.begin(), this_frame);
+    if (damage_history.size() > max_damage_history)
+        damage_history.resize(max_damage_history);
+
+    return partial;
+}
+
+void mrg::Renderer::scissor_to(geom::Rectangle const& area) const
+{
+    if (area.size.width.as_int() <= 0 || area.size.height.as_int() <= 0)
+    {
+        glScissor(0, 0, 0, 0);
+        return;
+    }
+
+    auto const to_gl_window = display_transform * screen_to_gl_coords;
+
+    float left = std::numeric_limits<float>::max();
+    float right = std::numeric_limits<float>::lowest();
+    float bottom = std::numeric_limits<float>::max();
+    float top = std::numeric_limits<float>::lowest();
+
+    for (auto const& corner : {area.top_left, area.top_right(), area.bottom_left(), area.bottom_right()})
+    {
+        auto const clip = to_gl_window * glm::vec4(corner.x.as_int(), corner.y.as_int(), 0.0f, 1.0f);
+        auto const x = gl_viewport.top_left.x.as_int() +
+                       (clip.x / clip.w + 1.0f) / 2.0f * gl_viewport.size.width.as_int();
+        auto const y = gl_viewport.top_left.y.as_int() +
+                       (clip.y / clip.w + 1.0f) / 2.0f * gl_viewport.size.height.as_int();
+
+        left = std::min(left, x);
+        right = std::max(right, x);
+        bottom = std::min(bottom, y);
+        top = std::max(top, y);
+    }
+
+    // Round to the pixel boundaries whose centres are inside the area
+    auto const x = static_cast<GLint>(std::lround(left));
+    auto const y = static_cast<GLint>(std::lround(bottom));
+    glScissor(x, y, std::lround(right) - x, std::lround(top) - y);
+}
+
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
 {
     auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
@@ -579,7 +749,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
                                   GL_FALSE, sizeof(mgl::Vertex),
                                   &p.vertices[0].texcoord);
 
-            if (blend.dst_rgb == GL_ZERO)
+            if (blend.dst_rgb == GL_ZERO || p.opaque)
             {
                 glDisable(GL_BLEND);
             }
@@ -648,6 +818,7 @@ void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
                       0.0f});
 
     viewport = rect;
+    damage_history.clear();
     update_gl_viewport();
 }
 
@@ -684,6 +855,12 @@ void mrg::Renderer::update_gl_viewport()
         GLint offset_y = (buf_height - reduced_height) / 2;
 
         glViewport(offset_x, offset_y, reduced_width, reduced_height);
+        gl_viewport = {{offset_x, offset_y}, {reduced_width, reduced_height}};
+        gl_viewport_known = true;
+    }
+    else
+    {
+        gl_viewport_known = false;
     }
 }
 
@@ -693,12 +870,15 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
     if (new_display_transform != display_transform)
     {
         display_transform = new_display_transform;
+        damage_history.clear();
         update_gl_viewport();
     }
 }
 
 void mrg::Renderer::suspend()
 {
+    damage_history.clear();
+    visible_regions.clear();
     texture_cache->invalidate();
 }
 
@@ -23,6 +23,8 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/geometry/region.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
@@ -65,6 +67,8 @@ public:
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void set_visible_region(graphics::Renderable::ID id, geometry::Region const& region) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
@@ -127,6 +131,9 @@ protected:
 
 private:
     void update_gl_viewport();
+    int buffer_age() const;
+    bool area_to_redraw(geometry::Rectangle& area) const;
+    void scissor_to(geometry::Rectangle const& area) const;
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -135,6 +142,15 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+
+    bool buffer_age_supported{false};
+    bool gl_viewport_known{false};
+    geometry::Rectangle gl_viewport;  // In GL window coordinates
+    bool mutable damage_set{false};
+    geometry::Rectangle mutable damage;
+    /// Damage of recent frames, most recent first, for repairing older back buffers
+    std::vector<geometry::Rectangle> mutable damage_history;
+    std::unordered_map<graphics::Renderable::ID, geometry::Region> mutable visible_regions;
 };
 
 }
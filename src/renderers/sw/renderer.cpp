@@ -0,0 +1,472 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/gl/pixel_kernels.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/log.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mgl = mir::gl;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+namespace
+{
+/// How many frames of damage we remember for repairing older buffers
+size_t const max_damage_history = 4;
+
+bool blue_at_top(MirPixelFormat format)
+{
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+        return false;
+
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        return true;
+
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error(
+            "Software renderer can only draw into 32bpp RGB formats"));
+    }
+}
+
+bool has_alpha(MirPixelFormat format)
+{
+    return format == mir_pixel_format_argb_8888 || format == mir_pixel_format_abgr_8888;
+}
+
+/// The source pixel nearest the centre of destination pixel i, when scaling length to source_length
+int nearest(int i, int length, int source_length)
+{
+    return ((2 * i + 1) * source_length) / (2 * length);
+}
+
+bool is_empty(geom::Size const& size)
+{
+    return size.width.as_int() <= 0 || size.height.as_int() <= 0;
+}
+}
+
+mrs::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+    : render_target{dynamic_cast<RenderTarget*>(display_buffer.native_display_buffer())},
+      kernels{mgl::pixel_kernels()},
+      to_abgr{render_target && blue_at_top(render_target->pixel_format())}
+{
+    if (!render_target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+
+    mir::log_info("Software renderer using %s pixel kernels", kernels.name);
+
+    set_viewport(display_buffer.view_area());
+}
+
+mrs::Renderer::~Renderer() = default;
+
+void mrs::Renderer::set_viewport(geometry::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+
+    // Nothing drawn for the old viewport is any help
+    damage_history.clear();
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& transform)
+{
+    if (transform != glm::mat2(1) && !warned_about_transform)
+    {
+        mir::log_warning("Output transforms are not supported by the software renderer; drawing untransformed");
+        warned_about_transform = true;
+    }
+}
+
+void mrs::Renderer::set_damage(geom::Rectangles const& damage)
+{
+    this->damage = damage;
+    damage_set = true;
+}
+
+void mrs::Renderer::set_visible_region(mg::Renderable::ID id, geom::Region const& region)
+{
+    visible_regions[id] = region;
+}
+
+void mrs::Renderer::suspend()
+{
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    Target const target{
+        render_target->map_for_write(),
+        {viewport.top_left, render_target->size()},
+        render_target->stride().as_int()};
+
+    auto const redraw = area_to_redraw(target.area);
+
+    // There's no need to clear what an opaque renderable is about to cover
+    static glm::mat4 const identity(1);
+    geom::Region background{redraw};
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        if (renderable->transformation() != identity || !buffer ||
+            !mgl::can_convert(buffer->pixel_format()) ||
+            !dynamic_cast<PixelSource*>(buffer->native_buffer_base()))
+        {
+            continue;
+        }
+
+        auto opaque = renderable->opaque_region();
+        auto const clip = visible_regions.find(renderable->id());
+        if (clip != visible_regions.end())
+            opaque.intersect(clip->second);
+        background.subtract(opaque);
+    }
+    clear(target, background);
+
+    for (auto const& renderable : renderables)
+        draw(target, *renderable, redraw);
+
+    visible_regions.clear();
+
+    auto damage = redraw;
+    damage.translate(geom::Point{} - target.area.top_left);
+    render_target->swap_buffers(damage);
+}
+
+auto mrs::Renderer::area_to_redraw(geom::Rectangle const& target_area) const -> geom::Region
+{
+    bool const have_damage = damage_set;
+    damage_set = false;
+
+    geom::Region this_frame;
+    if (have_damage)
+    {
+        for (auto const& rect : damage)
+            this_frame.unite(rect);
+        this_frame.intersect(target_area);
+    }
+    else
+    {
+        this_frame = target_area;
+    }
+
+    /*
+     * A buffer of age N last held the frame from N frames ago, so it needs
+     * what changed in this frame and in the N-1 frames since.
+     */
+    auto const age = render_target->buffer_age();
+    geom::Region redraw{target_area};
+    if (have_damage && age > 0 && static_cast<size_t>(age) <= damage_history.size())
+    {
+        redraw = this_frame;
+        for (auto i = 0; i < age - 1; ++i)
+            redraw.unite(damage_history[i]);
+    }
+
+    damage_history.insert(damage_history.begin(), this_frame);
+    if (damage_history.size() > max_damage_history)
+        damage_history.resize(max_damage_history);
+
+    return redraw;
+}
+
+void mrs::Renderer::clear(Target const& target, geom::Region const& area) const
+{
+    for (auto const& rect : area)
+    {
+        auto const x = rect.top_left.x.as_int() - target.area.top_left.x.as_int();
+        auto const top = rect.top_left.y.as_int() - target.area.top_left.y.as_int();
+        auto const bytes = rect.size.width.as_int() * sizeof(uint32_t);
+
+        for (auto y = top; y != top + rect.size.height.as_int(); ++y)
+            memset(target.pixels + y * target.stride + x * sizeof(uint32_t), 0, bytes);
+    }
+}
+
+void mrs::Renderer::draw(Target const& target, mg::Renderable const& renderable, geom::Region const& redraw) const
+{
+    auto const buffer = renderable.buffer();
+    auto const format = buffer->pixel_format();
+    auto const source = dynamic_cast<PixelSource*>(buffer->native_buffer_base());
+    if (!source || !mgl::can_convert(format))
+    {
+        mir::log_error("Buffer does not support software rendering!");
+        return;
+    }
+
+    if (renderable.transformation() != glm::mat4(1))
+    {
+        draw_transformed(target, renderable, *source, redraw);
+        return;
+    }
+
+    auto const position = renderable.screen_position();
+    auto const buffer_size = buffer->size();
+    auto const src = renderable.src_bounds();
+    bool const scaled = src.size != position.size;
+
+    geom::Region translucent{position};
+    translucent.intersect(redraw);
+    auto const clip = visible_regions.find(renderable.id());
+    if (clip != visible_regions.end())
+        translucent.intersect(clip->second);
+    if (!scaled)
+    {
+        // Don't read beyond the buffer, whatever src_bounds() says
+        translucent.intersect(geom::Rectangle{
+            position.top_left - (src.top_left - geom::Point{}),
+            buffer_size});
+    }
+
+    auto opaque = renderable.opaque_region();
+    opaque.intersect(translucent);
+    translucent.subtract(opaque);
+
+    auto const alpha = static_cast<uint8_t>(std::lround(std::min(std::max(renderable.alpha(), 0.0f), 1.0f) * 255));
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(format);
+    auto const stride = source->stride().as_int();
+    bool const in_target_order = to_abgr ?
+        format == mir_pixel_format_abgr_8888 || format == mir_pixel_format_xbgr_8888 :
+        format == mir_pixel_format_argb_8888 || format == mir_pixel_format_xrgb_8888;
+
+    auto const draw_rect =
+        [&](unsigned char const* pixels, geom::Rectangle const& rect, bool copy)
+        {
+            auto const width = rect.size.width.as_int();
+            auto const left = rect.top_left.x.as_int() - position.top_left.x.as_int();
+            auto const top = rect.top_left.y.as_int() - position.top_left.y.as_int();
+
+            // Rows we can use without conversion; alpha is only ignored if we copy into a target without it
+            bool const direct = !scaled && in_target_order &&
+                (has_alpha(format) || (copy && !has_alpha(render_target->pixel_format())));
+
+            if (scaled)
+            {
+                columns.resize(width);
+                for (auto i = 0; i != width; ++i)
+                {
+                    auto const column = src.top_left.x.as_int() +
+                        nearest(left + i, position.size.width.as_int(), src.size.width.as_int());
+                    columns[i] = std::min(std::max(column, 0), buffer_size.width.as_int() - 1);
+                }
+            }
+
+            for (auto y = 0; y != rect.size.height.as_int(); ++y)
+            {
+                auto const dst = reinterpret_cast<uint32_t*>(
+                    target.pixels +
+                    (rect.top_left.y.as_int() + y - target.area.top_left.y.as_int()) * target.stride) +
+                    (rect.top_left.x.as_int() - target.area.top_left.x.as_int());
+
+                uint32_t const* row;
+                if (scaled)
+                {
+                    auto const source_y = std::min(std::max(
+                        src.top_left.y.as_int() + nearest(top + y, position.size.height.as_int(), src.size.height.as_int()),
+                        0), buffer_size.height.as_int() - 1);
+
+                    // Convert the span we sample from, then pick the samples
+                    auto const first = columns.front();
+                    converted.resize(columns.back() - first + 1);
+                    mgl::convert_row(
+                        kernels,
+                        converted.data(),
+                        pixels + source_y * stride + first * bytes_per_pixel,
+                        format,
+                        to_abgr,
+                        converted.size());
+
+                    scaled_row.resize(width);
+                    for (auto i = 0; i != width; ++i)
+                        scaled_row[i] = converted[columns[i] - first];
+                    row = scaled_row.data();
+                }
+                else
+                {
+                    auto const source_row = pixels +
+                        (src.top_left.y.as_int() + top + y) * stride +
+                        (src.top_left.x.as_int() + left) * bytes_per_pixel;
+
+                    if (direct)
+                    {
+                        row = reinterpret_cast<uint32_t const*>(source_row);
+                    }
+                    else
+                    {
+                        converted.resize(width);
+                        mgl::convert_row(kernels, converted.data(), source_row, format, to_abgr, width);
+                        row = converted.data();
+                    }
+                }
+
+                if (copy)
+                    memcpy(dst, row, width * sizeof(uint32_t));
+                else
+                    kernels.blend(dst, row, width, alpha);
+            }
+        };
+
+    // Read even if nothing is to be drawn, as that's what releases the buffer to its client
+    source->read(
+        [&](unsigned char const* pixels)
+        {
+            if (is_empty(src.size) || is_empty(position.size) || is_empty(buffer_size))
+                return;
+
+            for (auto const& rect : opaque)
+                draw_rect(pixels, rect, alpha == 255);
+            for (auto const& rect : translucent)
+                draw_rect(pixels, rect, false);
+        });
+}
+
+void mrs::Renderer::draw_transformed(
+    Target const& target,
+    mg::Renderable const& renderable,
+    PixelSource& source,
+    geom::Region const& redraw) const
+{
+    auto const buffer = renderable.buffer();
+    auto const format = buffer->pixel_format();
+    auto const buffer_size = buffer->size();
+    auto const position = renderable.screen_position();
+    auto const src = renderable.src_bounds();
+    auto const transform = renderable.transformation();
+
+    if (!warned_about_projection &&
+        (transform[0][3] != 0 || transform[1][3] != 0 || transform[3][3] != 1))
+    {
+        mir::log_warning("Software renderer ignores the perspective part of surface transformations");
+        warned_about_projection = true;
+    }
+
+    // Like the GL renderer, transform about the centre of the renderable (x' = a x + b y + tx, y' = c x + d y + ty)
+    float const centre_x = position.top_left.x.as_int() + position.size.width.as_int() / 2.0f;
+    float const centre_y = position.top_left.y.as_int() + position.size.height.as_int() / 2.0f;
+    float const a = transform[0][0], b = transform[1][0], tx = transform[3][0];
+    float const c = transform[0][1], d = transform[1][1], ty = transform[3][1];
+    float const determinant = a * d - b * c;
+
+    auto const alpha = static_cast<uint8_t>(std::lround(std::min(std::max(renderable.alpha(), 0.0f), 1.0f) * 255));
+    auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(format);
+    auto const stride = source.stride().as_int();
+
+    // Read even if nothing is to be drawn, as that's what releases the buffer to its client
+    source.read(
+        [&](unsigned char const* pixels)
+        {
+            if (is_empty(src.size) || is_empty(position.size) || is_empty(buffer_size) ||
+                std::abs(determinant) < 1e-6f)
+            {
+                return;
+            }
+
+            // Draw over the bounding box of the transformed corners...
+            float left{std::numeric_limits<float>::max()}, top{left};
+            float right{std::numeric_limits<float>::lowest()}, bottom{right};
+            for (auto const x : {position.top_left.x.as_int(), position.bottom_right().x.as_int()})
+            {
+                for (auto const y : {position.top_left.y.as_int(), position.bottom_right().y.as_int()})
+                {
+                    auto const dx = x - centre_x, dy = y - centre_y;
+                    auto const screen_x = a * dx + b * dy + tx + centre_x;
+                    auto const screen_y = c * dx + d * dy + ty + centre_y;
+                    left = std::min(left, screen_x);
+                    right = std::max(right, screen_x);
+                    top = std::min(top, screen_y);
+                    bottom = std::max(bottom, screen_y);
+                }
+            }
+
+            auto const left_edge = static_cast<int>(std::floor(left));
+            auto const top_edge = static_cast<int>(std::floor(top));
+            geom::Region area{geom::Rectangle{
+                {left_edge, top_edge},
+                {static_cast<int>(std::ceil(right)) - left_edge, static_cast<int>(std::ceil(bottom)) - top_edge}}};
+            area.intersect(redraw);
+            auto const clip = visible_regions.find(renderable.id());
+            if (clip != visible_regions.end())
+                area.intersect(clip->second);
+
+            // ...sampling the source pixel each target pixel centre maps back to, and leaving alone
+            // the target pixels that map to somewhere outside the renderable
+            for (auto const& rect : area)
+            {
+                auto const width = rect.size.width.as_int();
+                scaled_row.resize(width);
+
+                for (auto y = rect.top_left.y.as_int(); y != rect.bottom_right().y.as_int(); ++y)
+                {
+                    for (auto i = 0; i != width; ++i)
+                    {
+                        auto const dx = rect.top_left.x.as_int() + i + 0.5f - centre_x - tx;
+                        auto const dy = y + 0.5f - centre_y - ty;
+                        auto const local_x = (d * dx - b * dy) / determinant + centre_x - position.top_left.x.as_int();
+                        auto const local_y = (a * dy - c * dx) / determinant + centre_y - position.top_left.y.as_int();
+
+                        if (local_x < 0 || local_y < 0 ||
+                            local_x >= position.size.width.as_int() || local_y >= position.size.height.as_int())
+                        {
+                            scaled_row[i] = 0;
+                            continue;
+                        }
+
+                        auto const column = std::min(std::max(
+                            src.top_left.x.as_int() +
+                                static_cast<int>(local_x * src.size.width.as_int() / position.size.width.as_int()),
+                            0), buffer_size.width.as_int() - 1);
+                        auto const row = std::min(std::max(
+                            src.top_left.y.as_int() +
+                                static_cast<int>(local_y * src.size.height.as_int() / position.size.height.as_int()),
+                            0), buffer_size.height.as_int() - 1);
+
+                        mgl::convert_row(
+                            kernels,
+                            &scaled_row[i],
+                            pixels + row * stride + column * bytes_per_pixel,
+                            format,
+                            to_abgr,
+                            1);
+                    }
+
+                    auto const dst = reinterpret_cast<uint32_t*>(
+                        target.pixels + (y - target.area.top_left.y.as_int()) * target.stride) +
+                        (rect.top_left.x.as_int() - target.area.top_left.x.as_int());
+                    kernels.blend(dst, scaled_row.data(), width, alpha);
+                }
+            }
+        });
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_RENDERER_H_
+#define MIR_RENDERER_SW_RENDERER_H_
+
+#include <mir/renderer/renderer.h>
+#include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/geometry/region.h>
+#include <mir/graphics/renderable.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace gl { struct PixelKernels; }
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+class PixelSource;
+
+/**
+ * Composites renderables with the CPU, straight from their PixelSource buffers
+ * into a RenderTarget. Only the damaged part of the target is redrawn.
+ *
+ * Surfaces are drawn where screen_position() puts them, scaled (with nearest
+ * neighbour sampling) if src_bounds() is a different size. The 2D affine part
+ * of transformation() is applied about the surface's centre, as the GL
+ * renderer does; output transforms are not supported.
+ */
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer);
+    ~Renderer();
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void set_damage(geometry::Rectangles const& damage) override;
+    void set_visible_region(graphics::Renderable::ID id, geometry::Region const& region) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+private:
+    struct Target
+    {
+        unsigned char* pixels;
+        geometry::Rectangle area; // In screen coordinates
+        int stride;
+    };
+
+    auto area_to_redraw(geometry::Rectangle const& target_area) const -> geometry::Region;
+    void clear(Target const& target, geometry::Region const& area) const;
+    void draw(Target const& target, graphics::Renderable const& renderable, geometry::Region const& redraw) const;
+    void draw_transformed(
+        Target const& target,
+        graphics::Renderable const& renderable,
+        PixelSource& source,
+        geometry::Region const& redraw) const;
+
+    RenderTarget* const render_target;
+    mir::gl::PixelKernels const& kernels;
+    bool const to_abgr;
+
+    geometry::Rectangle viewport;
+    bool mutable warned_about_transform{false};
+    bool mutable warned_about_projection{false};
+    bool mutable damage_set{false};
+    geometry::Rectangles mutable damage;
+    /// Damage of recent frames, most recent first, for repairing older buffers
+    std::vector<geometry::Region> mutable damage_history;
+    std::unordered_map<graphics::Renderable::ID, geometry::Region> mutable visible_regions;
+
+    /// Scratch rows for converting and scaling source pixels
+    std::vector<uint32_t> mutable converted;
+    std::vector<uint32_t> mutable scaled_row;
+    std::vector<int> mutable columns;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDERER_H_
@@ -19,6 +19,7 @@
 #include "compositing_screencast.h"
 #include "screencast_display_buffer.h"
 #include "queueing_schedule.h"
+#include "damage_tracker.h"
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_properties.h"
 #include "mir/graphics/display.h"
@@ -28,11 +29,15 @@
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/graphics/transformation.h"
 #include "mir/compositor/display_buffer_compositor.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
 #include "mir/geometry/rectangles.h"
 #include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
 
+#include <tuple>
+
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 namespace mg = mir::graphics;
@@ -64,6 +69,46 @@ std::unique_ptr<mg::VirtualOutput> make_virtual_output(mg::Display& display, geo
     }
     return nullptr;
 }
+
+/**
+ * Maps damage (in screen coordinates, within region) onto a buffer of
+ * buffer_size that region is captured into, as capture() lays it out
+ */
+geom::Rectangles damage_in_buffer(
+    geom::Rectangles const& damage,
+    geom::Rectangle const& region,
+    geom::Size const& buffer_size,
+    MirMirrorMode mirror_mode)
+{
+    int const region_width = region.size.width.as_int();
+    int const region_height = region.size.height.as_int();
+    int const width = buffer_size.width.as_int();
+    int const height = buffer_size.height.as_int();
+
+    // Round outwards, so that scaled damage still covers every pixel it touches
+    auto const scale_down = [](int offset, int to, int from)
+        { return static_cast<int>(int64_t{offset} * to / from); };
+    auto const scale_up = [](int offset, int to, int from)
+        { return static_cast<int>((int64_t{offset} * to + from - 1) / from); };
+
+    geom::Rectangles result;
+    for (auto const& rect : damage)
+    {
+        auto const offset = rect.top_left - region.top_left;
+        int left = scale_down(offset.dx.as_int(), width, region_width);
+        int top = scale_down(offset.dy.as_int(), height, region_height);
+        int right = scale_up(offset.dx.as_int() + rect.size.width.as_int(), width, region_width);
+        int bottom = scale_up(offset.dy.as_int() + rect.size.height.as_int(), height, region_height);
+
+        if (mirror_mode == mir_mirror_mode_horizontal)
+            std::tie(left, right) = std::make_pair(width - right, width - left);
+        if (mirror_mode == mir_mirror_mode_vertical)
+            std::tie(top, bottom) = std::make_pair(height - bottom, height - top);
+
+        result.add({{left, top}, {right - left, bottom - top}});
+    }
+    return result;
+}
 }
 
 class mc::detail::ScreencastSessionContext
@@ -81,6 +126,7 @@ public:
       display_buffer{std::make_unique<ScreencastDisplayBuffer>(capture_region, capture_size, mirror_mode, free_queue, ready_queue, display)},
       display_buffer_compositor{db_compositor_factory.create_compositor_for(*display_buffer)},
       virtual_output{make_virtual_output(display, capture_region)},
+      capture_region(capture_region),
       queue_size(capture_size),
       mirror_mode(mirror_mode)
     {
@@ -100,25 +146,45 @@ public:
     {
         std::lock_guard<decltype(mutex)> lk(mutex);
         if (queue_size != display_buffer->renderbuffer_size())
+        {
             display_buffer->set_renderbuffer_size(queue_size);
+            damage.invalidate();
+        }
+
+        auto elements = scene->scene_elements_for(this);
+
+        // Nothing on screen has changed, so the last capture is still current
+        if (damage_since_last_capture(elements).size() == 0 && last_captured_buffer)
+            return last_captured_buffer;
 
         //FIXME:: the client needs a better way to express it is no longer
         //using the last captured buffer
         if (last_captured_buffer)
             free_queue.schedule(last_captured_buffer);
 
-        display_buffer_compositor->composite(scene->scene_elements_for(this));
+        composite(std::move(elements));
 
         last_captured_buffer = ready_queue.next_buffer();
+        last_filled_buffer = last_captured_buffer;
         return last_captured_buffer;
     }
 
-    void capture(std::shared_ptr<mg::Buffer> const& buffer)
+    geom::Rectangles capture(std::shared_ptr<mg::Buffer> const& buffer)
     {
         std::lock_guard<decltype(mutex)> lk(mutex);
         if (buffer->size() != display_buffer->renderbuffer_size())
+        {
             display_buffer->set_renderbuffer_size(buffer->size());
-       
+            damage.invalidate();
+        }
+
+        auto elements = scene->scene_elements_for(this);
+        auto const changed = damage_in_buffer(
+            damage_since_last_capture(elements), capture_region, buffer->size(), mirror_mode);
+
+        if (changed.size() == 0 && last_filled_buffer.lock() == buffer)
+            return changed;
+
         //a bit confusingly, the old way of screencasting had the mirror_mode_none
         //produce upside down buffers.
         if (mirror_mode == mir_mirror_mode_none)
@@ -138,15 +204,46 @@ public:
         for(auto i = 0u; i < scheduled; i++)
             free_queue.schedule(free_queue.next_buffer());
 
-        display_buffer_compositor->composite(scene->scene_elements_for(this));
+        composite(std::move(elements));
         if (buffer != ready_queue.next_buffer())
+        {
+            damage.invalidate();
             throw std::runtime_error("unable to capture to buffer");
+        }
 
         display_buffer->set_transformation(mg::transformation(mirror_mode));
         display_buffer->commit();
+
+        last_filled_buffer = buffer;
+        return changed;
     }
 
 private:
+    geom::Rectangles damage_since_last_capture(mc::SceneElementSequence const& elements)
+    {
+        mg::RenderableList renderables;
+        renderables.reserve(elements.size());
+        for (auto const& element : elements)
+            renderables.push_back(element->renderable());
+
+        return damage.damage_for(renderables, capture_region, glm::mat2{});
+    }
+
+    void composite(mc::SceneElementSequence&& elements)
+    {
+        try
+        {
+            display_buffer_compositor->composite(std::move(elements));
+        }
+        catch (...)
+        {
+            // We don't know what made it into the buffer
+            damage.invalidate();
+            last_filled_buffer.reset();
+            throw;
+        }
+    }
+
     std::mutex mutex;
     std::shared_ptr<Scene> const scene;
     QueueingSchedule free_queue;
@@ -156,6 +253,9 @@ private:
     std::unique_ptr<compositor::DisplayBufferCompositor> display_buffer_compositor;
     std::unique_ptr<graphics::VirtualOutput> virtual_output;
     std::shared_ptr<mg::Buffer> last_captured_buffer;
+    std::weak_ptr<mg::Buffer> last_filled_buffer;
+    DamageTracker damage;
+    geom::Rectangle const capture_region;
     geom::Size queue_size;
     MirMirrorMode mirror_mode;
 };
@@ -247,8 +347,8 @@ mc::CompositingScreencast::create_session_context(
         scene, *display, *db_compositor_factory, buffers, rect, size, mirror_mode);
 }
 
-void mc::CompositingScreencast::capture(
+geom::Rectangles mc::CompositingScreencast::capture(
     mf::ScreencastSessionId id, std::shared_ptr<mg::Buffer> const& b)
 {
-    session(id)->capture(b);
+    return session(id)->capture(b);
 }
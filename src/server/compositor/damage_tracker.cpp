@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damage_tracker.h"
+#include "mir/graphics/buffer.h"
+#include "mir/geometry/displacement.h"
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+void add_clipped(geom::Rectangles& damage, geom::Rectangle const& rect, geom::Rectangle const& view_area)
+{
+    auto const clipped = rect.intersection_with(view_area);
+    if (clipped != geom::Rectangle{})
+        damage.add(clipped);
+}
+
+/// The parts of renderable's position covered by damage to its buffer
+void add_content_damage(
+    geom::Rectangles& damage,
+    mg::Renderable const& renderable,
+    geom::Rectangle const& position,
+    geom::Rectangle const& src_bounds,
+    geom::Size const& buffer_size,
+    mg::BufferID previous,
+    geom::Rectangle const& view_area)
+{
+    // A scaled or cropped buffer doesn't map pixel-for-pixel onto its position
+    if (src_bounds != geom::Rectangle{{0, 0}, buffer_size} || buffer_size != position.size)
+    {
+        add_clipped(damage, position, view_area);
+        return;
+    }
+
+    auto const offset = position.top_left - geom::Point{};
+    for (auto const& rect : renderable.buffer_damage_since(previous))
+    {
+        auto const on_screen = geom::Rectangle{rect.top_left + offset, rect.size}.intersection_with(position);
+        add_clipped(damage, on_screen, view_area);
+    }
+}
+}
+
+geom::Rectangles mc::DamageTracker::damage_for(
+    mg::RenderableList const& renderables,
+    geom::Rectangle const& view_area,
+    glm::mat2 const& output_transform)
+{
+    static glm::mat4 const identity(1);
+
+    this_frame.clear();
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        this_frame.push_back(RenderableState{
+            renderable->id(),
+            renderable->screen_position(),
+            renderable->src_bounds(),
+            buffer ? buffer->id() : mg::BufferID{},
+            buffer ? buffer->size() : geom::Size{},
+            renderable->alpha(),
+            renderable->shaped(),
+            renderable->transformation() != identity});
+    }
+
+    geom::Rectangles damage;
+    bool full_damage = !valid ||
+                       view_area != last_view_area ||
+                       output_transform != last_output_transform;
+
+    if (!full_damage)
+    {
+        last_index.clear();
+        for (size_t i = 0; i != last_frame.size(); ++i)
+            last_index[last_frame[i].id] = i;
+
+        std::vector<bool> seen(last_frame.size(), false);
+
+        /*
+         * A renderable whose index in the last frame is lower than that of
+         * something now beneath it has been restacked; the overlap of any
+         * pair that swapped places lies within the one we find this way.
+         */
+        size_t highest_last_index = 0;
+        bool any_matched = false;
+
+        for (size_t i = 0; i != this_frame.size(); ++i)
+        {
+            auto const& now = this_frame[i];
+            auto const found = last_index.find(now.id);
+            if (found == last_index.end())
+            {
+                if (now.transformed)
+                    full_damage = true;
+                add_clipped(damage, now.position, view_area);
+                continue;
+            }
+
+            auto const& then = last_frame[found->second];
+            seen[found->second] = true;
+
+            bool const restacked = any_matched && found->second < highest_last_index;
+            if (!any_matched || found->second > highest_last_index)
+                highest_last_index = found->second;
+            any_matched = true;
+
+            bool const changed_geometry = restacked ||
+                                          now.position != then.position ||
+                                          now.src_bounds != then.src_bounds ||
+                                          now.alpha != then.alpha ||
+                                          now.shaped != then.shaped ||
+                                          now.transformed != then.transformed;
+            bool const changed_content = now.buffer_id != then.buffer_id;
+
+            if (!changed_geometry && !changed_content)
+                continue;
+
+            // We can't predict where a transformed renderable ends up
+            if (now.transformed || then.transformed)
+                full_damage = true;
+
+            if (!changed_geometry)
+            {
+                add_content_damage(
+                    damage, *renderables[i], now.position, now.src_bounds, now.buffer_size, then.buffer_id, view_area);
+                continue;
+            }
+
+            if (then.position != now.position)
+                add_clipped(damage, then.position, view_area);
+            add_clipped(damage, now.position, view_area);
+        }
+
+        for (size_t i = 0; i != last_frame.size(); ++i)
+        {
+            if (!seen[i])
+            {
+                if (last_frame[i].transformed)
+                    full_damage = true;
+                add_clipped(damage, last_frame[i].position, view_area);
+            }
+        }
+    }
+
+    if (full_damage)
+    {
+        damage.clear();
+        damage.add(view_area);
+    }
+
+    valid = true;
+    last_view_area = view_area;
+    last_output_transform = output_transform;
+    std::swap(last_frame, this_frame);
+
+    return damage;
+}
+
+void mc::DamageTracker::invalidate()
+{
+    valid = false;
+}
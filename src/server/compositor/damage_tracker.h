@@ -0,0 +1,82 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Works out which parts of an output need redrawing by comparing the
+ * renderables of successive frames: appearing, disappearing, moving,
+ * resizing and restacking renderables damage their old and new positions,
+ * a new buffer damages the parts of the area it is drawn to that the client
+ * reported as changed.
+ */
+class DamageTracker
+{
+public:
+    DamageTracker() = default;
+
+    /**
+     * The damage (clipped to view_area) between the previous frame and one
+     * made of renderables. An empty result means nothing visible changed.
+     */
+    geometry::Rectangles damage_for(
+        graphics::RenderableList const& renderables,
+        geometry::Rectangle const& view_area,
+        glm::mat2 const& output_transform);
+
+    /// The next frame is treated as completely damaged
+    void invalidate();
+
+private:
+    struct RenderableState
+    {
+        graphics::Renderable::ID id;
+        geometry::Rectangle position;
+        geometry::Rectangle src_bounds;
+        graphics::BufferID buffer_id;
+        geometry::Size buffer_size;
+        float alpha;
+        bool shaped;
+        bool transformed;
+    };
+
+    bool valid{false};
+    geometry::Rectangle last_view_area;
+    glm::mat2 last_output_transform;
+    std::vector<RenderableState> last_frame;
+    std::vector<RenderableState> this_frame;
+    std::unordered_map<graphics::Renderable::ID, size_t> last_index;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_DAMAGE_TRACKER_H_ */
@@ -23,11 +23,14 @@
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
 #include "gl/renderer_factory.h"
+#include "sw/renderer_factory.h"
 #include "compositing_screencast.h"
 #include "mir/main_loop.h"
 
 #include "mir/frontend/screencast.h"
 #include "mir/options/configuration.h"
+#include "mir/abnormal_exit.h"
+#include "mir/log.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -86,8 +89,21 @@ mir::DefaultServerConfiguration::the_compositor()
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]() -> std::shared_ptr<mir::renderer::RendererFactory>
         {
+            auto const renderer = the_options()->get<std::string>(options::renderer_opt);
+
+            if (renderer == "software")
+            {
+                mir::log_info("Using software renderer");
+                return std::make_shared<mir::renderer::software::RendererFactory>();
+            }
+            else if (renderer != "gl")
+            {
+                BOOST_THROW_EXCEPTION(mir::AbnormalExit(
+                    std::string("Exiting Mir! Reason: Unknown renderer \"") + renderer + "\""));
+            }
+
             return std::make_shared<mir::renderer::gl::RendererFactory>();
         });
 }
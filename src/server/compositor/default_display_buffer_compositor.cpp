@@ -49,7 +49,8 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     report->began_frame(this);
 
     auto const& view_area = display_buffer.view_area();
-    auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
+    partly_visible.clear();
+    auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area, partly_visible);
 
     for (auto const& element : occlusions)
         element->occluded();
@@ -76,11 +77,18 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+
+        // Whatever we composited last is no longer what is on screen
+        damage.invalidate();
     }
     else
     {
-        renderer->set_output_transform(display_buffer.transformation());
+        auto const transformation = display_buffer.transformation();
+        renderer->set_output_transform(transformation);
         renderer->set_viewport(view_area);
+        renderer->set_damage(damage.damage_for(renderable_list, view_area, transformation));
+        for (auto const& visible : partly_visible)
+            renderer->set_visible_region(visible.first, visible.second);
         renderer->render(renderable_list);
 
         report->renderables_in_frame(this, renderable_list);
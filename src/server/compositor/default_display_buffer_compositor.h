@@ -21,6 +21,8 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "damage_tracker.h"
+#include "occlusion.h"
 #include <memory>
 
 namespace mir
@@ -52,6 +54,8 @@ private:
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    DamageTracker damage;
+    VisibleRegions partly_visible; // Kept to reuse its buckets between frames
 };
 
 }
@@ -28,6 +28,14 @@ namespace mg = mir::graphics;
 namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 
+namespace
+{
+bool contains(std::vector<mc::CompositorID> const& users, mc::CompositorID id)
+{
+    return std::find(users.begin(), users.end(), id) != users.end();
+}
+}
+
 mc::MultiMonitorArbiter::MultiMonitorArbiter(
     std::shared_ptr<Schedule> const& schedule) :
     schedule(schedule)
@@ -45,13 +53,13 @@ std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::compositor_acquire(composit
     if (!current_buffer && !schedule->num_scheduled())
         BOOST_THROW_EXCEPTION(std::logic_error("no buffer to give to compositor"));
 
-    if (current_buffer_users.find(id) != current_buffer_users.end() || !current_buffer)
+    if (contains(current_buffer_users, id) || !current_buffer)
     {
         if (schedule->num_scheduled())
             current_buffer = schedule->next_buffer();
         current_buffer_users.clear();
     }
-    current_buffer_users.insert(id);
+    current_buffer_users.push_back(id);
 
     return current_buffer;
 }
@@ -82,7 +90,7 @@ bool mc::MultiMonitorArbiter::buffer_ready_for(mc::CompositorID id)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
     return schedule->num_scheduled() ||
-       ((current_buffer_users.find(id) == current_buffer_users.end()) && current_buffer);
+       (!contains(current_buffer_users, id) && current_buffer);
 }
 
 bool mc::MultiMonitorArbiter::has_buffer()
@@ -24,7 +24,7 @@
 #include <memory>
 #include <mutex>
 #include <deque>
-#include <set>
+#include <vector>
 
 namespace mir
 {
@@ -51,7 +51,9 @@ public:
 private:
     std::mutex mutable mutex;
     std::shared_ptr<graphics::Buffer> current_buffer;
-    std::set<compositor::CompositorID> current_buffer_users;
+    // Only ever holds a handful of compositors; a vector keeps its storage
+    // across frames where a set would allocate a node on every acquire.
+    std::vector<compositor::CompositorID> current_buffer_users;
     std::shared_ptr<Schedule> schedule;
 };
 
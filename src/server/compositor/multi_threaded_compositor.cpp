@@ -19,6 +19,7 @@
 #include "multi_threaded_compositor.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/display_configuration.h"
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/compositor/display_listener.h"
@@ -31,6 +32,8 @@
 #include "mir/raii.h"
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
+#include "mir/thread/basic_thread_pool.h"
+#include "mir/optional_value.h"
 
 #include <thread>
 #include <chrono>
@@ -43,22 +46,120 @@ namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
 
+namespace
+{
+/// How the frames of a display buffer are timed: by the output it shows, if we know it
+struct FrameTiming
+{
+    mir::optional_value<unsigned> output_id;
+    std::chrono::nanoseconds refresh{0};
+};
+
+auto frame_timing_for(mg::DisplayConfiguration const& conf, mg::DisplayBuffer const& buffer) -> FrameTiming
+{
+    FrameTiming timing;
+
+    conf.for_each_output(
+        [&timing, view_area = buffer.view_area()](mg::DisplayConfigurationOutput const& output)
+        {
+            if (timing.output_id.is_set() || !output.used || output.extents() != view_area)
+                return;
+
+            timing.output_id = output.id.as_value();
+
+            if (output.current_mode_index < output.modes.size())
+            {
+                auto const hz = output.modes[output.current_mode_index].vrefresh_hz;
+                if (hz > 0)
+                    timing.refresh = std::chrono::nanoseconds{static_cast<int64_t>(1e9 / hz)};
+            }
+        });
+
+    return timing;
+}
+
+auto presented_frame(mg::Display const& display, FrameTiming const& timing) -> mc::PresentedFrame
+{
+    if (timing.output_id.is_set())
+    {
+        auto const frame = display.last_frame_on(timing.output_id.value());
+
+        // Displays that don't count their frames can't tell us when they were shown, and
+        // clients are told frames are timed by CLOCK_MONOTONIC
+        if (frame.msc != 0 && frame.ust.clock_id == CLOCK_MONOTONIC)
+            return {frame, timing.refresh};
+    }
+
+    auto untimed = mc::PresentedFrame::untimed(std::chrono::steady_clock::now());
+    untimed.refresh = timing.refresh;
+    return untimed;
+}
+}
+
 namespace mir
 {
 namespace compositor
 {
 
+/*
+ * Composites one display buffer of a sync group on a thread of its own, so
+ * that the outputs of a group can render in parallel. The display buffer
+ * compositor (and so its rendering context) is created, used and destroyed
+ * on that thread.
+ */
+class OutputCompositingThread
+{
+public:
+    OutputCompositingThread(
+        mc::DisplayBufferCompositorFactory& compositor_factory,
+        mg::DisplayBuffer& buffer) :
+        id{&buffer}
+    {
+        worker.run(
+            [this, &compositor_factory, &buffer]
+            {
+                mir::set_thread_name("Mir/Comp");
+                compositor = compositor_factory.create_compositor_for(buffer);
+            },
+            id).get();
+    }
+
+    ~OutputCompositingThread()
+    {
+        worker.run([this] { compositor.reset(); }, id).wait();
+    }
+
+    mc::DisplayBufferCompositor* display_buffer_compositor() const
+    {
+        return compositor.get();
+    }
+
+    std::future<void> composite(mc::Scene& scene)
+    {
+        return worker.run(
+            [this, &scene] { compositor->composite(scene.scene_elements_for(compositor.get())); },
+            id);
+    }
+
+private:
+    mir::thread::BasicThreadPool::TaskId const id;
+    mir::thread::BasicThreadPool worker{1};
+    std::unique_ptr<mc::DisplayBufferCompositor> compositor;
+};
+
 class CompositingFunctor
 {
 public:
     CompositingFunctor(
         std::shared_ptr<mc::DisplayBufferCompositorFactory> const& db_compositor_factory,
+        mg::Display const& display,
         mg::DisplaySyncGroup& group,
         std::shared_ptr<mc::Scene> const& scene,
         std::shared_ptr<DisplayListener> const& display_listener,
         std::chrono::milliseconds fixed_composite_delay,
         std::shared_ptr<CompositorReport> const& report) :
         compositor_factory{db_compositor_factory},
+        display(display),
         group(group),
         scene(scene),
         running{true},
@@ -75,19 +176,38 @@ public:
     {
         mir::set_thread_name("Mir/Comp");
 
-        std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
+        /*
+         * The first display buffer of the group is composited on this thread
+         * and any others on threads of their own, so that a frame of the group
+         * takes as long as its slowest output rather than the sum of them all.
+         */
+        std::unique_ptr<mc::DisplayBufferCompositor> local_compositor;
+        std::vector<std::unique_ptr<OutputCompositingThread>> output_threads;
+        std::vector<mc::DisplayBufferCompositor*> compositors;
+        std::vector<FrameTiming> frame_timings;
+        auto const conf = display.configuration();
         group.for_each_display_buffer(
-        [this, &compositors](mg::DisplayBuffer& buffer)
+        [this, &local_compositor, &output_threads, &compositors, &frame_timings, &conf](mg::DisplayBuffer& buffer)
         {
-            compositors.emplace_back(
-                std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer)));
+            frame_timings.push_back(frame_timing_for(*conf, buffer));
+
+            if (!local_compositor)
+            {
+                local_compositor = compositor_factory->create_compositor_for(buffer);
+                compositors.push_back(local_compositor.get());
+            }
+            else
+            {
+                output_threads.push_back(std::make_unique<OutputCompositingThread>(*compositor_factory, buffer));
+                compositors.push_back(output_threads.back()->display_buffer_compositor());
+            }
 
             auto const& r = buffer.view_area();
-            auto const comp_id = std::get<1>(compositors.back()).get();
             report->added_display(r.size.width.as_int(), r.size.height.as_int(),
                                   r.top_left.x.as_int(), r.top_left.y.as_int(),
-                                  CompositorReport::SubCompositorId{comp_id});
+                                  CompositorReport::SubCompositorId{compositors.back()});
         });
+        std::vector<std::future<void>> output_frames(output_threads.size());
 
         //Appease TSan, avoid destructor and this thread accessing the same shared_ptr instance
         auto const disp_listener = display_listener;
@@ -100,12 +220,12 @@ public:
         auto compositor_registration = mir::raii::paired_calls(
             [this,&compositors]
             {
-                for (auto& compositor : compositors)
-                    scene->register_compositor(std::get<1>(compositor).get());
+                for (auto compositor : compositors)
+                    scene->register_compositor(compositor);
             },
             [this,&compositors]{
-                for (auto& compositor : compositors)
-                    scene->unregister_compositor(std::get<1>(compositor).get());
+                for (auto compositor : compositors)
+                    scene->unregister_compositor(compositor);
             });
 
         started.set_value();
@@ -135,13 +255,20 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
-                    for (auto& tuple : compositors)
-                    {
-                        auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
-                    }
+                    for (size_t i = 0; i != output_threads.size(); ++i)
+                        output_frames[i] = output_threads[i]->composite(*scene);
+
+                    if (local_compositor)
+                        local_compositor->composite(scene->scene_elements_for(local_compositor.get()));
+
+                    for (auto& frame : output_frames)
+                        frame.get();
+
                     group.post();
 
+                    for (size_t i = 0; i != compositors.size(); ++i)
+                        scene->frame_presented(compositors[i], presented_frame(display, frame_timings[i]));
+
                     /*
                      * "Predictive bypass" optimization: If the last frame was
                      * bypassed/overlayed or you simply have a fast GPU, it is
@@ -162,10 +289,9 @@ public:
                      * to the initial scene_elements_for()...
                      */
                     int pending = 0;
-                    for (auto& compositor : compositors)
+                    for (auto compositor : compositors)
                     {
-                        auto const comp_id = std::get<1>(compositor).get();
-                        int pend = scene->frames_pending(comp_id);
+                        int pend = scene->frames_pending(compositor);
                         if (pend > pending)
                             pending = pend;
                     }
@@ -232,6 +358,7 @@ public:
 
 private:
     std::shared_ptr<mc::DisplayBufferCompositorFactory> const compositor_factory;
+    mg::Display const& display;
     mg::DisplaySyncGroup& group;
     std::shared_ptr<mc::Scene> const scene;
     bool running;
@@ -367,7 +494,7 @@ void mc::MultiThreadedCompositor::create_compositing_threads()
     display->for_each_display_sync_group([this](mg::DisplaySyncGroup& group)
     {
         auto thread_functor = std::make_unique<mc::CompositingFunctor>(
-            display_buffer_compositor_factory, group, scene, display_listener,
+            display_buffer_compositor_factory, *display, group, scene, display_listener,
             fixed_composite_delay, report);
 
         futures.push_back(thread_pool.run(std::ref(*thread_functor), &group));
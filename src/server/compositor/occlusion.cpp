@@ -17,12 +17,11 @@
  */
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
-#include <vector>
-
 using namespace mir::geometry;
 using namespace mir::graphics;
 using namespace mir::compositor;
@@ -30,60 +29,71 @@ using namespace mir::compositor;
 namespace
 {
 bool renderable_is_occluded(
-    Renderable const& renderable, 
+    Renderable const& renderable,
     Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+    Region& uncovered,
+    Region& visible)
 {
     static glm::mat4 const identity(1);
-    static Rectangle const empty{};
+
+    visible.clear();
 
     if (renderable.transformation() != identity)
         return false;  // Weirdly transformed. Assume never occluded.
 
-    auto const& window = renderable.screen_position();
-    auto const& clipped_window = window.intersection_with(area);
-
-    if (clipped_window == empty)
+    auto const clipped_window = renderable.screen_position().intersection_with(area);
+    if (clipped_window == Rectangle{})
         return true;  // Not in the area; definitely occluded.
 
-    bool occluded = false;
-    for (auto const& r : coverage)
-    {
-        if (r.contains(clipped_window))
-        {
-            occluded = true;
-            break;
-        }
-    }
+    Region const window{clipped_window};
+    visible = window;
+    visible.intersect(uncovered);
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
+    if (visible.empty())
+        return true;
 
-    return occluded;
+    uncovered.subtract(renderable.opaque_region());
+
+    if (visible == window)
+        visible.clear();  // Nothing to clip
+
+    return false;
 }
 }
 
 SceneElementSequence mir::compositor::filter_occlusions_from(
     SceneElementSequence& elements,
-    Rectangle const& area)
+    Rectangle const& area,
+    VisibleRegions& partly_visible)
 {
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    Region uncovered{area};
+    Region visible;
 
     auto it = elements.rbegin();
     while (it != elements.rend())
     {
         auto const renderable = (*it)->renderable();
-        if (renderable_is_occluded(*renderable, area, coverage))
+        if (renderable_is_occluded(*renderable, area, uncovered, visible))
         {
             occluded.insert(occluded.begin(), *it);
             it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
         }
         else
         {
+            if (!visible.empty())
+                partly_visible[renderable->id()] = visible;
             it++;
         }
     }
 
     return occluded;
 }
+
+SceneElementSequence mir::compositor::filter_occlusions_from(
+    SceneElementSequence& elements,
+    Rectangle const& area)
+{
+    VisibleRegions partly_visible;
+    return filter_occlusions_from(elements, area, partly_visible);
+}
@@ -20,12 +20,28 @@
 #define MIR_COMPOSITOR_OCCLUSION_H_
 
 #include "mir/compositor/scene.h"
+#include "mir/geometry/region.h"
+#include "mir/graphics/renderable.h"
+
+#include <unordered_map>
 
 namespace mir
 {
 namespace compositor
 {
 
+typedef std::unordered_map<graphics::Renderable::ID, geometry::Region> VisibleRegions;
+
+/**
+ * Removes the elements completely hidden (or outside area) from list and
+ * returns them. The visible parts of those left that are only partly
+ * visible are added to partly_visible.
+ */
+SceneElementSequence filter_occlusions_from(
+    SceneElementSequence& list,
+    geometry::Rectangle const& area,
+    VisibleRegions& partly_visible);
+
 SceneElementSequence filter_occlusions_from(SceneElementSequence& list, geometry::Rectangle const& area);
 
 } // namespace compositor
@@ -22,6 +22,7 @@
 #include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
 #include <boost/throw_exception.hpp>
+#include <algorithm>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
@@ -42,13 +43,33 @@ mc::Stream::Stream(
     size(size),
     pf(pf),
     first_frame_posted(false),
-    frame_callback{[](auto){}}
+    frame_callback{[](auto){}},
+    presented_callback{[](auto, auto, auto){}}
 {
 }
 
 mc::Stream::~Stream() = default;
 
+namespace
+{
+/// Enough to cover the buffers a client can get ahead of the slowest output
+size_t const max_damage_history = 8;
+
+geom::Rectangles whole(mg::Buffer const& buffer)
+{
+    return geom::Rectangles{{{0, 0}, buffer.size()}};
+}
+}
+
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    if (!buffer)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
+
+    submit_buffer(buffer, whole(*buffer));
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
@@ -56,9 +77,13 @@ void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
     {
         std::lock_guard<decltype(mutex)> lk(mutex); 
         first_frame_posted = true;
+        damage_history.push_back({++submitted, buffer->id(), buffer->size(), damage});
+        if (damage_history.size() > max_damage_history)
+            damage_history.pop_front();
         pf = buffer->pixel_format();
         size = buffer->size();
         schedule->schedule(buffer);
+        submitted_since_presented = true;
     }
     {
         std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
@@ -85,17 +110,65 @@ void mc::Stream::set_frame_posted_callback(
     frame_callback = callback;
 }
 
+void mc::Stream::set_frame_presented_callback(
+    std::function<void(PresentedFrame const&, bool, uint64_t)> const& callback)
+{
+    std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
+    presented_callback = callback;
+}
+
+void mc::Stream::frame_presented(PresentedFrame const& frame, bool on_screen)
+{
+    uint64_t shown;
+    {
+        std::lock_guard<decltype(mutex)> lk(mutex);
+        // Nobody is waiting to hear about a frame they haven't submitted, unless it
+        // shows a buffer they submitted before an earlier frame was composited
+        bool const newly_shown = on_screen && rendered != presented;
+        if (!submitted_since_presented && !newly_shown)
+            return;
+        submitted_since_presented = false;
+        if (on_screen)
+            presented = rendered;
+        shown = rendered;
+    }
+
+    std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
+    presented_callback(frame, on_screen, shown);
+}
+
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    auto const buffer = arbiter->compositor_acquire(id);
+
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    auto const submission = std::find_if(
+        damage_history.rbegin(), damage_history.rend(),
+        [id = buffer->id()](SubmittedDamage const& submitted) { return submitted.id == id; });
+    if (submission != damage_history.rend())
+        rendered = std::max(rendered, submission->submission);
+
+    return buffer;
 }
 
 geom::Size mc::Stream::stream_size()
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
+    if (viewport_destination.is_set())
+        return viewport_destination.value();
+    if (viewport_source.is_set())
+        return viewport_source.value().size;
     return size;
 }
 
+geom::Rectangle mc::Stream::src_bounds() const
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    if (viewport_source.is_set())
+        return viewport_source.value();
+    return {{0, 0}, size};
+}
+
 void mc::Stream::allow_framedropping(bool dropping)
 {
     std::lock_guard<decltype(mutex)> lk(mutex); 
@@ -161,3 +234,52 @@ bool mc::Stream::has_submitted_buffer() const
 void mc::Stream::set_scale(float)
 {
 }
+
+void mc::Stream::set_opaque_region(geom::Region const& region)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    opaque_region_ = region;
+}
+
+void mc::Stream::set_viewport(
+    mir::optional_value<geom::Rectangle> const& source,
+    mir::optional_value<geom::Size> const& destination)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    viewport_source = source;
+    viewport_destination = destination;
+}
+
+geom::Region mc::Stream::opaque_region() const
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    return opaque_region_;
+}
+
+geom::Rectangles mc::Stream::buffer_damage(mg::BufferID previous, mg::Buffer const& buffer) const
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+
+    auto const is_buffer = [id = buffer.id()](SubmittedDamage const& entry) { return entry.id == id; };
+    auto const is_previous = [previous](SubmittedDamage const& entry) { return entry.id == previous; };
+
+    auto const current = std::find_if(damage_history.rbegin(), damage_history.rend(), is_buffer);
+    if (current == damage_history.rend())
+        return whole(buffer);
+
+    auto const since = std::find_if(current, damage_history.rend(), is_previous);
+    if (since == damage_history.rend() || since == current || since->size != buffer.size())
+        return whole(buffer);
+
+    geom::Rectangles damage;
+    for (auto entry = current; entry != since; ++entry)
+    {
+        if (entry->size != buffer.size())
+            return whole(buffer);
+
+        for (auto const& rect : entry->damage)
+            damage.add(rect);
+    }
+
+    return damage;
+}
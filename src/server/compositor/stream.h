@@ -29,6 +29,7 @@
 #include <mutex>
 #include <memory>
 #include <set>
+#include <deque>
 
 namespace mir
 {
@@ -43,6 +44,9 @@ public:
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
@@ -54,8 +58,20 @@ public:
     bool framedropping() const override;
     int buffers_ready_for_compositor(void const* user_id) const override;
     void drop_old_buffers() override;
+    void frame_presented(PresentedFrame const& frame, bool on_screen) override;
+    void set_frame_presented_callback(
+        std::function<void(PresentedFrame const&, bool, uint64_t)> const& callback) override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    void set_opaque_region(geometry::Region const& region) override;
+    void set_viewport(
+        optional_value<geometry::Rectangle> const& source,
+        optional_value<geometry::Size> const& destination) override;
+    geometry::Rectangle src_bounds() const override;
+    geometry::Region opaque_region() const override;
+    geometry::Rectangles buffer_damage(
+        graphics::BufferID previous,
+        graphics::Buffer const& buffer) const override;
 
 private:
     enum class ScheduleMode;
@@ -69,8 +85,26 @@ private:
     MirPixelFormat pf;
     bool first_frame_posted;
 
+    struct SubmittedDamage
+    {
+        uint64_t submission;
+        graphics::BufferID id;
+        geometry::Size size;
+        geometry::Rectangles damage;
+    };
+    std::deque<SubmittedDamage> damage_history; // Oldest first
+    geometry::Region opaque_region_;
+    optional_value<geometry::Rectangle> viewport_source;
+    optional_value<geometry::Size> viewport_destination;
+
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
+    std::function<void(PresentedFrame const&, bool, uint64_t)> presented_callback;
+    // Guarded by mutex
+    bool submitted_since_presented{false};
+    uint64_t submitted{0};  ///< The number of the latest submission
+    uint64_t rendered{0};   ///< The number of the latest submission the compositor has acquired
+    uint64_t presented{0};  ///< The value of rendered when a frame was last presented on screen
 };
 }
 }
@@ -27,6 +27,8 @@
 
 #include "mir_protobuf_wire.pb.h"
 
+#include <unordered_map>
+
 namespace mfd = mir::frontend::detail;
 
 namespace
@@ -187,175 +189,162 @@ void mfd::ProtobufMessageProcessor::client_pid(int pid)
     display_server->client_pid(pid);
 }
 
-bool mfd::ProtobufMessageProcessor::dispatch(
-    Invocation const& invocation,
-    std::vector<mir::Fd> const& side_channel_fds)
+namespace
 {
-    report->received_invocation(display_server.get(), invocation.id(), invocation.method_name());
+struct Call
+{
+    mfd::ProtobufMessageProcessor* const processor;
+    mfd::DisplayServer* const display_server;
+    mir::frontend::MessageProcessorReport* const report;
+    mfd::Invocation const& invocation;
+    std::vector<mir::Fd> const& side_channel_fds;
+};
 
-    bool result = true;
+struct Method
+{
+    std::string const name;
+    void (*const handler)(Call const& call);
+    bool const ends_connection;
+};
+
+using mfd::DisplayServer;
+using mir::protobuf::DisplayServerDebug;
 
+void translate_surface_to_screen(Call const& call)
+{
     try
     {
-        // TODO comparing strings in an if-else chain isn't efficient.
-        // It is probably possible to generate a Trie at compile time.
-        if ("connect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::connect, invocation);
-        }
-        else if ("create_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_surface, invocation);
-        }
-        else if ("submit_buffer" == invocation.method_name())
+        auto debug_interface = dynamic_cast<DisplayServerDebug*>(call.display_server);
+        mfd::invoke(call.processor, debug_interface, &DisplayServerDebug::translate_surface_to_screen, call.invocation);
+    }
+    catch (std::runtime_error const&)
+    {
+        std::string message{"Server does not support the client debugging interface"};
+        mfd::invoke(call.processor,
+               &message,
+               &DisplayServerDebug::translate_surface_to_screen,
+               call.invocation);
+        std::runtime_error err{"Client attempted to use unavailable debug interface"};
+        call.report->exception_handled(call.display_server, call.invocation.id(), err);
+    }
+}
+
+// Indexed by the opcode method_for() resolves a method name to
+std::vector<Method> const methods{
+    {"connect", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::connect, call.invocation); }, false},
+    {"create_surface", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::create_surface, call.invocation); }, false},
+    {"submit_buffer", [](Call const& call)
         {
-            auto request = parse_parameter<mir::protobuf::BufferRequest>(invocation);
+            auto request = mfd::parse_parameter<mir::protobuf::BufferRequest>(call.invocation);
             request.mutable_buffer()->clear_fd();
-            for (auto& fd : side_channel_fds)
+            for (auto& fd : call.side_channel_fds)
                 request.mutable_buffer()->add_fd(fd);
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::submit_buffer, invocation.id(), &request);
-        }
-        else if ("allocate_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::allocate_buffers, invocation);
-        }
-        else if ("release_buffers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffers, invocation);
-        }
-        else if ("release_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_surface, invocation);
-        }
-        else if ("platform_operation" == invocation.method_name())
-        {
-            auto request = parse_parameter<mir::protobuf::PlatformOperationMessage>(invocation);
+            mfd::invoke(call.processor->shared_from_this(), call.display_server, &DisplayServer::submit_buffer,
+                   call.invocation.id(), &request);
+        }, false},
+    {"allocate_buffers", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::allocate_buffers, call.invocation); }, false},
+    {"release_buffers", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::release_buffers, call.invocation); }, false},
+    {"release_surface", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::release_surface, call.invocation); }, false},
+    {"platform_operation", [](Call const& call)
+        {
+            auto request = mfd::parse_parameter<mir::protobuf::PlatformOperationMessage>(call.invocation);
 
             request.clear_fd();
-            for (auto& fd : side_channel_fds)
+            for (auto& fd : call.side_channel_fds)
                 request.add_fd(fd);
 
-            invoke(shared_from_this(), display_server.get(), &DisplayServer::platform_operation,
-                   invocation.id(), &request);
-        }
-        else if ("configure_display" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_display, invocation);
-        }
-        else if ("remove_session_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::remove_session_configuration, invocation);
-        }
-        else if ("set_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::set_base_display_configuration, invocation);
-        }
-        else if ("configure_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_surface, invocation);
-        }
-        else if ("modify_surface" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::modify_surface, invocation);
-        }
-        else if ("create_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_screencast, invocation);
-        }
-        else if ("screencast_buffer" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::screencast_buffer, invocation);
-        }
-        else if ("screencast_to_buffer" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::screencast_to_buffer, invocation);
-        }
-        else if ("release_screencast" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_screencast, invocation);
-        }
-        else if ("create_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::create_buffer_stream, invocation);
-        }
-        else if ("release_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::release_buffer_stream, invocation);
-        }
-        else if ("configure_cursor" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::configure_cursor, invocation);
-        }
-        else if ("new_fds_for_prompt_providers" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::new_fds_for_prompt_providers, invocation);
-        }
-        else if ("start_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::start_prompt_session, invocation);
-        }
-        else if ("stop_prompt_session" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::stop_prompt_session, invocation);
-        }
-        else if ("request_operation" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::request_operation, invocation);
-        }
-        else if ("disconnect" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::disconnect, invocation);
-            result = false;
-        }
-        else if ("pong" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::pong, invocation);
-        }
-        else if ("configure_buffer_stream" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &DisplayServer::configure_buffer_stream, invocation);
-        }
-        else if ("translate_surface_to_screen" == invocation.method_name())
-        {
-            try
-            {
-                auto debug_interface = dynamic_cast<mir::protobuf::DisplayServerDebug*>(display_server.get());
-                invoke(this, debug_interface, &mir::protobuf::DisplayServerDebug::translate_surface_to_screen, invocation);
-            }
-            catch (std::runtime_error const&)
-            {
-                std::string message{"Server does not support the client debugging interface"};
-                invoke(this,
-                       &message,
-                       &mir::protobuf::DisplayServerDebug::translate_surface_to_screen,
-                       invocation);
-                std::runtime_error err{"Client attempted to use unavailable debug interface"};
-                report->exception_handled(display_server.get(), invocation.id(), err);
-            }
-        }
-        else if ("request_persistent_surface_id" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::request_persistent_surface_id, invocation);
-        }
-        else if ("preview_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::preview_base_display_configuration, invocation);
-        }
-        else if ("confirm_base_display_configuration" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::confirm_base_display_configuration, invocation);
-        }
-        else if ("cancel_base_display_configuration_preview" == invocation.method_name())
-        {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::cancel_base_display_configuration_preview, invocation);
-        }
-        else if ("apply_input_configuration" == invocation.method_name())
+            mfd::invoke(call.processor->shared_from_this(), call.display_server, &DisplayServer::platform_operation,
+                   call.invocation.id(), &request);
+        }, false},
+    {"configure_display", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::configure_display, call.invocation); }, false},
+    {"remove_session_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::remove_session_configuration, call.invocation); }, false},
+    {"set_base_display_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::set_base_display_configuration, call.invocation); }, false},
+    {"configure_surface", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::configure_surface, call.invocation); }, false},
+    {"modify_surface", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::modify_surface, call.invocation); }, false},
+    {"create_screencast", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::create_screencast, call.invocation); }, false},
+    {"screencast_buffer", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::screencast_buffer, call.invocation); }, false},
+    {"screencast_to_buffer", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::screencast_to_buffer, call.invocation); }, false},
+    {"release_screencast", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::release_screencast, call.invocation); }, false},
+    {"create_buffer_stream", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::create_buffer_stream, call.invocation); }, false},
+    {"release_buffer_stream", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::release_buffer_stream, call.invocation); }, false},
+    {"configure_cursor", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::configure_cursor, call.invocation); }, false},
+    {"new_fds_for_prompt_providers", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::new_fds_for_prompt_providers, call.invocation); }, false},
+    {"start_prompt_session", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::start_prompt_session, call.invocation); }, false},
+    {"stop_prompt_session", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::stop_prompt_session, call.invocation); }, false},
+    {"request_operation", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::request_operation, call.invocation); }, false},
+    {"disconnect", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::disconnect, call.invocation); }, true},
+    {"pong", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::pong, call.invocation); }, false},
+    {"configure_buffer_stream", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &DisplayServer::configure_buffer_stream, call.invocation); }, false},
+    {"translate_surface_to_screen", &translate_surface_to_screen, false},
+    {"request_persistent_surface_id", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::request_persistent_surface_id, call.invocation); }, false},
+    {"preview_base_display_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::preview_base_display_configuration, call.invocation); }, false},
+    {"confirm_base_display_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::confirm_base_display_configuration, call.invocation); }, false},
+    {"cancel_base_display_configuration_preview", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::cancel_base_display_configuration_preview, call.invocation); }, false},
+    {"apply_input_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::apply_input_configuration, call.invocation); }, false},
+    {"set_base_input_configuration", [](Call const& call)
+        { mfd::invoke(call.processor, call.display_server, &mir::protobuf::DisplayServer::set_base_input_configuration, call.invocation); }, false},
+};
+
+Method const* method_for(std::string const& name)
+{
+    static auto const opcodes = []
         {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::apply_input_configuration, invocation);
-        }
-        else if ("set_base_input_configuration" == invocation.method_name())
+            std::unordered_map<std::string, size_t> opcodes;
+            for (size_t opcode = 0; opcode != methods.size(); ++opcode)
+                opcodes[methods[opcode].name] = opcode;
+            return opcodes;
+        }();
+
+    auto const opcode = opcodes.find(name);
+    return opcode != opcodes.end() ? &methods[opcode->second] : nullptr;
+}
+}
+
+bool mfd::ProtobufMessageProcessor::dispatch(
+    Invocation const& invocation,
+    std::vector<mir::Fd> const& side_channel_fds)
+{
+    report->received_invocation(display_server.get(), invocation.id(), invocation.method_name());
+
+    bool result = true;
+
+    auto const method = method_for(invocation.method_name());
+
+    try
+    {
+        if (method)
         {
-            invoke(this, display_server.get(), &protobuf::DisplayServer::set_base_input_configuration, invocation);
+            method->handler({this, display_server.get(), report.get(), invocation, side_channel_fds});
+            result = !method->ends_connection;
         }
         else
         {
@@ -979,13 +979,23 @@ void mf::SessionMediator::screencast_buffer(
 
 void mf::SessionMediator::screencast_to_buffer(
     mir::protobuf::ScreencastRequest const* request,
-    mir::protobuf::Void*,
+    mir::protobuf::ScreencastCapture* response,
     google::protobuf::Closure* done)
 {
     auto session = weak_session.lock();
     ScreencastSessionId const screencast_session_id{request->id().value()};
     auto buffer = buffer_cache.at(mg::BufferID{request->buffer_id()});
-    screencast->capture(screencast_session_id, buffer);
+    auto const damage = screencast->capture(screencast_session_id, buffer);
+
+    response->set_damage_reported(true);
+    for (auto const& rect : damage)
+    {
+        auto const protobuf_rect = response->add_damage();
+        protobuf_rect->set_left(rect.top_left.x.as_int());
+        protobuf_rect->set_top(rect.top_left.y.as_int());
+        protobuf_rect->set_width(rect.size.width.as_uint32_t());
+        protobuf_rect->set_height(rect.size.height.as_uint32_t());
+    }
     done->Run();
 }
 
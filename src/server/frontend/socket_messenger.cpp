@@ -17,11 +17,12 @@
  */
 
 #include "socket_messenger.h"
-#include "mir/frontend/client_constants.h"
 #include "mir/variable_length_array.h"
 #include "mir/fd_socket_transmission.h"
 #include "mir/raii.h"
 
+#include <sys/socket.h>
+
 #include <boost/throw_exception.hpp>
 
 #include <errno.h>
@@ -34,15 +35,23 @@ namespace mfd = mf::detail;
 namespace bs = boost::system;
 namespace ba = boost::asio;
 
-mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
+namespace
+{
+// Beyond this many fds waiting to be sent the client is treated as unresponsive
+size_t const max_pending_fds{1024};
+}
+
+mfd::SocketMessenger::SocketMessenger(
+    std::shared_ptr<ba::local::stream_protocol::socket> const& socket,
+    size_t max_backlog)
     : socket(socket),
-      socket_fd{IntOwnedFd{socket->native_handle()}}
+      socket_fd{IntOwnedFd{socket->native_handle()}},
+      max_backlog{max_backlog}
 {
     // Make the socket non-blocking to avoid hanging the server when a client
-    // is unresponsive. Also increase the send buffer size to 64KiB to allow
-    // more leeway for transient client freezes.
+    // is unresponsive. Also increase the send buffer size to 64KiB so that
+    // messages usually go straight out rather than being queued.
     // See https://bugs.launchpad.net/mir/+bug/1350207
-    // TODO: Rework the messenger to support asynchronous sends
     socket->non_blocking(true);
     boost::asio::socket_base::send_buffer_size option(64*1024);
     socket->set_option(option);
@@ -74,23 +83,216 @@ mf::SessionCredentials mfd::SocketMessenger::client_creds()
 void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_set)
 {
     static size_t const header_size{2};
-    mir::VariableLengthArray<mf::serialization_buffer_size> whole_message{header_size + length};
+    static char const fd_marker{'M'};
 
-    whole_message.data()[0] = static_cast<unsigned char>((length >> 8) & 0xff);
-    whole_message.data()[1] = static_cast<unsigned char>((length >> 0) & 0xff);
-    std::copy(data, data + length, whole_message.data() + header_size);
+    size_t fd_count{0};
+    for (auto const& fds : fd_set)
+        fd_count += fds.size();
 
-    std::unique_lock<std::mutex> lg(message_lock);
+    std::lock_guard<std::mutex> lg(message_lock);
+
+    if (dropped)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Client has been disconnected"));
+
+    auto const backlog = outgoing.size() - sent;
+    if (backlog + header_size + length + fd_set.size() > max_backlog ||
+        pending_fds + fd_count > max_pending_fds)
+    {
+        drop_client();
+        BOOST_THROW_EXCEPTION(std::runtime_error("Client is not reading its messages, disconnecting it"));
+    }
 
-    // TODO: This should be asynchronous, but we are not making sure
-    // that a potential call to send_fds is executed _after_ this
-    // function has completed (if it would be executed asynchronously.
-    // NOTE: we rely on this synchronous behavior as per the comment in
-    // mf::SessionMediator::create_surface
-    ba::write(*socket, ba::buffer(whole_message.data(), whole_message.size()));
+    outgoing.push_back(static_cast<char>((length >> 8) & 0xff));
+    outgoing.push_back(static_cast<char>((length >> 0) & 0xff));
+    outgoing.insert(outgoing.end(), data, data + length);
 
     for (auto const& fds : fd_set)
-        mir::send_fds(socket_fd, fds);
+    {
+        if (fds.empty())
+            continue;
+
+        fd_markers.push_back({outgoing.size(), fds});
+        outgoing.push_back(fd_marker);
+        pending_fds += fds.size();
+    }
+
+    // If we're already waiting for the client this message goes out with the
+    // rest of the backlog. Otherwise, as everything is sent in order, we keep
+    // the ordering mf::SessionMediator::create_surface relies on.
+    if (waiting_for_writable)
+        return;
+
+    try
+    {
+        if (!flush())
+            wait_for_writable();
+    }
+    catch (...)
+    {
+        drop_client();
+        throw;
+    }
+}
+
+bool mfd::SocketMessenger::flush()
+{
+    while (sent < outgoing.size())
+    {
+        // The client reads each fd marker on its own, and the fds go to
+        // whichever read takes the first byte of the sendmsg() that carried
+        // them. So a chunk with fds starts at their marker, and everything
+        // up to the next marker can go with it.
+        std::vector<Fd> const* fds{nullptr};
+        auto end = outgoing.size();
+
+        if (!fd_markers.empty())
+        {
+            if (fd_markers.front().position == sent)
+            {
+                fds = &fd_markers.front().fds;
+                if (fd_markers.size() > 1)
+                    end = fd_markers[1].position;
+            }
+            else
+            {
+                end = fd_markers.front().position;
+            }
+        }
+
+        auto const written = send_some(outgoing.data() + sent, end - sent, fds);
+        if (written == 0)
+            break;
+
+        if (fds)
+        {
+            pending_fds -= fds->size();
+            fd_markers.pop_front();
+        }
+
+        sent += written;
+    }
+
+    if (sent == outgoing.size())
+    {
+        outgoing.clear();
+        sent = 0;
+        return true;
+    }
+
+    outgoing.erase(outgoing.begin(), outgoing.begin() + sent);
+    for (auto& marker : fd_markers)
+        marker.position -= sent;
+    sent = 0;
+
+    return false;
+}
+
+size_t mfd::SocketMessenger::send_some(char const* data, size_t length, std::vector<Fd> const* fds)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<char*>(data);
+    iov.iov_len = length;
+
+    struct msghdr header;
+    header.msg_name = nullptr;
+    header.msg_namelen = 0;
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = nullptr;
+    header.msg_controllen = 0;
+    header.msg_flags = 0;
+
+    static auto const builtin_n_fds = 5;
+    static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
+    auto const fds_bytes = fds ? fds->size() * sizeof(int) : 0;
+    mir::VariableLengthArray<builtin_cmsg_space> control{fds ? CMSG_SPACE(fds_bytes) : 0};
+
+    if (fds)
+    {
+        // Silence valgrind uninitialized memory complaint
+        memset(control.data(), 0, control.size());
+        header.msg_control = control.data();
+        header.msg_controllen = control.size();
+
+        struct cmsghdr* const message = CMSG_FIRSTHDR(&header);
+        message->cmsg_len = CMSG_LEN(fds_bytes);
+        message->cmsg_level = SOL_SOCKET;
+        message->cmsg_type = SCM_RIGHTS;
+
+        int* const fd_data = reinterpret_cast<int*>(CMSG_DATA(message));
+        int i = 0;
+        for (auto const& fd : *fds)
+            fd_data[i++] = fd;
+    }
+
+    while (true)
+    {
+        auto const result = sendmsg(socket_fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (result >= 0)
+            return result;
+
+        if (socket_error_is_transient(errno))
+            continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+
+        BOOST_THROW_EXCEPTION(socket_error("Failed to send message to client"));
+    }
+}
+
+void mfd::SocketMessenger::wait_for_writable()
+{
+    waiting_for_writable = true;
+
+    std::weak_ptr<SocketMessenger> const weak_this{shared_from_this()};
+    socket->async_write_some(
+        ba::null_buffers(),
+        [weak_this](bs::error_code const& error, size_t)
+        {
+            if (auto const self = weak_this.lock())
+                self->on_writable(error);
+        });
+}
+
+void mfd::SocketMessenger::on_writable(bs::error_code const& error)
+{
+    std::lock_guard<std::mutex> lg(message_lock);
+
+    waiting_for_writable = false;
+
+    if (dropped)
+        return;
+
+    if (error)
+    {
+        drop_client();
+        return;
+    }
+
+    try
+    {
+        if (!flush())
+            wait_for_writable();
+    }
+    catch (std::exception const&)
+    {
+        drop_client();
+    }
+}
+
+void mfd::SocketMessenger::drop_client()
+{
+    dropped = true;
+    outgoing.clear();
+    sent = 0;
+    fd_markers.clear();
+    pending_fds = 0;
+
+    // Let the read side see the client go, so the connection is torn down
+    bs::error_code ignored;
+    socket->shutdown(ba::local::stream_protocol::socket::shutdown_both, ignored);
 }
 
 void mfd::SocketMessenger::async_receive_msg(
@@ -21,7 +21,11 @@
 #include "message_sender.h"
 #include "message_receiver.h"
 #include "mir/frontend/session_credentials.h"
+
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace mir
 {
@@ -29,11 +33,23 @@ namespace frontend
 {
 namespace detail
 {
+/**
+ * Sends and receives messages on a client socket.
+ *
+ * Sends never block: what the socket won't take immediately is queued and
+ * written, coalesced with anything sent meanwhile, once the socket becomes
+ * writable. A client that lets more than max_backlog bytes pile up is
+ * disconnected. Messages (and their fds) reach the client in the order
+ * they were sent.
+ */
 class SocketMessenger : public MessageSender,
-                        public MessageReceiver
+                        public MessageReceiver,
+                        public std::enable_shared_from_this<SocketMessenger>
 {
 public:
-    SocketMessenger(std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket);
+    SocketMessenger(
+        std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket,
+        size_t max_backlog = default_max_backlog);
 
     void send(char const* data, size_t length, FdSets const& fds) override;
 
@@ -43,15 +59,38 @@ public:
     SessionCredentials client_creds() override;
     void receive_fds(std::vector<Fd>& fds) override;
 
+    static size_t const default_max_backlog = 1024*1024;
+
 private:
     void set_passcred(int opt);
     void update_session_creds();
     SessionCredentials creator_creds() const;
 
+    // These require message_lock to be held
+    bool flush();
+    size_t send_some(char const* data, size_t length, std::vector<Fd> const* fds);
+    void wait_for_writable();
+    void on_writable(boost::system::error_code const& error);
+    void drop_client();
+
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
+    size_t const max_backlog;
+
+    // The fds of each set go with a dummy byte at the given position
+    struct FdMarker
+    {
+        size_t position;
+        std::vector<Fd> fds;
+    };
 
     std::mutex message_lock;
+    std::vector<char> outgoing;
+    size_t sent{0};
+    std::deque<FdMarker> fd_markers;
+    size_t pending_fds{0};
+    bool waiting_for_writable{false};
+    bool dropped{false};
     SessionCredentials session_creds{0, 0, 0};
 };
 }
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_cache.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/input/keymap.h"
+
+#include <xkbcommon/xkbcommon.h>
+#include <boost/throw_exception.hpp>
+
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+namespace
+{
+/// A file holding text (and its terminator) that nobody, including us, can modify
+auto sealed_file_with(std::string const& text) -> mir::Fd
+{
+    auto const size = text.size() + 1;
+
+    mir::Fd fd{static_cast<int>(syscall(SYS_memfd_create, "mir-keymap", MFD_CLOEXEC | MFD_ALLOW_SEALING))};
+    if (fd == mir::Fd::invalid)
+    {
+        // Kernels without memfd (or sealing) get an unsealed copy instead
+        mir::AnonymousShmFile file{size};
+        memcpy(file.base_ptr(), text.c_str(), size);
+        return mir::Fd{dup(file.fd())};
+    }
+
+    for (size_t written = 0; written != size;)
+    {
+        auto const result = write(fd, text.c_str() + written, size - written);
+        if (result == -1)
+        {
+            if (errno == EINTR)
+                continue;
+
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to write keymap"}));
+        }
+        written += result;
+    }
+
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == -1)
+    {
+        BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to seal keymap"}));
+    }
+
+    return fd;
+}
+
+auto serialise(xkb_keymap* keymap) -> std::string
+{
+    std::unique_ptr<char, void(*)(void*)> const buffer{
+        xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1),
+        free};
+
+    return buffer.get();
+}
+}
+
+mf::CompiledKeymap::CompiledKeymap(std::shared_ptr<xkb_keymap> const& keymap, std::string const& text)
+    : keymap_{keymap},
+      size_{text.size() + 1},
+      fd_{sealed_file_with(text)}
+{
+}
+
+auto mf::CompiledKeymap::keymap() const -> xkb_keymap*
+{
+    return keymap_.get();
+}
+
+auto mf::CompiledKeymap::fd() const -> Fd
+{
+    return fd_;
+}
+
+auto mf::CompiledKeymap::size() const -> size_t
+{
+    return size_;
+}
+
+mf::KeymapCache::KeymapCache()
+    : context{xkb_context_new(XKB_CONTEXT_NO_FLAGS), &xkb_context_unref}
+{
+}
+
+mf::KeymapCache::~KeymapCache() = default;
+
+auto mf::KeymapCache::keymap_for(mi::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const key = std::make_tuple(names.model, names.layout, names.variant, names.options);
+    auto const cached = by_names.find(key);
+    if (cached != by_names.end())
+        return cached->second;
+
+    xkb_rule_names const rule_names = {
+        "evdev",
+        names.model.c_str(),
+        names.layout.c_str(),
+        names.variant.c_str(),
+        names.options.c_str()
+    };
+
+    std::shared_ptr<xkb_keymap> const keymap{
+        xkb_keymap_new_from_names(context.get(), &rule_names, XKB_KEYMAP_COMPILE_NO_FLAGS),
+        &xkb_keymap_unref};
+
+    if (!keymap)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to compile keymap"}));
+    }
+
+    auto const text = serialise(keymap.get());
+
+    // A device may later send us this same keymap as text
+    auto& compiled = by_text[text];
+    if (!compiled)
+        compiled = std::make_shared<CompiledKeymap const>(keymap, text);
+
+    by_names[key] = compiled;
+    return compiled;
+}
+
+auto mf::KeymapCache::keymap_for(char const* buffer, size_t length) -> std::shared_ptr<CompiledKeymap const>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // The buffer may or may not include the terminator
+    std::string const text{buffer, strnlen(buffer, length)};
+    auto const cached = by_text.find(text);
+    if (cached != by_text.end())
+        return cached->second;
+
+    std::shared_ptr<xkb_keymap> const keymap{
+        xkb_keymap_new_from_buffer(
+            context.get(),
+            text.c_str(),
+            text.size(),
+            XKB_KEYMAP_FORMAT_TEXT_V1,
+            XKB_KEYMAP_COMPILE_NO_FLAGS),
+        &xkb_keymap_unref};
+
+    if (!keymap)
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Failed to compile keymap"}));
+    }
+
+    auto const compiled = std::make_shared<CompiledKeymap const>(keymap, text);
+    by_text[text] = compiled;
+    return compiled;
+}
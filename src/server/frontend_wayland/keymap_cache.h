@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_KEYMAP_CACHE_H
+#define MIR_FRONTEND_KEYMAP_CACHE_H
+
+#include "mir/fd.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+// from <xkbcommon/xkbcommon.h>
+struct xkb_keymap;
+struct xkb_context;
+
+namespace mir
+{
+namespace input
+{
+struct Keymap;
+}
+
+namespace frontend
+{
+
+/// A compiled keymap, and a sealed (read-only) file holding it for clients to map
+class CompiledKeymap
+{
+public:
+    CompiledKeymap(std::shared_ptr<xkb_keymap> const& keymap, std::string const& text);
+
+    auto keymap() const -> xkb_keymap*;
+
+    /// The file to send in wl_keyboard.keymap; it is shared by every client
+    auto fd() const -> Fd;
+
+    /// The size of the keymap text, including its terminator (as other compositors send)
+    auto size() const -> size_t;
+
+private:
+    std::shared_ptr<xkb_keymap> const keymap_;
+    size_t const size_;
+    Fd const fd_;
+};
+
+/**
+ * Compiling a keymap takes tens of milliseconds, so rather than doing so for every
+ * wl_keyboard we compile each distinct keymap once and share it.
+ */
+class KeymapCache
+{
+public:
+    KeymapCache();
+    ~KeymapCache();
+
+    /// The keymap for these RMLVO names, compiled on first use
+    auto keymap_for(input::Keymap const& names) -> std::shared_ptr<CompiledKeymap const>;
+
+    /// The keymap serialised (as xkb_v1 text) in a per-device keymap event, compiled on first use
+    auto keymap_for(char const* buffer, size_t length) -> std::shared_ptr<CompiledKeymap const>;
+
+private:
+    KeymapCache(KeymapCache const&) = delete;
+    KeymapCache& operator=(KeymapCache const&) = delete;
+
+    std::mutex mutex;
+    std::unique_ptr<xkb_context, void (*)(xkb_context*)> const context;
+
+    std::map<std::tuple<std::string, std::string, std::string, std::string>,
+        std::shared_ptr<CompiledKeymap const>> by_names;
+    std::unordered_map<std::string, std::shared_ptr<CompiledKeymap const>> by_text;
+};
+}
+}
+
+#endif // MIR_FRONTEND_KEYMAP_CACHE_H
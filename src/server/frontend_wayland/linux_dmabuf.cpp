@@ -0,0 +1,591 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linux_dmabuf.h"
+
+#include "shm_buffer.h"
+
+#include "mir/log.h"
+#include "mir/shm_file.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <system_error>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace geom = mir::geometry;
+
+namespace
+{
+// The frontend doesn't depend on libdrm, so spell out the few DRM codes we need
+constexpr uint32_t fourcc_code(char a, char b, char c, char d)
+{
+    return uint32_t(a) | (uint32_t(b) << 8) | (uint32_t(c) << 16) | (uint32_t(d) << 24);
+}
+
+uint32_t const drm_format_argb8888 = fourcc_code('A', 'R', '2', '4');
+uint32_t const drm_format_xrgb8888 = fourcc_code('X', 'R', '2', '4');
+uint32_t const drm_format_abgr8888 = fourcc_code('A', 'B', '2', '4');
+uint32_t const drm_format_xbgr8888 = fourcc_code('X', 'B', '2', '4');
+
+uint64_t const drm_format_mod_linear = 0;
+uint64_t const drm_format_mod_invalid = (1ULL << 56) - 1;
+
+/// Only the (single plane) formats in this table can be read from the CPU
+MirPixelFormat cpu_format_for(uint32_t fourcc)
+{
+    if (fourcc == drm_format_argb8888)
+        return mir_pixel_format_argb_8888;
+    else if (fourcc == drm_format_xrgb8888)
+        return mir_pixel_format_xrgb_8888;
+    else if (fourcc == drm_format_abgr8888)
+        return mir_pixel_format_abgr_8888;
+    else if (fourcc == drm_format_xbgr8888)
+        return mir_pixel_format_xbgr_8888;
+    else
+        return mir_pixel_format_invalid;
+}
+
+bool contains(std::vector<mg::DmaBufFormat> const& formats, uint32_t fourcc, uint64_t modifier)
+{
+    return std::any_of(begin(formats), end(formats), [&](mg::DmaBufFormat const& format)
+        {
+            return format.fourcc == fourcc && format.modifier == modifier;
+        });
+}
+
+bool contains(std::vector<mg::DmaBufFormat> const& formats, uint32_t fourcc)
+{
+    return std::any_of(begin(formats), end(formats), [&](mg::DmaBufFormat const& format)
+        {
+            return format.fourcc == fourcc;
+        });
+}
+
+auto advertised_formats(std::vector<mg::DmaBufFormat> const& platform_formats) -> std::vector<mg::DmaBufFormat>
+{
+    auto formats = platform_formats;
+
+    for (auto const& format : mf::LinuxDmabuf::cpu_readable_formats())
+    {
+        if (!contains(formats, format.fourcc, format.modifier))
+            formats.push_back(format);
+    }
+
+    return formats;
+}
+
+/// Presents a mapped dma-buf plane as a ShmFile, holding the CPU access open for the ShmFile's lifetime
+class DmaBufFile : public mir::ShmFile
+{
+public:
+    DmaBufFile(std::shared_ptr<mf::DmaBufBuffer::Mapping> const& mapping, uint32_t offset);
+    ~DmaBufFile();
+
+    void* base_ptr() const override;
+    int fd() const override;
+
+private:
+    std::shared_ptr<mf::DmaBufBuffer::Mapping> const mapping;
+    uint32_t const offset;
+};
+
+/// A client's dma-buf read with the CPU, for when the graphics platform can't import it
+class DmaBufShmBuffer : public mgc::ShmBuffer
+{
+public:
+    DmaBufShmBuffer(
+        std::unique_ptr<mir::ShmFile> shm_file,
+        geom::Size const& size,
+        MirPixelFormat const& pixel_format,
+        std::function<void()>&& on_consumed,
+        std::function<void()>&& on_release)
+        : ShmBuffer(std::move(shm_file), size, pixel_format),
+          on_consumed{std::move(on_consumed)},
+          on_release{std::move(on_release)}
+    {
+    }
+
+    ~DmaBufShmBuffer()
+    {
+        on_release();
+    }
+
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
+    {
+        return nullptr;
+    }
+
+    void gl_bind_to_texture() override
+    {
+        consume();
+        ShmBuffer::gl_bind_to_texture();
+    }
+
+    void update_texture(geom::Rectangles const& damage) override
+    {
+        consume();
+        ShmBuffer::update_texture(damage);
+    }
+
+    void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
+    {
+        consume();
+        ShmBuffer::read(do_with_pixels);
+    }
+
+private:
+    void consume()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        on_consumed();
+        on_consumed = [](){};
+    }
+
+    std::mutex mutex;
+    std::function<void()> on_consumed;
+    std::function<void()> const on_release;
+};
+}
+
+class mf::DmaBufBuffer::Mapping
+{
+public:
+    Mapping(mir::Fd const& fd, size_t size)
+        : fd{fd},
+          size{size},
+          data{mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)}
+    {
+        if (data == MAP_FAILED)
+        {
+            BOOST_THROW_EXCEPTION((std::system_error{errno, std::system_category(), "Failed to map dma-buf"}));
+        }
+    }
+
+    ~Mapping()
+    {
+        munmap(data, size);
+    }
+
+    /// Lets the exporter keep caches coherent while we read (for exporters that need to)
+    ///@{
+    void begin_access() const
+    {
+        sync(DMA_BUF_SYNC_START | DMA_BUF_SYNC_READ);
+    }
+
+    void end_access() const
+    {
+        sync(DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ);
+    }
+    ///@}
+
+    mir::Fd const fd;
+    size_t const size;
+    void* const data;
+
+private:
+    void sync(uint64_t flags) const
+    {
+        dma_buf_sync sync{flags};
+        while (ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync) == -1 && (errno == EINTR || errno == EAGAIN))
+        {
+        }
+    }
+};
+
+DmaBufFile::DmaBufFile(std::shared_ptr<mf::DmaBufBuffer::Mapping> const& mapping, uint32_t offset)
+    : mapping{mapping},
+      offset{offset}
+{
+    mapping->begin_access();
+}
+
+DmaBufFile::~DmaBufFile()
+{
+    mapping->end_access();
+}
+
+void* DmaBufFile::base_ptr() const
+{
+    return static_cast<char*>(mapping->data) + offset;
+}
+
+int DmaBufFile::fd() const
+{
+    return mapping->fd;
+}
+
+namespace mir
+{
+namespace frontend
+{
+class LinuxBufferParams : public wayland::LinuxBufferParamsV1
+{
+public:
+    LinuxBufferParams(
+        struct wl_client* client,
+        struct wl_resource* parent,
+        uint32_t id,
+        std::shared_ptr<graphics::WaylandAllocator> const& allocator,
+        std::vector<graphics::DmaBufFormat> const& platform_formats);
+
+private:
+    void destroy() override;
+    void add(mir::Fd fd, uint32_t plane_idx, uint32_t offset, uint32_t stride, uint32_t modifier_hi,
+             uint32_t modifier_lo) override;
+    void create(int32_t width, int32_t height, uint32_t format, uint32_t flags) override;
+    void create_immed(uint32_t buffer_id, int32_t width, int32_t height, uint32_t format, uint32_t flags) override;
+
+    /// Collects the buffer's attributes, posting a protocol error (and returning false) if they are invalid
+    bool take_attributes(int32_t width, int32_t height, uint32_t format, graphics::DmaBufAttributes& attributes);
+
+    bool platform_importable(graphics::DmaBufAttributes const& attributes) const;
+
+    static int const max_planes = 4;
+
+    std::shared_ptr<graphics::WaylandAllocator> const allocator;
+    std::vector<graphics::DmaBufFormat> const platform_formats;
+
+    std::map<uint32_t, graphics::DmaBufAttributes::Plane> planes;
+    uint64_t modifier{drm_format_mod_invalid};
+    bool used{false};
+};
+}
+}
+
+auto mf::LinuxDmabuf::cpu_readable_formats() -> std::vector<mg::DmaBufFormat>
+{
+    std::vector<mg::DmaBufFormat> formats;
+
+    for (auto const fourcc : {drm_format_argb8888, drm_format_xrgb8888, drm_format_abgr8888, drm_format_xbgr8888})
+    {
+        formats.push_back({fourcc, drm_format_mod_linear});
+        formats.push_back({fourcc, drm_format_mod_invalid});
+    }
+
+    return formats;
+}
+
+mf::LinuxDmabuf::LinuxDmabuf(struct wl_display* display, std::shared_ptr<mg::WaylandAllocator> const& allocator)
+    : LinuxDmabufV1(display, 3),
+      allocator{allocator},
+      platform_formats{allocator->dmabuf_formats()},
+      formats{advertised_formats(platform_formats)}
+{
+}
+
+void mf::LinuxDmabuf::bind(struct wl_client* /*client*/, struct wl_resource* resource)
+{
+    if (version_supports_modifier(resource))
+    {
+        for (auto const& format : formats)
+        {
+            send_modifier_event(resource, format.fourcc, format.modifier >> 32, format.modifier & 0xffffffff);
+        }
+    }
+    else
+    {
+        std::vector<uint32_t> sent;
+        for (auto const& format : formats)
+        {
+            if (std::find(begin(sent), end(sent), format.fourcc) == end(sent))
+            {
+                send_format_event(resource, format.fourcc);
+                sent.push_back(format.fourcc);
+            }
+        }
+    }
+}
+
+void mf::LinuxDmabuf::destroy(struct wl_client* /*client*/, struct wl_resource* resource)
+{
+    destroy_wayland_object(resource);
+}
+
+void mf::LinuxDmabuf::create_params(struct wl_client* client, struct wl_resource* resource, uint32_t params_id)
+{
+    new LinuxBufferParams{client, resource, params_id, allocator, platform_formats};
+}
+
+mf::LinuxBufferParams::LinuxBufferParams(
+    struct wl_client* client,
+    struct wl_resource* parent,
+    uint32_t id,
+    std::shared_ptr<mg::WaylandAllocator> const& allocator,
+    std::vector<mg::DmaBufFormat> const& platform_formats)
+    : LinuxBufferParamsV1(client, parent, id),
+      allocator{allocator},
+      platform_formats{platform_formats}
+{
+}
+
+void mf::LinuxBufferParams::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::LinuxBufferParams::add(
+    mir::Fd fd,
+    uint32_t plane_idx,
+    uint32_t offset,
+    uint32_t stride,
+    uint32_t modifier_hi,
+    uint32_t modifier_lo)
+{
+    if (used)
+    {
+        wl_resource_post_error(resource, Error::already_used, "Params have already been used to create a buffer");
+        return;
+    }
+
+    if (plane_idx >= max_planes)
+    {
+        wl_resource_post_error(resource, Error::plane_idx, "Plane index %u is out of bounds", plane_idx);
+        return;
+    }
+
+    if (planes.find(plane_idx) != planes.end())
+    {
+        wl_resource_post_error(resource, Error::plane_set, "Plane %u has already been set", plane_idx);
+        return;
+    }
+
+    // The modifier describes the whole buffer, so every plane must agree on it
+    auto const plane_modifier = (uint64_t(modifier_hi) << 32) | modifier_lo;
+    if (!planes.empty() && plane_modifier != modifier)
+    {
+        wl_resource_post_error(resource, Error::invalid_format, "Planes have mismatched modifiers");
+        return;
+    }
+
+    modifier = plane_modifier;
+    planes.emplace(plane_idx, mg::DmaBufAttributes::Plane{fd, offset, stride});
+}
+
+void mf::LinuxBufferParams::create(int32_t width, int32_t height, uint32_t format, uint32_t flags)
+{
+    mg::DmaBufAttributes attributes;
+    if (!take_attributes(width, height, format, attributes))
+        return;
+
+    auto const importable = platform_importable(attributes);
+
+    // We don't (yet) handle any of the flags, so let the client fall back to something else
+    if (flags != 0 || (!importable && !DmaBufBuffer::cpu_readable(attributes)))
+    {
+        send_failed_event();
+        return;
+    }
+
+    auto const buffer = new DmaBufBuffer{client, resource, 0, std::move(attributes), importable, allocator};
+    send_created_event(buffer->resource);
+}
+
+void mf::LinuxBufferParams::create_immed(
+    uint32_t buffer_id,
+    int32_t width,
+    int32_t height,
+    uint32_t format,
+    uint32_t flags)
+{
+    mg::DmaBufAttributes attributes;
+    if (!take_attributes(width, height, format, attributes))
+        return;
+
+    auto const importable = platform_importable(attributes);
+
+    if (flags != 0 || (!importable && !DmaBufBuffer::cpu_readable(attributes)))
+    {
+        wl_resource_post_error(resource, Error::invalid_wl_buffer, "Cannot import dma-buf");
+        return;
+    }
+
+    new DmaBufBuffer{client, resource, buffer_id, std::move(attributes), importable, allocator};
+}
+
+bool mf::LinuxBufferParams::take_attributes(
+    int32_t width,
+    int32_t height,
+    uint32_t format,
+    mg::DmaBufAttributes& attributes)
+{
+    if (used)
+    {
+        wl_resource_post_error(resource, Error::already_used, "Params have already been used to create a buffer");
+        return false;
+    }
+    used = true;
+
+    if (planes.empty() || planes.rbegin()->first + 1 != planes.size())
+    {
+        wl_resource_post_error(resource, Error::incomplete, "Planes must be added for consecutive indices from 0");
+        return false;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        wl_resource_post_error(resource, Error::invalid_dimensions, "Invalid buffer size %dx%d", width, height);
+        return false;
+    }
+
+    if (!contains(platform_formats, format) && !contains(LinuxDmabuf::cpu_readable_formats(), format))
+    {
+        wl_resource_post_error(resource, Error::invalid_format, "Unsupported format 0x%08x", format);
+        return false;
+    }
+
+    // Every format we advertise is single plane
+    if (planes.size() != 1)
+    {
+        wl_resource_post_error(resource, Error::incomplete, "Format 0x%08x has 1 plane, not %zu", format, planes.size());
+        return false;
+    }
+
+    for (auto const& plane : planes)
+    {
+        auto const end = uint64_t(plane.second.offset) + uint64_t(plane.second.stride) * height;
+
+        // Not every dma-buf can report its size, in which case we can't check. The client
+        // shares the file offset, so leave it where we found it.
+        auto const position = lseek(plane.second.fd, 0, SEEK_CUR);
+        auto const size = lseek(plane.second.fd, 0, SEEK_END);
+        if (position != -1)
+            lseek(plane.second.fd, position, SEEK_SET);
+
+        if (size != -1 && (plane.second.offset >= size || end > uint64_t(size)))
+        {
+            wl_resource_post_error(
+                resource, Error::out_of_bounds,
+                "Plane %u extends beyond the end of the dma-buf", plane.first);
+            return false;
+        }
+    }
+
+    attributes.size = geom::Size{width, height};
+    attributes.fourcc = format;
+    attributes.modifier = modifier;
+    for (auto& plane : planes)
+    {
+        attributes.planes.push_back(std::move(plane.second));
+    }
+    planes.clear();
+
+    return true;
+}
+
+bool mf::LinuxBufferParams::platform_importable(mg::DmaBufAttributes const& attributes) const
+{
+    return contains(platform_formats, attributes.fourcc, attributes.modifier);
+}
+
+mf::DmaBufBuffer::DmaBufBuffer(
+    struct wl_client* client,
+    struct wl_resource* parent,
+    uint32_t id,
+    mg::DmaBufAttributes&& attributes,
+    bool platform_importable,
+    std::shared_ptr<mg::WaylandAllocator> const& allocator)
+    : Buffer(client, parent, id),
+      attributes{std::move(attributes)},
+      allocator{allocator},
+      try_platform_import{platform_importable}
+{
+}
+
+auto mf::DmaBufBuffer::from(struct wl_resource* buffer) -> DmaBufBuffer*
+{
+    if (!wayland::Buffer::is_instance(buffer))
+        return nullptr;
+
+    return dynamic_cast<DmaBufBuffer*>(wayland::Buffer::from(buffer));
+}
+
+bool mf::DmaBufBuffer::cpu_readable(mg::DmaBufAttributes const& attributes)
+{
+    auto const format = cpu_format_for(attributes.fourcc);
+
+    // ShmBuffer expects rows to be tightly packed
+    return format != mir_pixel_format_invalid &&
+           attributes.planes.size() == 1 &&
+           (attributes.modifier == drm_format_mod_linear || attributes.modifier == drm_format_mod_invalid) &&
+           attributes.planes[0].stride == attributes.size.width.as_uint32_t() * MIR_BYTES_PER_PIXEL(format);
+}
+
+auto mf::DmaBufBuffer::mir_buffer(std::function<void()>&& on_consumed, std::function<void()>&& on_release)
+    -> std::shared_ptr<mg::Buffer>
+{
+    if (try_platform_import && !imported)
+    {
+        try
+        {
+            imported = allocator->import_dmabuf(attributes);
+        }
+        catch (...)
+        {
+            if (!cpu_readable(attributes))
+                throw;
+
+            mir::log(
+                mir::logging::Severity::warning,
+                "Wayland",
+                std::current_exception(),
+                "Failed to import dma-buf; falling back to reading it with the CPU");
+            try_platform_import = false;
+        }
+    }
+
+    if (imported)
+    {
+        return imported->buffer(std::move(on_consumed), std::move(on_release));
+    }
+
+    if (!cpu_readable(attributes))
+    {
+        BOOST_THROW_EXCEPTION((std::runtime_error{"Cannot read dma-buf with the CPU"}));
+    }
+
+    auto const& plane = attributes.planes[0];
+
+    if (!mapping)
+    {
+        mapping = std::make_shared<Mapping>(
+            plane.fd,
+            plane.offset + size_t(plane.stride) * attributes.size.height.as_uint32_t());
+    }
+
+    return std::make_shared<DmaBufShmBuffer>(
+        std::make_unique<DmaBufFile>(mapping, plane.offset),
+        attributes.size,
+        cpu_format_for(attributes.fourcc),
+        std::move(on_consumed),
+        std::move(on_release));
+}
+
+void mf::DmaBufBuffer::destroy()
+{
+    destroy_wayland_object();
+}
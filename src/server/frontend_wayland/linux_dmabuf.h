@@ -0,0 +1,103 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_LINUX_DMABUF_H
+#define MIR_FRONTEND_LINUX_DMABUF_H
+
+#include "linux-dmabuf-unstable-v1_wrapper.h"
+#include "wayland_wrapper.h"
+
+#include "mir/graphics/wayland_allocator.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+class Buffer;
+}
+namespace frontend
+{
+
+/// Lets clients attach buffers they allocated as dma-bufs (the "linux-dmabuf" protocol)
+class LinuxDmabuf : public wayland::LinuxDmabufV1
+{
+public:
+    LinuxDmabuf(struct wl_display* display, std::shared_ptr<graphics::WaylandAllocator> const& allocator);
+
+    /// The formats we can read without the help of the graphics platform
+    static auto cpu_readable_formats() -> std::vector<graphics::DmaBufFormat>;
+
+private:
+    void bind(struct wl_client* client, struct wl_resource* resource) override;
+    void destroy(struct wl_client* client, struct wl_resource* resource) override;
+    void create_params(struct wl_client* client, struct wl_resource* resource, uint32_t params_id) override;
+
+    std::shared_ptr<graphics::WaylandAllocator> const allocator;
+    std::vector<graphics::DmaBufFormat> const platform_formats;
+    std::vector<graphics::DmaBufFormat> const formats;
+};
+
+/// A wl_buffer created through zwp_linux_dmabuf_v1
+class DmaBufBuffer : public wayland::Buffer
+{
+public:
+    DmaBufBuffer(
+        struct wl_client* client,
+        struct wl_resource* parent,
+        uint32_t id,
+        graphics::DmaBufAttributes&& attributes,
+        bool platform_importable,
+        std::shared_ptr<graphics::WaylandAllocator> const& allocator);
+
+    /// The DmaBufBuffer behind a wl_buffer, or nullptr if the wl_buffer came from elsewhere
+    static auto from(struct wl_resource* buffer) -> DmaBufBuffer*;
+
+    /// Whether we can fall back to reading a dma-buf with these attributes from the CPU
+    static bool cpu_readable(graphics::DmaBufAttributes const& attributes);
+
+    /**
+     * Wraps the dma-buf for the compositor.
+     *
+     * The graphics platform imports it (once, on the first commit) if it can; otherwise
+     * it is mapped and read with the CPU, which works without a GPU (e.g. for udmabuf
+     * buffers).
+     */
+    auto mir_buffer(std::function<void()>&& on_consumed, std::function<void()>&& on_release)
+        -> std::shared_ptr<graphics::Buffer>;
+
+    class Mapping;
+
+private:
+    void destroy() override;
+
+    graphics::DmaBufAttributes const attributes;
+    std::shared_ptr<graphics::WaylandAllocator> const allocator;
+
+    /// Cleared when the platform fails to import the dma-buf so we don't keep retrying
+    bool try_platform_import;
+    /// The platform's import, made on first use and shared by every later commit
+    std::shared_ptr<graphics::ImportedDmaBuf> imported;
+    std::shared_ptr<Mapping> mapping;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_LINUX_DMABUF_H
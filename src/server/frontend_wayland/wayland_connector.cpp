@@ -548,9 +548,14 @@ auto mf::create_wl_shell(wl_display* display, std::shared_ptr<Shell> const& shel
     return std::make_shared<mf::WlShell>(display, shell, *seat, output_manager);
 }
 
-void mf::WaylandExtensions::init(wl_display* display, std::shared_ptr<Shell> const& shell, WlSeat* seat, OutputManager* const output_manager)
+void mf::WaylandExtensions::init(
+    wl_display* display,
+    std::shared_ptr<Shell> const& shell,
+    WlSeat* seat,
+    OutputManager* const output_manager,
+    std::shared_ptr<mg::WaylandAllocator> const& allocator)
 {
-    custom_extensions(display, shell, seat, output_manager);
+    custom_extensions(display, shell, seat, output_manager, allocator);
 }
 
 void mf::WaylandExtensions::add_extension(std::string const name, std::shared_ptr<void> implementation)
@@ -558,7 +563,12 @@ void mf::WaylandExtensions::add_extension(std::string const name, std::shared_pt
     extension_protocols[std::move(name)] = std::move(implementation);
 }
 
-void mf::WaylandExtensions::custom_extensions(wl_display*, std::shared_ptr<Shell> const&, WlSeat*, OutputManager* const)
+void mf::WaylandExtensions::custom_extensions(
+    wl_display*,
+    std::shared_ptr<Shell> const&,
+    WlSeat*,
+    OutputManager* const,
+    std::shared_ptr<mg::WaylandAllocator> const&)
 {
 }
 
@@ -631,7 +641,7 @@ mf::WaylandConnector::WaylandConnector(
 
     data_device_manager_global = mf::create_data_device_manager(display.get());
 
-    extensions->init(display.get(), shell, seat_global.get(), output_manager.get());
+    extensions->init(display.get(), shell, seat_global.get(), output_manager.get(), this->allocator);
 
     wl_display_init_shm(display.get());
 
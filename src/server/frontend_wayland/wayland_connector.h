@@ -68,14 +68,24 @@ public:
     WaylandExtensions(WaylandExtensions const&) = delete;
     WaylandExtensions& operator=(WaylandExtensions const&) = delete;
 
-    void init(wl_display* display, std::shared_ptr<Shell> const& shell, WlSeat* seat, OutputManager* const output_manager);
+    void init(
+        wl_display* display,
+        std::shared_ptr<Shell> const& shell,
+        WlSeat* seat,
+        OutputManager* const output_manager,
+        std::shared_ptr<graphics::WaylandAllocator> const& allocator);
 
     auto get_extension(std::string const& name) const -> std::shared_ptr<void>;
 
 protected:
 
     void add_extension(std::string const name, std::shared_ptr<void> implementation);
-    virtual void custom_extensions(wl_display* display, std::shared_ptr<Shell> const& shell, WlSeat* seat, OutputManager* const output_manager);
+    virtual void custom_extensions(
+        wl_display* display,
+        std::shared_ptr<Shell> const& shell,
+        WlSeat* seat,
+        OutputManager* const output_manager,
+        std::shared_ptr<graphics::WaylandAllocator> const& allocator);
 
 private:
     std::unordered_map<std::string, std::shared_ptr<void>> extension_protocols;
@@ -21,6 +21,9 @@
 #include "xdg_shell_v6.h"
 #include "xdg_shell_stable.h"
 #include "layer_shell_v1.h"
+#include "wp_presentation.h"
+#include "wp_viewporter.h"
+#include "linux_dmabuf.h"
 #include "xwayland_wm_shell.h"
 #include "mir_display.h"
 #include "wl_seat.h"
@@ -38,6 +41,9 @@ auto const wl_shell       = "wl_shell";
 auto const xdg_shell      = "xdg_wm_base";
 auto const xdg_shell_v6   = "zxdg_shell_v6";
 auto const layer_shell_v1 = "zwlr_layer_shell_v1";
+auto const presentation   = "wp_presentation";
+auto const viewporter     = "wp_viewporter";
+auto const linux_dmabuf   = "zwp_linux_dmabuf_v1";
 
 auto configure_wayland_extensions(std::string extensions,
     bool x11_enabled,
@@ -57,7 +63,8 @@ auto configure_wayland_extensions(std::string extensions,
             wl_display* display,
             std::shared_ptr<mf::Shell> const& shell,
             mf::WlSeat* seat,
-            mf::OutputManager* const output_manager)
+            mf::OutputManager* const output_manager,
+            std::shared_ptr<mir::graphics::WaylandAllocator> const& allocator)
         {
             if (extension.find(wl_shell) != extension.end())
                 add_extension(wl_shell, mf::create_wl_shell(display, shell, seat, output_manager));
@@ -72,6 +79,15 @@ auto configure_wayland_extensions(std::string extensions,
                 add_extension(layer_shell_v1, std::make_shared<mf::LayerShellV1>(display, shell, *seat,
                                                                                  output_manager));
 
+            if (extension.find(presentation) != extension.end())
+                add_extension(presentation, std::make_shared<mf::WpPresentation>(display));
+
+            if (extension.find(viewporter) != extension.end())
+                add_extension(viewporter, std::make_shared<mf::WpViewporter>(display));
+
+            if (extension.find(linux_dmabuf) != extension.end())
+                add_extension(linux_dmabuf, std::make_shared<mf::LinuxDmabuf>(display, allocator));
+
             std::function<void(std::function<void()>&& work)> run_on_wayland_mainloop = [seat](std::function<void()>&& work)
                 {
                     seat->spawn(std::move(work));
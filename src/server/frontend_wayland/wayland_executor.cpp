@@ -25,8 +25,8 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <atomic>
 #include <cstring>
-#include <deque>
 #include <functional>
 #include <mutex>
 #include <system_error>
@@ -55,40 +55,80 @@ private:
         TerminationRequested,
         Stopped
     };
+
+    struct WorkItem
+    {
+        std::atomic<WorkItem*> next{nullptr};
+        std::function<void()> work;
+    };
+
 public:
     explicit State(wl_event_loop* loop)
-        : loop{loop}
+        : loop{loop},
+          head{&stub},
+          tail{&stub}
     {
     }
 
-    void enqueue(std::function<void()>&& work)
+    ~State()
     {
-        std::lock_guard<std::mutex> lock{mutex};
-        if (state == ExecutionState::Running)
+        while (auto item = pop())
+            delete item;
+    }
+
+    /**
+     * Queue work for the event loop
+     *
+     * \return true if the event loop needs to be woken to process the work; false if it
+     *          has already been asked to and hasn't yet started draining the queue.
+     */
+    bool enqueue(std::function<void()>&& work)
+    {
+        if (state.load(std::memory_order_acquire) == ExecutionState::Running)
         {
-            workqueue.emplace_back(std::move(work));
+            auto const item = new WorkItem;
+            item->work = std::move(work);
+            push(item);
+
+            return !wakeup_pending.exchange(true, std::memory_order_acq_rel);
         }
         // If we've been terminated then drop the work on the floor, letting the
         // std::function destructor clean up any necessary state.
+        return false;
     }
 
     void enqueue_termination(std::function<void()>&& terminator)
     {
         std::lock_guard<std::mutex> lock{mutex};
-        if (state == ExecutionState::Running)
+        if (state.load(std::memory_order_relaxed) == ExecutionState::Running)
         {
-            workqueue.emplace_front(std::move(terminator));
-            state = ExecutionState::TerminationRequested;
+            this->terminator = std::move(terminator);
+            state.store(ExecutionState::TerminationRequested, std::memory_order_release);
         }
     }
 
+    /// Called by the event loop before draining the queue; work spawned after this needs a fresh wakeup
+    void start_draining()
+    {
+        // This has to read-modify-write: if a spawn() saw the old value (and so didn't wake us)
+        // we need to synchronise with it to be sure of seeing its work item
+        wakeup_pending.exchange(false, std::memory_order_acq_rel);
+    }
+
     std::function<void()> get_work()
     {
-        std::lock_guard<std::mutex> lock{mutex};
-        if (!workqueue.empty())
+        // A termination request jumps the queue
+        if (state.load(std::memory_order_acquire) == ExecutionState::TerminationRequested)
         {
-            auto const work = std::move(workqueue.front());
-            workqueue.pop_front();
+            std::lock_guard<std::mutex> lock{mutex};
+            if (terminator)
+                return std::move(terminator);
+        }
+
+        if (auto const item = pop())
+        {
+            auto work = std::move(item->work);
+            delete item;
             return work;
         }
         return {};
@@ -98,12 +138,11 @@ public:
     {
         std::unique_lock<std::mutex> lock{mutex};
 
-        if (state == ExecutionState::TerminationRequested)
+        if (terminator)
         {
-            // If we've been asked to terminate then the front of the workqueue
-            // will contain the termination request.
+            // If we've been asked to terminate then we have to run the termination request.
             {
-                std::function<void()> const work = std::move(workqueue.front());
+                std::function<void()> const work = std::move(terminator);
                 lock.unlock();
 
                 work();
@@ -111,18 +150,73 @@ public:
             lock.lock();
         }
 
-        state = ExecutionState::Stopped;
-        workqueue.empty();
+        state.store(ExecutionState::Stopped, std::memory_order_release);
+        while (auto item = pop())
+            delete item;
 
         return lock;
     }
 
     static int on_notify(int fd, uint32_t, void* data);
 private:
+    /*
+     * The work queue is an intrusive multi-producer, single-consumer queue (after Dmitry Vyukov's):
+     * any thread can push, only the event loop pops, and neither takes a lock.
+     */
+    void push(WorkItem* item)
+    {
+        auto const prev = head.exchange(item, std::memory_order_acq_rel);
+        // Between the exchange and this store the queue is briefly "broken" at prev; pop()
+        // treats that as empty, and the wakeup protocol makes sure the item is picked up later
+        prev->next.store(item, std::memory_order_release);
+    }
+
+    WorkItem* pop()
+    {
+        auto current = tail;
+        auto next = current->next.load(std::memory_order_acquire);
+
+        if (current == &stub)
+        {
+            if (!next)
+                return nullptr;
+
+            tail = next;
+            current = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail = next;
+            return current;
+        }
+
+        if (current != head.load(std::memory_order_acquire))
+            return nullptr;
+
+        // current is the last item; put the stub back behind it so it can be handed out
+        stub.next.store(nullptr, std::memory_order_relaxed);
+        push(&stub);
+
+        next = current->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            tail = next;
+            return current;
+        }
+        return nullptr;
+    }
+
     std::mutex mutex;
-    ExecutionState state{ExecutionState::Running};
+    std::atomic<ExecutionState> state{ExecutionState::Running};
+    std::function<void()> terminator;
     wl_event_loop* const loop;
-    std::deque<std::function<void()>> workqueue;
+
+    WorkItem stub;
+    std::atomic<WorkItem*> head;    ///< Most recently pushed item; written by any thread
+    WorkItem* tail;                 ///< Next item to pop; only touched by the event loop
+    std::atomic<bool> wakeup_pending{false};
 };
 
 namespace
@@ -217,6 +311,8 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
             err);
     }
 
+    // Process everything that's queued, not just the item that caused the wakeup
+    state->start_draining();
     while (auto work = state->get_work())
     {
         try
@@ -232,7 +328,7 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
                 "Exception processing Wayland event loop work item");
         }
     }
-    if (state->state != ExecutionState::Running)
+    if (state->state.load(std::memory_order_acquire) != ExecutionState::Running)
     {
         EventLoopDestroyedHandler::remove_destruction_handler_for_loop(state->loop);
     }
@@ -244,7 +340,7 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
 
 mf::WaylandExecutor::WaylandExecutor(wl_event_loop* loop)
     : state{std::make_shared<State>(loop)},
-      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE | EFD_NONBLOCK)},
+      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
       source{wl_event_loop_add_fd(
           loop,
           notify_fd,
@@ -303,7 +399,9 @@ mf::WaylandExecutor::~WaylandExecutor()
 
 void mf::WaylandExecutor::spawn (std::function<void()>&& work)
 {
-    state->enqueue(std::move(work));
+    // Only the first work item since the event loop last started draining needs to wake it
+    if (!state->enqueue(std::move(work)))
+        return;
 
     if (auto err = eventfd_write(notify_fd, 1))
     {
@@ -247,7 +247,7 @@ std::experimental::optional<geom::Size> mf::WindowWlSurfaceRole::window_size()
     else if (committed_window_size)
         return committed_window_size;
     else
-        return surface->buffer_size();
+        return surface->size();
 }
 
 MirWindowState mf::WindowWlSurfaceRole::window_state()
@@ -20,6 +20,7 @@
 
 #include "wl_seat.h"
 
+#include "keymap_cache.h"
 #include "wayland_utils.h"
 #include "wl_surface.h"
 #include "wl_keyboard.h"
@@ -153,6 +154,7 @@ mf::WlSeat::WlSeat(
                 {
                     *keymap = new_keymap;
                 })},
+        keymap_cache{std::make_shared<KeymapCache>()},
         pointer_listeners{std::make_shared<ListenerList<WlPointer>>()},
         keyboard_listeners{std::make_shared<ListenerList<WlKeyboard>>()},
         touch_listeners{std::make_shared<ListenerList<WlTouch>>()},
@@ -231,6 +233,7 @@ void mf::WlSeat::get_keyboard(wl_client* client, wl_resource* resource, uint32_t
             resource,
             id,
             *keymap,
+            keymap_cache,
             [listeners = keyboard_listeners, client](WlKeyboard* listener)
             {
                 listeners->unregister_listener(client, listener);
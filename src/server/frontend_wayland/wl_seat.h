@@ -46,6 +46,7 @@ namespace frontend
 class WlPointer;
 class WlKeyboard;
 class WlTouch;
+class KeymapCache;
 
 class WlSeat : public wayland::Seat
 {
@@ -92,6 +93,9 @@ private:
     std::unique_ptr<mir::input::Keymap> const keymap;
     std::shared_ptr<ConfigObserver> const config_observer;
 
+    /// Shared by all our keyboards, so each keymap is only compiled once
+    std::shared_ptr<KeymapCache> const keymap_cache;
+
     // listener list are shared pointers so devices can keep them around long enough to remove themselves
     std::shared_ptr<ListenerList<WlPointer>> const pointer_listeners;
     std::shared_ptr<ListenerList<WlKeyboard>> const keyboard_listeners;
@@ -23,7 +23,9 @@
 #include "wl_subcompositor.h"
 #include "wl_region.h"
 #include "wlshmbuffer.h"
+#include "linux_dmabuf.h"
 #include "deleted_for_resource.h"
+#include "wp_presentation.h"
 
 #include "wayland_wrapper.h"
 
@@ -34,12 +36,24 @@
 #include "mir/graphics/wayland_allocator.h"
 #include "mir/shell/surface_specification.h"
 #include "mir/log.h"
+#include "mir/geometry/rectangles.h"
 
 #include <algorithm>
+#include <chrono>
+#include <limits>
 
 namespace mf = mir::frontend;
 namespace geom = mir::geometry;
 
+namespace
+{
+// wl_callback.done carries a timestamp in milliseconds with an undefined base
+uint32_t timestamp_ms(std::chrono::nanoseconds time)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
+}
+}
+
 mf::WlSurfaceState::Callback::Callback(struct wl_client* client, struct wl_resource* parent, uint32_t id)
     : wayland::Callback{client, parent, id},
       destroyed{deleted_flag_for_resource(resource)}
@@ -57,10 +71,31 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedbacks.insert(end(presentation_feedbacks),
+                                  begin(source.presentation_feedbacks),
+                                  end(source.presentation_feedbacks));
+
+    buffer_damage.insert(end(buffer_damage),
+                         begin(source.buffer_damage),
+                         end(source.buffer_damage));
+
+    surface_damage.insert(end(surface_damage),
+                          begin(source.surface_damage),
+                          end(source.surface_damage));
+
+    if (source.viewport_source)
+        viewport_source = source.viewport_source;
+
+    if (source.viewport_destination)
+        viewport_destination = source.viewport_destination;
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -90,6 +125,20 @@ mf::WlSurface::WlSurface(
 {
     // wl_surface is specified to act in mailbox mode
     stream->allow_framedropping(true);
+
+    // Frame callbacks are answered when a frame showing our content reaches the screen,
+    // which is what lets clients pace themselves to the display
+    stream->set_frame_presented_callback(
+        [this, executor = executor, destroyed = destroyed](
+            compositor::PresentedFrame const& frame, bool on_screen, uint64_t shown)
+        {
+            executor->spawn(run_unless(
+                destroyed,
+                [this, frame, on_screen, shown]()
+                {
+                    frame_presented(frame, on_screen, shown);
+                }));
+        });
 }
 
 mf::WlSurface::~WlSurface()
@@ -105,6 +154,8 @@ mf::WlSurface::~WlSurface()
     }
 
     role->destroy();
+    stream->set_frame_presented_callback([](auto, auto, auto){});
+    PresentationFeedbacks::discard(pending.presentation_feedbacks);
     session->destroy_buffer_stream(stream_id);
 }
 
@@ -123,8 +174,8 @@ mf::WlSurface::Position mf::WlSurface::transform_point(geom::Point point)
         if (result.is_in_input_region)
             return result;
     }
-    geom::Rectangle surface_rect = {geom::Point{}, buffer_size_.value_or(geom::Size{})};
-    for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{{{}, buffer_size_.value_or(geom::Size{})}}))
+    geom::Rectangle surface_rect = {geom::Point{}, size().value_or(geom::Size{})};
+    for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{surface_rect}))
     {
         if (rect.intersection_with(surface_rect).contains(point))
             return {point, this, true};
@@ -132,6 +183,14 @@ mf::WlSurface::Position mf::WlSurface::transform_point(geom::Point point)
     return {point, this, false};
 }
 
+std::experimental::optional<geom::Size> mf::WlSurface::size() const
+{
+    if (!buffer_size_)
+        return std::experimental::nullopt;
+    else
+        return viewport_state.surface_size(buffer_size_.value());
+}
+
 mf::SurfaceId mf::WlSurface::surface_id() const
 {
     return role->surface_id();
@@ -177,7 +236,7 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
     geometry::Displacement offset = parent_offset + offset_;
 
     buffer_streams.push_back({stream_id, offset, {}});
-    geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
+    geom::Rectangle surface_rect = {geom::Point{} + offset, size().value_or(geom::Size{})};
     if (input_shape)
     {
         for (auto rect : input_shape.value())
@@ -214,20 +273,54 @@ mf::WlSurface* mf::WlSurface::from(wl_resource* resource)
     return static_cast<WlSurface*>(static_cast<wayland::Surface*>(raw_surface));
 }
 
-void mf::WlSurface::send_frame_callbacks()
+void mf::WlSurface::send_frame_callbacks(uint32_t timestamp)
 {
     for (auto const& frame : frame_callbacks)
     {
         if (!*frame->destroyed)
         {
-            // TODO: argument should be a timestamp
-            frame->send_done_event(0);
+            frame->send_done_event(timestamp);
             frame->destroy_wayland_object();
         }
     }
     frame_callbacks.clear();
 }
 
+void mf::WlSurface::frame_presented(
+    compositor::PresentedFrame const& frame,
+    bool on_screen,
+    uint64_t shown)
+{
+    send_frame_callbacks(timestamp_ms(frame.frame.ust.nanoseconds));
+    presentation_feedbacks.frame_presented(frame, on_screen, shown);
+}
+
+void mf::WlSurface::add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback)
+{
+    pending.presentation_feedbacks.push_back(feedback);
+}
+
+void mf::WlSurface::set_pending_viewport_source(std::experimental::optional<SurfaceViewport::Source> const& source)
+{
+    pending.viewport_source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& destination)
+{
+    pending.viewport_destination = destination;
+}
+
+bool mf::WlSurface::check_viewport(std::experimental::optional<geom::Size> const& buffer_size)
+{
+    if (auto const error = viewport_state.error(buffer_size))
+    {
+        if (viewport_)
+            wl_resource_post_error(viewport_, error.value().code, "%s", error.value().message.c_str());
+        return false;
+    }
+    return true;
+}
+
 void mf::WlSurface::destroy()
 {
     *destroyed = true;
@@ -248,20 +341,31 @@ void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buff
 
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    add_damage(pending.surface_damage, x, y, width, height);
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    add_damage(pending.buffer_damage, x, y, width, height);
+}
+
+void mf::WlSurface::add_damage(
+    std::vector<geom::Rectangle>& damage,
+    int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    // Clients commonly send (0, 0, INT32_MAX, INT32_MAX) to mean "everything", so
+    // clamp to the representable part of the buffer rather than overflowing
+    int64_t const left = std::max<int64_t>(x, 0);
+    int64_t const top = std::max<int64_t>(y, 0);
+    int64_t const right = std::min<int64_t>(int64_t{x} + width, std::numeric_limits<int32_t>::max());
+    int64_t const bottom = std::min<int64_t>(int64_t{y} + height, std::numeric_limits<int32_t>::max());
+
+    if (right <= left || bottom <= top)
+        return;
+
+    damage.push_back({
+        {static_cast<int32_t>(left), static_cast<int32_t>(top)},
+        {static_cast<int32_t>(right - left), static_cast<int32_t>(bottom - top)}});
 }
 
 void mf::WlSurface::frame(uint32_t callback)
@@ -271,8 +375,10 @@ void mf::WlSurface::frame(uint32_t callback)
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    if (region)
+        pending.opaque_region = WlRegion::from(region.value())->region();
+    else
+        pending.opaque_region = geom::Region{};
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -303,6 +409,28 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    auto const old_size = size();
+
+    if (state.viewport_source || state.viewport_destination)
+    {
+        viewport_state.commit(state.viewport_source, state.viewport_destination);
+
+        // A new buffer is checked against the viewport once we know its size
+        if (!check_viewport(state.buffer ? std::experimental::nullopt : buffer_size_))
+            return;
+
+        optional_value<geom::Rectangle> source;
+        if (auto const bounds = viewport_state.source_bounds())
+            source = bounds.value();
+        optional_value<geom::Size> destination;
+        if (auto const size = viewport_state.destination())
+            destination = size.value();
+        stream->set_viewport(source, destination);
+    }
+
+    if (state.opaque_region)
+        stream->set_opaque_region(state.opaque_region.value());
+
     if (state.buffer)
     {
         wl_resource * buffer = *state.buffer;
@@ -311,19 +439,31 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
-            send_frame_callbacks();
+            presentation_feedbacks.commit(state.presentation_feedbacks, state.buffer, submissions);
+            send_frame_callbacks(timestamp_ms(std::chrono::steady_clock::now().time_since_epoch()));
         }
         else
         {
-            auto const executor_send_frame_callbacks = [this, executor = executor, destroyed = destroyed]()
-                {
-                    executor->spawn(run_unless(
-                        destroyed,
-                        [this]()
-                        {
-                            send_frame_callbacks();
-                        }));
-                };
+            std::function<void()> on_consumed = [](){};
+            auto const submission = submissions + 1;
+
+            // Surfaces without a role (such as cursors) are never composited as part of the
+            // scene, so the best we can do is answer when the buffer has been used
+            if (role == &null_role)
+            {
+                on_consumed = [this, executor = executor, destroyed = destroyed, submission]()
+                    {
+                        executor->spawn(run_unless(
+                            destroyed,
+                            [this, submission]()
+                            {
+                                frame_presented(
+                                    compositor::PresentedFrame::untimed(std::chrono::steady_clock::now()),
+                                    true,
+                                    submission);
+                            }));
+                    };
+            }
 
             std::shared_ptr<graphics::Buffer> mir_buffer;
 
@@ -331,7 +471,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
             {
                 mir_buffer = WlShmBuffer::mir_buffer_from_wl_buffer(
                     buffer,
-                    std::move(executor_send_frame_callbacks));
+                    executor,
+                    std::move(on_consumed));
             }
             else
             {
@@ -344,23 +485,56 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                             [buffer](){ wl_resource_queue_event(buffer, wayland::Buffer::Opcode::release); }));
                     };
 
-                mir_buffer = allocator->buffer_from_resource(
-                    buffer,
-                    std::move(executor_send_frame_callbacks),
-                    std::move(release_buffer));
+                if (auto const dmabuf = DmaBufBuffer::from(buffer))
+                {
+                    mir_buffer = dmabuf->mir_buffer(std::move(on_consumed), std::move(release_buffer));
+                }
+                else
+                {
+                    mir_buffer = allocator->buffer_from_resource(
+                        buffer,
+                        std::move(on_consumed),
+                        std::move(release_buffer));
+                }
             }
 
-            if (!input_shape && (!buffer_size_ || mir_buffer->size() != buffer_size_.value()))
+            buffer_size_ = mir_buffer->size();
+
+            if (!check_viewport(mir_buffer->size()))
+                return;
+
+            geom::Rectangle const whole_buffer{{0, 0}, mir_buffer->size()};
+            auto const damaged = viewport_state.damage_in_buffer(
+                state.buffer_damage,
+                state.surface_damage,
+                mir_buffer->size());
+
+            geom::Rectangles damage;
+            for (auto const& rect : damaged)
             {
-                state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
+                auto const clipped = rect.intersection_with(whole_buffer);
+                if (clipped != geom::Rectangle{})
+                    damage.add(clipped);
             }
-            buffer_size_ = mir_buffer->size();
-            stream->submit_buffer(mir_buffer);
+
+            // Clients that don't report damage expect the whole buffer to be shown
+            if (damaged.empty())
+                damage.add(whole_buffer);
+
+            stream->submit_buffer(mir_buffer, damage);
+            submissions = submission;
+            presentation_feedbacks.commit(state.presentation_feedbacks, state.buffer, submission);
         }
     }
     else
     {
-        send_frame_callbacks();
+        presentation_feedbacks.commit(state.presentation_feedbacks, state.buffer, submissions);
+        send_frame_callbacks(timestamp_ms(std::chrono::steady_clock::now().time_since_epoch()));
+    }
+
+    if (!input_shape && size() != old_size)
+    {
+        state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
     }
 
     for (WlSubsurface* child: children)
@@ -22,6 +22,8 @@
 #include "wayland_wrapper.h"
 
 #include "wl_surface_role.h"
+#include "wp_presentation.h"
+#include "wp_viewporter.h"
 
 #include "mir/frontend/buffer_stream_id.h"
 #include "mir/frontend/surface_id.h"
@@ -29,7 +31,10 @@
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
 
+#include <chrono>
 #include <vector>
 #include <map>
 
@@ -45,10 +50,6 @@ namespace shell
 {
 struct StreamSpecification;
 }
-namespace geometry
-{
-class Rectangle;
-}
 
 namespace frontend
 {
@@ -81,6 +82,12 @@ struct WlSurfaceState
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    std::vector<std::shared_ptr<WpPresentationFeedback>> presentation_feedbacks;
+    std::vector<geometry::Rectangle> buffer_damage; // in buffer coordinates
+    std::vector<geometry::Rectangle> surface_damage; // in surface coordinates
+    std::experimental::optional<std::experimental::optional<SurfaceViewport::Source>> viewport_source;
+    std::experimental::optional<std::experimental::optional<geometry::Size>> viewport_destination;
+    std::experimental::optional<geometry::Region> opaque_region;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -126,6 +133,8 @@ public:
     geometry::Displacement offset() const { return offset_; }
     geometry::Displacement total_offset() const { return offset_ + role->total_offset(); }
     std::experimental::optional<geometry::Size> buffer_size() const { return buffer_size_; }
+    /// The size of the surface in surface coordinates (the buffer size, unless a viewport changes it)
+    std::experimental::optional<geometry::Size> size() const;
     bool synchronized() const;
     Position transform_point(geometry::Point point);
     wl_resource* raw_resource() const { return resource; }
@@ -137,6 +146,11 @@ public:
     std::unique_ptr<WlSurface, std::function<void(WlSurface*)>> add_child(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    void add_presentation_feedback(std::shared_ptr<WpPresentationFeedback> const& feedback);
+    wl_resource* viewport() const { return viewport_; }
+    void set_viewport(wl_resource* viewport) { viewport_ = viewport; }
+    void set_pending_viewport_source(std::experimental::optional<SurfaceViewport::Source> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& destination);
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
@@ -162,11 +176,19 @@ private:
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
+    PresentationFeedbacks presentation_feedbacks;
+    uint64_t submissions{0}; ///< The number of buffers submitted to stream, which numbers them
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    wl_resource* viewport_{nullptr};
+    SurfaceViewport viewport_state;
     std::map<void const*, std::function<void()>> destroy_listeners;
     std::shared_ptr<bool> const destroyed;
 
-    void send_frame_callbacks();
+    void send_frame_callbacks(uint32_t timestamp);
+    void frame_presented(compositor::PresentedFrame const& frame, bool on_screen, uint64_t shown);
+    /// Posts the protocol error if the committed viewport can't be applied, and returns whether it can
+    bool check_viewport(std::experimental::optional<geometry::Size> const& buffer_size);
+    static void add_damage(std::vector<geometry::Rectangle>& damage, int32_t x, int32_t y, int32_t width, int32_t height);
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
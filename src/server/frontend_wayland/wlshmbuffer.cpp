@@ -19,7 +19,10 @@
  */
 
 #include "wlshmbuffer.h"
+#include "deleted_for_resource.h"
+#include "damaged_texture_upload.h"
 
+#include <mir/executor.h>
 #include <mir/log.h>
 
 #include <wayland-server-protocol.h>
@@ -126,46 +129,107 @@ namespace mf = mir::frontend;
 namespace mg = mir::graphics;
 using namespace mir::geometry;
 
-mf::WlShmBuffer::~WlShmBuffer()
+class mf::WlShmBuffer::ClientBuffer
 {
-    std::lock_guard <std::mutex> lock{*buffer_mutex};
-    if (buffer) {
-        wl_resource_queue_event(resource, WL_BUFFER_RELEASE);
+public:
+    ClientBuffer(wl_resource* resource, std::shared_ptr<Executor> const& wayland_executor);
+    ~ClientBuffer();
+
+    std::mutex mutex;
+    /// Null once the client has destroyed the wl_buffer
+    wl_shm_buffer* buffer;
+
+    wl_resource* const resource;
+    std::shared_ptr<bool> const resource_destroyed;
+    std::shared_ptr<Executor> const wayland_executor;
+
+    /// Held so that libwayland defers remapping the pool while we might be reading from it
+    wl_shm_pool* const pool;
+
+    Size const size;
+    Stride const stride;
+    MirPixelFormat const format;
+};
+
+mf::WlShmBuffer::ClientBuffer::ClientBuffer(
+    wl_resource* resource,
+    std::shared_ptr<Executor> const& wayland_executor)
+    : buffer{shm_buffer_from_resource_checked(resource)},
+      resource{resource},
+      resource_destroyed{deleted_flag_for_resource(resource)},
+      wayland_executor{wayland_executor},
+      pool{wl_shm_buffer_ref_pool(buffer)},
+      size{wl_shm_buffer_get_width(buffer), wl_shm_buffer_get_height(buffer)},
+      stride{wl_shm_buffer_get_stride(buffer)},
+      format{wl_format_to_mir_format(wl_shm_buffer_get_format(buffer))}
+{
+    if (stride.as_int() < size.width.as_int() * MIR_BYTES_PER_PIXEL(format)) {
+        wl_shm_pool_unref(pool);
+        wl_resource_post_error(
+            resource,
+            WL_SHM_ERROR_INVALID_STRIDE,
+            "Stride (%u) is less than width × bytes per pixel (%u×%u). "
+                "Did you accidentally specify stride in pixels?",
+            stride.as_int(), size.width.as_int(), MIR_BYTES_PER_PIXEL(format));
+
+        BOOST_THROW_EXCEPTION((
+                                  std::runtime_error{"Buffer has invalid stride"}));
     }
 }
 
+mf::WlShmBuffer::ClientBuffer::~ClientBuffer()
+{
+    // We may be destroyed on a compositor thread, but both the release event and
+    // dropping our reference on the pool (which may complete a deferred resize)
+    // need to happen on the Wayland thread.
+    wayland_executor->spawn(
+        [pool = pool, resource = resource, destroyed = resource_destroyed]()
+        {
+            if (!*destroyed)
+            {
+                wl_resource_queue_event(resource, WL_BUFFER_RELEASE);
+            }
+            wl_shm_pool_unref(pool);
+        });
+}
+
+mf::WlShmBuffer::~WlShmBuffer() = default;
+
 std::shared_ptr<mg::Buffer> mf::WlShmBuffer::mir_buffer_from_wl_buffer(
     wl_resource *buffer,
+    std::shared_ptr<Executor> const& wayland_executor,
     std::function<void()> &&on_consumed)
 {
-    std::shared_ptr <WlShmBuffer> mir_buffer;
-    DestructionShim *shim;
+    std::shared_ptr<ClientBuffer> client_buffer;
 
     if (auto notifier = wl_resource_get_destroy_listener(buffer, &on_buffer_destroyed)) {
         // We've already constructed a shim for this buffer, update it.
+        DestructionShim *shim;
         shim = wl_container_of(notifier, shim, destruction_listener);
 
-        if (!(mir_buffer = shim->associated_buffer.lock())) {
+        if (!(client_buffer = shim->client_buffer.lock())) {
             /*
              * We've seen this wl_buffer before, but all the WlShmBuffers associated with it
              * have been destroyed.
-             *
-             * Recreate a new WlShmBuffer to track the new compositor lifetime.
              */
-            mir_buffer = std::shared_ptr < WlShmBuffer > {new WlShmBuffer{buffer, std::move(on_consumed)}};
-            shim->associated_buffer = mir_buffer;
+            client_buffer = std::make_shared<ClientBuffer>(buffer, wayland_executor);
+            shim->client_buffer = client_buffer;
         }
     } else {
-        mir_buffer = std::shared_ptr < WlShmBuffer > {new WlShmBuffer{buffer, std::move(on_consumed)}};
-        shim = new DestructionShim;
+        client_buffer = std::make_shared<ClientBuffer>(buffer, wayland_executor);
+        auto const shim = new DestructionShim;
         shim->destruction_listener.notify = &on_buffer_destroyed;
-        shim->associated_buffer = mir_buffer;
+        shim->client_buffer = client_buffer;
 
         wl_resource_add_destroy_listener(buffer, &shim->destruction_listener);
     }
 
-    mir_buffer->buffer_mutex = shim->mutex;
-    return mir_buffer;
+    /*
+     * Every commit gets a buffer (and BufferID) of its own, even when the client
+     * reattaches a wl_buffer we still hold: the client may have drawn into it since,
+     * and texture caches and damage tracking only notice a new ID.
+     */
+    return std::shared_ptr<WlShmBuffer>{new WlShmBuffer{client_buffer, std::move(on_consumed)}};
 }
 
 std::shared_ptr <mg::NativeBuffer> mf::WlShmBuffer::native_buffer_handle() const
@@ -216,6 +280,15 @@ void mf::WlShmBuffer::gl_bind_to_texture()
     }
 }
 
+void mf::WlShmBuffer::update_texture(Rectangles const& damage)
+{
+    read(
+        [this, &damage](unsigned char const *pixels)
+        {
+            mg::common::upload_damaged_pixels(pixels, size_, stride_, format_, damage);
+        });
+}
+
 void mf::WlShmBuffer::bind()
 {
     gl_bind_to_texture();
@@ -227,7 +300,13 @@ void mf::WlShmBuffer::secure_for_render()
 
 void mf::WlShmBuffer::write(unsigned char const *pixels, size_t size)
 {
-    std::lock_guard <std::mutex> lock{*buffer_mutex};
+    std::lock_guard <std::mutex> lock{client_buffer->mutex};
+    auto const buffer = client_buffer->buffer;
+    if (!buffer) {
+        log_warning("Attempt to write to WlShmBuffer after the wl_buffer has been destroyed");
+        return;
+    }
+
     wl_shm_buffer_begin_access(buffer);
     auto data = wl_shm_buffer_get_data(buffer);
     ::memcpy(data, pixels, size);
@@ -236,7 +315,8 @@ void mf::WlShmBuffer::write(unsigned char const *pixels, size_t size)
 
 void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_with_pixels)
 {
-    std::lock_guard <std::mutex> lock{*buffer_mutex};
+    std::lock_guard <std::mutex> lock{client_buffer->mutex};
+    auto const buffer = client_buffer->buffer;
     if (!buffer) {
         log_warning("Attempt to read from WlShmBuffer after the wl_buffer has been destroyed");
         return;
@@ -247,7 +327,14 @@ void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_
         consumed = true;
     }
 
-    do_with_pixels(static_cast<unsigned char const *>(data.get()));
+    /*
+     * Read straight from the client's pool. The access bracketing makes this
+     * safe against a client truncating the pool: libwayland's SIGBUS handler
+     * maps zeros over the missing pages and the client is sent an error.
+     */
+    wl_shm_buffer_begin_access(buffer);
+    do_with_pixels(static_cast<unsigned char const *>(wl_shm_buffer_get_data(buffer)));
+    wl_shm_buffer_end_access(buffer);
 }
 
 Stride mf::WlShmBuffer::stride() const
@@ -256,33 +343,16 @@ Stride mf::WlShmBuffer::stride() const
 }
 
 mf::WlShmBuffer::WlShmBuffer(
-    wl_resource *buffer,
+    std::shared_ptr<ClientBuffer> const& client_buffer,
     std::function<void()> &&on_consumed)
     :
-    buffer{shm_buffer_from_resource_checked(buffer)},
-    resource{buffer},
-    size_{wl_shm_buffer_get_width(this->buffer), wl_shm_buffer_get_height(this->buffer)},
-    stride_{wl_shm_buffer_get_stride(this->buffer)},
-    format_{wl_format_to_mir_format(wl_shm_buffer_get_format(this->buffer))},
-    data{std::make_unique<uint8_t[]>(size_.height.as_int() * stride_.as_int())},
+    client_buffer{client_buffer},
+    size_{client_buffer->size},
+    stride_{client_buffer->stride},
+    format_{client_buffer->format},
     consumed{false},
     on_consumed{std::move(on_consumed)}
 {
-    if (stride_.as_int() < size_.width.as_int() * MIR_BYTES_PER_PIXEL(format_)) {
-        wl_resource_post_error(
-            resource,
-            WL_SHM_ERROR_INVALID_STRIDE,
-            "Stride (%u) is less than width × bytes per pixel (%u×%u). "
-                "Did you accidentally specify stride in pixels?",
-            stride_.as_int(), size_.width.as_int(), MIR_BYTES_PER_PIXEL(format_));
-
-        BOOST_THROW_EXCEPTION((
-                                  std::runtime_error{"Buffer has invalid stride"}));
-    }
-
-    wl_shm_buffer_begin_access(this->buffer);
-    std::memcpy(data.get(), wl_shm_buffer_get_data(this->buffer), size_.height.as_int() * stride_.as_int());
-    wl_shm_buffer_end_access(this->buffer);
 }
 
 void mf::WlShmBuffer::on_buffer_destroyed(wl_listener *listener, void *)
@@ -294,11 +364,9 @@ void mf::WlShmBuffer::on_buffer_destroyed(wl_listener *listener, void *)
     DestructionShim *shim;
     shim = wl_container_of(listener, shim, destruction_listener);
 
-    {
-        if (auto mir_buffer = shim->associated_buffer.lock()) {
-            std::lock_guard <std::mutex> lock{*shim->mutex};
-            mir_buffer->buffer = nullptr;
-        }
+    if (auto client_buffer = shim->client_buffer.lock()) {
+        std::lock_guard <std::mutex> lock{client_buffer->mutex};
+        client_buffer->buffer = nullptr;
     }
 
     delete shim;
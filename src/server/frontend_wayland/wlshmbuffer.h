@@ -22,6 +22,7 @@
 
 #include <mir/graphics/buffer_basic.h>
 #include <mir/renderer/gl/texture_source.h>
+#include <mir/renderer/gl/incremental_texture_source.h>
 #include <mir/renderer/sw/pixel_source.h>
 
 #include <wayland-server-core.h>
@@ -32,13 +33,25 @@
 
 namespace mir
 {
+class Executor;
+
 namespace frontend
 {
 
+/**
+ * A graphics::Buffer reading directly from the client's wl_shm_pool.
+ *
+ * The pixels are not copied out of the pool when the buffer is attached;
+ * readers access the pool mapping (guarded against the client truncating
+ * it). Each commit gets a WlShmBuffer of its own, and the wl_buffer is only
+ * released back to the client once the last of those attached from it is
+ * destroyed, after the last upload.
+ */
 class WlShmBuffer :
     public graphics::BufferBasic,
     public graphics::NativeBufferBase,
     public renderer::gl::TextureSource,
+    public renderer::gl::IncrementalTextureSource,
     public renderer::software::PixelSource
 {
 public:
@@ -46,6 +59,7 @@ public:
 
     static std::shared_ptr <graphics::Buffer> mir_buffer_from_wl_buffer(
         wl_resource *buffer,
+        std::shared_ptr<Executor> const& wayland_executor,
         std::function<void()> &&on_consumed);
 
     std::shared_ptr <graphics::NativeBuffer> native_buffer_handle() const override;
@@ -58,6 +72,8 @@ public:
 
     void gl_bind_to_texture() override;
 
+    void update_texture(geometry::Rectangles const& damage) override;
+
     void bind() override;
 
     void secure_for_render() override;
@@ -69,30 +85,27 @@ public:
     geometry::Stride stride() const override;
 
 private:
+    /// The state shared by every WlShmBuffer attached from one wl_buffer
+    class ClientBuffer;
+
     WlShmBuffer(
-        wl_resource *buffer,
+        std::shared_ptr<ClientBuffer> const& client_buffer,
         std::function<void()> &&on_consumed);
 
     static void on_buffer_destroyed(wl_listener *listener, void *);
 
     struct DestructionShim
     {
-        std::shared_ptr <std::mutex> const mutex = std::make_shared<std::mutex>();
-        std::weak_ptr <WlShmBuffer> associated_buffer;
+        std::weak_ptr<ClientBuffer> client_buffer;
         wl_listener destruction_listener;
     };
 
-    std::shared_ptr <std::mutex> buffer_mutex;
-
-    wl_shm_buffer *buffer;
-    wl_resource *const resource;
+    std::shared_ptr<ClientBuffer> const client_buffer;
 
     geometry::Size const size_;
     geometry::Stride const stride_;
     MirPixelFormat const format_;
 
-    std::unique_ptr<uint8_t[]> const data;
-
     bool consumed;
     std::function<void()> on_consumed;
 };
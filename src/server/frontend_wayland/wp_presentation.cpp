@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "wp_presentation.h"
+
+#include "wl_surface.h"
+#include "deleted_for_resource.h"
+
+#include <time.h>
+
+namespace mf = mir::frontend;
+
+mf::WpPresentation::WpPresentation(struct wl_display* display)
+    : Presentation(display, 1)
+{
+}
+
+void mf::WpPresentation::bind(struct wl_client* /*client*/, struct wl_resource* resource)
+{
+    // Frames timed by their output, and those timed by std::chrono::steady_clock, are on CLOCK_MONOTONIC
+    send_clock_id_event(resource, CLOCK_MONOTONIC);
+}
+
+void mf::WpPresentation::destroy(struct wl_client* /*client*/, struct wl_resource* resource)
+{
+    destroy_wayland_object(resource);
+}
+
+void mf::WpPresentation::feedback(
+    struct wl_client* client,
+    struct wl_resource* resource,
+    struct wl_resource* surface,
+    uint32_t callback)
+{
+    WlSurface::from(surface)->add_presentation_feedback(
+        std::make_shared<WpPresentationFeedback>(client, resource, callback));
+}
+
+mf::WpPresentationFeedback::WpPresentationFeedback(struct wl_client* client, struct wl_resource* parent, uint32_t id)
+    : PresentationFeedback(client, parent, id),
+      destroyed{deleted_flag_for_resource(resource)}
+{
+}
+
+void mf::WpPresentationFeedback::presented(compositor::PresentedFrame const& frame)
+{
+    if (*destroyed)
+        return;
+
+    auto const since_epoch = frame.frame.ust.nanoseconds;
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    auto const nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+    uint64_t const tv_sec = seconds.count();
+    // An msc of 0 means the output has no frame counter, for which the protocol wants a seq of 0
+    uint64_t const seq = frame.frame.msc;
+    uint32_t const flags = frame.frame.vsync ?
+        Kind::vsync | Kind::hw_clock | Kind::hw_completion :
+        0;
+
+    send_presented_event(
+        tv_sec >> 32,
+        tv_sec & 0xffffffff,
+        nanoseconds.count(),
+        frame.refresh.count(),
+        seq >> 32,
+        seq & 0xffffffff,
+        flags);
+    destroy_wayland_object();
+}
+
+void mf::WpPresentationFeedback::discarded()
+{
+    if (*destroyed)
+        return;
+
+    send_discarded_event();
+    destroy_wayland_object();
+}
+
+mf::PresentationFeedbacks::~PresentationFeedbacks()
+{
+    for (auto& content : submitted)
+        discard(content.feedbacks);
+}
+
+void mf::PresentationFeedbacks::commit(
+    Feedbacks const& requested,
+    std::experimental::optional<wl_resource*> const& buffer,
+    uint64_t submission)
+{
+    auto new_feedbacks = requested;
+
+    if (buffer && *buffer)
+    {
+        // The buffer that's waiting to be shown may still make it to the screen before
+        // this one does, so its feedback stays until we know which was shown
+        submitted.push_back({submission, std::move(new_feedbacks)});
+        return;
+    }
+
+    if (buffer)
+    {
+        for (auto& content : submitted)
+            discard(content.feedbacks);
+        submitted.clear();
+    }
+    discard(new_feedbacks);
+}
+
+void mf::PresentationFeedbacks::frame_presented(
+    compositor::PresentedFrame const& frame,
+    bool on_screen,
+    uint64_t shown)
+{
+    // A throttled frame paces the client, but showed none of its content
+    if (!on_screen)
+        return;
+
+    while (!submitted.empty() && submitted.front().submission <= shown)
+    {
+        auto& content = submitted.front();
+
+        // Anything older than what was shown was replaced before it was composited
+        if (content.submission == shown)
+        {
+            for (auto const& feedback : content.feedbacks)
+                feedback->presented(frame);
+            content.feedbacks.clear();
+        }
+        else
+        {
+            discard(content.feedbacks);
+        }
+
+        submitted.pop_front();
+    }
+}
+
+void mf::PresentationFeedbacks::discard(Feedbacks& feedbacks)
+{
+    for (auto const& feedback : feedbacks)
+        feedback->discarded();
+    feedbacks.clear();
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_FRONTEND_WP_PRESENTATION_H
+#define MIR_FRONTEND_WP_PRESENTATION_H
+
+#include "presentation-time_wrapper.h"
+
+#include "mir/compositor/presented_frame.h"
+
+#include <experimental/optional>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+
+/// Reports when committed content reached the screen (the "presentation-time" protocol)
+class WpPresentation : public wayland::Presentation
+{
+public:
+    WpPresentation(struct wl_display* display);
+
+private:
+    void bind(struct wl_client* client, struct wl_resource* resource) override;
+    void destroy(struct wl_client* client, struct wl_resource* resource) override;
+    void feedback(struct wl_client* client, struct wl_resource* resource, struct wl_resource* surface,
+                  uint32_t callback) override;
+};
+
+class WpPresentationFeedback : public wayland::PresentationFeedback
+{
+public:
+    WpPresentationFeedback(struct wl_client* client, struct wl_resource* parent, uint32_t id);
+
+    /// Both of these deliver the (only) outcome of the feedback and destroy the protocol object
+    ///@{
+    void presented(compositor::PresentedFrame const& frame);
+    void discarded();
+    ///@}
+
+private:
+    std::shared_ptr<bool> const destroyed;
+};
+
+/**
+ * The presentation feedback a surface owes for the content it has submitted. Feedback is for
+ * a particular content update, so it is presented when a frame first shows that content, or
+ * discarded if later content is shown first; anything still outstanding when this is destroyed
+ * is discarded.
+ */
+class PresentationFeedbacks
+{
+public:
+    using Feedbacks = std::vector<std::shared_ptr<WpPresentationFeedback>>;
+
+    PresentationFeedbacks() = default;
+    ~PresentationFeedbacks();
+
+    /**
+     * A commit of \a requested feedbacks. \a buffer is as in WlSurfaceState: a commit without
+     * a new (non-null) buffer has no content of its own to be shown, and a null buffer removes
+     * whatever was waiting to be shown. A new buffer was submitted to the surface's stream as
+     * number \a submission.
+     */
+    void commit(
+        Feedbacks const& requested,
+        std::experimental::optional<wl_resource*> const& buffer,
+        uint64_t submission);
+
+    /**
+     * A frame showed the stream's submission number \a shown when \a on_screen; otherwise
+     * the frame was throttled and showed nothing.
+     */
+    void frame_presented(compositor::PresentedFrame const& frame, bool on_screen, uint64_t shown);
+
+    static void discard(Feedbacks& feedbacks);
+
+private:
+    PresentationFeedbacks(PresentationFeedbacks const&) = delete;
+    PresentationFeedbacks& operator=(PresentationFeedbacks const&) = delete;
+
+    struct Submitted
+    {
+        uint64_t submission;
+        Feedbacks feedbacks;
+    };
+    std::deque<Submitted> submitted; // Oldest first
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WP_PRESENTATION_H
@@ -0,0 +1,247 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "wp_viewporter.h"
+
+#include "wl_surface.h"
+
+#include <cmath>
+#include <sstream>
+#include <memory>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class WpViewport : public wayland::Viewport
+{
+public:
+    WpViewport(struct wl_client* client, struct wl_resource* parent, uint32_t id, WlSurface* surface);
+    ~WpViewport();
+
+private:
+    void destroy() override;
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    bool check_surface();
+
+    WlSurface* const surface;
+    std::shared_ptr<bool> const surface_destroyed;
+};
+}
+}
+
+mf::WpViewporter::WpViewporter(struct wl_display* display)
+    : Viewporter(display, 1)
+{
+}
+
+void mf::WpViewporter::destroy(struct wl_client* /*client*/, struct wl_resource* resource)
+{
+    destroy_wayland_object(resource);
+}
+
+void mf::WpViewporter::get_viewport(
+    struct wl_client* client,
+    struct wl_resource* resource,
+    uint32_t id,
+    struct wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+
+    if (wl_surface->viewport())
+    {
+        wl_resource_post_error(resource, Error::viewport_exists, "Surface already has a viewport");
+        return;
+    }
+
+    new WpViewport{client, resource, id, wl_surface};
+}
+
+mf::WpViewport::WpViewport(struct wl_client* client, struct wl_resource* parent, uint32_t id, WlSurface* surface)
+    : Viewport(client, parent, id),
+      surface{surface},
+      surface_destroyed{surface->destroyed_flag()}
+{
+    surface->set_viewport(resource);
+}
+
+mf::WpViewport::~WpViewport()
+{
+    if (*surface_destroyed)
+        return;
+
+    // Dropping the viewport removes its state on the surface's next commit
+    surface->set_viewport(nullptr);
+    surface->set_pending_viewport_source(std::experimental::nullopt);
+    surface->set_pending_viewport_destination(std::experimental::nullopt);
+}
+
+void mf::WpViewport::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WpViewport::set_source(double x, double y, double width, double height)
+{
+    if (!check_surface())
+        return;
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        surface->set_pending_viewport_source(std::experimental::nullopt);
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        wl_resource_post_error(
+            resource, Error::bad_value,
+            "Invalid viewport source rectangle %fx%f+%f+%f", width, height, x, y);
+        return;
+    }
+
+    surface->set_pending_viewport_source(SurfaceViewport::Source{x, y, width, height});
+}
+
+void mf::WpViewport::set_destination(int32_t width, int32_t height)
+{
+    if (!check_surface())
+        return;
+
+    if (width == -1 && height == -1)
+    {
+        surface->set_pending_viewport_destination(std::experimental::nullopt);
+        return;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        wl_resource_post_error(
+            resource, Error::bad_value,
+            "Invalid viewport destination size %dx%d", width, height);
+        return;
+    }
+
+    surface->set_pending_viewport_destination(geom::Size{width, height});
+}
+
+bool mf::WpViewport::check_surface()
+{
+    if (*surface_destroyed)
+    {
+        wl_resource_post_error(resource, Error::no_surface, "The viewport's wl_surface has been destroyed");
+        return false;
+    }
+    return true;
+}
+
+void mf::SurfaceViewport::commit(
+    std::experimental::optional<std::experimental::optional<Source>> const& source,
+    std::experimental::optional<std::experimental::optional<geom::Size>> const& destination)
+{
+    if (source)
+        this->source = source.value();
+
+    if (destination)
+        destination_ = destination.value();
+}
+
+auto mf::SurfaceViewport::error(std::experimental::optional<geom::Size> const& buffer_size) const
+    -> std::experimental::optional<Error>
+{
+    if (!source)
+        return std::experimental::nullopt;
+
+    auto const& src = source.value();
+
+    if (!destination_ && (std::trunc(src.width) != src.width || std::trunc(src.height) != src.height))
+    {
+        std::ostringstream message;
+        message << "Viewport source size " << src.width << "x" << src.height
+                << " is not an integer and there is no destination size";
+        return Error{wayland::Viewport::Error::bad_size, message.str()};
+    }
+
+    if (buffer_size &&
+        (src.x + src.width > buffer_size.value().width.as_int() ||
+         src.y + src.height > buffer_size.value().height.as_int()))
+    {
+        std::ostringstream message;
+        message << "Viewport source rectangle is outside the "
+                << buffer_size.value().width << "x" << buffer_size.value().height << " buffer";
+        return Error{wayland::Viewport::Error::out_of_buffer, message.str()};
+    }
+
+    return std::experimental::nullopt;
+}
+
+auto mf::SurfaceViewport::source_bounds() const -> std::experimental::optional<geom::Rectangle>
+{
+    if (!source)
+        return std::experimental::nullopt;
+
+    auto const& src = source.value();
+    auto const left = static_cast<int>(std::floor(src.x));
+    auto const top = static_cast<int>(std::floor(src.y));
+    auto const right = static_cast<int>(std::ceil(src.x + src.width));
+    auto const bottom = static_cast<int>(std::ceil(src.y + src.height));
+
+    return geom::Rectangle{{left, top}, {right - left, bottom - top}};
+}
+
+auto mf::SurfaceViewport::destination() const -> std::experimental::optional<geom::Size>
+{
+    if (destination_)
+        return destination_;
+
+    // Without a destination the source is shown unscaled (error() insists on its size being whole)
+    if (source)
+        return geom::Size{std::lround(source.value().width), std::lround(source.value().height)};
+
+    return std::experimental::nullopt;
+}
+
+auto mf::SurfaceViewport::surface_size(geom::Size const& buffer_size) const -> geom::Size
+{
+    return destination().value_or(buffer_size);
+}
+
+auto mf::SurfaceViewport::damage_in_buffer(
+    std::vector<geom::Rectangle> const& buffer_damage,
+    std::vector<geom::Rectangle> const& surface_damage,
+    geom::Size const& buffer_size) const -> std::vector<geom::Rectangle>
+{
+    auto damage = buffer_damage;
+
+    if (!source && !destination_)
+    {
+        // Without a viewport surface coordinates are buffer coordinates
+        damage.insert(end(damage), begin(surface_damage), end(surface_damage));
+    }
+    else if (!surface_damage.empty())
+    {
+        // Scaled content is redrawn in full anyway, so don't bother mapping the damage back
+        damage.push_back({{0, 0}, buffer_size});
+    }
+
+    return damage;
+}
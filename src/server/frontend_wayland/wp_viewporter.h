@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_FRONTEND_WP_VIEWPORTER_H
+#define MIR_FRONTEND_WP_VIEWPORTER_H
+
+#include "viewporter_wrapper.h"
+
+#include "mir/geometry/rectangle.h"
+
+#include <experimental/optional>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+
+/// Lets clients crop and scale the contents of their surfaces (the "viewporter" protocol)
+class WpViewporter : public wayland::Viewporter
+{
+public:
+    WpViewporter(struct wl_display* display);
+
+private:
+    void destroy(struct wl_client* client, struct wl_resource* resource) override;
+    void get_viewport(struct wl_client* client, struct wl_resource* resource, uint32_t id,
+                      struct wl_resource* surface) override;
+};
+
+/**
+ * A surface's committed viewport: the part of its buffer it shows, and the size it shows it at.
+ * Either part may be unset.
+ */
+class SurfaceViewport
+{
+public:
+    /// A source rectangle in buffer coordinates, exactly as the client gave it
+    struct Source
+    {
+        double x, y, width, height;
+    };
+
+    /// Why the committed state can't be applied
+    struct Error
+    {
+        uint32_t code; ///< A wayland::Viewport::Error
+        std::string message;
+    };
+
+    /// A commit of the pending state; as in WlSurfaceState, an outer nullopt leaves that part unchanged
+    void commit(
+        std::experimental::optional<std::experimental::optional<Source>> const& source,
+        std::experimental::optional<std::experimental::optional<geometry::Size>> const& destination);
+
+    /// Checks the committed state, against the buffer too if there is one
+    auto error(std::experimental::optional<geometry::Size> const& buffer_size) const
+        -> std::experimental::optional<Error>;
+
+    /// Our buffers are sampled on whole pixels, so this is the smallest pixel-aligned rectangle containing the source
+    auto source_bounds() const -> std::experimental::optional<geometry::Rectangle>;
+    /// The size the source is shown at, if the viewport changes it
+    auto destination() const -> std::experimental::optional<geometry::Size>;
+
+    /// The size, in surface coordinates, of a surface showing a buffer of \a buffer_size
+    auto surface_size(geometry::Size const& buffer_size) const -> geometry::Size;
+
+    /// Damage in buffer coordinates, given what the client reported in each coordinate space
+    auto damage_in_buffer(
+        std::vector<geometry::Rectangle> const& buffer_damage,
+        std::vector<geometry::Rectangle> const& surface_damage,
+        geometry::Size const& buffer_size) const -> std::vector<geometry::Rectangle>;
+
+private:
+    std::experimental::optional<Source> source;
+    std::experimental::optional<geometry::Size> destination_;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WP_VIEWPORTER_H
@@ -197,7 +197,8 @@ mir::DefaultServerConfiguration::the_display()
                     return std::make_shared<mg::offscreen::Display>(
                         egl_access->egl_native_display(),
                         the_display_configuration_policy(),
-                        the_display_report());
+                        the_display_report(),
+                        the_options()->get<std::string>(options::renderer_opt) == "software");
                 }
                 else
                 {
@@ -73,7 +73,10 @@ mgo::detail::EGLDisplayHandle::~EGLDisplayHandle() noexcept
         eglTerminate(egl_display);
 }
 
-mgo::detail::DisplaySyncGroup::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer> output) :
+mgo::detail::DisplaySyncGroup::DisplaySyncGroup(
+    DisplayConfigurationOutputId output_id,
+    std::unique_ptr<mg::DisplayBuffer> output) :
+    output_id{output_id},
     output(std::move(output))
 {
 }
@@ -86,6 +89,12 @@ void mgo::detail::DisplaySyncGroup::for_each_display_buffer(
 
 void mgo::detail::DisplaySyncGroup::post()
 {
+    last_frame_.increment_now();
+}
+
+mg::Frame mgo::detail::DisplaySyncGroup::last_frame() const
+{
+    return last_frame_.load();
 }
 
 std::chrono::milliseconds
@@ -97,8 +106,10 @@ mgo::detail::DisplaySyncGroup::recommended_sleep() const
 mgo::Display::Display(
     EGLNativeDisplayType egl_native_display,
     std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-    std::shared_ptr<DisplayReport> const&)
-    : egl_display{create_and_initialize_display(egl_native_display)},
+    std::shared_ptr<DisplayReport> const&,
+    bool cpu_only)
+    : cpu_only{cpu_only},
+      egl_display{create_and_initialize_display(egl_native_display)},
       egl_context_shared{egl_display, EGL_NO_CONTEXT},
       current_display_configuration{geom::Size{1024,768}}
 {
@@ -150,13 +161,21 @@ void mgo::Display::configure(mg::DisplayConfiguration const& conf)
         {
             if (output.connected && output.preferred_mode_index < output.modes.size())
             {
-                eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
-                auto raw_db = new mgo::DisplayBuffer{
-                    SurfacelessEGLContext{egl_display, egl_context_shared},
-                    output.extents()};
+                std::unique_ptr<mg::DisplayBuffer> db;
+                if (cpu_only)
+                {
+                    db = std::make_unique<mgo::CPUDisplayBuffer>(output.extents());
+                }
+                else
+                {
+                    eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+                    db = std::make_unique<mgo::DisplayBuffer>(
+                        SurfacelessEGLContext{egl_display, egl_context_shared},
+                        output.extents());
+                }
 
                 display_sync_groups.emplace_back(
-                    new mgo::detail::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer>(raw_db)));
+                    new mgo::detail::DisplaySyncGroup(output.id, std::move(db)));
             }
         });
 }
@@ -198,8 +217,16 @@ mg::NativeDisplay* mgo::Display::native_display()
     return this;
 }
 
-mg::Frame mgo::Display::last_frame_on(unsigned) const
+mg::Frame mgo::Display::last_frame_on(unsigned output_id) const
 {
+    std::lock_guard<std::mutex> lock{configuration_mutex};
+
+    for (auto const& group : display_sync_groups)
+    {
+        if (group->output_id.as_value() == static_cast<int>(output_id))
+            return group->last_frame();
+    }
+
     return {};
 }
 
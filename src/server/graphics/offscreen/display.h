@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_OFFSCREEN_DISPLAY_H_
 
 #include "mir/graphics/display.h"
+#include "mir/graphics/atomic_frame.h"
 #include "display_configuration.h"
 #include "mir/graphics/surfaceless_egl_context.h"
 #include "mir/renderer/gl/context_source.h"
@@ -62,12 +63,17 @@ private:
 class DisplaySyncGroup : public graphics::DisplaySyncGroup
 {
 public:
-    DisplaySyncGroup(std::unique_ptr<DisplayBuffer> output);
+    DisplaySyncGroup(DisplayConfigurationOutputId output_id, std::unique_ptr<DisplayBuffer> output);
     void for_each_display_buffer(std::function<void(DisplayBuffer&)> const&) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+
+    DisplayConfigurationOutputId const output_id;
+    /// There's no vsync to count, so each post() counts as a frame shown when it happens
+    Frame last_frame() const;
 private:
     std::unique_ptr<DisplayBuffer> const output;
+    AtomicFrame last_frame_;
 };
 
 }
@@ -77,9 +83,11 @@ class Display : public graphics::Display,
                 public renderer::gl::ContextSource
 {
 public:
+    /// With \a cpu_only, outputs are only drawn into by the software renderer and don't go through GL
     Display(EGLNativeDisplayType egl_native_display,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-            std::shared_ptr<DisplayReport> const& listener);
+            std::shared_ptr<DisplayReport> const& listener,
+            bool cpu_only);
     ~Display() noexcept;
 
     void for_each_display_sync_group(std::function<void(DisplaySyncGroup&)> const& f) override;
@@ -108,11 +116,12 @@ public:
     std::unique_ptr<renderer::gl::Context> create_gl_context() const override;
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
 private:
+    bool const cpu_only;
     detail::EGLDisplayHandle const egl_display;
     SurfacelessEGLContext const egl_context_shared;
     mutable std::mutex configuration_mutex;
     DisplayConfiguration current_display_configuration;
-    std::vector<std::unique_ptr<DisplaySyncGroup>> display_sync_groups;
+    std::vector<std::unique_ptr<detail::DisplaySyncGroup>> display_sync_groups;
 };
 
 }
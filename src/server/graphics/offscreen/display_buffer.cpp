@@ -46,7 +46,7 @@ public:
 }
 
 mgo::detail::GLFramebufferObject::GLFramebufferObject(geom::Size const& size)
-    : size{size}, color_renderbuffer{0}, depth_renderbuffer{0}, fbo{0}
+    : size{size}, color_renderbuffer{0}, color_texture{0}, depth_renderbuffer{0}, fbo{0}
 {
     /* Save previous FBO state */
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &old_fbo);
@@ -99,6 +99,8 @@ mgo::detail::GLFramebufferObject::~GLFramebufferObject()
         glDeleteFramebuffers(1, &fbo);
     if (color_renderbuffer)
         glDeleteRenderbuffers(1, &color_renderbuffer);
+    if (color_texture)
+        glDeleteTextures(1, &color_texture);
     if (depth_renderbuffer)
         glDeleteRenderbuffers(1, &depth_renderbuffer);
 }
@@ -116,19 +118,112 @@ void mgo::detail::GLFramebufferObject::unbind() const
                old_viewport[2], old_viewport[3]);
 }
 
-mgo::DisplayBuffer::DisplayBuffer(SurfacelessEGLContext egl_context,
-                                  geom::Rectangle const& area)
-    : egl_context{std::move(egl_context)},
-      fbo{area.size},
-      area(area)
+void mgo::detail::GLFramebufferObject::upload(unsigned char const* pixels, geom::Region const& damage)
+{
+    auto const width = size.width.as_int();
+    auto const height = size.height.as_int();
+
+    if (!color_texture)
+    {
+        /* The CPU can't write into a renderbuffer, so attach a texture in its place */
+        glGenTextures(1, &color_texture);
+        glBindTexture(GL_TEXTURE_2D, color_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        auto const fbo_raii = mir::raii::paired_calls(
+            [this] { glBindFramebuffer(GL_FRAMEBUFFER, fbo); },
+            [this] { glBindFramebuffer(GL_FRAMEBUFFER, old_fbo); });
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, color_texture, 0);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            BOOST_THROW_EXCEPTION(std::runtime_error("Failed to attach texture to FBO"));
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, color_texture);
+    }
+
+    /*
+     * GL rows go bottom up, so flip the rows to match what GL rendering leaves.
+     * Each band of the damage shares its rows, so we upload the span it covers.
+     */
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    auto band = damage.begin();
+    while (band != damage.end())
+    {
+        auto const top = band->top_left.y.as_int();
+        auto const bottom = band->bottom_right().y.as_int();
+        auto const left = band->top_left.x.as_int();
+        auto right = band->bottom_right().x.as_int();
+        for (++band; band != damage.end() && band->top_left.y.as_int() == top; ++band)
+            right = band->bottom_right().x.as_int();
+
+        for (auto row = top; row != bottom; ++row)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, left, height - 1 - row, right - left, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, pixels + (row * width + left) * 4);
+        }
+    }
+}
+
+mgo::CPUDisplayBuffer::CPUDisplayBuffer(geom::Rectangle const& area)
+    : area(area)
 {
 }
 
-geom::Rectangle mgo::DisplayBuffer::view_area() const
+geom::Rectangle mgo::CPUDisplayBuffer::view_area() const
 {
     return area;
 }
 
+unsigned char* mgo::CPUDisplayBuffer::map_for_write()
+{
+    if (pixels.empty())
+        pixels.resize(stride().as_int() * area.size.height.as_int());
+
+    return pixels.data();
+}
+
+geom::Size mgo::CPUDisplayBuffer::size() const
+{
+    return area.size;
+}
+
+geom::Stride mgo::CPUDisplayBuffer::stride() const
+{
+    return geom::Stride{area.size.width.as_int() * MIR_BYTES_PER_PIXEL(pixel_format())};
+}
+
+MirPixelFormat mgo::CPUDisplayBuffer::pixel_format() const
+{
+    // Red in the lowest byte, which is what GL_RGBA and GL_UNSIGNED_BYTE upload
+    return mir_pixel_format_xbgr_8888;
+}
+
+int mgo::CPUDisplayBuffer::buffer_age() const
+{
+    return age;
+}
+
+void mgo::CPUDisplayBuffer::swap_buffers(geom::Region const&)
+{
+    // The one buffer we have now holds the frame just drawn
+    age = 1;
+}
+
+mgo::DisplayBuffer::DisplayBuffer(SurfacelessEGLContext egl_context,
+                                  geom::Rectangle const& area)
+    : CPUDisplayBuffer{area},
+      egl_context{std::move(egl_context)},
+      fbo{area.size}
+{
+}
+
 void mgo::DisplayBuffer::make_current()
 {
     egl_context.make_current();
@@ -150,17 +245,28 @@ void mgo::DisplayBuffer::swap_buffers()
     glFinish();
 }
 
-bool mgo::DisplayBuffer::overlay(RenderableList const&)
+void mgo::DisplayBuffer::swap_buffers(geom::Region const& damage)
+{
+    egl_context.make_current();
+    fbo.upload(pixels.data(), damage);
+    // glTexSubImage2D() has copied the pixels, and nothing waits on the frame
+    glFlush();
+    egl_context.release_current();
+
+    CPUDisplayBuffer::swap_buffers(damage);
+}
+
+bool mgo::CPUDisplayBuffer::overlay(RenderableList const&)
 {
     return false;
 }
 
-glm::mat2 mgo::DisplayBuffer::transformation() const
+glm::mat2 mgo::CPUDisplayBuffer::transformation() const
 {
     return glm::mat2(1);
 }
 
-mg::NativeDisplayBuffer* mgo::DisplayBuffer::native_display_buffer()
+mg::NativeDisplayBuffer* mgo::CPUDisplayBuffer::native_display_buffer()
 {
     return this;
 }
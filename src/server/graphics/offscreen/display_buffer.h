@@ -24,10 +24,14 @@
 #include "mir/graphics/display_buffer.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 
 #include <EGL/egl.h>
 
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -45,38 +49,73 @@ public:
     ~GLFramebufferObject();
     void bind() const;
     void unbind() const;
+    /// Replaces \a damage with that of \a pixels, tightly packed RGBA rows with the top row first
+    void upload(unsigned char const* pixels, geometry::Region const& damage);
 
 private:
     geometry::Size const size;
     int old_fbo;
     int old_viewport[4];
     unsigned int color_renderbuffer;
+    unsigned int color_texture;
     unsigned int depth_renderbuffer;
     unsigned int fbo;
 };
 
 }
 
-class DisplayBuffer : public graphics::DisplayBuffer,
-                      public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+/**
+ * Drawn into by the software renderer, with the CPU alone.
+ */
+class CPUDisplayBuffer : public graphics::DisplayBuffer,
+                         public graphics::NativeDisplayBuffer,
+                         public renderer::software::RenderTarget
 {
 public:
-    DisplayBuffer(SurfacelessEGLContext egl_context,
-                  geometry::Rectangle const& area);
+    CPUDisplayBuffer(geometry::Rectangle const& area);
 
     geometry::Rectangle view_area() const override;
     bool overlay(RenderableList const& renderlist) override;
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
+
+    // renderer::software::RenderTarget
+    unsigned char* map_for_write() override;
+    geometry::Size size() const override;
+    geometry::Stride stride() const override;
+    MirPixelFormat pixel_format() const override;
+    int buffer_age() const override;
+    void swap_buffers(geometry::Region const& damage) override;
+
+protected:
+    geometry::Rectangle const area;
+    std::vector<unsigned char> pixels;
+    int age{0};
+};
+
+/**
+ * Can be drawn into either with GL or, by the software renderer, with the CPU.
+ * What the CPU draws is uploaded into the framebuffer GL draws into.
+ */
+class DisplayBuffer : public CPUDisplayBuffer,
+                      public renderer::gl::RenderTarget
+{
+public:
+    DisplayBuffer(SurfacelessEGLContext egl_context,
+                  geometry::Rectangle const& area);
+
+    // renderer::gl::RenderTarget
     void make_current() override;
     void bind() override;
     void release_current() override;
     void swap_buffers() override;
+
+    // renderer::software::RenderTarget
+    void swap_buffers(geometry::Region const& damage) override;
+
 private:
     SurfacelessEGLContext const egl_context;
-    detail::GLFramebufferObject const fbo;
-    geometry::Rectangle const area;
+    detail::GLFramebufferObject fbo;
 };
 
 }
@@ -70,6 +70,11 @@ public:
         return 1;
     }
 
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override
+    {
+        return geom::Rectangles{{{0, 0}, buffer_->size()}};
+    }
+
     mg::Renderable::ID id() const override
     {
         return this;
@@ -86,6 +91,11 @@ public:
         return {position, buffer_->size()};
     }
 
+    geom::Rectangle src_bounds() const override
+    {
+        return {{0, 0}, buffer_->size()};
+    }
+
     float alpha() const override
     {
         return 1.0;
@@ -101,6 +111,11 @@ public:
         return true;
     }
 
+    geom::Region opaque_region() const override
+    {
+        return {};
+    }
+
     void move_to(geom::Point new_position)
     {
         std::lock_guard<std::mutex> lock{position_mutex};
@@ -0,0 +1,340 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "coalescing_dispatcher.h"
+
+#include "mir/time/alarm_factory.h"
+#include "mir/time/alarm.h"
+#include "mir/time/clock.h"
+#include "mir/events/event_builders.h"
+#include "mir_toolkit/mir_cookie.h"
+
+#include <boost/throw_exception.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mt = mir::time;
+
+namespace
+{
+// Touch samples closer together than this give too noisy a velocity to predict from
+std::chrono::nanoseconds const min_resample_gap{std::chrono::milliseconds{2}};
+// Never predict a contact further ahead than this
+std::chrono::nanoseconds const max_prediction{std::chrono::milliseconds{8}};
+
+std::vector<uint8_t> cookie_of(MirInputEvent const* event)
+{
+    std::vector<uint8_t> cookie_data;
+    if (mir_input_event_has_cookie(event))
+    {
+        auto cookie = mir_input_event_get_cookie(event);
+        cookie_data.resize(mir_cookie_buffer_size(cookie));
+        mir_cookie_to_buffer(cookie, cookie_data.data(), mir_cookie_buffer_size(cookie));
+        mir_cookie_release(cookie);
+    }
+    return cookie_data;
+}
+
+std::vector<mev::ContactState> contacts_of(MirTouchEvent const* event)
+{
+    std::vector<mev::ContactState> contacts;
+    contacts.reserve(mir_touch_event_point_count(event));
+
+    for (size_t i = 0, count = mir_touch_event_point_count(event); i != count; ++i)
+    {
+        contacts.push_back(mev::ContactState{
+                           mir_touch_event_id(event, i),
+                           mir_touch_event_action(event, i),
+                           mir_touch_event_tooltype(event, i),
+                           mir_touch_event_axis_value(event, i, mir_touch_axis_x),
+                           mir_touch_event_axis_value(event, i, mir_touch_axis_y),
+                           mir_touch_event_axis_value(event, i, mir_touch_axis_pressure),
+                           mir_touch_event_axis_value(event, i, mir_touch_axis_touch_major),
+                           mir_touch_event_axis_value(event, i, mir_touch_axis_touch_minor),
+                           0.0f
+                           });
+    }
+
+    return contacts;
+}
+
+bool same_contacts(std::vector<mev::ContactState> const& a, std::vector<mev::ContactState> const& b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+        [](mev::ContactState const& lhs, mev::ContactState const& rhs)
+        {
+            return lhs.touch_id == rhs.touch_id;
+        });
+}
+}
+
+mi::CoalescingDispatcher::CoalescingDispatcher(
+    std::shared_ptr<mi::InputDispatcher> const& next_dispatcher,
+    std::shared_ptr<mt::AlarmFactory> const& factory,
+    std::shared_ptr<mt::Clock> const& clock,
+    mt::Duration frame_interval)
+    : next_dispatcher(next_dispatcher),
+      clock(clock),
+      frame_interval(frame_interval),
+      frame_origin(clock->now()),
+      next_deadline(frame_origin),
+      flush_alarm(factory->create_alarm(
+          [this]()
+          {
+              std::lock_guard<std::recursive_mutex> lock(mutex);
+              // Whatever the client draws in response will be on screen a frame later
+              flush_locked(next_deadline + this->frame_interval);
+          }))
+{
+    if (frame_interval <= mt::Duration::zero())
+        BOOST_THROW_EXCEPTION(std::invalid_argument("Input coalescing needs a positive frame interval"));
+}
+
+bool mi::CoalescingDispatcher::dispatch(std::shared_ptr<MirEvent const> const& event)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    if (mir_event_get_type(event.get()) == mir_event_type_input)
+    {
+        auto const iev = mir_event_get_input_event(event.get());
+        switch (mir_input_event_get_type(iev))
+        {
+        case mir_input_event_type_pointer:
+            if (coalesce_pointer(iev))
+                return true;
+            break;
+        case mir_input_event_type_touch:
+            if (coalesce_touch(iev))
+                return true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    flush_locked({});
+    return next_dispatcher->dispatch(event);
+}
+
+// Returns true if the event has been absorbed into a pending one, that is ::dispatch should not pass it on.
+bool mi::CoalescingDispatcher::coalesce_pointer(MirInputEvent const* event)
+{
+    auto const pev = mir_input_event_get_pointer_event(event);
+    if (mir_pointer_event_action(pev) != mir_pointer_action_motion)
+        return false;
+
+    auto const id = mir_input_event_get_device_id(event);
+    auto const buttons = mir_pointer_event_buttons(pev);
+    auto const modifiers = mir_pointer_event_modifiers(pev);
+
+    auto pending = pending_pointers.find(id);
+    if (pending != pending_pointers.end() &&
+        (pending->second.buttons != buttons || pending->second.modifiers != modifiers))
+    {
+        flush_locked({});
+        pending = pending_pointers.find(id);
+    }
+
+    if (pending == pending_pointers.end())
+    {
+        pending = pending_pointers.insert({id, PendingPointer{
+            {}, {}, modifiers, buttons, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}}).first;
+        pending_order.push_back({id, mir_input_event_type_pointer});
+    }
+
+    auto& merged = pending->second;
+    merged.event_time = std::chrono::nanoseconds{mir_input_event_get_event_time(event)};
+    merged.cookie = cookie_of(event);
+    merged.x = mir_pointer_event_axis_value(pev, mir_pointer_axis_x);
+    merged.y = mir_pointer_event_axis_value(pev, mir_pointer_axis_y);
+    merged.dx += mir_pointer_event_axis_value(pev, mir_pointer_axis_relative_x);
+    merged.dy += mir_pointer_event_axis_value(pev, mir_pointer_axis_relative_y);
+    merged.hscroll += mir_pointer_event_axis_value(pev, mir_pointer_axis_hscroll);
+    merged.vscroll += mir_pointer_event_axis_value(pev, mir_pointer_axis_vscroll);
+
+    schedule_flush_locked();
+    return true;
+}
+
+// Returns true if the event has been absorbed into a pending one, that is ::dispatch should not pass it on.
+bool mi::CoalescingDispatcher::coalesce_touch(MirInputEvent const* event)
+{
+    auto const id = mir_input_event_get_device_id(event);
+    auto contacts = contacts_of(mir_input_event_get_touch_event(event));
+
+    bool const only_moved = std::all_of(contacts.begin(), contacts.end(),
+        [](mev::ContactState const& contact) { return contact.action == mir_touch_action_change; });
+
+    if (!only_moved)
+    {
+        // A contact going down or up ends the motion we can predict from
+        flush_locked({});
+        touch_states.erase(id);
+        return false;
+    }
+
+    auto state = touch_states.find(id);
+    if (state != touch_states.end() && !same_contacts(state->second.latest.contacts, contacts))
+    {
+        if (state->second.pending)
+            flush_locked({});
+        touch_states.erase(id);
+        state = touch_states.end();
+    }
+
+    TouchSample sample{
+        std::chrono::nanoseconds{mir_input_event_get_event_time(event)},
+        cookie_of(event),
+        mir_touch_event_modifiers(mir_input_event_get_touch_event(event)),
+        std::move(contacts)};
+
+    if (state == touch_states.end())
+    {
+        state = touch_states.insert({id, TouchState{{}, std::move(sample), false}}).first;
+    }
+    else
+    {
+        state->second.previous = std::move(state->second.latest);
+        state->second.latest = std::move(sample);
+    }
+
+    if (!state->second.pending)
+    {
+        state->second.pending = true;
+        pending_order.push_back({id, mir_input_event_type_touch});
+    }
+
+    schedule_flush_locked();
+    return true;
+}
+
+void mi::CoalescingDispatcher::schedule_flush_locked()
+{
+    if (flush_alarm->state() == mt::Alarm::pending)
+        return;
+
+    auto const now = clock->now();
+    auto const frames_elapsed = (now - frame_origin) / frame_interval;
+    next_deadline = frame_origin + (frames_elapsed + 1) * frame_interval;
+
+    // Deadlines stay on the frame grid; the alarm only has to get us there (and not early)
+    auto const delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+        next_deadline - now + std::chrono::milliseconds{1} - mt::Duration{1});
+    flush_alarm->reschedule_in(delay);
+}
+
+void mi::CoalescingDispatcher::flush_locked(optional_value<mt::Timestamp> const& display_time)
+{
+    auto const order = std::move(pending_order);
+    pending_order.clear();
+
+    for (auto const& device : order)
+    {
+        if (device.type == mir_input_event_type_pointer)
+        {
+            auto const pending = pending_pointers.find(device.id);
+            if (pending == pending_pointers.end())
+                continue;
+
+            auto const merged = std::move(pending->second);
+            pending_pointers.erase(pending);
+
+            next_dispatcher->dispatch(mev::make_event(
+                device.id, merged.event_time, merged.cookie, merged.modifiers,
+                mir_pointer_action_motion, merged.buttons,
+                merged.x, merged.y,
+                merged.hscroll, merged.vscroll,
+                merged.dx, merged.dy));
+        }
+        else
+        {
+            auto const state = touch_states.find(device.id);
+            if (state == touch_states.end() || !state->second.pending)
+                continue;
+
+            state->second.pending = false;
+            auto const& latest = state->second.latest;
+
+            next_dispatcher->dispatch(mev::make_event(
+                device.id, latest.event_time, latest.cookie, latest.modifiers,
+                resampled_contacts(state->second, display_time)));
+        }
+    }
+}
+
+std::vector<mev::ContactState> mi::CoalescingDispatcher::resampled_contacts(
+    TouchState const& state,
+    optional_value<mt::Timestamp> const& display_time) const
+{
+    auto contacts = state.latest.contacts;
+
+    if (!display_time.is_set() || !state.previous.is_set())
+        return contacts;
+
+    auto const& previous = state.previous.value();
+    auto const gap = state.latest.event_time - previous.event_time;
+    if (gap < min_resample_gap)
+        return contacts;
+
+    // Extrapolate the contacts' last velocity, but not so far that an overshoot shows
+    auto const prediction = std::min({
+        std::chrono::duration_cast<std::chrono::nanoseconds>(display_time.value().time_since_epoch()) -
+            state.latest.event_time,
+        max_prediction,
+        gap / 2});
+
+    if (prediction <= std::chrono::nanoseconds::zero())
+        return contacts;
+
+    auto const alpha = static_cast<float>(prediction.count()) / gap.count();
+
+    for (auto& contact : contacts)
+    {
+        auto const before = std::find_if(previous.contacts.begin(), previous.contacts.end(),
+            [&contact](mev::ContactState const& candidate) { return candidate.touch_id == contact.touch_id; });
+
+        if (before == previous.contacts.end())
+            continue;
+
+        contact.x += (contact.x - before->x) * alpha;
+        contact.y += (contact.y - before->y) * alpha;
+    }
+
+    return contacts;
+}
+
+void mi::CoalescingDispatcher::start()
+{
+    next_dispatcher->start();
+}
+
+void mi::CoalescingDispatcher::stop()
+{
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+
+        pending_order.clear();
+        pending_pointers.clear();
+        touch_states.clear();
+    }
+
+    // Not under the lock: cancelling may wait for a flush that is waiting for it
+    flush_alarm->cancel();
+
+    next_dispatcher->stop();
+}
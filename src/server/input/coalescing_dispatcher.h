@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_INPUT_COALESCING_DISPATCHER_H_
+#define MIR_INPUT_COALESCING_DISPATCHER_H_
+
+#include "mir/input/input_dispatcher.h"
+#include "mir/events/contact_state.h"
+#include "mir/optional_value.h"
+#include "mir/time/types.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace time
+{
+class AlarmFactory;
+class Alarm;
+class Clock;
+}
+namespace input
+{
+/**
+ * Merges the continuous parts of the input stream between frame deadlines.
+ *
+ * Relative pointer motion and scroll events from a device are summed into a
+ * single motion event, and touch contacts that only moved are delivered once
+ * per frame, resampled towards the time the frame they cause is expected to
+ * reach the screen. Any other event (buttons, keys, touch down/up, device
+ * state) first flushes everything pending, so its position in the stream is
+ * exactly where the device put it.
+ */
+class CoalescingDispatcher : public InputDispatcher
+{
+public:
+    CoalescingDispatcher(std::shared_ptr<InputDispatcher> const& next_dispatcher,
+                         std::shared_ptr<time::AlarmFactory> const& factory,
+                         std::shared_ptr<time::Clock> const& clock,
+                         time::Duration frame_interval);
+
+    // InputDispatcher
+    bool dispatch(std::shared_ptr<MirEvent const> const& event) override;
+    void start() override;
+    void stop() override;
+
+private:
+    struct PendingPointer
+    {
+        std::chrono::nanoseconds event_time;
+        std::vector<uint8_t> cookie;
+        MirInputEventModifiers modifiers;
+        MirPointerButtons buttons;
+        float x, y;
+        float dx, dy;
+        float hscroll, vscroll;
+    };
+
+    struct TouchSample
+    {
+        std::chrono::nanoseconds event_time;
+        std::vector<uint8_t> cookie;
+        MirInputEventModifiers modifiers;
+        std::vector<events::ContactState> contacts;
+    };
+
+    struct TouchState
+    {
+        optional_value<TouchSample> previous;
+        TouchSample latest;
+        bool pending;
+    };
+
+    struct PendingDevice
+    {
+        MirInputDeviceId id;
+        MirInputEventType type;
+    };
+
+    bool coalesce_pointer(MirInputEvent const* event);
+    bool coalesce_touch(MirInputEvent const* event);
+    void schedule_flush_locked();
+    /// Dispatches everything pending; touches are resampled if a display time is given
+    void flush_locked(optional_value<time::Timestamp> const& display_time);
+    std::vector<events::ContactState> resampled_contacts(
+        TouchState const& state,
+        optional_value<time::Timestamp> const& display_time) const;
+
+    /// Downstream filters may inject events synchronously, so this needs to be reentrant
+    std::recursive_mutex mutex;
+
+    std::shared_ptr<InputDispatcher> const next_dispatcher;
+    std::shared_ptr<time::Clock> const clock;
+    time::Duration const frame_interval;
+    time::Timestamp const frame_origin;
+    time::Timestamp next_deadline;
+
+    std::vector<PendingDevice> pending_order;
+    std::unordered_map<MirInputDeviceId, PendingPointer> pending_pointers;
+    std::unordered_map<MirInputDeviceId, TouchState> touch_states;
+
+    std::unique_ptr<time::Alarm> const flush_alarm;
+};
+
+}
+}
+
+#endif // MIR_INPUT_COALESCING_DISPATCHER_H_
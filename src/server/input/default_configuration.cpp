@@ -19,6 +19,7 @@
 #include "mir/default_server_configuration.h"
 
 #include "key_repeat_dispatcher.h"
+#include "coalescing_dispatcher.h"
 #include "event_filter_chain_dispatcher.h"
 #include "config_changer.h"
 #include "cursor_controller.h"
@@ -142,8 +143,18 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
             auto enable_repeat = options->get<bool>(options::enable_key_repeat_opt) &&
                 !options->is_set(options::host_socket_opt);
 
+            std::shared_ptr<mi::InputDispatcher> next_dispatcher = the_event_filter_chain_dispatcher();
+
+            auto const coalesce_rate = options->get<int>(options::coalesce_input_opt);
+            if (coalesce_rate > 0)
+            {
+                next_dispatcher = std::make_shared<mi::CoalescingDispatcher>(
+                    next_dispatcher, the_main_loop(), the_clock(),
+                    std::chrono::duration_cast<mir::time::Duration>(std::chrono::seconds{1}) / coalesce_rate);
+            }
+
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                the_event_filter_chain_dispatcher(), the_main_loop(), the_cookie_authority(),
+                next_dispatcher, the_main_loop(), the_cookie_authority(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
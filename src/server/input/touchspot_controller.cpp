@@ -58,6 +58,11 @@ public:
         return 1;
     }
 
+    geom::Rectangles buffer_damage_since(mg::BufferID) const override
+    {
+        return geom::Rectangles{{{0, 0}, buffer_->size()}};
+    }
+
     mg::Renderable::ID id() const override
     {
         return this;
@@ -72,6 +77,11 @@ public:
     {
         return {position, buffer_->size()};
     }
+
+    geom::Rectangle src_bounds() const override
+    {
+        return {{0, 0}, buffer_->size()};
+    }
     
     float alpha() const override
     {
@@ -88,6 +98,11 @@ public:
         return true;
     }
 
+    geom::Region opaque_region() const override
+    {
+        return {};
+    }
+
 // TouchspotRenderable    
     void move_center_to(geom::Point pos)
     {
@@ -19,6 +19,8 @@
 #include "compositor_report.h"
 #include "mir/logging/logger.h"
 
+#include <algorithm>
+
 using namespace mir::time;
 namespace ml = mir::logging;
 namespace mrl = mir::report::logging;
@@ -102,13 +104,16 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_render_time_usec = dn ? dr / dn : 0;
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
+        long worst_frame_usec =
+            std::chrono::duration_cast<std::chrono::microseconds>(worst_frame_time).count();
 
-        char msg[128];
+        char msg[192];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed, "
+                 "worst frame %ld.%03ld ms",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,7 +124,9 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 worst_frame_usec / 1000,
+                 worst_frame_usec % 1000
                  );
 
         logger.log(ml::Severity::informational, msg, component);
@@ -130,6 +137,7 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
     last_reported_latency_sum = latency_sum;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
+    worst_frame_time = std::chrono::nanoseconds::zero();
 }
 
 void mrl::CompositorReport::finished_frame(SubCompositorId id)
@@ -138,6 +146,7 @@ void mrl::CompositorReport::finished_frame(SubCompositorId id)
     auto& inst = instance[id];
 
     auto t = now();
+    inst.worst_frame_time = std::max<std::chrono::nanoseconds>(inst.worst_frame_time, t - inst.start_of_frame);
     inst.total_time_sum += t - inst.end_of_frame;
     inst.end_of_frame = t;
     inst.nframes++;
@@ -65,6 +65,7 @@ private:
         TimePoint total_time_sum;
         TimePoint render_time_sum;
         TimePoint latency_sum;
+        std::chrono::nanoseconds worst_frame_time{0};
         long nframes = 0;
         long nbypassed = 0;
         bool bypassed = true;
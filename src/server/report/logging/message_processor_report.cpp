@@ -20,7 +20,9 @@
 #include "mir/logging/logger.h"
 
 #include <boost/exception/diagnostic_information.hpp>
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 namespace ml = mir::logging;
 namespace mrl = mir::report::logging;
@@ -28,6 +30,14 @@ namespace mrl = mir::report::logging;
 namespace
 {
 char const* const component = "frontend::MessageProcessor";
+
+// Per-method latencies are summarised at most this often
+std::chrono::seconds const latency_report_interval{1};
+
+long as_microseconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
 }
 
 
@@ -88,6 +98,7 @@ void mrl::MessageProcessorReport::completed_invocation(void const* mediator, int
 {
     auto const end = clock->now();
     std::ostringstream out;
+    std::vector<std::string> latency_summary;
 
     {
         std::lock_guard<std::mutex> lock(mutex);
@@ -110,6 +121,8 @@ void mrl::MessageProcessorReport::completed_invocation(void const* mediator, int
 
                 if (!result)
                     out << " (disconnecting)";
+
+                record_latency(pi->second.method, end - pi->second.start, end, latency_summary);
             }
 
             invocations.erase(pi);
@@ -120,6 +133,42 @@ void mrl::MessageProcessorReport::completed_invocation(void const* mediator, int
     }
 
     log->log(ml::Severity::informational, out.str(), component);
+
+    for (auto const& line : latency_summary)
+        log->log(ml::Severity::informational, line, component);
+}
+
+void mrl::MessageProcessorReport::record_latency(
+    std::string const& method,
+    std::chrono::nanoseconds elapsed,
+    time::Timestamp now,
+    std::vector<std::string>& summary)
+{
+    auto& latency = latencies[method];
+    latency.calls += 1;
+    latency.total += elapsed;
+    latency.worst = std::max(latency.worst, elapsed);
+
+    if (!latencies_started)
+    {
+        latencies_started = true;
+        latencies_since = now;
+    }
+    else if (now - latencies_since >= latency_report_interval)
+    {
+        for (auto const& method_latency : latencies)
+        {
+            auto const& l = method_latency.second;
+            std::ostringstream out;
+            out << "method=" << method_latency.first << "(), calls=" << l.calls
+                << ", mean=" << as_microseconds(l.total / l.calls) << "µs"
+                << ", worst=" << as_microseconds(l.worst) << "µs";
+            summary.push_back(out.str());
+        }
+
+        latencies.clear();
+        latencies_since = now;
+    }
 }
 
 void mrl::MessageProcessorReport::unknown_method(void const* mediator, int id, std::string const& method)
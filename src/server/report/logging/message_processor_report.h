@@ -24,7 +24,9 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace mir
 {
@@ -53,6 +55,15 @@ struct MediatorDetails
 };
 
 typedef std::unordered_map<void const*, MediatorDetails> Mediators;
+
+struct MethodLatency
+{
+    long calls;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds worst;
+};
+
+typedef std::unordered_map<std::string, MethodLatency> MethodLatencies;
 }
 
 class MessageProcessorReport : public mir::frontend::MessageProcessorReport
@@ -75,10 +86,20 @@ public:
     ~MessageProcessorReport() noexcept(true);
 
 private:
+    // Requires mutex to be held
+    void record_latency(
+        std::string const& method,
+        std::chrono::nanoseconds elapsed,
+        time::Timestamp now,
+        std::vector<std::string>& summary);
+
     std::shared_ptr<mir::logging::Logger> const log;
     std::shared_ptr<time::Clock> const clock;
     std::mutex mutex;
     detail::Mediators mediators;
+    detail::MethodLatencies latencies;
+    time::Timestamp latencies_since;
+    bool latencies_started{false};
 };
 }
 }
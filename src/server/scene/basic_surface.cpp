@@ -19,6 +19,7 @@
  */
 
 #include "basic_surface.h"
+#include "block_pool.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/shell/input_targeter.h"
@@ -26,6 +27,7 @@
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/pixel_format_utils.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/renderer/sw/pixel_source.h"
 
 #include "mir/scene/scene_report.h"
@@ -153,6 +155,12 @@ void ms::SurfaceObservers::start_drag_and_drop(Surface const* surf, std::vector<
                  { observer->start_drag_and_drop(surf, handle); });
 }
 
+void ms::SurfaceObservers::input_region_set_to(Surface const* surf, std::vector<geometry::Rectangle> const& region)
+{
+    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                 { observer->input_region_set_to(surf, region); });
+}
+
 
 struct ms::CursorStreamImageAdapter
 {
@@ -229,6 +237,8 @@ std::shared_ptr<mc::BufferStream> default_stream(std::list<ms::StreamInfo> const
         return layers.front().stream;
 }
 
+// Enough for a few frames in flight on a few outputs
+std::size_t const max_pooled_snapshots = 16;
 }
 
 ms::BasicSurface::BasicSurface(
@@ -252,7 +262,8 @@ ms::BasicSurface::BasicSurface(
     parent_(parent),
     layers(layers),
     confine_pointer_state_(state),
-    cursor_stream_adapter{std::make_unique<ms::CursorStreamImageAdapter>(*this)}
+    cursor_stream_adapter{std::make_unique<ms::CursorStreamImageAdapter>(*this)},
+    snapshot_pool{std::make_shared<BlockPool>(max_pooled_snapshots)}
 {
     auto callback = [this](auto const& size) { observers.frame_posted(this, 1, size); };
 
@@ -321,9 +332,28 @@ std::shared_ptr<mf::BufferStream> ms::BasicSurface::primary_buffer_stream() cons
 }
 
 void ms::BasicSurface::set_input_region(std::vector<geom::Rectangle> const& input_rectangles)
+{
+    {
+        std::unique_lock<std::mutex> lock(guard);
+        custom_input_rectangles = input_rectangles;
+    }
+    observers.input_region_set_to(this, input_rectangles);
+}
+
+geom::Rectangle ms::BasicSurface::input_area_bounds() const
 {
     std::unique_lock<std::mutex> lock(guard);
-    custom_input_rectangles = input_rectangles;
+
+    // Custom input rectangles are allowed outside the surface (client-side
+    // decorations' shadows, subsurfaces placed beyond their parent)
+    geom::Rectangles area{surface_rect};
+    for (auto const& rectangle : custom_input_rectangles)
+    {
+        if (rectangle.size.width > geom::Width{} && rectangle.size.height > geom::Height{})
+            area.add({surface_rect.top_left + (rectangle.top_left - geom::Point{}), rectangle.size});
+    }
+
+    return area.bounding_rectangle();
 }
 
 void ms::BasicSurface::resize(geom::Size const& desired_size)
@@ -781,6 +811,7 @@ public:
         std::shared_ptr<mc::BufferStream> const& stream,
         void const* compositor_id,
         geom::Rectangle const& position,
+        geom::Rectangle const& src_bounds,
         glm::mat4 const& transform,
         float alpha,
         mg::Renderable::ID id)
@@ -788,6 +819,7 @@ public:
       compositor_id{compositor_id},
       alpha_{alpha},
       screen_position_(position),
+      src_bounds_(src_bounds),
       transformation_(transform),
       id_(id)
     {
@@ -812,6 +844,9 @@ public:
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
+    geom::Rectangle src_bounds() const override
+    { return src_bounds_; }
+
     float alpha() const override
     { return alpha_; }
 
@@ -821,14 +856,37 @@ public:
     bool shaped() const override
     { return mg::contains_alpha(underlying_buffer_stream->pixel_format()); }
 
+    geom::Region opaque_region() const override
+    {
+        if (alpha_ != 1.0f)
+            return {};
+
+        if (!shaped())
+            return geom::Region{screen_position_};
+
+        // The client's region is in the stream's coordinates, which only map
+        // directly onto the screen if the surface doesn't resize the stream
+        if (underlying_buffer_stream->stream_size() != screen_position_.size)
+            return {};
+
+        auto region = underlying_buffer_stream->opaque_region();
+        region.translate(screen_position_.top_left - geom::Point{});
+        region.intersect(screen_position_);
+        return region;
+    }
+
     mg::Renderable::ID id() const override
     { return id_; }
+
+    geom::Rectangles buffer_damage_since(mg::BufferID previous) const override
+    { return underlying_buffer_stream->buffer_damage(previous, *buffer()); }
 private:
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
     void const*const compositor_id;
     float const alpha_;
     geom::Rectangle const screen_position_;
+    geom::Rectangle const src_bounds_;
     glm::mat4 const transformation_;
     mg::Renderable::ID const id_;
 };
@@ -843,6 +901,13 @@ int ms::BasicSurface::buffers_ready_for_compositor(void const* id) const
     return max_buf;
 }
 
+void ms::BasicSurface::frame_presented(mc::PresentedFrame const& frame, bool on_screen)
+{
+    std::unique_lock<std::mutex> lk(guard);
+    for (auto const& info : layers)
+        info.stream->frame_presented(frame, on_screen);
+}
+
 void ms::BasicSurface::consume(MirEvent const* event)
 {
     observers.input_consumed(this, event);
@@ -884,8 +949,14 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
 {
-    std::unique_lock<std::mutex> lk(guard);
     mg::RenderableList list;
+    append_renderables(id, list);
+    return list;
+}
+
+void ms::BasicSurface::append_renderables(mc::CompositorID id, mg::RenderableList& list) const
+{
+    std::unique_lock<std::mutex> lk(guard);
     for (auto const& info : layers)
     {
         if (info.stream->has_submitted_buffer())
@@ -896,13 +967,14 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
+            list.emplace_back(std::allocate_shared<SurfaceSnapshot>(
+                PooledAllocator<SurfaceSnapshot>{snapshot_pool},
                 info.stream, id,
                 geom::Rectangle{surface_rect.top_left + info.displacement, std::move(size)},
+                info.stream->src_bounds(),
                 transformation_matrix, surface_alpha, info.stream.get()));
         }
     }
-    return list;
 }
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
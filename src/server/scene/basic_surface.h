@@ -54,6 +54,7 @@ namespace scene
 {
 class SceneReport;
 class CursorStreamImageAdapter;
+class BlockPool;
 
 class BasicSurface : public Surface
 {
@@ -92,6 +93,7 @@ public:
     void set_reception_mode(input::InputReceptionMode mode) override;
 
     void set_input_region(std::vector<geometry::Rectangle> const& input_rectangles) override;
+    geometry::Rectangle input_area_bounds() const override;
 
     void resize(geometry::Size const& size) override;
     geometry::Point top_left() const override;
@@ -105,7 +107,9 @@ public:
     bool visible() const override;
     
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    void append_renderables(compositor::CompositorID id, graphics::RenderableList& renderables) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
+    void frame_presented(compositor::PresentedFrame const& frame, bool on_screen) override;
 
     MirWindowType type() const override;
     MirWindowState state() const override;
@@ -178,6 +182,9 @@ private:
     MirPointerConfinementState confine_pointer_state_ = mir_pointer_unconfined;
 
     std::unique_ptr<CursorStreamImageAdapter> const cursor_stream_adapter;
+
+    // Recycles the SurfaceSnapshots generated for each composited frame
+    std::shared_ptr<BlockPool> const snapshot_pool;
 };
 
 }
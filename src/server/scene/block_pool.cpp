@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "block_pool.h"
+
+#include <new>
+
+namespace ms = mir::scene;
+
+ms::BlockPool::BlockPool(std::size_t max_free_blocks) :
+    max_free_blocks{max_free_blocks}
+{
+    free_blocks.reserve(max_free_blocks);
+}
+
+ms::BlockPool::~BlockPool()
+{
+    for (auto const block : free_blocks)
+        ::operator delete(block);
+}
+
+void* ms::BlockPool::allocate(std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (!block_size)
+            block_size = size;
+
+        if (size == block_size && !free_blocks.empty())
+        {
+            auto const block = free_blocks.back();
+            free_blocks.pop_back();
+            return block;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ms::BlockPool::deallocate(void* block, std::size_t size)
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        if (size == block_size && free_blocks.size() < max_free_blocks)
+        {
+            free_blocks.push_back(block);
+            return;
+        }
+    }
+
+    ::operator delete(block);
+}
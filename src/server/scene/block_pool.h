@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_SCENE_BLOCK_POOL_H_
+#define MIR_SCENE_BLOCK_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * A free list of equally sized blocks of memory.
+ *
+ * Objects that are created and destroyed every frame can be made with
+ * std::allocate_shared() and a PooledAllocator so that, once the pool has
+ * warmed up, their memory is recycled rather than coming from the heap.
+ * Blocks may be returned from any thread.
+ */
+class BlockPool
+{
+public:
+    explicit BlockPool(std::size_t max_free_blocks);
+    ~BlockPool();
+
+    void* allocate(std::size_t size);
+    void deallocate(void* block, std::size_t size);
+
+private:
+    BlockPool(BlockPool const&) = delete;
+    BlockPool& operator=(BlockPool const&) = delete;
+
+    std::mutex mutex;
+    std::size_t block_size{0};
+    std::vector<void*> free_blocks;
+    std::size_t const max_free_blocks;
+};
+
+template<typename T>
+class PooledAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit PooledAllocator(std::shared_ptr<BlockPool> const& pool) : pool{pool} {}
+
+    template<typename U>
+    PooledAllocator(PooledAllocator<U> const& other) : pool{other.pool} {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(pool->allocate(n * sizeof(T))); }
+    void deallocate(T* block, std::size_t n) { pool->deallocate(block, n * sizeof(T)); }
+
+    template<typename U>
+    bool operator==(PooledAllocator<U> const& other) const { return pool == other.pool; }
+    template<typename U>
+    bool operator!=(PooledAllocator<U> const& other) const { return pool != other.pool; }
+
+private:
+    template<typename U> friend class PooledAllocator;
+
+    std::shared_ptr<BlockPool> pool;
+};
+}
+}
+
+#endif /* MIR_SCENE_BLOCK_POOL_H_ */
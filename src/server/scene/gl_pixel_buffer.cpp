@@ -17,6 +17,8 @@
  */
 
 #include "gl_pixel_buffer.h"
+#include "mir/gl/async_readback.h"
+#include "mir/gl/pixel_kernels.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/gl/context.h"
 #include "mir/renderer/gl/texture_source.h"
@@ -27,11 +29,14 @@
 #include MIR_SERVER_GLEXT_H
 
 namespace mg = mir::graphics;
+namespace mgl = mir::gl;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
 namespace
 {
+/// Enough to read one snapshot back while converting the one before
+unsigned int const readback_depth = 2;
 
 bool is_big_endian()
 {
@@ -39,19 +44,11 @@ bool is_big_endian()
     return (*reinterpret_cast<char*>(&n) != 1);
 }
 
-inline uint32_t abgr_to_argb(uint32_t p)
-{
-    return ((p << 16) & 0x00ff0000) | /* Move R to new position */
-           ((p) & 0x0000ff00) |       /* G remains at same position */
-           ((p >> 16) & 0x000000ff) | /* Move B to new position */
-           ((p) & 0xff000000);        /* A remains at same position */
-}
-
 }
 
 ms::GLPixelBuffer::GLPixelBuffer(std::unique_ptr<renderer::gl::Context> gl_context)
     : gl_context{std::move(gl_context)},
-      tex{0}, fbo{0}, gl_pixel_format{0}, pixels_need_y_flip{false}
+      tex{0}, fbo{0}, readback_checked{false}
 {
     /*
      * TODO: Handle systems that are big-endian, and therefore GL_BGRA doesn't
@@ -73,6 +70,7 @@ ms::GLPixelBuffer::~GLPixelBuffer() noexcept
     if (tex != 0 || fbo != 0)
         gl_context->make_current();
 
+    readback.reset();
     if (tex != 0)
         glDeleteTextures(1, &tex);
     if (fbo != 0)
@@ -93,6 +91,13 @@ void ms::GLPixelBuffer::prepare()
         glGenFramebuffers(1, &fbo);
 
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+    if (!readback_checked)
+    {
+        if (mgl::AsyncReadback::available())
+            readback = std::make_unique<mgl::AsyncReadback>(readback_depth);
+        readback_checked = true;
+    }
 }
 
 void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
@@ -100,8 +105,6 @@ void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
     auto width = buffer.size().width.as_uint32_t();
     auto height = buffer.size().height.as_uint32_t();
 
-    pixels.resize(width * height * 4);
-
     prepare();
 
     auto const texture_source =
@@ -113,53 +116,79 @@ void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
 
-    /* First try to get pixels as BGRA */
-    glGetError();
-    gl_pixel_format = GL_BGRA_EXT;
-    glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
-
-    /* If getting pixels as BGRA failed, fall back to RGBA */
-    if (glGetError() != GL_NO_ERROR)
+    // Nobody wanted the oldest
+    if (fills.size() == max_pending())
     {
-        gl_pixel_format = GL_RGBA;
-        glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+        if (readback)
+            readback->finish([](unsigned char const*, geom::Size, geom::Stride) {});
+        fills.pop_front();
     }
 
-    size_ = buffer.size();
-    pixels_need_y_flip = true;
-}
+    /* First try to get pixels as BGRA, falling back to RGBA */
+    Fill fill{buffer.size(), GL_BGRA_EXT, {}};
 
-void const* ms::GLPixelBuffer::as_argb_8888()
-{
-    if (pixels_need_y_flip)
+    if (readback)
     {
-        auto const stride_val = stride().as_uint32_t();
-        auto const height = size_.height.as_uint32_t();
-
-        std::vector<char> tmp(stride_val);
+        geom::Rectangle const area{{0, 0}, buffer.size()};
 
-        for (unsigned int i = 0; i < height / 2; i++)
+        if (!readback->start(area, fill.gl_pixel_format))
         {
-            /* Store line i */
-            tmp.assign(&pixels[i * stride_val], &pixels[(i + 1) * stride_val]);
-
-            /* Copy line height - i - 1 to line i */
-            copy_and_convert_pixel_line(&pixels[(height - i - 1) * stride_val],
-                                        &pixels[i * stride_val]);
-
-            /* Copy stored line (i) to height - i - 1 */
-            copy_and_convert_pixel_line(tmp.data(),
-                                        &pixels[(height - i - 1) * stride_val]);
+            fill.gl_pixel_format = GL_RGBA;
+            if (!readback->start(area, fill.gl_pixel_format))
+                BOOST_THROW_EXCEPTION(std::runtime_error("Failed to read back buffer pixels"));
         }
+    }
+    else
+    {
+        fill.gl_pixels.resize(width * height * 4);
 
-        /* Process middle line if there is one */
-        if (height % 2 == 1)
+        glGetError();
+        glReadPixels(0, 0, width, height, fill.gl_pixel_format, GL_UNSIGNED_BYTE, fill.gl_pixels.data());
+
+        if (glGetError() != GL_NO_ERROR)
         {
-            copy_and_convert_pixel_line(&pixels[(height / 2) * stride_val],
-                                        &pixels[(height / 2) * stride_val]);
+            fill.gl_pixel_format = GL_RGBA;
+            glReadPixels(0, 0, width, height, fill.gl_pixel_format, GL_UNSIGNED_BYTE, fill.gl_pixels.data());
         }
+    }
 
-        pixels_need_y_flip = false;
+    fills.push_back(std::move(fill));
+}
+
+void const* ms::GLPixelBuffer::as_argb_8888()
+{
+    if (fills.empty())
+        return pixels.data();
+
+    auto const fill = std::move(fills.front());
+    fills.pop_front();
+
+    size_ = fill.size;
+    auto const width = size_.width.as_uint32_t();
+    auto const height = size_.height.as_uint32_t();
+    pixels.resize(width * height * 4);
+
+    auto const dst = reinterpret_cast<unsigned char*>(pixels.data());
+    /* RGBA in memory is abgr_8888 on little endian, so swap to argb_8888 */
+    bool const swap_rb = fill.gl_pixel_format == GL_RGBA;
+
+    if (readback)
+    {
+        gl_context->make_current();
+        readback->finish(
+            [&](unsigned char const* gl_rows, geom::Size, geom::Stride gl_stride)
+            {
+                mgl::copy_flipped(
+                    mgl::pixel_kernels(), dst, stride().as_uint32_t(),
+                    gl_rows, gl_stride.as_uint32_t(), width, height, swap_rb);
+            });
+    }
+    else
+    {
+        mgl::copy_flipped(
+            mgl::pixel_kernels(), dst, stride().as_uint32_t(),
+            reinterpret_cast<unsigned char const*>(fill.gl_pixels.data()), stride().as_uint32_t(),
+            width, height, swap_rb);
     }
 
     return pixels.data();
@@ -175,20 +204,7 @@ geom::Stride ms::GLPixelBuffer::stride() const
     return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)};
 }
 
-void ms::GLPixelBuffer::copy_and_convert_pixel_line(char* src, char* dst)
+unsigned int ms::GLPixelBuffer::max_pending() const
 {
-    if (gl_pixel_format == GL_RGBA)
-    {
-        /* Convert from abgr_8888 to argb_8888 while copying */
-        auto pixels_src = reinterpret_cast<uint32_t*>(src);
-        auto pixels_dst = reinterpret_cast<uint32_t*>(dst);
-        auto const width = size_.width.as_uint32_t();
-
-        for (uint32_t n = 0; n < width; n++)
-            pixels_dst[n] = abgr_to_argb(pixels_src[n]);
-    }
-    else if (src != dst)
-    {
-        std::copy(src, src + stride().as_uint32_t(), dst);
-    }
+    return readback_depth;
 }
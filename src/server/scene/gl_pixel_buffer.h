@@ -21,6 +21,7 @@
 
 #include "pixel_buffer.h"
 
+#include <deque>
 #include <memory>
 #include <vector>
 
@@ -39,10 +40,20 @@ namespace gl
 class Context;
 }
 }
+namespace gl
+{
+class AsyncReadback;
+}
 
 namespace scene
 {
-/** Extracts the pixels from a graphics::Buffer using GL facilities. */
+/**
+ * Extracts the pixels from a graphics::Buffer using GL facilities.
+ *
+ * Where GL supports it, fill_from() only queues the readback, and
+ * as_argb_8888() waits for it. With two fills queued, the second is read
+ * back while the first is mapped and converted.
+ */
 class GLPixelBuffer : public PixelBuffer
 {
 public:
@@ -53,17 +64,27 @@ public:
     void const* as_argb_8888();
     geometry::Size size() const;
     geometry::Stride stride() const;
+    unsigned int max_pending() const;
 
 private:
+    struct Fill
+    {
+        geometry::Size size;
+        GLuint gl_pixel_format;
+        /// The pixels as GL read them, when not read back asynchronously
+        std::vector<char> gl_pixels;
+    };
+
     void prepare();
-    void copy_and_convert_pixel_line(char* src, char* dst);
 
     std::unique_ptr<renderer::gl::Context> const gl_context;
     GLuint tex;
     GLuint fbo;
+    bool readback_checked;
+    std::unique_ptr<gl::AsyncReadback> readback;
+    /// Fills not yet collected by as_argb_8888(), oldest first
+    std::deque<Fill> fills;
     std::vector<char> pixels;
-    GLuint gl_pixel_format;
-    bool pixels_need_y_flip;
     geometry::Size size_;
     geometry::Stride stride_;
 };
@@ -32,6 +32,9 @@ namespace scene
 {
 /**
  * Interface for extracting the pixels from a graphics::Buffer.
+ *
+ * Up to max_pending() fills can be in progress at once, so that one buffer
+ * can be extracted while the pixels of another are collected.
  */
 class PixelBuffer
 {
@@ -39,32 +42,39 @@ public:
     virtual ~PixelBuffer() = default;
 
     /**
-     * Fills the PixelBuffer with the contents of a graphics::Buffer.
+     * Starts filling the PixelBuffer with the contents of a graphics::Buffer.
+     *
+     * If max_pending() fills are already in progress, the oldest is dropped.
      *
      * \param [in] buffer the buffer to get the pixels of
      */
     virtual void fill_from(graphics::Buffer& buffer) = 0;
 
     /**
-     * The pixels in 0xAARRGGBB format.
+     * The pixels of the oldest fill not yet collected, in 0xAARRGGBB format.
      *
      * The pixel data is owned by the PixelBuffer object and is only valid
-     * until the next call to fill_from().
+     * until the next call to as_argb_8888().
      *
      * This method may involve transformation of the extracted data.
      */
     virtual void const* as_argb_8888() = 0;
 
     /**
-     * The size of the pixel buffer.
+     * The size of the pixels last returned by as_argb_8888().
      */
     virtual geometry::Size size() const = 0;
 
     /**
-     * The stride of the pixel buffer.
+     * The stride of the pixels last returned by as_argb_8888().
      */
     virtual geometry::Stride stride() const = 0;
 
+    /**
+     * How many fills can be in progress before the oldest must be collected.
+     */
+    virtual unsigned int max_pending() const { return 1; }
+
 protected:
     PixelBuffer() = default;
     PixelBuffer(PixelBuffer const&) = delete;
@@ -27,6 +27,8 @@
 namespace ms = mir::scene;
 namespace mc = mir::compositor;
 
+std::chrono::seconds const ms::RenderingTracker::throttled_presentation_interval{1};
+
 ms::RenderingTracker::RenderingTracker(
     std::weak_ptr<ms::Surface> const& weak_surface)
     : weak_surface{weak_surface}
@@ -41,6 +43,12 @@ void ms::RenderingTracker::rendered_in(mc::CompositorID cid)
 
     occlusions.erase(cid);
 
+    if (std::find(rendered_since_presented.begin(), rendered_since_presented.end(), cid) ==
+        rendered_since_presented.end())
+    {
+        rendered_since_presented.push_back(cid);
+    }
+
     configure_visibility(mir_window_visibility_exposed);
 }
 
@@ -80,6 +88,33 @@ bool ms::RenderingTracker::is_exposed_in(mc::CompositorID cid) const
     return occlusions.find(cid) == occlusions.end();
 }
 
+bool ms::RenderingTracker::frame_presented_in(
+    mc::CompositorID cid,
+    std::chrono::steady_clock::time_point presentation_time)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    auto const rendered = std::find(rendered_since_presented.begin(), rendered_since_presented.end(), cid);
+
+    if (rendered == rendered_since_presented.end())
+        return false;
+
+    rendered_since_presented.erase(rendered);
+    last_presented = presentation_time;
+    return true;
+}
+
+bool ms::RenderingTracker::throttled_frame_due(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock{guard};
+
+    if (now - last_presented < throttled_presentation_interval)
+        return false;
+
+    last_presented = now;
+    return true;
+}
+
 bool ms::RenderingTracker::occluded_in_all_active_compositors()
 {
     return occlusions == active_compositors_;
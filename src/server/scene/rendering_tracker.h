@@ -21,9 +21,11 @@
 
 #include "mir/compositor/compositor_id.h"
 
+#include <chrono>
 #include <memory>
 #include <set>
 #include <mutex>
+#include <vector>
 
 #include "mir_toolkit/common.h"
 
@@ -44,6 +46,24 @@ public:
     void active_compositors(std::set<compositor::CompositorID> const& cids);
     bool is_exposed_in(compositor::CompositorID cid) const;
 
+    /**
+     * Whether the surface should hear about the frame \a cid has just presented:
+     * that's every frame it was rendered in.
+     */
+    bool frame_presented_in(
+        compositor::CompositorID cid,
+        std::chrono::steady_clock::time_point presentation_time);
+
+    /**
+     * Whether the surface has gone unpresented for throttled_presentation_interval
+     * at \a now, and so should hear of a frame anyway. A surface that is occluded
+     * or offscreen only hears about one frame in a while, so that clients pacing
+     * themselves by it stop redrawing what nobody can see.
+     */
+    bool throttled_frame_due(std::chrono::steady_clock::time_point now);
+
+    static std::chrono::seconds const throttled_presentation_interval;
+
 private:
     bool occluded_in_all_active_compositors();
     void configure_visibility(MirWindowVisibility visibility);
@@ -53,6 +73,9 @@ private:
     std::weak_ptr<Surface> const weak_surface;
     std::set<compositor::CompositorID> occlusions;
     std::set<compositor::CompositorID> active_compositors_;
+    // A vector rather than a set as it's updated every frame and is tiny
+    std::vector<compositor::CompositorID> rendered_since_presented;
+    std::chrono::steady_clock::time_point last_presented;
     std::mutex mutable guard;
 };
 
@@ -108,3 +108,7 @@ void ms::SurfaceEventSource::start_drag_and_drop(Surface const*, std::vector<uin
 {
     event_sink->handle_event(mev::make_start_drag_and_drop_event(id, handle));
 }
+
+void ms::SurfaceEventSource::input_region_set_to(Surface const*, std::vector<geometry::Rectangle> const&)
+{
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "surface_index.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+// Beyond this many cells a surface is cheaper to test on every query than to bucket
+int const max_cells_per_surface = 256;
+
+int floor_div(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+template<typename Container, typename Value>
+void erase_value(Container& container, Value const& value)
+{
+    container.erase(std::remove(container.begin(), container.end(), value), container.end());
+}
+}
+
+ms::SurfaceIndex::SurfaceIndex(int cell_size) :
+    cell_size{cell_size}
+{
+}
+
+ms::SurfaceIndex::~SurfaceIndex() = default;
+
+auto ms::SurfaceIndex::key_for(int column, int row) const -> CellKey
+{
+    return (CellKey(std::uint32_t(column)) << 32) | std::uint32_t(row);
+}
+
+template<typename F>
+void ms::SurfaceIndex::for_each_cell(geom::Rectangle const& bounds, F f) const
+{
+    if (bounds.size.width.as_int() <= 0 || bounds.size.height.as_int() <= 0)
+        return;
+
+    auto const first_column = floor_div(bounds.left().as_int(), cell_size);
+    auto const last_column = floor_div(bounds.right().as_int() - 1, cell_size);
+    auto const first_row = floor_div(bounds.top().as_int(), cell_size);
+    auto const last_row = floor_div(bounds.bottom().as_int() - 1, cell_size);
+
+    for (auto row = first_row; row <= last_row; ++row)
+        for (auto column = first_column; column <= last_column; ++column)
+            f(key_for(column, row));
+}
+
+void ms::SurfaceIndex::add_to_cells(Entry* entry)
+{
+    auto const& bounds = entry->bounds;
+    long const columns = bounds.size.width.as_int() / cell_size + 2;
+    long const rows = bounds.size.height.as_int() / cell_size + 2;
+
+    entry->oversized = columns * rows > max_cells_per_surface;
+
+    if (entry->oversized)
+        oversized.push_back(entry);
+    else
+        for_each_cell(bounds, [&](CellKey key) { cells[key].push_back(entry); });
+}
+
+void ms::SurfaceIndex::remove_from_cells(Entry* entry)
+{
+    if (entry->oversized)
+    {
+        erase_value(oversized, entry);
+        return;
+    }
+
+    for_each_cell(entry->bounds, [&](CellKey key)
+        {
+            auto const cell = cells.find(key);
+            if (cell != cells.end())
+            {
+                erase_value(cell->second, entry);
+                if (cell->second.empty())
+                    cells.erase(cell);
+            }
+        });
+}
+
+void ms::SurfaceIndex::insert(std::shared_ptr<Surface> const& surface)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // Read under the lock so that a concurrent update() can't be overtaken
+    auto const bounds = surface->input_area_bounds();
+
+    auto& entry = entries[surface.get()];
+    if (entry)
+        remove_from_cells(entry.get());
+
+    entry.reset(new Entry{surface, bounds, next_rank++, false});
+    add_to_cells(entry.get());
+}
+
+void ms::SurfaceIndex::erase(Surface const* surface)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const entry = entries.find(surface);
+    if (entry != entries.end())
+    {
+        remove_from_cells(entry->second.get());
+        entries.erase(entry);
+    }
+}
+
+void ms::SurfaceIndex::raise(Surface const* surface)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const entry = entries.find(surface);
+    if (entry != entries.end())
+        entry->second->rank = next_rank++;
+}
+
+void ms::SurfaceIndex::update(Surface const* surface)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const entry = entries.find(surface);
+    if (entry == entries.end())
+        return;
+
+    auto const bounds = surface->input_area_bounds();
+    if (entry->second->bounds != bounds)
+    {
+        remove_from_cells(entry->second.get());
+        entry->second->bounds = bounds;
+        add_to_cells(entry->second.get());
+    }
+}
+
+auto ms::SurfaceIndex::surface_at(geom::Point point) const -> std::shared_ptr<Surface>
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    Entry const* top = nullptr;
+    std::shared_ptr<Surface> top_surface;
+
+    auto const consider = [&](Entry const* entry)
+        {
+            if (top && entry->rank < top->rank)
+                return;
+
+            if (!entry->bounds.contains(point))
+                return;
+
+            if (auto const surface = entry->surface.lock())
+            {
+                if (surface->input_area_contains(point))
+                {
+                    top = entry;
+                    top_surface = surface;
+                }
+            }
+        };
+
+    auto const cell = cells.find(key_for(
+        floor_div(point.x.as_int(), cell_size),
+        floor_div(point.y.as_int(), cell_size)));
+
+    if (cell != cells.end())
+    {
+        for (auto const entry : cell->second)
+            consider(entry);
+    }
+
+    for (auto const entry : oversized)
+        consider(entry);
+
+    return top_surface;
+}
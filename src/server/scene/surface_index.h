@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_SCENE_SURFACE_INDEX_H_
+#define MIR_SCENE_SURFACE_INDEX_H_
+
+#include "mir/geometry/point.h"
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+
+/**
+ * A spatial index of surfaces for hit-testing.
+ *
+ * Surfaces are bucketed by the cells of a uniform grid that their
+ * input_area_bounds() overlap, so finding the surface under a point only
+ * needs to test the handful of surfaces sharing its cell rather than the
+ * whole stack. Surfaces too large to bucket cheaply are always tested.
+ *
+ * The index has to be told when those bounds change. It reads a surface's
+ * state while holding its own lock, so must not be called into while
+ * holding a surface's lock.
+ */
+class SurfaceIndex
+{
+public:
+    explicit SurfaceIndex(int cell_size = default_cell_size);
+    ~SurfaceIndex();
+
+    /// Adds a surface above all those already in the index
+    void insert(std::shared_ptr<Surface> const& surface);
+    void erase(Surface const* surface);
+    /// Moves a surface above all the others
+    void raise(Surface const* surface);
+    /// Re-reads the input area bounds of a surface
+    void update(Surface const* surface);
+
+    /// The topmost surface whose input area contains point, if any
+    auto surface_at(geometry::Point point) const -> std::shared_ptr<Surface>;
+
+    static int const default_cell_size = 256;
+
+private:
+    SurfaceIndex(SurfaceIndex const&) = delete;
+    SurfaceIndex& operator=(SurfaceIndex const&) = delete;
+
+    struct Entry
+    {
+        std::weak_ptr<Surface> surface;
+        geometry::Rectangle bounds;
+        std::uint64_t rank;
+        bool oversized;
+    };
+
+    using CellKey = std::uint64_t;
+
+    CellKey key_for(int column, int row) const;
+    template<typename F>
+    void for_each_cell(geometry::Rectangle const& bounds, F f) const;
+    void add_to_cells(Entry* entry);
+    void remove_from_cells(Entry* entry);
+
+    int const cell_size;
+
+    std::mutex mutable mutex;
+    std::uint64_t next_rank{0};
+    std::unordered_map<Surface const*, std::unique_ptr<Entry>> entries;
+    std::unordered_map<CellKey, std::vector<Entry*>> cells;
+    std::vector<Entry*> oversized;
+};
+}
+}
+
+#endif /* MIR_SCENE_SURFACE_INDEX_H_ */
@@ -20,10 +20,16 @@
 
 #include "surface_stack.h"
 #include "rendering_tracker.h"
+#include "block_pool.h"
+#include "surface_index.h"
 #include "mir/scene/surface.h"
+#include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
+#include "mir/time/alarm_factory.h"
+#include "mir/time/alarm.h"
+#include "mir/time/clock.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -41,19 +47,20 @@ namespace geom = mir::geometry;
 
 namespace
 {
+// Enough for a few frames in flight on a few outputs of a busy desktop
+std::size_t const max_pooled_elements = 1024;
+std::size_t const max_pooled_overlays = 16;
 
 class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -76,7 +83,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -106,70 +112,174 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
 };
 
+// Keeps the hit-testing index in step with the geometry and input regions of the surfaces
+class InputIndexUpdater : public ms::NullSurfaceObserver
+{
+public:
+    InputIndexUpdater(std::shared_ptr<ms::SurfaceIndex> const& index)
+        : index{index}
+    {
+    }
+
+    void resized_to(ms::Surface const* surface, geom::Size const&) override
+    {
+        index->update(surface);
+    }
+
+    void moved_to(ms::Surface const* surface, geom::Point const&) override
+    {
+        index->update(surface);
+    }
+
+    void input_region_set_to(ms::Surface const* surface, std::vector<geom::Rectangle> const&) override
+    {
+        index->update(surface);
+    }
+
+private:
+    std::shared_ptr<ms::SurfaceIndex> const index;
+};
 }
 
 ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
     report{report},
+    element_pool{std::make_shared<BlockPool>(max_pooled_elements)},
+    overlay_pool{std::make_shared<BlockPool>(max_pooled_overlays)},
+    contents{std::make_shared<Contents>()},
+    input_index{std::make_shared<SurfaceIndex>()},
+    input_index_updater{std::make_shared<InputIndexUpdater>(input_index)},
     scene_changed{false}
 {
 }
 
+ms::SurfaceStack::SurfaceStack(
+    std::shared_ptr<SceneReport> const& report,
+    std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+    std::shared_ptr<time::Clock> const& clock) :
+    report{report},
+    element_pool{std::make_shared<BlockPool>(max_pooled_elements)},
+    overlay_pool{std::make_shared<BlockPool>(max_pooled_overlays)},
+    contents{std::make_shared<Contents>()},
+    input_index{std::make_shared<SurfaceIndex>()},
+    input_index_updater{std::make_shared<InputIndexUpdater>(input_index)},
+    scene_changed{false},
+    clock{clock},
+    throttled_presentation_alarm{alarm_factory->create_alarm([this] { present_throttled_frames(); })}
+{
+    throttled_presentation_alarm->reschedule_in(RenderingTracker::throttled_presentation_interval);
+}
+
+auto ms::SurfaceStack::current_contents() const -> std::shared_ptr<Contents const>
+{
+    return std::atomic_load(&contents);
+}
+
+void ms::SurfaceStack::publish(std::shared_ptr<Contents const> const& new_contents)
+{
+    std::atomic_store(&contents, new_contents);
+}
+
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
-    RecursiveReadLock lg(guard);
+    auto const current = current_contents();
 
     scene_changed = false;
+
+    // Each compositor has its own thread, so this is a per-compositor scratch list
+    // whose storage is reused from frame to frame.
+    thread_local mg::RenderableList renderables;
+    renderables.clear();
+
     mc::SceneElementSequence elements;
-    for (auto const& surface : surfaces)
+    elements.reserve(current->surfaces.size() + current->overlays.size());
+
+    for (auto const& entry : current->surfaces)
     {
-        if (surface->visible())
+        if (entry.surface->visible())
         {
-            for (auto& renderable : surface->generate_renderables(id))
+            auto const first = renderables.size();
+            entry.surface->append_renderables(id, renderables);
+
+            for (auto i = first; i != renderables.size(); ++i)
             {
                 elements.emplace_back(
-                    std::make_shared<SurfaceSceneElement>(
-                        surface->name(),
-                        renderable,
-                        rendering_trackers[surface.get()],
+                    std::allocate_shared<SurfaceSceneElement>(
+                        PooledAllocator<SurfaceSceneElement>{element_pool},
+                        renderables[i],
+                        entry.tracker,
                         id));
             }
         }
     }
-    for (auto const& renderable : overlays)
+    for (auto const& renderable : current->overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(
+            std::allocate_shared<OverlaySceneElement>(
+                PooledAllocator<OverlaySceneElement>{overlay_pool},
+                renderable));
     }
+
+    // Don't hold on to the renderables (and their buffers) after the frame
+    renderables.clear();
     return elements;
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 {
-    RecursiveReadLock lg(guard);
+    auto const current = current_contents();
 
     int result = scene_changed ? 1 : 0;
-    for (auto const& surface : surfaces)
+    for (auto const& entry : current->surfaces)
     {
-        if (surface->visible())
+        if (entry.surface->visible() && entry.tracker->is_exposed_in(id))
         {
-            auto const tracker = rendering_trackers.find(surface.get());
-            if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
-            {
-                // Note that we ask the surface and not a Renderable.
-                // This is because we don't want to waste time and resources
-                // on a snapshot till we're sure we need it...
-                int ready = surface->buffers_ready_for_compositor(id);
-                if (ready > result)
-                    result = ready;
-            }
+            // Note that we ask the surface and not a Renderable.
+            // This is because we don't want to waste time and resources
+            // on a snapshot till we're sure we need it...
+            int ready = entry.surface->buffers_ready_for_compositor(id);
+            if (ready > result)
+                result = ready;
         }
     }
     return result;
 }
 
+void ms::SurfaceStack::frame_presented(
+    mc::CompositorID id,
+    mc::PresentedFrame const& frame)
+{
+    // PresentedFrame timestamps are on CLOCK_MONOTONIC, which is std::chrono::steady_clock
+    std::chrono::steady_clock::time_point const presentation_time{
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(frame.frame.ust.nanoseconds)};
+    auto const current = current_contents();
+
+    for (auto const& entry : current->surfaces)
+    {
+        if (entry.tracker->frame_presented_in(id, presentation_time))
+            entry.surface->frame_presented(frame, true);
+    }
+}
+
+void ms::SurfaceStack::present_throttled_frames()
+{
+    // Surfaces that are composited hear from frame_presented(); this catches the
+    // rest, including every surface while the scene is idle and nothing composites.
+    auto const now = clock->now();
+    auto const current = current_contents();
+
+    for (auto const& entry : current->surfaces)
+    {
+        if (entry.tracker->throttled_frame_due(now))
+            entry.surface->frame_presented(mc::PresentedFrame::untimed(now), false);
+    }
+
+    throttled_presentation_alarm->reschedule_in(RenderingTracker::throttled_presentation_interval);
+}
+
 void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard<std::recursive_mutex> lock{compositors_mutex};
 
     registered_compositors.insert(cid);
 
@@ -178,7 +288,7 @@ void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard<std::recursive_mutex> lock{compositors_mutex};
 
     registered_compositors.erase(cid);
 
@@ -189,8 +299,10 @@ void ms::SurfaceStack::add_input_visualization(
     std::shared_ptr<mg::Renderable> const& overlay)
 {
     {
-        RecursiveWriteLock lg(guard);
-        overlays.push_back(overlay);
+        std::lock_guard<std::mutex> lock{write_mutex};
+        auto const updated = std::make_shared<Contents>(*current_contents());
+        updated->overlays.push_back(overlay);
+        publish(updated);
     }
     emit_scene_changed();
 }
@@ -200,13 +312,15 @@ void ms::SurfaceStack::remove_input_visualization(
 {
     auto overlay = weak_overlay.lock();
     {
-        RecursiveWriteLock lg(guard);
-        auto const p = std::find(overlays.begin(), overlays.end(), overlay);
-        if (p == overlays.end())
+        std::lock_guard<std::mutex> lock{write_mutex};
+        auto const updated = std::make_shared<Contents>(*current_contents());
+        auto const p = std::find(updated->overlays.begin(), updated->overlays.end(), overlay);
+        if (p == updated->overlays.end())
         {
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
-        overlays.erase(p);
+        updated->overlays.erase(p);
+        publish(updated);
     }
     
     emit_scene_changed();
@@ -214,10 +328,7 @@ void ms::SurfaceStack::remove_input_visualization(
 
 void ms::SurfaceStack::emit_scene_changed()
 {
-    {
-        RecursiveWriteLock lg(guard);
-        scene_changed = true;
-    }
+    scene_changed = true;
     observers.scene_changed();
 }
 
@@ -225,10 +336,18 @@ void ms::SurfaceStack::add_surface(
     std::shared_ptr<Surface> const& surface,
     mi::InputReceptionMode input_mode)
 {
+    auto const tracker = std::make_shared<RenderingTracker>(surface);
+    surface->add_observer(input_index_updater);
     {
-        RecursiveWriteLock lg(guard);
-        surfaces.push_back(surface);
-        create_rendering_tracker_for(surface);
+        // Compositors query the tracker as soon as it is published, so it must know them first
+        std::lock_guard<std::recursive_mutex> compositors_lock{compositors_mutex};
+        tracker->active_compositors(registered_compositors);
+
+        std::lock_guard<std::mutex> lock{write_mutex};
+        auto const updated = std::make_shared<Contents>(*current_contents());
+        updated->surfaces.push_back({surface, tracker});
+        input_index->insert(surface);
+        publish(updated);
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface.get());
@@ -242,20 +361,25 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
 
     bool found_surface = false;
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<std::mutex> lock{write_mutex};
 
-        auto const surface = std::find(surfaces.begin(), surfaces.end(), keep_alive);
+        auto const updated = std::make_shared<Contents>(*current_contents());
+        auto const entry = std::find_if(
+            updated->surfaces.begin(), updated->surfaces.end(),
+            [&](StackEntry const& entry) { return entry.surface == keep_alive; });
 
-        if (surface != surfaces.end())
+        if (entry != updated->surfaces.end())
         {
-            surfaces.erase(surface);
-            rendering_trackers.erase(keep_alive.get());
+            updated->surfaces.erase(entry);
+            input_index->erase(keep_alive.get());
+            publish(updated);
             found_surface = true;
         }
     }
 
     if (found_surface)
     {
+        keep_alive->remove_observer(input_index_updater);
         observers.surface_removed(keep_alive.get());
 
         report->surface_removed(keep_alive.get(), keep_alive.get()->name());
@@ -263,42 +387,28 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
-{
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
-
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
-}
-
 auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
 -> std::shared_ptr<Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& surface : in_reverse(surfaces))
-    {
-        // TODO There's a lack of clarity about how the input area will
-        // TODO be maintained and whether this test will detect clicks on
-        // TODO decorations (it should) as these may be outside the area
-        // TODO known to the client.  But it works for now.
-        if (surface->input_area_contains(cursor))
-                return surface;
-    }
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    return input_index->surface_at(cursor);
+}
 
-    return {};
+auto ms::SurfaceStack::input_surface_at(geometry::Point point) const
+-> std::shared_ptr<mi::Surface>
+{
+    return input_index->surface_at(point);
 }
 
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
 {
-    RecursiveReadLock lg(guard);
-    for (auto &surface : surfaces)
+    auto const current = current_contents();
+    for (auto const& entry : current->surfaces)
     {
-        callback(surface);
+        callback(entry.surface);
     }
 }
 
@@ -309,13 +419,19 @@ void ms::SurfaceStack::raise(std::weak_ptr<Surface> const& s)
     {
         auto const surface = s.lock();
 
-        RecursiveWriteLock ul(guard);
-        auto const p = std::find(surfaces.begin(), surfaces.end(), surface);
+        std::lock_guard<std::mutex> lock{write_mutex};
+        auto const updated = std::make_shared<Contents>(*current_contents());
+        auto const p = std::find_if(
+            updated->surfaces.begin(), updated->surfaces.end(),
+            [&](StackEntry const& entry) { return entry.surface == surface; });
 
-        if (p != surfaces.end())
+        if (p != updated->surfaces.end())
         {
-            surfaces.erase(p);
-            surfaces.push_back(surface);
+            auto const entry = *p;
+            updated->surfaces.erase(p);
+            updated->surfaces.push_back(entry);
+            input_index->raise(surface.get());
+            publish(updated);
             surfaces_reordered = true;
         }
     }
@@ -331,36 +447,37 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
 {
     bool surfaces_reordered{false};
     {
-        RecursiveWriteLock ul(guard);
+        std::lock_guard<std::mutex> lock{write_mutex};
 
-        auto const old_surfaces = surfaces;
+        auto const current = current_contents();
+        auto const updated = std::make_shared<Contents>(*current);
         std::stable_partition(
-            begin(surfaces), end(surfaces),
-            [&](std::weak_ptr<Surface> const& s) { return !ss.count(s); });
+            begin(updated->surfaces), end(updated->surfaces),
+            [&](StackEntry const& entry) { return !ss.count(entry.surface); });
 
-        if (old_surfaces != surfaces)
-            surfaces_reordered = true;
+        surfaces_reordered = !std::equal(
+            begin(current->surfaces), end(current->surfaces), begin(updated->surfaces),
+            [](StackEntry const& a, StackEntry const& b) { return a.surface == b.surface; });
+
+        if (surfaces_reordered)
+        {
+            for (auto const& entry : updated->surfaces)
+            {
+                if (ss.count(entry.surface))
+                    input_index->raise(entry.surface.get());
+            }
+            publish(updated);
+        }
     }
 
     if (surfaces_reordered)
         observers.surfaces_reordered();
 }
 
-void ms::SurfaceStack::create_rendering_tracker_for(std::shared_ptr<Surface> const& surface)
-{
-    auto const tracker = std::make_shared<RenderingTracker>(surface);
-
-    RecursiveWriteLock ul(guard);
-    tracker->active_compositors(registered_compositors);
-    rendering_trackers[surface.get()] = tracker;
-}
-
 void ms::SurfaceStack::update_rendering_tracker_compositors()
 {
-    RecursiveReadLock ul(guard);
-
-    for (auto const& pair : rendering_trackers)
-        pair.second->active_compositors(registered_compositors);
+    for (auto const& entry : current_contents()->surfaces)
+        entry.tracker->active_compositors(registered_compositors);
 }
 
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
@@ -368,10 +485,10 @@ void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observe
     observers.add(observer);
 
     // Notify observer of existing surfaces
-    RecursiveReadLock lk(guard);
-    for (auto &surface : surfaces)
+    auto const current = current_contents();
+    for (auto const& entry : current->surfaces)
     {
-        observer->surface_exists(surface.get());
+        observer->surface_exists(entry.surface.get());
     }
 }
 
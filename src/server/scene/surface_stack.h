@@ -24,7 +24,6 @@
 #include "mir/compositor/scene.h"
 #include "mir/scene/observer.h"
 #include "mir/input/scene.h"
-#include "mir/recursive_read_write_mutex.h"
 
 #include "mir/basic_observers.h"
 
@@ -41,6 +40,12 @@ namespace graphics
 {
 class Renderable;
 }
+namespace time
+{
+class AlarmFactory;
+class Alarm;
+class Clock;
+}
 /// Management of Surface objects. Includes the model (SurfaceStack and Surface
 /// classes) and controller (SurfaceController) elements of an MVC design.
 namespace scene
@@ -48,6 +53,9 @@ namespace scene
 class BasicSurface;
 class SceneReport;
 class RenderingTracker;
+class BlockPool;
+class SurfaceIndex;
+class SurfaceObserver;
 
 class Observers : public Observer, BasicObservers<Observer>
 {
@@ -69,11 +77,20 @@ class SurfaceStack : public compositor::Scene, public input::Scene, public shell
 public:
     explicit SurfaceStack(
         std::shared_ptr<SceneReport> const& report);
+    /// As above, but surfaces nobody has presented for a while are told of a frame
+    /// from \a alarm_factory even when nothing is being composited
+    SurfaceStack(
+        std::shared_ptr<SceneReport> const& report,
+        std::shared_ptr<time::AlarmFactory> const& alarm_factory,
+        std::shared_ptr<time::Clock> const& clock);
     virtual ~SurfaceStack() noexcept(true) {}
 
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
     int frames_pending(compositor::CompositorID) const override;
+    void frame_presented(
+        compositor::CompositorID id,
+        compositor::PresentedFrame const& frame) override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
 
@@ -91,6 +108,7 @@ public:
         input::InputReceptionMode input_mode) override;
     
     auto surface_at(geometry::Point) const -> std::shared_ptr<Surface> override;
+    auto input_surface_at(geometry::Point point) const -> std::shared_ptr<input::Surface> override;
 
     void add_observer(std::shared_ptr<Observer> const& observer) override;
     void remove_observer(std::weak_ptr<Observer> const& observer) override;
@@ -104,21 +122,55 @@ public:
 private:
     SurfaceStack(const SurfaceStack&) = delete;
     SurfaceStack& operator=(const SurfaceStack&) = delete;
-    void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
-    void update_rendering_tracker_compositors();
 
-    RecursiveReadWriteMutex mutable guard;
+    struct StackEntry
+    {
+        std::shared_ptr<Surface> surface;
+        std::shared_ptr<RenderingTracker> tracker;
+    };
+
+    /// An immutable version of the stack. Readers (compositors, input) take a
+    /// reference to the current version and walk it without locking; writers
+    /// copy it, modify the copy and publish that in its place.
+    struct Contents
+    {
+        std::vector<StackEntry> surfaces;
+        std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+    };
+
+    auto current_contents() const -> std::shared_ptr<Contents const>;
+    /// Requires write_mutex to be held
+    void publish(std::shared_ptr<Contents const> const& new_contents);
+    /// Requires compositors_mutex (but not write_mutex) to be held
+    void update_rendering_tracker_compositors();
+    void present_throttled_frames();
 
     std::shared_ptr<SceneReport> const report;
 
-    std::vector<std::shared_ptr<Surface>> surfaces;
-    std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
+    // Recycle the scene elements built for every frame rather than allocating them
+    std::shared_ptr<BlockPool> const element_pool;
+    std::shared_ptr<BlockPool> const overlay_pool;
+
+    // Serialises writers; never taken on the read paths
+    std::mutex mutable write_mutex;
+    // Only accessed through std::atomic_load()/std::atomic_store()
+    std::shared_ptr<Contents const> contents;
+
+    // Serialises changes to the compositor set with handing it to the rendering
+    // trackers. Tracker callbacks (surface visibility changes) run holding only
+    // this, so they may modify the stack. Taken before write_mutex, never after.
+    std::recursive_mutex mutable compositors_mutex;
     std::set<compositor::CompositorID> registered_compositors;
-    
-    std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+
+    // Hit-testing index, kept in step with the stack and the surfaces' geometry
+    std::shared_ptr<SurfaceIndex> const input_index;
+    std::shared_ptr<SurfaceObserver> const input_index_updater;
 
     Observers observers;
     std::atomic<bool> scene_changed;
+
+    std::shared_ptr<time::Clock> const clock;
+    std::unique_ptr<time::Alarm> const throttled_presentation_alarm;
 };
 
 }
@@ -54,33 +54,55 @@ public:
 
         while (running)
         {
-            while (running && work.empty())
+            while (running && work.empty() && started.empty())
                 work_cv.wait(lock);
 
             if (running)
             {
-                auto wi = work.front();
-                work.pop_front();
+                /*
+                 * Start as many snapshots as the pixel buffer can work on at
+                 * once before collecting the oldest, so queued snapshots are
+                 * read back while the one before is converted.
+                 */
+                while (!work.empty() && started.size() < pixels->max_pending())
+                {
+                    auto wi = work.front();
+                    work.pop_front();
+
+                    lock.unlock();
+                    start_snapshot(wi);
+                    lock.lock();
+
+                    started.push_back(wi);
+                }
+
+                auto wi = started.front();
+                started.pop_front();
 
                 lock.unlock();
 
-                take_snapshot(wi);
+                finish_snapshot(wi);
 
                 lock.lock();
             }
         }
     }
 
-    void take_snapshot(WorkItem const& wi)
+    void start_snapshot(WorkItem const& wi)
     {
         wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
             pixels->fill_from(buffer);
         });
+    }
+
+    void finish_snapshot(WorkItem const& wi)
+    {
+        auto const argb_pixels = pixels->as_argb_8888();
 
         wi.snapshot_taken(
             ms::Snapshot{pixels->size(),
                      pixels->stride(),
-                     pixels->as_argb_8888()});
+                     argb_pixels});
     }
 
     void schedule_snapshot(WorkItem const& wi)
@@ -103,6 +125,8 @@ private:
     std::mutex work_mutex;
     std::condition_variable work_cv;
     std::deque<WorkItem> work;
+    /// Snapshots filled from their buffers but not yet collected, oldest first
+    std::deque<WorkItem> started;
 };
 
 }
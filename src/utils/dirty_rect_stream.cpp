@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dirty_rect_stream.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mu = mir::utils;
+namespace geom = mir::geometry;
+
+namespace
+{
+uint32_t const version{1};
+size_t const pixel_format_length{8};
+
+uint64_t area_of(geom::Rectangle const& rect)
+{
+    return uint64_t{rect.size.width.as_uint32_t()} * rect.size.height.as_uint32_t();
+}
+}
+
+mu::DirtyRectStream::DirtyRectStream(
+    std::ostream& out,
+    unsigned int width,
+    unsigned int height,
+    std::string const& pixel_format,
+    unsigned int bytes_per_pixel)
+    : out{out},
+      width{width},
+      height{height},
+      bytes_per_pixel{bytes_per_pixel}
+{
+    if (width > UINT16_MAX || height > UINT16_MAX)
+        throw std::runtime_error("Frame too large for a dirty-rect stream");
+
+    char format[pixel_format_length] = {};
+    pixel_format.copy(format, pixel_format_length);
+
+    uint32_t const header[] = {version, width, height, bytes_per_pixel};
+    write("MDRS", 4);
+    write(header, sizeof header);
+    write(format, sizeof format);
+}
+
+void mu::DirtyRectStream::write_frame(
+    std::chrono::microseconds timestamp,
+    std::vector<geom::Rectangle> const& damage,
+    char const* pixels,
+    int stride)
+{
+    auto const rects = rects_to_send(damage);
+    first_frame = false;
+
+    uint64_t const time = timestamp.count();
+    uint32_t const count = rects.size();
+    write(&time, sizeof time);
+    write(&count, sizeof count);
+
+    for (auto const& rect : rects)
+    {
+        uint16_t const position[] = {
+            static_cast<uint16_t>(rect.top_left.x.as_int()), static_cast<uint16_t>(rect.top_left.y.as_int()),
+            static_cast<uint16_t>(rect.size.width.as_int()), static_cast<uint16_t>(rect.size.height.as_int())};
+        write(position, sizeof position);
+    }
+
+    for (auto const& rect : rects)
+    {
+        auto const row_size = rect.size.width.as_uint32_t() * bytes_per_pixel;
+        auto row = pixels + rect.top_left.y.as_int() * stride + rect.top_left.x.as_int() * bytes_per_pixel;
+        for (auto y = 0; y != rect.size.height.as_int(); ++y, row += stride)
+            write(row, row_size);
+    }
+}
+
+uint64_t mu::DirtyRectStream::bytes_written() const
+{
+    return written;
+}
+
+void mu::DirtyRectStream::write(void const* data, size_t size)
+{
+    out.write(static_cast<char const*>(data), size);
+    written += size;
+}
+
+std::vector<geom::Rectangle> mu::DirtyRectStream::rects_to_send(std::vector<geom::Rectangle> const& damage) const
+{
+    geom::Rectangle const frame{{0, 0}, {width, height}};
+    if (first_frame)
+        return {frame};
+
+    std::vector<geom::Rectangle> rects;
+    uint64_t total_area{0};
+    geom::X left{width}, right{0};
+    geom::Y top{height}, bottom{0};
+
+    for (auto const& rect : damage)
+    {
+        auto const clipped = rect.intersection_with(frame);
+        if (area_of(clipped) == 0)
+            continue;
+
+        rects.push_back(clipped);
+        total_area += area_of(clipped);
+
+        left = std::min(left, clipped.left());
+        top = std::min(top, clipped.top());
+        right = std::max(right, clipped.right());
+        bottom = std::max(bottom, clipped.bottom());
+    }
+
+    // Overlapping rectangles would send some pixels twice; the bounding box is cheaper
+    geom::Rectangle const bounds{{left, top}, {(right - left).as_int(), (bottom - top).as_int()}};
+    if (rects.size() > 1 && total_area >= area_of(bounds))
+        return {bounds};
+
+    return rects;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_UTILS_DIRTY_RECT_STREAM_H_
+#define MIR_UTILS_DIRTY_RECT_STREAM_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mir
+{
+namespace utils
+{
+/**
+ * Writes a screencast as the parts of each frame that changed.
+ *
+ * All fields are in host byte order. The stream starts with a header:
+ *
+ *   char     magic[4]        "MDRS"
+ *   uint32_t version         1
+ *   uint32_t width, height
+ *   uint32_t bytes_per_pixel
+ *   char     pixel_format[8] e.g. "RGBA", zero padded
+ *
+ * followed by one record per frame:
+ *
+ *   uint64_t timestamp       microseconds since the first frame
+ *   uint32_t rect_count      0 if the frame is the same as the previous one
+ *   uint16_t x, y, w, h      for each rectangle
+ *
+ * and then the pixels of each rectangle in turn, top row first, with rows
+ * tightly packed. The first frame is always a single, full frame rectangle.
+ */
+class DirtyRectStream
+{
+public:
+    DirtyRectStream(
+        std::ostream& out,
+        unsigned int width,
+        unsigned int height,
+        std::string const& pixel_format,
+        unsigned int bytes_per_pixel);
+
+    /// pixels is the whole frame, top row first, stride bytes apart
+    void write_frame(
+        std::chrono::microseconds timestamp,
+        std::vector<geometry::Rectangle> const& damage,
+        char const* pixels,
+        int stride);
+
+    /// Bytes written so far, header included
+    uint64_t bytes_written() const;
+
+private:
+    void write(void const* data, size_t size);
+    std::vector<geometry::Rectangle> rects_to_send(std::vector<geometry::Rectangle> const& damage) const;
+
+    std::ostream& out;
+    unsigned int const width;
+    unsigned int const height;
+    unsigned int const bytes_per_pixel;
+    bool first_frame{true};
+    uint64_t written{0};
+};
+}
+}
+
+#endif /* MIR_UTILS_DIRTY_RECT_STREAM_H_ */
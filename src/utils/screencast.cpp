@@ -20,9 +20,11 @@
 #include "mir_toolkit/mir_client_library.h"
 #include "mir_toolkit/mir_screencast.h"
 #include "mir_toolkit/mir_buffer_stream.h"
+#include "mir_toolkit/mir_buffer.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
 #include "mir/raii.h"
+#include "dirty_rect_stream.h"
 
 #include <EGL/egl.h>
 #include <GLES2/gl2.h>
@@ -426,6 +428,87 @@ private:
     GLenum read_pixel_format;
 };
 
+/// Captures to a buffer of our own and writes out only what changed
+class DirtyRectScreencast : public Screencast
+{
+public:
+    DirtyRectScreencast(int num_captures, double capture_fps,
+                        MirConnection* connection, ScreencastConfiguration* config,
+                        MirScreencast* screencast)
+        : Screencast(num_captures, capture_fps),
+          screencast{screencast},
+          buffer{mir_connection_allocate_buffer_sync(
+              connection, config->width, config->height, config->pixel_format)},
+          pixel_format_{mir_pixel_format_to_string(config->pixel_format)},
+          width{config->width},
+          height{config->height},
+          bytes_per_pixel{static_cast<unsigned int>(MIR_BYTES_PER_PIXEL(config->pixel_format))}
+    {
+        if (!mir_buffer_is_valid(buffer))
+            throw std::runtime_error(std::string{"Failed to allocate screencast buffer: "} +
+                                     mir_buffer_get_error_message(buffer));
+    }
+
+    ~DirtyRectScreencast()
+    {
+        mir_buffer_release(buffer);
+    }
+
+    std::string pixel_format() override
+    {
+        return pixel_format_;
+    }
+
+    void capture_to(std::ostream& stream) override
+    {
+        auto const now = std::chrono::steady_clock::now();
+        if (!writer)
+        {
+            writer = std::make_unique<mir::utils::DirtyRectStream>(
+                stream, width, height, pixel_format_, bytes_per_pixel);
+            start = now;
+        }
+
+        if (mir_screencast_capture_to_buffer_sync(screencast, buffer) != mir_screencast_success)
+            throw std::runtime_error("Failed to capture screencast buffer");
+
+        std::vector<mir::geometry::Rectangle> damage;
+        auto const count = mir_screencast_get_damage(screencast, nullptr, 0);
+        if (count < 0)
+        {
+            damage.push_back({{0, 0}, {width, height}});
+        }
+        else
+        {
+            std::vector<MirRectangle> rects(count);
+            mir_screencast_get_damage(screencast, rects.data(), rects.size());
+            for (auto const& rect : rects)
+                damage.push_back({{rect.left, rect.top}, {rect.width, rect.height}});
+        }
+
+        MirGraphicsRegion region;
+        MirBufferLayout layout;
+        if (!mir_buffer_map(buffer, &region, &layout) || layout != mir_buffer_layout_linear)
+            throw std::runtime_error("Failed to map screencast buffer");
+
+        writer->write_frame(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - start),
+            damage, region.vaddr, region.stride);
+
+        mir_buffer_unmap(buffer);
+    }
+
+private:
+    MirScreencast* const screencast;
+    MirBuffer* const buffer;
+    std::string const pixel_format_;
+    unsigned int const width;
+    unsigned int const height;
+    unsigned int const bytes_per_pixel;
+    std::unique_ptr<mir::utils::DirtyRectStream> writer;
+    std::chrono::steady_clock::time_point start;
+};
+
 std::unique_ptr<Screencast> create_screencast(int num_captures, double capture_fps,
                                               MirConnection* connection,
                                               ScreencastConfiguration* config,
@@ -454,6 +537,7 @@ try
     std::vector<int> requested_size;
     bool use_std_out = false;
     bool query_params_only = false;
+    bool dirty_rects = false;
     int capture_interval = 1;
 
     po::options_description desc("Usage");
@@ -474,6 +558,9 @@ try
             po::value<std::vector<int>>(&screen_region)->multitoken(),
             "screen region to capture [left top width height]")
         ("stdout", po::value<bool>(&use_std_out)->zero_tokens(), "use stdout for output (--file is ignored)")
+        ("dirty-rects",
+            po::value<bool>(&dirty_rects)->zero_tokens(),
+            "write only the parts of each frame that changed, as a dirty-rect stream (see src/utils/dirty_rect_stream.h)")
         ("query",
             po::value<bool>(&query_params_only)->zero_tokens(),
             "only queries the colorspace and output size used but does not start screencast")
@@ -549,6 +636,8 @@ try
     mir_screencast_spec_set_height(spec, screencast_config.height);
     mir_screencast_spec_set_pixel_format(spec, screencast_config.pixel_format);
     mir_screencast_spec_set_capture_region(spec, &screencast_config.region);
+    if (dirty_rects)
+        mir_screencast_spec_set_number_of_buffers(spec, 0);
 
     double capture_rate_limit = get_capture_rate_limit(*display_config, screencast_config);
     double capture_fps = capture_rate_limit/capture_interval;
@@ -562,11 +651,20 @@ try
     if (mir_screencast == nullptr)
         throw std::runtime_error("Failed to create screencast");
 
-    auto buffer_stream = mir_screencast_get_buffer_stream(mir_screencast.get());
-    if (buffer_stream == nullptr)
-        throw std::runtime_error("Failed to obtain buffer stream from screencast");
+    std::unique_ptr<Screencast> screencast;
+    if (dirty_rects)
+    {
+        screencast = std::make_unique<DirtyRectScreencast>(
+            number_of_captures, capture_fps, connection.get(), &screencast_config, mir_screencast.get());
+    }
+    else
+    {
+        auto buffer_stream = mir_screencast_get_buffer_stream(mir_screencast.get());
+        if (buffer_stream == nullptr)
+            throw std::runtime_error("Failed to obtain buffer stream from screencast");
 
-    auto screencast = create_screencast(number_of_captures, capture_fps, connection.get(), &screencast_config, buffer_stream);
+        screencast = create_screencast(number_of_captures, capture_fps, connection.get(), &screencast_config, buffer_stream);
+    }
 
     if (output_filename.empty() && !use_std_out)
     {
@@ -575,6 +673,8 @@ try
         ss << screencast_config.width << "x" << screencast_config.height;
         ss << "_" << capture_fps << "Hz";
         ss << to_file_extension(screencast->pixel_format());
+        if (dirty_rects)
+            ss << ".mdrs";
         output_filename = ss.str();
     }
 
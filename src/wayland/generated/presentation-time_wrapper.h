@@ -0,0 +1,102 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from presentation-time.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+namespace mir
+{
+namespace wayland
+{
+
+class Presentation
+{
+public:
+    static char const constexpr* interface_name = "wp_presentation";
+    static int const interface_version = 1;
+
+    static Presentation* from(struct wl_resource*);
+
+    Presentation(struct wl_display* display, uint32_t max_version);
+    virtual ~Presentation();
+
+    void send_clock_id_event(struct wl_resource* resource, uint32_t clk_id) const;
+
+    void destroy_wayland_object(struct wl_resource* resource) const;
+
+    struct wl_global* const global;
+    uint32_t const max_version;
+
+    struct Error
+    {
+        static uint32_t const invalid_timestamp = 0;
+        static uint32_t const invalid_flag = 1;
+    };
+
+    struct Opcode
+    {
+        static uint32_t const clock_id = 0;
+    };
+
+    struct Thunks;
+
+private:
+    virtual void bind(struct wl_client* client, struct wl_resource* resource) { (void)client; (void)resource; }
+
+    virtual void destroy(struct wl_client* client, struct wl_resource* resource) = 0;
+    virtual void feedback(struct wl_client* client, struct wl_resource* resource, struct wl_resource* surface, uint32_t callback) = 0;
+};
+
+class PresentationFeedback
+{
+public:
+    static char const constexpr* interface_name = "wp_presentation_feedback";
+    static int const interface_version = 1;
+
+    static PresentationFeedback* from(struct wl_resource*);
+
+    PresentationFeedback(struct wl_client* client, struct wl_resource* parent, uint32_t id);
+    virtual ~PresentationFeedback() = default;
+
+    void send_sync_output_event(struct wl_resource* output) const;
+    void send_presented_event(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags) const;
+    void send_discarded_event() const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Kind
+    {
+        static uint32_t const vsync = 0x1;
+        static uint32_t const hw_clock = 0x2;
+        static uint32_t const hw_completion = 0x4;
+        static uint32_t const zero_copy = 0x8;
+    };
+
+    struct Opcode
+    {
+        static uint32_t const sync_output = 0;
+        static uint32_t const presented = 1;
+        static uint32_t const discarded = 2;
+    };
+
+    struct Thunks;
+
+private:
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_PRESENTATION_TIME_XML_WRAPPER
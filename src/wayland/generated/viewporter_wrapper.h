@@ -0,0 +1,88 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from viewporter.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+namespace mir
+{
+namespace wayland
+{
+
+class Viewporter
+{
+public:
+    static char const constexpr* interface_name = "wp_viewporter";
+    static int const interface_version = 1;
+
+    static Viewporter* from(struct wl_resource*);
+
+    Viewporter(struct wl_display* display, uint32_t max_version);
+    virtual ~Viewporter();
+
+    void destroy_wayland_object(struct wl_resource* resource) const;
+
+    struct wl_global* const global;
+    uint32_t const max_version;
+
+    struct Error
+    {
+        static uint32_t const viewport_exists = 0;
+    };
+
+    struct Thunks;
+
+private:
+    virtual void bind(struct wl_client* client, struct wl_resource* resource) { (void)client; (void)resource; }
+
+    virtual void destroy(struct wl_client* client, struct wl_resource* resource) = 0;
+    virtual void get_viewport(struct wl_client* client, struct wl_resource* resource, uint32_t id, struct wl_resource* surface) = 0;
+};
+
+class Viewport
+{
+public:
+    static char const constexpr* interface_name = "wp_viewport";
+    static int const interface_version = 1;
+
+    static Viewport* from(struct wl_resource*);
+
+    Viewport(struct wl_client* client, struct wl_resource* parent, uint32_t id);
+    virtual ~Viewport() = default;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const bad_value = 0;
+        static uint32_t const bad_size = 1;
+        static uint32_t const out_of_buffer = 2;
+        static uint32_t const no_surface = 3;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void destroy() = 0;
+    virtual void set_source(double x, double y, double width, double height) = 0;
+    virtual void set_destination(int32_t width, int32_t height) = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_VIEWPORTER_XML_WRAPPER
@@ -80,6 +80,13 @@ public:
         return !rectangular;
     }
 
+    geometry::Region opaque_region() const override
+    {
+        if (!rectangular || opacity != 1.0f)
+            return {};
+        return geometry::Region{rect};
+    }
+
     void set_buffer(std::shared_ptr<graphics::Buffer> b)
     {
         buf = b;
@@ -95,11 +102,21 @@ public:
         return rect;
     }
 
+    geometry::Rectangle src_bounds() const override
+    {
+        return {{0, 0}, rect.size};
+    }
+
     unsigned int swap_interval() const override
     {
         return 1u;
     }
 
+    geometry::Rectangles buffer_damage_since(graphics::BufferID) const override
+    {
+        return geometry::Rectangles{{{0, 0}, buf->size()}};
+    }
+
 private:
     std::shared_ptr<graphics::Buffer> buf;
     mir::geometry::Rectangle rect;
@@ -53,6 +53,12 @@ struct MockBufferStream : public compositor::BufferStream
             .WillByDefault(testing::Return(mir_pixel_format_abgr_8888));
         ON_CALL(*this, stream_size())
             .WillByDefault(testing::Return(geometry::Size{0,0}));
+        ON_CALL(*this, buffer_damage(testing::_, testing::_))
+            .WillByDefault(testing::Invoke(
+                [](graphics::BufferID, graphics::Buffer const& buffer)
+                {
+                    return geometry::Rectangles{{{0, 0}, buffer.size()}};
+                }));
     }
     std::shared_ptr<StubBuffer> buffer { std::make_shared<StubBuffer>() };
     MOCK_METHOD1(acquire_client_buffer, void(std::function<void(graphics::Buffer* buffer)>));
@@ -60,6 +66,7 @@ struct MockBufferStream : public compositor::BufferStream
     MOCK_METHOD1(lock_compositor_buffer,
                  std::shared_ptr<graphics::Buffer>(void const*));
     MOCK_METHOD1(set_frame_posted_callback, void(std::function<void(geometry::Size const&)> const&));
+    MOCK_METHOD1(set_frame_presented_callback, void(std::function<void(compositor::PresentedFrame const&, bool, uint64_t)> const&));
 
     MOCK_METHOD0(get_stream_pixel_format, MirPixelFormat());
     MOCK_METHOD0(stream_size, geometry::Size());
@@ -69,15 +76,22 @@ struct MockBufferStream : public compositor::BufferStream
 
     MOCK_CONST_METHOD1(buffers_ready_for_compositor, int(void const*));
     MOCK_METHOD0(drop_old_buffers, void());
+    MOCK_METHOD2(frame_presented, void(compositor::PresentedFrame const&, bool));
     MOCK_METHOD0(drop_client_requests, void());
 
     MOCK_METHOD1(submit_buffer, void(std::shared_ptr<graphics::Buffer> const&));
+    MOCK_METHOD2(submit_buffer, void(std::shared_ptr<graphics::Buffer> const&, geometry::Rectangles const&));
     MOCK_METHOD1(with_most_recent_buffer_do, void(std::function<void(graphics::Buffer&)> const&));
     MOCK_CONST_METHOD0(pixel_format, MirPixelFormat());
     MOCK_CONST_METHOD0(has_submitted_buffer, bool());
     MOCK_METHOD1(disassociate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(associate_buffer, void(graphics::BufferID));
     MOCK_METHOD1(set_scale, void(float));
+    MOCK_METHOD1(set_opaque_region, void(geometry::Region const&));
+    MOCK_METHOD2(set_viewport, void(optional_value<geometry::Rectangle> const&, optional_value<geometry::Size> const&));
+    MOCK_CONST_METHOD0(src_bounds, geometry::Rectangle());
+    MOCK_CONST_METHOD0(opaque_region, geometry::Region());
+    MOCK_CONST_METHOD2(buffer_damage, geometry::Rectangles(graphics::BufferID, graphics::Buffer const&));
 
 };
 }
@@ -37,22 +37,37 @@ struct MockRenderable : public graphics::Renderable
             .WillByDefault(testing::Return(geometry::Rectangle{{},{}}));
         ON_CALL(*this, buffer())
             .WillByDefault(testing::Return(std::make_shared<StubBuffer>()));
+        ON_CALL(*this, src_bounds())
+            .WillByDefault(testing::Invoke(
+                [this]
+                {
+                    return geometry::Rectangle{{0, 0}, buffer()->size()};
+                }));
         ON_CALL(*this, alpha())
             .WillByDefault(testing::Return(1.0f));
         ON_CALL(*this, transformation())
             .WillByDefault(testing::Return(glm::mat4{}));
         ON_CALL(*this, visible())
             .WillByDefault(testing::Return(true));
+        ON_CALL(*this, buffer_damage_since(testing::_))
+            .WillByDefault(testing::Invoke(
+                [this](graphics::BufferID)
+                {
+                    return geometry::Rectangles{{{0, 0}, buffer()->size()}};
+                }));
     }
 
     MOCK_CONST_METHOD0(id, ID());
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
+    MOCK_CONST_METHOD0(src_bounds, geometry::Rectangle());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
     MOCK_CONST_METHOD0(shaped, bool());
+    MOCK_CONST_METHOD0(opaque_region, geometry::Region());
     MOCK_CONST_METHOD0(swap_interval, unsigned int());
+    MOCK_CONST_METHOD1(buffer_damage_since, geometry::Rectangles(graphics::BufferID));
 };
 }
 }
@@ -33,6 +33,8 @@ struct MockRenderer : public renderer::Renderer
 {
     MOCK_METHOD1(set_viewport, void(geometry::Rectangle const&));
     MOCK_METHOD1(set_output_transform, void(glm::mat2 const&));
+    MOCK_METHOD1(set_damage, void(geometry::Rectangles const&));
+    MOCK_METHOD2(set_visible_region, void(graphics::Renderable::ID, geometry::Region const&));
     MOCK_CONST_METHOD1(render, void(graphics::RenderableList const&));
     MOCK_METHOD0(suspend, void());
 
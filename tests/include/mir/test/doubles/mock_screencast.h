@@ -44,7 +44,10 @@ public:
     MOCK_METHOD1(capture,
                  std::shared_ptr<graphics::Buffer>(
                      frontend::ScreencastSessionId));
-    MOCK_METHOD2(capture, void(frontend::ScreencastSessionId, std::shared_ptr<graphics::Buffer> const&));
+    MOCK_METHOD2(capture,
+                 geometry::Rectangles(
+                     frontend::ScreencastSessionId,
+                     std::shared_ptr<graphics::Buffer> const&));
 };
 
 }
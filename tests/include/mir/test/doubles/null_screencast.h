@@ -47,7 +47,10 @@ public:
     {
         return nullptr;
     }
-    void capture(frontend::ScreencastSessionId, std::shared_ptr<graphics::Buffer> const&) {}
+    geometry::Rectangles capture(frontend::ScreencastSessionId, std::shared_ptr<graphics::Buffer> const&)
+    {
+        return {};
+    }
 };
 
 }
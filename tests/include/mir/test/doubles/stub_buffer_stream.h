@@ -61,18 +61,32 @@ public:
     int buffers_ready_for_compositor(void const*) const override { return nready; }
 
     void drop_old_buffers() override {}
+    void frame_presented(compositor::PresentedFrame const&, bool) override {}
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& b) override
     {
         if (b) ++nready;
     }
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& b, geometry::Rectangles const&) override
+    {
+        if (b) ++nready;
+    }
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& fn) override
     {
         fn(*stub_compositor_buffer);
     }
     MirPixelFormat pixel_format() const override { return mir_pixel_format_abgr_8888; }
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const&) override {}
+    void set_frame_presented_callback(std::function<void(compositor::PresentedFrame const&, bool, uint64_t)> const&) override {}
     bool has_submitted_buffer() const override { return true; }
     void set_scale(float) override {}
+    void set_opaque_region(geometry::Region const&) override {}
+    void set_viewport(optional_value<geometry::Rectangle> const&, optional_value<geometry::Size> const&) override {}
+    geometry::Rectangle src_bounds() const override { return {{0, 0}, stub_compositor_buffer->size()}; }
+    geometry::Region opaque_region() const override { return {}; }
+    geometry::Rectangles buffer_damage(graphics::BufferID, graphics::Buffer const& buffer) const override
+    {
+        return geometry::Rectangles{{{0, 0}, buffer.size()}};
+    }
 
     std::shared_ptr<graphics::Buffer> stub_compositor_buffer;
     int nready = 0;
@@ -33,6 +33,10 @@ class StubInputScene : public input::Scene
     void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& ) override
     {
     }
+    auto input_surface_at(geometry::Point) const -> std::shared_ptr<input::Surface> override
+    {
+        return {};
+    }
     void add_observer(std::shared_ptr<scene::Observer> const& /* observer */) override
     {
     }
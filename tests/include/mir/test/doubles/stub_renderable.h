@@ -74,6 +74,10 @@ public:
     {
         return rect;
     }
+    geometry::Rectangle src_bounds() const override
+    {
+        return {{0, 0}, stub_buffer->size()};
+    }
     float alpha() const override
     {
         return 1.0f;
@@ -86,10 +90,20 @@ public:
     {
         return false;
     }
+    geometry::Region opaque_region() const override
+    {
+        if (shaped() || alpha() != 1.0f)
+            return {};
+        return geometry::Region{screen_position()};
+    }
     unsigned int swap_interval() const override
     {
         return 1;
     }
+    geometry::Rectangles buffer_damage_since(graphics::BufferID) const override
+    {
+        return geometry::Rectangles{{{0, 0}, stub_buffer->size()}};
+    }
 
 private:
     std::shared_ptr<graphics::Buffer> make_stub_buffer(geometry::Rectangle const& rect)
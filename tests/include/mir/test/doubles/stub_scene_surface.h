@@ -51,7 +51,9 @@ public:
 
     void set_streams(std::list<scene::StreamInfo> const&) override {}
     graphics::RenderableList generate_renderables(compositor::CompositorID) const override { return {}; }
+    void append_renderables(compositor::CompositorID, graphics::RenderableList&) const override {}
     int buffers_ready_for_compositor(void const*) const override { return 0; }
+    void frame_presented(compositor::PresentedFrame const&, bool) override {}
 
     MirWindowType type() const override { return mir_window_type_normal; }
     MirWindowState state() const override { return mir_window_state_unknown; }
@@ -61,6 +63,7 @@ public:
     bool visible() const override { return true; }
     void move_to(geometry::Point const&) override {}
     void set_input_region(std::vector<geometry::Rectangle> const&) override {}
+    geometry::Rectangle input_area_bounds() const override { return input_bounds(); }
     void resize(geometry::Size const&) override {}
     void set_transformation(glm::mat4 const&) override {}
     void set_alpha(float) override {}
@@ -142,6 +142,20 @@ void mtd::FakeDisplay::configure(mir::graphics::DisplayConfiguration const& new_
     swap(groups, new_groups);
 }
 
+mg::Frame mtd::FakeDisplay::last_frame_on(unsigned output_id) const
+{
+    std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+
+    // There's a sync group for each output, in the same order
+    for (size_t i = 0; i != config->outputs.size() && i != groups.size(); ++i)
+    {
+        if (config->outputs[i].id.as_value() == static_cast<int>(output_id))
+            return groups[i]->last_frame();
+    }
+
+    return {};
+}
+
 void mtd::FakeDisplay::emit_configuration_change_event(
     std::shared_ptr<mir::graphics::DisplayConfiguration> const& new_config)
 {
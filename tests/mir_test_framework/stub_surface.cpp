@@ -61,6 +61,11 @@ void mtd::StubSurface::set_input_region(std::vector<mir::geometry::Rectangle> co
 {
 }
 
+mir::geometry::Rectangle mtd::StubSurface::input_area_bounds() const
+{
+    return {};
+}
+
 void mtd::StubSurface::resize(mir::geometry::Size const& /*size*/)
 {
 }
@@ -106,11 +111,21 @@ mir::graphics::RenderableList mtd::StubSurface::generate_renderables(mir::compos
     return {};
 }
 
+void mtd::StubSurface::append_renderables(
+    mir::compositor::CompositorID /*id*/,
+    mir::graphics::RenderableList& /*renderables*/) const
+{
+}
+
 int mtd::StubSurface::buffers_ready_for_compositor(void const* /*compositor_id*/) const
 {
     return 0;
 }
 
+void mtd::StubSurface::frame_presented(mir::compositor::PresentedFrame const& /*frame*/, bool /*on_screen*/)
+{
+}
+
 MirWindowType mtd::StubSurface::type() const
 {
     return MirWindowType::mir_window_type_normal;
@@ -0,0 +1,137 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/compositor/stream.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/input/input_reception_mode.h"
+#include "mir/graphics/renderable.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+std::atomic<unsigned long> allocation_count{0};
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    if (auto const p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+using namespace testing;
+
+namespace
+{
+int const surface_count{100};
+int const frame_count{1000};
+
+struct SceneAllocations : Test
+{
+    void SetUp() override
+    {
+        stack.register_compositor(this);
+
+        for (int i = 0; i != surface_count; ++i)
+        {
+            auto const stream = std::make_shared<mc::Stream>(
+                geom::Size{64, 64}, mir_pixel_format_abgr_8888);
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                "surface",
+                geom::Rectangle{{(i % 10) * 100, (i / 10) * 100}, {64, 64}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{{stream, {}, {}}},
+                std::shared_ptr<mg::CursorImage>{},
+                mir::report::null_scene_report());
+
+            stream->submit_buffer(std::make_shared<mtd::StubBuffer>());
+            stack.add_surface(surface, mir::input::InputReceptionMode::normal);
+            surface->configure(mir_window_attrib_visibility, mir_window_visibility_exposed);
+            streams.push_back(stream);
+        }
+    }
+
+    void TearDown() override
+    {
+        stack.unregister_compositor(this);
+    }
+
+    void composite_frame()
+    {
+        for (auto const& element : stack.scene_elements_for(this))
+        {
+            element->renderable()->buffer();
+            element->rendered();
+        }
+    }
+
+    double allocations_per_frame()
+    {
+        // Let the per-compositor pools and thread-local storage fill up
+        for (int i = 0; i != 10; ++i)
+            composite_frame();
+
+        auto const before = allocation_count.load();
+        for (int i = 0; i != frame_count; ++i)
+            composite_frame();
+
+        return double(allocation_count.load() - before) / frame_count;
+    }
+
+    ms::SurfaceStack stack{mir::report::null_scene_report()};
+    std::vector<std::shared_ptr<mc::Stream>> streams;
+};
+}
+
+TEST_F(SceneAllocations, steady_state_frame_does_not_allocate_per_surface)
+{
+    auto const per_frame = allocations_per_frame();
+
+    std::cout << "Heap allocations per composited frame with "
+              << surface_count << " surfaces: " << per_frame << std::endl;
+
+    // The returned scene sequence is still a fresh vector each frame; nothing
+    // that scales with the number of surfaces should reach the heap.
+    EXPECT_THAT(per_frame, Le(1.0));
+}
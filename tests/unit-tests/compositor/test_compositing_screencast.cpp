@@ -223,6 +223,36 @@ struct CompositingScreencastTest : testing::Test
     MirPixelFormat const default_pixel_format;
     int const default_num_buffers{2};
     MirMirrorMode const default_mirror_mode{mir_mirror_mode_vertical};
+
+    /// The damage reported when something appears at changed after a first capture
+    geom::Rectangles damage_when_changing(
+        geom::Rectangle const& region,
+        geom::Size const& buffer_size,
+        MirMirrorMode mirror_mode,
+        geom::Rectangle const& changed)
+    {
+        using namespace testing;
+
+        mtd::StubSceneElement element{std::make_shared<mtd::StubRenderable>(changed)};
+        NiceMock<mtd::MockScene> mock_scene;
+        EXPECT_CALL(mock_scene, scene_elements_for(_))
+            .WillOnce(Return(mc::SceneElementSequence{}))
+            .WillOnce(Return(mc::SceneElementSequence{mt::fake_shared(element)}));
+
+        mc::CompositingScreencast screencast_local{
+            mt::fake_shared(mock_scene),
+            mt::fake_shared(stub_display),
+            mt::fake_shared(stub_buffer_allocator),
+            mt::fake_shared(stub_db_compositor_factory)};
+
+        auto const buffer = std::make_shared<mtd::StubGLBuffer>(buffer_size);
+        auto const session_id = screencast_local.create_session(
+            region, buffer_size, default_pixel_format, 0, mirror_mode);
+
+        EXPECT_THAT(screencast_local.capture(session_id, buffer),
+                    Eq(geom::Rectangles{{{0, 0}, buffer_size}}));
+        return screencast_local.capture(session_id, buffer);
+    }
 };
 
 }
@@ -486,7 +516,15 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
     MockBufferAllocator mock_buffer_allocator;
     int const expected_num_buffers = 4;
     std::vector<mtd::StubGLBuffer> buffers(expected_num_buffers);
+    NiceMock<mtd::MockScene> changing_scene;
 
+    // Something new on screen each time, so each capture needs a new buffer
+    ON_CALL(changing_scene, scene_elements_for(_))
+        .WillByDefault(InvokeWithoutArgs([this]
+            {
+                return mc::SceneElementSequence{std::make_shared<mtd::StubSceneElement>(
+                    std::make_shared<mtd::StubRenderable>(default_region))};
+            }));
 
     EXPECT_CALL(mock_buffer_allocator, alloc_buffer(_))
         .WillOnce(Return(mt::fake_shared(buffers[0])))
@@ -495,7 +533,7 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
         .WillOnce(Return(mt::fake_shared(buffers[3])));
 
     mc::CompositingScreencast screencast_local{
-        mt::fake_shared(stub_scene),
+        mt::fake_shared(changing_scene),
         mt::fake_shared(stub_display),
         mt::fake_shared(mock_buffer_allocator),
         mt::fake_shared(stub_db_compositor_factory)};
@@ -511,4 +549,105 @@ TEST_F(CompositingScreencastTest, uses_requested_number_of_buffers)
     }
 }
 
+TEST_F(CompositingScreencastTest, recapture_of_unchanged_scene_returns_last_buffer_without_compositing)
+{
+    using namespace testing;
+
+    std::vector<mtd::StubGLBuffer> buffers(default_num_buffers);
+    NiceMock<MockBufferAllocator> mock_buffer_allocator;
+    NiceMock<MockDisplayBufferCompositorFactory> mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_buffer_allocator, alloc_buffer(_))
+        .WillOnce(Return(mt::fake_shared(buffers[0])))
+        .WillOnce(Return(mt::fake_shared(buffers[1])));
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(1);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(stub_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(mock_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        default_num_buffers, default_mirror_mode);
+
+    auto const first = screencast_local.capture(session_id);
+    EXPECT_THAT(screencast_local.capture(session_id), Eq(first));
+}
+
+TEST_F(CompositingScreencastTest, does_not_recomposite_unchanged_scene_into_the_same_buffer)
+{
+    using namespace testing;
+
+    auto const buffer = std::make_shared<mtd::StubGLBuffer>(default_size);
+    NiceMock<MockDisplayBufferCompositorFactory> mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(1);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(stub_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
+
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        0, default_mirror_mode);
+
+    EXPECT_THAT(screencast_local.capture(session_id, buffer), Eq(geom::Rectangles{{{0, 0}, default_size}}));
+    EXPECT_THAT(screencast_local.capture(session_id, buffer), Eq(geom::Rectangles{}));
+}
+
+TEST_F(CompositingScreencastTest, composites_unchanged_scene_into_a_different_buffer)
+{
+    using namespace testing;
+
+    auto const buffer1 = std::make_shared<mtd::StubGLBuffer>(default_size);
+    auto const buffer2 = std::make_shared<mtd::StubGLBuffer>(default_size);
+    NiceMock<MockDisplayBufferCompositorFactory> mock_db_compositor_factory;
+
+    EXPECT_CALL(mock_db_compositor_factory.mock_db_compositor, composite_(_))
+        .Times(2);
+
+    mc::CompositingScreencast screencast_local{
+        mt::fake_shared(stub_scene),
+        mt::fake_shared(stub_display),
+        mt::fake_shared(stub_buffer_allocator),
+        mt::fake_shared(mock_db_compositor_factory)};
 
+    auto session_id = screencast_local.create_session(
+        default_region, default_size, default_pixel_format,
+        0, default_mirror_mode);
+
+    screencast_local.capture(session_id, buffer1);
+    EXPECT_THAT(screencast_local.capture(session_id, buffer2), Eq(geom::Rectangles{}));
+}
+
+TEST_F(CompositingScreencastTest, reports_damage_in_scaled_buffer_coordinates)
+{
+    using namespace testing;
+
+    geom::Rectangle const region{{100, 100}, {200, 200}};
+    geom::Size const buffer_size{100, 100};
+    geom::Rectangle const changed{{120, 140}, {31, 40}};
+
+    EXPECT_THAT(damage_when_changing(region, buffer_size, mir_mirror_mode_none, changed),
+                Eq(geom::Rectangles{{{10, 20}, {16, 20}}}));
+}
+
+TEST_F(CompositingScreencastTest, reports_damage_mirrored_as_captured)
+{
+    using namespace testing;
+
+    geom::Rectangle const region{{0, 0}, {100, 100}};
+    geom::Size const buffer_size{100, 100};
+    geom::Rectangle const changed{{10, 20}, {30, 40}};
+
+    EXPECT_THAT(damage_when_changing(region, buffer_size, mir_mirror_mode_vertical, changed),
+                Eq(geom::Rectangles{{{10, 40}, {30, 40}}}));
+    EXPECT_THAT(damage_when_changing(region, buffer_size, mir_mirror_mode_horizontal, changed),
+                Eq(geom::Rectangles{{{60, 20}, {30, 40}}}));
+}
@@ -22,6 +22,7 @@
 #include "mir/compositor/scene.h"
 #include "mir/renderer/renderer.h"
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/test/doubles/mock_renderer.h"
 #include "mir/test/fake_shared.h"
 #include "mir/test/gmock_fixes.h"
@@ -388,3 +389,195 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+
+TEST_F(DefaultDisplayBufferCompositor, damages_whole_screen_on_first_frame)
+{
+    using namespace testing;
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{screen}));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, unchanged_scene_has_no_damage)
+{
+    using namespace testing;
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{}));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, new_buffer_damages_only_its_renderable)
+{
+    using namespace testing;
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{small->screen_position()}));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, new_buffer_damages_only_its_damaged_part)
+{
+    using namespace testing;
+
+    struct PartlyDamagedRenderable : mtd::FakeRenderable
+    {
+        using FakeRenderable::FakeRenderable;
+        geom::Rectangles buffer_damage_since(mg::BufferID) const override
+        {
+            return geom::Rectangles{{{2, 3}, {4, 5}}};
+        }
+    };
+
+    geom::Rectangle const position{{10, 20}, {30, 40}};
+    auto const window = std::make_shared<PartlyDamagedRenderable>(position);
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(position.size));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, window}));
+
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(position.size));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{{{12, 23}, {4, 5}}}));
+    compositor.composite(make_scene_elements({big, window}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, new_buffer_damages_all_of_a_cropped_renderable)
+{
+    using namespace testing;
+
+    struct CroppedRenderable : mtd::FakeRenderable
+    {
+        using FakeRenderable::FakeRenderable;
+        geom::Rectangle src_bounds() const override
+        {
+            return {{5, 5}, screen_position().size};
+        }
+        geom::Rectangles buffer_damage_since(mg::BufferID) const override
+        {
+            return geom::Rectangles{{{2, 3}, {4, 5}}};
+        }
+    };
+
+    geom::Rectangle const position{{10, 20}, {30, 40}};
+    auto const window = std::make_shared<CroppedRenderable>(position);
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(position.size));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, window}));
+
+    window->set_buffer(std::make_shared<mtd::StubBuffer>(position.size));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{position}));
+    compositor.composite(make_scene_elements({big, window}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, moved_renderable_damages_old_and_new_positions)
+{
+    using namespace testing;
+
+    struct MovedRenderable : mtd::FakeRenderable
+    {
+        MovedRenderable(geom::Rectangle const& rect, ID id) : FakeRenderable{rect}, id_{id} {}
+        ID id() const override { return id_; }
+        ID const id_;
+    };
+
+    geom::Rectangle const before{{10, 20}, {30, 40}};
+    geom::Rectangle const after{{500, 300}, {30, 40}};
+    auto const window = std::make_shared<mtd::FakeRenderable>(before);
+    auto const moved_window = std::make_shared<MovedRenderable>(after, window->id());
+    moved_window->set_buffer(window->buffer());
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({window}));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{before, after}));
+    compositor.composite(make_scene_elements({moved_window}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, removed_renderable_damages_where_it_was)
+{
+    using namespace testing;
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{small->screen_position()}));
+    compositor.composite(make_scene_elements({big}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, damages_whole_screen_after_overlay)
+{
+    using namespace testing;
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    compositor.composite(make_scene_elements({big, small}));
+
+    EXPECT_CALL(mock_renderer, set_damage(geom::Rectangles{screen}));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, clips_partly_covered_renderables_to_their_visible_region)
+{
+    using namespace testing;
+
+    auto const beneath = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {100, 100}});
+    auto const above = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{50, 0}, {100, 100}});
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    InSequence seq;
+    EXPECT_CALL(mock_renderer, set_visible_region(beneath->id(), geom::Region{geom::Rectangle{{0, 0}, {50, 100}}}));
+    EXPECT_CALL(mock_renderer, render(_));
+
+    compositor.composite(make_scene_elements({beneath, above}));
+}
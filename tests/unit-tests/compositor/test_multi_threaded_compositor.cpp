@@ -28,6 +28,7 @@
 
 #include "mir/test/current_thread_name.h"
 #include "mir/test/doubles/null_display.h"
+#include "mir/test/doubles/fake_display.h"
 #include "mir/test/doubles/null_display_buffer.h"
 #include "mir/test/doubles/mock_display_buffer.h"
 #include "mir/test/doubles/mock_compositor_report.h"
@@ -40,6 +41,7 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <set>
 #include <thread>
 #include <mutex>
 #include <chrono>
@@ -93,6 +95,40 @@ private:
     std::vector<StubDisplaySyncGroup> buffers;
 };
 
+class StubDisplayWithOneSyncGroup : public mtd::NullDisplay
+{
+public:
+    StubDisplayWithOneSyncGroup(unsigned int nbuffers, std::function<void()> const& on_post = []{}) :
+        group{std::vector<geom::Rectangle>(nbuffers, geom::Rectangle{{0,0},{1,1}}), on_post}
+    {
+    }
+
+    void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+    {
+        f(group);
+    }
+
+private:
+    struct PostNotifyingSyncGroup : mtd::StubDisplaySyncGroup
+    {
+        PostNotifyingSyncGroup(std::vector<geom::Rectangle> const& rects, std::function<void()> const& on_post) :
+            mtd::StubDisplaySyncGroup{rects},
+            on_post{on_post}
+        {
+        }
+
+        void post() override
+        {
+            on_post();
+            mtd::StubDisplaySyncGroup::post();
+        }
+
+        std::function<void()> const on_post;
+    };
+
+    PostNotifyingSyncGroup group;
+};
+
 class StubScene : public mtd::StubScene
 {
 public:
@@ -388,6 +424,142 @@ TEST(MultiThreadedCompositor, compositing_happens_in_different_threads)
     EXPECT_TRUE(db_compositor_factory->buffers_rendered_in_different_threads());
 }
 
+TEST(MultiThreadedCompositor, composites_display_buffers_of_a_sync_group_in_parallel)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers{3};
+
+    auto display = std::make_shared<StubDisplayWithOneSyncGroup>(nbuffers);
+    auto scene = std::make_shared<StubScene>();
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!db_compositor_factory->enough_records_gathered(nbuffers))
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    EXPECT_TRUE(db_compositor_factory->each_buffer_rendered_in_single_thread());
+    EXPECT_TRUE(db_compositor_factory->buffers_rendered_in_different_threads());
+}
+
+TEST(MultiThreadedCompositor, posts_sync_group_once_all_its_display_buffers_are_composited)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers{3};
+
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    unsigned int posts{0};
+    std::atomic<bool> posted_early{false};
+    auto display = std::make_shared<StubDisplayWithOneSyncGroup>(nbuffers, [&]
+        {
+            ++posts;
+            if (!db_compositor_factory->check_record_count_for_each_buffer(nbuffers, posts, posts))
+                posted_early = true;
+        });
+    auto scene = std::make_shared<StubScene>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!db_compositor_factory->enough_records_gathered(nbuffers, 100))
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    EXPECT_FALSE(posted_early);
+}
+
+TEST(MultiThreadedCompositor, tells_scene_each_compositor_presented_after_posting)
+{
+    using namespace testing;
+
+    unsigned int const nbuffers{3};
+
+    struct PresentationRecordingScene : StubScene
+    {
+        void frame_presented(mc::CompositorID id, mc::PresentedFrame const&) override
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (posts == 0)
+                presented_before_post = true;
+            presented.insert(id);
+        }
+
+        std::mutex mutex;
+        unsigned int posts{0};
+        bool presented_before_post{false};
+        std::set<mc::CompositorID> presented;
+    };
+
+    auto scene = std::make_shared<PresentationRecordingScene>();
+    auto display = std::make_shared<StubDisplayWithOneSyncGroup>(nbuffers, [&]
+        {
+            std::lock_guard<std::mutex> lock{scene->mutex};
+            ++scene->posts;
+        });
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!db_compositor_factory->enough_records_gathered(nbuffers, 10))
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    std::lock_guard<std::mutex> lock{scene->mutex};
+    EXPECT_FALSE(scene->presented_before_post);
+    EXPECT_THAT(scene->presented.size(), Eq(nbuffers));
+}
+
+TEST(MultiThreadedCompositor, tells_scene_when_the_output_showed_each_frame)
+{
+    using namespace testing;
+
+    struct PresentationRecordingScene : StubScene
+    {
+        void frame_presented(mc::CompositorID, mc::PresentedFrame const& frame) override
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            presented.push_back(frame);
+        }
+
+        std::mutex mutex;
+        std::vector<mc::PresentedFrame> presented;
+    };
+
+    auto scene = std::make_shared<PresentationRecordingScene>();
+    // Its one output is at 60Hz, and its sync group counts posts as frames
+    auto display = std::make_shared<mtd::FakeDisplay>(std::vector<geom::Rectangle>{{{0, 0}, {640, 480}}});
+    auto db_compositor_factory = std::make_shared<RecordingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, true};
+
+    compositor.start();
+
+    while (!db_compositor_factory->enough_records_gathered(1, 10))
+        scene->emit_change_event();
+
+    compositor.stop();
+
+    std::lock_guard<std::mutex> lock{scene->mutex};
+    ASSERT_THAT(scene->presented.size(), Ge(2u));
+    for (size_t i = 0; i != scene->presented.size(); ++i)
+    {
+        auto const& presented = scene->presented[i];
+        EXPECT_THAT(presented.frame.msc, Eq(static_cast<int64_t>(i + 1)));
+        EXPECT_THAT(presented.frame.ust.clock_id, Eq(CLOCK_MONOTONIC));
+        EXPECT_THAT(presented.refresh, Eq(std::chrono::nanoseconds{16666666}));
+    }
+    EXPECT_THAT(
+        scene->presented.back().frame.ust.nanoseconds,
+        Gt(scene->presented.front().frame.ust.nanoseconds));
+}
+
 TEST(MultiThreadedCompositor, does_not_deadlock_itself)
 {   // Regression test for LP: #1471909
     auto scene = std::make_shared<StubScene>();
@@ -202,3 +202,51 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, shaped_window_occludes_what_is_beneath_its_opaque_region)
+{
+    struct OpaqueCentredRenderable : mtd::FakeRenderable
+    {
+        using FakeRenderable::FakeRenderable;
+        Region opaque_region() const override
+        {
+            return Region{Rectangle{{20, 20}, {80, 80}}};
+        }
+    };
+
+    auto const top = std::make_shared<OpaqueCentredRenderable>(Rectangle{{10, 10}, {100, 100}}, 1.0f, false);
+    auto const beneath_opaque = std::make_shared<mtd::FakeRenderable>(30, 30, 50, 50);
+    auto const beneath_shadow = std::make_shared<mtd::FakeRenderable>(10, 10, 50, 50);
+    auto elements = scene_elements_from({beneath_shadow, beneath_opaque, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(beneath_opaque));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(beneath_shadow, top));
+}
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_windows_occluded)
+{
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 50, 100);
+    auto const right = std::make_shared<mtd::FakeRenderable>(50, 0, 50, 100);
+    auto const beneath = std::make_shared<mtd::FakeRenderable>(10, 10, 80, 80);
+    auto elements = scene_elements_from({beneath, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(beneath));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
+
+TEST_F(OcclusionFilterTest, reports_visible_region_of_partly_covered_windows)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(0, 0, 50, 100);
+    auto const beneath = std::make_shared<mtd::FakeRenderable>(10, 10, 80, 80);
+    auto elements = scene_elements_from({beneath, top});
+    VisibleRegions partly_visible;
+
+    filter_occlusions_from(elements, monitor_rect, partly_visible);
+
+    ASSERT_THAT(partly_visible.size(), Eq(1u));
+    EXPECT_THAT(partly_visible[beneath->id()], Eq(Region{Rectangle{{50, 10}, {40, 80}}}));
+}
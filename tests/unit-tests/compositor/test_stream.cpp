@@ -156,6 +156,42 @@ TEST_F(Stream, frame_callback_is_called_without_scheduling_lock)
     stream.submit_buffer(buffers[0]);
 }
 
+TEST_F(Stream, calls_frame_presented_callback_once_per_submission)
+{
+    std::vector<int64_t> presented;
+    stream.set_frame_presented_callback(
+        [&presented](auto const& frame, auto, auto) { presented.push_back(frame.frame.msc); });
+
+    mc::PresentedFrame first{{1, {}}, {}};
+    mc::PresentedFrame second{{2, {}}, {}};
+
+    stream.frame_presented(first, true);
+    stream.submit_buffer(buffers[0]);
+    stream.frame_presented(first, true);
+    stream.frame_presented(second, true);
+
+    EXPECT_THAT(presented, ElementsAre(1));
+}
+
+TEST_F(Stream, frame_presented_callback_reports_the_latest_buffer_the_compositor_has_shown)
+{
+    std::vector<uint64_t> shown;
+    stream.set_frame_presented_callback([&shown](auto, auto, auto submission) { shown.push_back(submission); });
+
+    auto const now = mc::PresentedFrame::untimed(std::chrono::steady_clock::now());
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1]);
+    stream.frame_presented(now, true);
+
+    // The second buffer is shown by a later frame, with nothing submitted in between
+    stream.lock_compositor_buffer(this);
+    stream.frame_presented(now, true);
+
+    EXPECT_THAT(shown, ElementsAre(1u, 2u));
+}
+
 TEST_F(Stream, flattens_queue_out_when_told_to_drop)
 {
     for(auto& buffer : buffers)
@@ -204,6 +240,46 @@ TEST_F(Stream, reports_size)
 }
 
 //Likewise, no reason buffers couldn't all be a different pixel format
+TEST_F(Stream, shows_whole_buffer_at_its_own_size_by_default)
+{
+    stream.submit_buffer(buffers[0]);
+
+    EXPECT_THAT(stream.stream_size(), Eq(initial_size));
+    EXPECT_THAT(stream.src_bounds(), Eq(geom::Rectangle{{0, 0}, initial_size}));
+}
+
+TEST_F(Stream, viewport_crops_and_scales)
+{
+    geom::Rectangle const source{{4, 1}, {20, 1}};
+    geom::Size const destination{80, 4};
+
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport(source, destination);
+
+    EXPECT_THAT(stream.src_bounds(), Eq(source));
+    EXPECT_THAT(stream.stream_size(), Eq(destination));
+}
+
+TEST_F(Stream, viewport_source_alone_sets_size)
+{
+    geom::Rectangle const source{{4, 1}, {20, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.set_viewport(source, {});
+
+    EXPECT_THAT(stream.stream_size(), Eq(source.size));
+}
+
+// mirclient's mir_buffer_stream_set_scale() has never changed how big a stream is shown
+TEST_F(Stream, scale_does_not_change_reported_size)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.set_scale(2.0f);
+
+    EXPECT_THAT(stream.stream_size(), Eq(initial_size));
+    EXPECT_THAT(stream.src_bounds(), Eq(geom::Rectangle{{0, 0}, initial_size}));
+}
+
 TEST_F(Stream, reports_format)
 {
     EXPECT_THAT(stream.pixel_format(), Eq(construction_format));
@@ -227,3 +303,38 @@ TEST_F(Stream, returns_buffers_to_client_when_told_to_bring_queue_up_to_date)
     EXPECT_THAT(buffers[1].use_count(), Eq(1));
     EXPECT_THAT(buffers[2].use_count(), Eq(2));
 }
+
+TEST_F(Stream, reports_accumulated_damage_since_a_previous_buffer)
+{
+    geom::Rectangle const first{{1, 0}, {2, 1}};
+    geom::Rectangle const second{{30, 1}, {4, 1}};
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{first});
+    stream.submit_buffer(buffers[2], geom::Rectangles{second});
+
+    EXPECT_THAT(stream.buffer_damage(buffers[1]->id(), *buffers[2]), Eq(geom::Rectangles{second}));
+    EXPECT_THAT(stream.buffer_damage(buffers[0]->id(), *buffers[2]), Eq(geom::Rectangles{first, second}));
+}
+
+TEST_F(Stream, reports_whole_buffer_damaged_when_previous_buffer_is_unknown)
+{
+    auto const unknown = std::make_shared<mtd::StubBuffer>(initial_size);
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_THAT(
+        stream.buffer_damage(unknown->id(), *buffers[1]),
+        Eq(geom::Rectangles{{{0, 0}, initial_size}}));
+}
+
+TEST_F(Stream, reports_whole_buffer_damaged_across_a_resize)
+{
+    geom::Size const new_size{10, 10};
+    auto const resized = std::make_shared<mtd::StubBuffer>(new_size);
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(resized, geom::Rectangles{{{1, 1}, {2, 2}}});
+
+    EXPECT_THAT(
+        stream.buffer_damage(buffers[0]->id(), *resized),
+        Eq(geom::Rectangles{{{0, 0}, new_size}}));
+}
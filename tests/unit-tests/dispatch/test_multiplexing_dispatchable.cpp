@@ -28,6 +28,7 @@
 #include <fcntl.h>
 
 #include <atomic>
+#include <vector>
 #include <thread>
 
 #include <gtest/gtest.h>
@@ -105,6 +106,167 @@ TEST(MultiplexingDispatchableTest, keeps_dispatching_until_fd_is_unreadable)
     EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
 }
 
+TEST(MultiplexingDispatchableTest, single_dispatch_services_every_ready_dispatchee)
+{
+    using namespace testing;
+
+    int const dispatchee_count{8};
+    int dispatched{0};
+
+    md::MultiplexingDispatchable dispatcher;
+    std::vector<std::shared_ptr<mt::TestDispatchable>> dispatchees;
+    for (int i = 0; i != dispatchee_count; ++i)
+    {
+        dispatchees.push_back(std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; }));
+        dispatcher.add_watch(dispatchees.back());
+        dispatchees.back()->trigger();
+    }
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, Eq(dispatchee_count));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, dispatchee_removed_by_earlier_dispatch_in_same_batch_is_not_dispatched)
+{
+    using namespace testing;
+
+    int dispatched{0};
+    md::MultiplexingDispatchable dispatcher;
+
+    std::shared_ptr<mt::TestDispatchable> first, second;
+    first = std::make_shared<mt::TestDispatchable>(
+        [&]()
+        {
+            ++dispatched;
+            dispatcher.remove_watch(second);
+        });
+    second = std::make_shared<mt::TestDispatchable>(
+        [&]()
+        {
+            ++dispatched;
+            dispatcher.remove_watch(first);
+        });
+
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(second);
+    first->trigger();
+    second->trigger();
+
+    while (mt::fd_is_readable(dispatcher.watch_fd()))
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    EXPECT_THAT(dispatched, Eq(1));
+}
+
+TEST(MultiplexingDispatchableTest, removal_is_noticed_across_a_nested_dispatch_in_the_same_batch)
+{
+    using namespace testing;
+
+    int dispatched{0};
+    bool nested_dispatched{false};
+    md::MultiplexingDispatchable dispatcher;
+    auto const nested = std::make_shared<md::MultiplexingDispatchable>();
+    auto const nested_dispatchee =
+        std::make_shared<mt::TestDispatchable>([&nested_dispatched]() { nested_dispatched = true; });
+    nested->add_watch(nested_dispatchee);
+
+    std::shared_ptr<mt::TestDispatchable> first, second;
+    first = std::make_shared<mt::TestDispatchable>(
+        [&]()
+        {
+            ++dispatched;
+            dispatcher.remove_watch(second);
+        });
+    second = std::make_shared<mt::TestDispatchable>(
+        [&]()
+        {
+            ++dispatched;
+            dispatcher.remove_watch(first);
+        });
+
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(nested);
+    dispatcher.add_watch(second);
+
+    // epoll reports them in the order they became ready, so the nested batch
+    // runs between the removal and the removed dispatchee
+    first->trigger();
+    nested_dispatchee->trigger();
+    second->trigger();
+
+    while (mt::fd_is_readable(dispatcher.watch_fd()))
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    EXPECT_TRUE(nested_dispatched);
+    EXPECT_THAT(dispatched, Eq(1));
+}
+
+TEST(MultiplexingDispatchableTest, dispatchees_are_rearmed_when_an_earlier_dispatch_in_the_batch_throws)
+{
+    using namespace testing;
+
+    int dispatched{0};
+    md::MultiplexingDispatchable dispatcher;
+
+    auto const throw_first_time = [&dispatched]()
+        {
+            if (dispatched++ == 0)
+                throw std::runtime_error{"dispatch failed"};
+        };
+    auto const first = std::make_shared<mt::TestDispatchable>(throw_first_time);
+    auto const second = std::make_shared<mt::TestDispatchable>(throw_first_time);
+
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(second);
+    first->trigger();
+    second->trigger();
+
+    EXPECT_THROW(dispatcher.dispatch(md::FdEvent::readable), std::runtime_error);
+
+    // Whichever dispatchee was not reached must still be delivered
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, Eq(2));
+}
+
+TEST(MultiplexingDispatchableTest, rest_of_batch_is_handed_to_a_thread_that_finds_nothing_to_dispatch)
+{
+    using namespace testing;
+
+    int second_dispatched{0};
+    md::MultiplexingDispatchable dispatcher;
+
+    auto const first = std::make_shared<mt::TestDispatchable>(
+        [&dispatcher]()
+        {
+            // Another thread woken for the same events finds them all in our batch
+            std::thread{[&dispatcher]() { dispatcher.dispatch(md::FdEvent::readable); }}.join();
+        });
+    auto const second = std::make_shared<mt::TestDispatchable>([&second_dispatched]() { ++second_dispatched; });
+
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(second);
+    first->trigger();
+    second->trigger();
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(second_dispatched, Eq(0));
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(second_dispatched, Eq(1));
+}
+
 TEST(MultiplexingDispatchableTest, dispatching_without_pending_event_is_harmless)
 {
     bool dispatched{false};
@@ -87,8 +87,18 @@ struct StubDisplayServer : mtd::StubDisplayServer
         changed_during_create_bstream_closure = before != after;
     }
 
+    void pong(
+        mp::PingEvent const*,
+        mp::Void*,
+        google::protobuf::Closure* closure) override
+    {
+        ++pongs;
+        closure->Run();
+    }
+
     bool changed_during_create_surface_closure;
     bool changed_during_create_bstream_closure;
+    int pongs{0};
 };
 }
 
@@ -151,3 +161,33 @@ TEST(ProtobufMessageProcessor, doesnt_inject_buffers_when_creating_bstream)
     mp->dispatch(invocation, fds);
     EXPECT_FALSE(stub_display_server.changed_during_create_bstream_closure);
 }
+
+TEST(ProtobufMessageProcessor, dispatches_calls_by_method_name)
+{
+    using namespace testing;
+    StubProtobufMessageSender stub_msg_sender;
+    StubMessageProcessorReport stub_report;
+    StubDisplayServer stub_display_server;
+    mfd::ProtobufMessageProcessor pb_message_processor(
+        mt::fake_shared(stub_msg_sender),
+        mt::fake_shared(stub_display_server),
+        mt::fake_shared(stub_report));
+    std::shared_ptr<mfd::MessageProcessor> mp = mt::fake_shared(pb_message_processor);
+
+    // All fields of the parameters of these calls are optional
+    mpw::Invocation raw_invocation;
+    raw_invocation.set_parameters("");
+    mfd::Invocation invocation(raw_invocation);
+    std::vector<mir::Fd> fds;
+
+    raw_invocation.set_method_name("pong");
+    EXPECT_TRUE(mp->dispatch(invocation, fds));
+    EXPECT_THAT(stub_display_server.pongs, Eq(1));
+
+    raw_invocation.set_method_name("pon");
+    EXPECT_FALSE(mp->dispatch(invocation, fds));
+
+    raw_invocation.set_method_name("disconnect");
+    EXPECT_FALSE(mp->dispatch(invocation, fds));
+    EXPECT_THAT(stub_display_server.pongs, Eq(1));
+}
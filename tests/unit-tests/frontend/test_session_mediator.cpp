@@ -1341,7 +1341,56 @@ TEST_F(SessionMediator, screencast_to_buffer_looks_up_and_fills_appropriate_buff
     screencast_request.mutable_id()->set_value(screencast_id.as_value());
     screencast_request.set_buffer_id(allocator->allocated_buffers.front().lock()->id().as_value());
 
-    mediator->screencast_to_buffer(&screencast_request, &null, null_callback.get());
+    mp::ScreencastCapture capture;
+    mediator->screencast_to_buffer(&screencast_request, &capture, null_callback.get());
+}
+
+TEST_F(SessionMediator, screencast_to_buffer_reports_damage_of_capture)
+{
+    mp::Void null;
+    mp::ScreencastParameters screencast_parameters;
+    screencast_parameters.set_num_buffers(0);
+    mp::Screencast screencast;
+    mp::BufferAllocation request;
+    auto buffer_request = request.add_buffer_requests();
+    buffer_request->set_width(100);
+    buffer_request->set_height(129);
+    buffer_request->set_pixel_format(mir_pixel_format_abgr_8888);
+    buffer_request->set_buffer_usage(mir_buffer_usage_hardware);
+    mf::ScreencastSessionId screencast_id{7};
+    geom::Rectangle const damaged{{3, 5}, {10, 20}};
+    auto mock_screencast = std::make_shared<NiceMock<mtd::MockScreencast>>();
+
+    ON_CALL(*mock_screencast, create_session(_,_,_,_,_))
+        .WillByDefault(Return(screencast_id));
+    EXPECT_CALL(*mock_screencast, capture(screencast_id, _))
+        .WillOnce(Return(geom::Rectangles{damaged}))
+        .WillOnce(Return(geom::Rectangles{}));
+
+    auto mediator = create_session_mediator_with_screencast(mock_screencast);
+    mediator->connect(&connect_parameters, &connection, null_callback.get());
+    mediator->allocate_buffers(&request, &null, null_callback.get());
+    mediator->create_screencast(&screencast_parameters, &screencast, null_callback.get());
+
+    mp::ScreencastRequest screencast_request;
+    screencast_request.mutable_id()->set_value(screencast_id.as_value());
+    screencast_request.set_buffer_id(allocator->allocated_buffers.front().lock()->id().as_value());
+
+    mp::ScreencastCapture changed;
+    mediator->screencast_to_buffer(&screencast_request, &changed, null_callback.get());
+
+    EXPECT_TRUE(changed.damage_reported());
+    ASSERT_THAT(changed.damage_size(), Eq(1));
+    EXPECT_THAT(changed.damage(0).left(), Eq(3));
+    EXPECT_THAT(changed.damage(0).top(), Eq(5));
+    EXPECT_THAT(changed.damage(0).width(), Eq(10u));
+    EXPECT_THAT(changed.damage(0).height(), Eq(20u));
+
+    mp::ScreencastCapture unchanged;
+    mediator->screencast_to_buffer(&screencast_request, &unchanged, null_callback.get());
+
+    EXPECT_TRUE(unchanged.damage_reported());
+    EXPECT_THAT(unchanged.damage_size(), Eq(0));
 }
 
 TEST_F(SessionMediator, buffer_releases_are_sent_from_specified_executor)
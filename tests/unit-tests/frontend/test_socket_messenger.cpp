@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/frontend/socket_messenger.h"
+#include "mir/fd_socket_transmission.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <thread>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace ba = boost::asio;
+using namespace testing;
+
+namespace
+{
+struct SocketMessenger : Test
+{
+    SocketMessenger()
+    {
+        ba::local::connect_pair(*server_socket, client_socket);
+        client_fd = mir::Fd{mir::IntOwnedFd{client_socket.native_handle()}};
+    }
+
+    auto make_messenger(size_t max_backlog = mfd::SocketMessenger::default_max_backlog)
+        -> std::shared_ptr<mfd::SocketMessenger>
+    {
+        return std::make_shared<mfd::SocketMessenger>(server_socket, max_backlog);
+    }
+
+    std::string receive_message()
+    {
+        unsigned char header[2];
+        std::vector<mir::Fd> no_fds;
+        mir::receive_data(client_fd, header, sizeof header, no_fds);
+
+        std::string message((header[0] << 8) | header[1], '\0');
+        mir::receive_data(client_fd, &message[0], message.size(), no_fds);
+        return message;
+    }
+
+    std::vector<mir::Fd> receive_fds(size_t count)
+    {
+        char marker;
+        std::vector<mir::Fd> fds(count);
+        mir::receive_data(client_fd, &marker, 1, fds);
+        return fds;
+    }
+
+    static std::string numbered_message(int n)
+    {
+        return std::to_string(n) + std::string(4000, 'x');
+    }
+
+    static mir::Fd temp_fd()
+    {
+        return mir::Fd{fileno(tmpfile())};
+    }
+
+    ba::io_service io;
+    std::shared_ptr<ba::local::stream_protocol::socket> const server_socket{
+        std::make_shared<ba::local::stream_protocol::socket>(io)};
+    ba::local::stream_protocol::socket client_socket{io};
+    mir::Fd client_fd;
+};
+}
+
+TEST_F(SocketMessenger, delivers_messages_and_their_fds_in_order)
+{
+    auto const messenger = make_messenger();
+    std::string const first{"first"};
+    std::string const second{"second"};
+
+    messenger->send(first.data(), first.size(), {{temp_fd()}, {temp_fd(), temp_fd()}});
+    messenger->send(second.data(), second.size(), {});
+
+    EXPECT_THAT(receive_message(), Eq(first));
+    EXPECT_THAT(receive_fds(1).size(), Eq(1u));
+    auto const fds = receive_fds(2);
+    EXPECT_THAT(receive_message(), Eq(second));
+
+    struct stat info;
+    for (auto const& fd : fds)
+        EXPECT_THAT(fstat(fd, &info), Eq(0));
+}
+
+TEST_F(SocketMessenger, does_not_block_on_client_that_is_not_reading)
+{
+    auto const messenger = make_messenger();
+    int const messages{200};
+
+    // Far more than the socket will hold
+    for (int i = 0; i != messages; ++i)
+    {
+        auto const message = numbered_message(i);
+        messenger->send(message.data(), message.size(), {{temp_fd()}});
+    }
+
+    std::thread io_thread{[this] { io.run(); }};
+
+    for (int i = 0; i != messages; ++i)
+    {
+        EXPECT_THAT(receive_message(), Eq(numbered_message(i)));
+        EXPECT_THAT(receive_fds(1).size(), Eq(1u));
+    }
+
+    io_thread.join();
+}
+
+TEST_F(SocketMessenger, disconnects_client_that_lets_backlog_grow_too_large)
+{
+    auto const messenger = make_messenger(64*1024);
+    auto const message = numbered_message(0);
+
+    EXPECT_THROW(
+        for (int i = 0; i != 1000; ++i)
+            messenger->send(message.data(), message.size(), {}),
+        std::runtime_error);
+
+    EXPECT_THROW(messenger->send(message.data(), message.size(), {}), std::runtime_error);
+}
+
+TEST_F(SocketMessenger, keeps_fds_open_until_they_are_sent)
+{
+    auto const messenger = make_messenger();
+    auto const message = numbered_message(0);
+
+    for (int i = 0; i != 100; ++i)
+        messenger->send(message.data(), message.size(), {{temp_fd()}});
+
+    std::thread io_thread{[this] { io.run(); }};
+
+    struct stat info;
+    for (int i = 0; i != 100; ++i)
+    {
+        receive_message();
+        auto const fds = receive_fds(1);
+        EXPECT_THAT(fstat(fds[0], &info), Eq(0));
+    }
+
+    io_thread.join();
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/geometry/region.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace mir::geometry;
+using namespace testing;
+
+namespace
+{
+std::vector<Rectangle> contents_of(Region const& region)
+{
+    return {std::begin(region), std::end(region)};
+}
+}
+
+TEST(Region, default_is_empty)
+{
+    Region const region;
+
+    EXPECT_TRUE(region.empty());
+    EXPECT_THAT(region.size(), Eq(0u));
+    EXPECT_THAT(region.bounding_rectangle(), Eq(Rectangle{}));
+}
+
+TEST(Region, empty_rectangle_gives_empty_region)
+{
+    EXPECT_TRUE((Region{Rectangle{{10, 10}, {0, 5}}}.empty()));
+}
+
+TEST(Region, union_of_overlapping_rectangles_is_banded)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{5, 5}, {10, 10}}};
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{0, 0}, {10, 5}},
+        Rectangle{{0, 5}, {15, 5}},
+        Rectangle{{5, 10}, {10, 5}}));
+}
+
+TEST(Region, union_of_touching_rectangles_coalesces)
+{
+    Region const side_by_side{{{0, 0}, {10, 10}}, {{10, 0}, {10, 10}}};
+    Region const stacked{{{0, 0}, {10, 10}}, {{0, 10}, {10, 10}}};
+
+    EXPECT_THAT(contents_of(side_by_side), ElementsAre(Rectangle{{0, 0}, {20, 10}}));
+    EXPECT_THAT(contents_of(stacked), ElementsAre(Rectangle{{0, 0}, {10, 20}}));
+}
+
+TEST(Region, representation_is_independent_of_construction_order)
+{
+    Rectangle const a{{0, 0}, {30, 10}};
+    Rectangle const b{{10, 5}, {5, 40}};
+    Rectangle const c{{-5, 20}, {10, 10}};
+
+    EXPECT_THAT((Region{a, b, c}), Eq(Region{c, b, a}));
+    EXPECT_THAT((Region{a, b, c}), Eq(Region{b, a, c}));
+}
+
+TEST(Region, subtracting_a_hole_leaves_a_frame)
+{
+    Region region{Rectangle{{0, 0}, {30, 30}}};
+    region.subtract(Rectangle{{10, 10}, {10, 10}});
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{0, 0}, {30, 10}},
+        Rectangle{{0, 10}, {10, 10}},
+        Rectangle{{20, 10}, {10, 10}},
+        Rectangle{{0, 20}, {30, 10}}));
+    EXPECT_FALSE(region.contains(Point{15, 15}));
+    EXPECT_TRUE(region.contains(Point{5, 15}));
+}
+
+TEST(Region, subtracting_a_cover_leaves_nothing)
+{
+    Region region{Rectangle{{10, 10}, {30, 30}}};
+    region.subtract(Region{{{0, 0}, {25, 50}}, {{25, 0}, {25, 50}}});
+
+    EXPECT_TRUE(region.empty());
+}
+
+TEST(Region, intersection_keeps_only_the_overlap)
+{
+    Region region{{{0, 0}, {10, 10}}, {{20, 0}, {10, 10}}};
+    region.intersect(Rectangle{{5, 5}, {20, 10}});
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{5, 5}, {5, 5}},
+        Rectangle{{20, 5}, {5, 5}}));
+}
+
+TEST(Region, contains_rectangle_spanning_several_rectangles)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{10, 0}, {10, 5}}, {{10, 5}, {10, 5}}};
+
+    EXPECT_TRUE(region.contains(Rectangle{{5, 2}, {10, 6}}));
+    EXPECT_FALSE(region.contains(Rectangle{{5, 2}, {20, 6}}));
+}
+
+TEST(Region, bounding_rectangle_covers_all_bands)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{-5, 20}, {30, 10}}};
+
+    EXPECT_THAT(region.bounding_rectangle(), Eq(Rectangle{{-5, 0}, {30, 30}}));
+}
+
+TEST(Region, translates)
+{
+    Region region{Rectangle{{0, 0}, {10, 10}}};
+    region.translate(Displacement{5, -5});
+
+    EXPECT_THAT(region, Eq(Region{Rectangle{{5, -5}, {10, 10}}}));
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/async_readback.h"
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace mgl = mir::gl;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+GLenum const pixel_pack_buffer{0x88EB};
+GLenum const already_signaled{0x911A};
+
+// Stand-ins for the GLES3 entry points, which MockGL doesn't provide
+std::vector<uint32_t> mapped_pixels;
+int fences{0};
+
+void* fake_map_buffer_range(GLenum, GLintptr, GLsizeiptr, GLbitfield) { return mapped_pixels.data(); }
+GLboolean fake_unmap_buffer(GLenum) { return GL_TRUE; }
+void* fake_fence_sync(GLenum, GLbitfield) { ++fences; return &fences; }
+GLenum fake_client_wait_sync(void*, GLbitfield, uint64_t) { return already_signaled; }
+void fake_delete_sync(void*) { --fences; }
+
+template<typename Function>
+auto as_proc(Function function)
+{
+    return reinterpret_cast<mtd::MockEGL::generic_function_pointer_t>(function);
+}
+
+struct AsyncReadback : Test
+{
+    AsyncReadback()
+    {
+        mapped_pixels.assign(width * height, 0);
+        fences = 0;
+
+        ON_CALL(mock_gl, glGetString(GL_VERSION))
+            .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.0 Mesa")));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glMapBufferRange")))
+            .WillByDefault(Return(as_proc(&fake_map_buffer_range)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glUnmapBuffer")))
+            .WillByDefault(Return(as_proc(&fake_unmap_buffer)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glFenceSync")))
+            .WillByDefault(Return(as_proc(&fake_fence_sync)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glClientWaitSync")))
+            .WillByDefault(Return(as_proc(&fake_client_wait_sync)));
+        ON_CALL(mock_egl, eglGetProcAddress(StrEq("glDeleteSync")))
+            .WillByDefault(Return(as_proc(&fake_delete_sync)));
+        ON_CALL(mock_gl, glGenBuffers(1, _))
+            .WillByDefault(SetArgPointee<1>(buffer));
+    }
+
+    NiceMock<mtd::MockGL> mock_gl;
+    NiceMock<mtd::MockEGL> mock_egl;
+    int const width{7};
+    int const height{5};
+    geom::Rectangle const area{{0, 0}, {width, height}};
+    GLuint const buffer{42};
+};
+}
+
+TEST_F(AsyncReadback, is_unavailable_before_gles_3)
+{
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 2.0 Mesa")));
+
+    EXPECT_FALSE(mgl::AsyncReadback::available());
+}
+
+TEST_F(AsyncReadback, is_unavailable_without_fences)
+{
+    ON_CALL(mock_egl, eglGetProcAddress(StrEq("glFenceSync")))
+        .WillByDefault(Return(nullptr));
+
+    EXPECT_FALSE(mgl::AsyncReadback::available());
+}
+
+TEST_F(AsyncReadback, is_available_with_gles_3_or_desktop_gl_3_2)
+{
+    EXPECT_TRUE(mgl::AsyncReadback::available());
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("4.5 (Compatibility Profile) Mesa")));
+    EXPECT_TRUE(mgl::AsyncReadback::available());
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("3.1 Mesa")));
+    EXPECT_FALSE(mgl::AsyncReadback::available());
+}
+
+TEST_F(AsyncReadback, reads_pixels_into_a_pack_buffer_instead_of_client_memory)
+{
+    mgl::AsyncReadback readback{2};
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glBindBuffer(pixel_pack_buffer, buffer));
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    EXPECT_CALL(mock_gl, glBindBuffer(pixel_pack_buffer, 0));
+
+    EXPECT_TRUE(readback.start(area, GL_RGBA));
+    EXPECT_THAT(readback.pending(), Eq(1u));
+    EXPECT_THAT(fences, Eq(1));
+}
+
+TEST_F(AsyncReadback, hands_the_mapped_pixels_to_the_consumer)
+{
+    mgl::AsyncReadback readback{2};
+    mapped_pixels[0] = 0x11223344;
+
+    readback.start(area, GL_RGBA);
+
+    uint32_t first_pixel{0};
+    geom::Size size;
+    geom::Stride stride;
+    readback.finish(
+        [&](unsigned char const* pixels, geom::Size size_, geom::Stride stride_)
+        {
+            first_pixel = *reinterpret_cast<uint32_t const*>(pixels);
+            size = size_;
+            stride = stride_;
+        });
+
+    EXPECT_THAT(first_pixel, Eq(0x11223344u));
+    EXPECT_THAT(size, Eq(area.size));
+    EXPECT_THAT(stride, Eq(geom::Stride{width * 4}));
+    EXPECT_THAT(readback.pending(), Eq(0u));
+    EXPECT_THAT(fences, Eq(0));
+}
+
+TEST_F(AsyncReadback, reports_formats_gl_cannot_read)
+{
+    mgl::AsyncReadback readback{2};
+
+    EXPECT_CALL(mock_gl, glGetError())
+        .WillOnce(Return(GL_NO_ERROR))
+        .WillOnce(Return(GL_INVALID_OPERATION));
+
+    EXPECT_FALSE(readback.start(area, GL_RGBA));
+    EXPECT_THAT(readback.pending(), Eq(0u));
+    EXPECT_THAT(fences, Eq(0));
+}
+
+TEST_F(AsyncReadback, refuses_to_start_more_readbacks_than_it_has_buffers)
+{
+    mgl::AsyncReadback readback{2};
+
+    readback.start(area, GL_RGBA);
+    readback.start(area, GL_RGBA);
+
+    EXPECT_THROW(readback.start(area, GL_RGBA), std::logic_error);
+}
+
+TEST_F(AsyncReadback, refuses_to_finish_nothing)
+{
+    mgl::AsyncReadback readback{2};
+
+    EXPECT_THROW(readback.finish([](unsigned char const*, geom::Size, geom::Stride) {}), std::logic_error);
+}
+
+TEST_F(AsyncReadback, finishes_readbacks_in_the_order_they_were_started)
+{
+    mgl::AsyncReadback readback{3};
+
+    readback.start({{0, 0}, {1, 1}}, GL_RGBA);
+    readback.start({{0, 0}, {2, 2}}, GL_RGBA);
+
+    std::vector<geom::Size> sizes;
+    auto const record = [&](unsigned char const*, geom::Size size, geom::Stride) { sizes.push_back(size); };
+    readback.finish(record);
+    readback.start({{0, 0}, {3, 3}}, GL_RGBA);
+    readback.finish(record);
+    readback.finish(record);
+
+    EXPECT_THAT(sizes, ElementsAre(geom::Size{1, 1}, geom::Size{2, 2}, geom::Size{3, 3}));
+}
@@ -21,11 +21,13 @@
 #include "mir/test/doubles/mock_gl_buffer.h"
 #include "mir/test/doubles/mock_renderable.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/renderer/gl/incremental_texture_source.h"
 #include <gtest/gtest.h>
 
 namespace mtd=mir::test::doubles;
 namespace mgl=mir::gl;
 namespace mg=mir::graphics;
+namespace geom=mir::geometry;
 
 namespace
 {
@@ -140,3 +142,76 @@ TEST_F(RecentlyUsedCache, invalidated_buffers_are_reloaded)
     cache.invalidate();
     cache.load(*renderable);
 }
+
+namespace
+{
+struct MockIncrementalGLBuffer : mtd::MockGLBuffer, mir::renderer::gl::IncrementalTextureSource
+{
+    using MockGLBuffer::MockGLBuffer;
+
+    MOCK_METHOD1(update_texture, void(geom::Rectangles const&));
+};
+}
+
+TEST_F(RecentlyUsedCache, uploads_only_damage_of_incremental_buffers_into_existing_texture)
+{
+    using namespace testing;
+    geom::Size const size{100, 100};
+    geom::Rectangles const damage{{{10, 10}, {20, 5}}};
+    auto const buffer = std::make_shared<NiceMock<MockIncrementalGLBuffer>>(
+        size, geom::Stride{400}, mir_pixel_format_argb_8888);
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(buffer));
+    ON_CALL(*renderable, buffer_damage_since(mg::BufferID{1})).WillByDefault(Return(damage));
+
+    mgl::RecentlyUsedCache cache;
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{1}));
+    EXPECT_CALL(*buffer, bind());
+    EXPECT_CALL(*buffer, update_texture(_)).Times(0);
+    cache.load(*renderable);
+    Mock::VerifyAndClearExpectations(buffer.get());
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{2}));
+    EXPECT_CALL(*buffer, bind()).Times(0);
+    EXPECT_CALL(*buffer, update_texture(damage));
+    cache.load(*renderable);
+}
+
+TEST_F(RecentlyUsedCache, reallocates_texture_when_incremental_buffer_changes_size)
+{
+    using namespace testing;
+    auto const buffer = std::make_shared<NiceMock<MockIncrementalGLBuffer>>(
+        geom::Size{100, 100}, geom::Stride{400}, mir_pixel_format_argb_8888);
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(buffer));
+
+    mgl::RecentlyUsedCache cache;
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{1}));
+    cache.load(*renderable);
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{2}));
+    EXPECT_CALL(*buffer, size()).WillRepeatedly(Return(geom::Size{200, 100}));
+    EXPECT_CALL(*buffer, bind());
+    EXPECT_CALL(*buffer, update_texture(_)).Times(0);
+    cache.load(*renderable);
+}
+
+TEST_F(RecentlyUsedCache, reuploads_whole_incremental_buffer_after_invalidation)
+{
+    using namespace testing;
+    auto const buffer = std::make_shared<NiceMock<MockIncrementalGLBuffer>>(
+        geom::Size{100, 100}, geom::Stride{400}, mir_pixel_format_argb_8888);
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(buffer));
+
+    mgl::RecentlyUsedCache cache;
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{1}));
+    cache.load(*renderable);
+
+    cache.invalidate();
+
+    EXPECT_CALL(*buffer, id()).WillRepeatedly(Return(mg::BufferID{2}));
+    EXPECT_CALL(*buffer, bind());
+    EXPECT_CALL(*buffer, update_texture(_)).Times(0);
+    cache.load(*renderable);
+}
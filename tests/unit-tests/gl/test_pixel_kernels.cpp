@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/pixel_kernels.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace mgl = mir::gl;
+
+using namespace testing;
+
+namespace
+{
+// Odd lengths exercise the scalar tails of the vector kernels
+size_t const row_length = 1027;
+
+auto random_pixels(size_t count) -> std::vector<uint32_t>
+{
+    std::mt19937 generator{count};
+    std::uniform_int_distribution<uint32_t> distribution;
+
+    std::vector<uint32_t> pixels(count);
+    for (auto& pixel : pixels)
+        pixel = distribution(generator);
+
+    // Include the opaque and entirely transparent runs that vector kernels special-case
+    for (size_t i = 64; i != 128; ++i)
+        pixels[i] |= 0xff000000;
+    for (size_t i = 128; i != 192; ++i)
+        pixels[i] = 0;
+
+    return pixels;
+}
+
+/// Premultiplied pixels have no channel greater than their alpha
+auto random_premultiplied_pixels(size_t count) -> std::vector<uint32_t>
+{
+    auto pixels = random_pixels(count);
+    for (auto& pixel : pixels)
+    {
+        auto const alpha = pixel >> 24;
+        uint32_t result = alpha << 24;
+        for (int shift = 0; shift != 24; shift += 8)
+            result |= (((pixel >> shift) & 0xff) * alpha / 255) << shift;
+        pixel = result;
+    }
+    return pixels;
+}
+
+struct PixelKernels : TestWithParam<mgl::PixelKernels const*>
+{
+    mgl::PixelKernels const& kernels = *GetParam();
+    mgl::PixelKernels const& reference = *mgl::supported_pixel_kernels().front();
+};
+}
+
+TEST(PixelKernel, blending_opaque_pixel_replaces_destination)
+{
+    uint32_t dst = 0x80402010;
+    uint32_t const src = 0xff123456;
+
+    mgl::pixel_kernels().blend(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(src));
+}
+
+TEST(PixelKernel, blending_half_transparent_pixel_darkens_destination_by_half)
+{
+    uint32_t dst = 0xffffffff;
+    uint32_t const src = 0x80000000;
+
+    mgl::pixel_kernels().blend(&dst, &src, 1, 255);
+
+    EXPECT_THAT(dst, Eq(0xff7f7f7fu));
+}
+
+TEST(PixelKernel, constant_alpha_scales_source)
+{
+    uint32_t dst = 0;
+    uint32_t const src = 0xffffffff;
+
+    mgl::pixel_kernels().blend(&dst, &src, 1, 0x80);
+
+    EXPECT_THAT(dst, Eq(0x80808080u));
+}
+
+TEST(PixelKernel, converts_between_channel_orders)
+{
+    uint32_t const abgr = 0x80112233;
+    uint32_t argb = 0;
+
+    mgl::convert_row(mgl::pixel_kernels(), &argb, reinterpret_cast<unsigned char const*>(&abgr),
+                     mir_pixel_format_abgr_8888, false, 1);
+
+    EXPECT_THAT(argb, Eq(0x80332211u));
+}
+
+TEST(PixelKernel, formats_without_alpha_are_made_opaque)
+{
+    uint32_t const xrgb = 0x00112233;
+    uint16_t const rgb565 = 0xf800;
+    unsigned char const rgb888[] = {0x11, 0x22, 0x33};
+    uint32_t pixel = 0;
+
+    mgl::convert_row(mgl::pixel_kernels(), &pixel, reinterpret_cast<unsigned char const*>(&xrgb),
+                     mir_pixel_format_xrgb_8888, false, 1);
+    EXPECT_THAT(pixel, Eq(0xff112233u));
+
+    mgl::convert_row(mgl::pixel_kernels(), &pixel, reinterpret_cast<unsigned char const*>(&rgb565),
+                     mir_pixel_format_rgb_565, false, 1);
+    EXPECT_THAT(pixel, Eq(0xffff0000u));
+
+    mgl::convert_row(mgl::pixel_kernels(), &pixel, rgb888, mir_pixel_format_rgb_888, false, 1);
+    EXPECT_THAT(pixel, Eq(0xff112233u));
+}
+
+TEST(PixelKernel, copy_flipped_reverses_rows_and_swaps_red_and_blue)
+{
+    size_t const width = 3, height = 2, src_stride = 16;
+    uint32_t const src[] = {
+        0x80112233, 0x80112233, 0x80112233, 0xdeadbeef,  // Padding in the last column
+        0x01020304, 0x05060708, 0x090a0b0c, 0xdeadbeef};
+    uint32_t dst[width * height]{};
+
+    mgl::copy_flipped(mgl::pixel_kernels(), reinterpret_cast<unsigned char*>(dst), width * 4,
+                      reinterpret_cast<unsigned char const*>(src), src_stride, width, height, true);
+
+    EXPECT_THAT(dst, ElementsAre(0x01040302u, 0x05080706u, 0x090c0b0au, 0x80332211u, 0x80332211u, 0x80332211u));
+
+    mgl::copy_flipped(mgl::pixel_kernels(), reinterpret_cast<unsigned char*>(dst), width * 4,
+                      reinterpret_cast<unsigned char const*>(src), src_stride, width, height, false);
+
+    EXPECT_THAT(dst, ElementsAre(0x01020304u, 0x05060708u, 0x090a0b0cu, 0x80112233u, 0x80112233u, 0x80112233u));
+}
+
+TEST_P(PixelKernels, blend_matches_reference)
+{
+    auto const src = random_premultiplied_pixels(row_length);
+    auto const original = random_pixels(row_length);
+
+    for (auto const alpha : {255, 254, 128, 1, 0})
+    {
+        auto expected = original;
+        auto actual = original;
+
+        reference.blend(expected.data(), src.data(), src.size(), alpha);
+        kernels.blend(actual.data(), src.data(), src.size(), alpha);
+
+        EXPECT_THAT(actual, ContainerEq(expected)) << "alpha " << alpha;
+    }
+}
+
+TEST_P(PixelKernels, blend_of_unpremultiplied_pixels_matches_reference)
+{
+    auto const src = random_pixels(row_length);
+    auto expected = random_pixels(row_length);
+    auto actual = expected;
+
+    reference.blend(expected.data(), src.data(), src.size(), 200);
+    kernels.blend(actual.data(), src.data(), src.size(), 200);
+
+    EXPECT_THAT(actual, ContainerEq(expected));
+}
+
+TEST_P(PixelKernels, convert_32_matches_reference)
+{
+    auto const src = random_pixels(row_length);
+
+    for (auto const swap_rb : {false, true})
+    {
+        for (auto const set_opaque : {false, true})
+        {
+            std::vector<uint32_t> expected(row_length), actual(row_length);
+
+            reference.convert_32(expected.data(), src.data(), src.size(), swap_rb, set_opaque);
+            kernels.convert_32(actual.data(), src.data(), src.size(), swap_rb, set_opaque);
+
+            EXPECT_THAT(actual, ContainerEq(expected)) << "swap_rb " << swap_rb << ", set_opaque " << set_opaque;
+        }
+    }
+}
+
+TEST_P(PixelKernels, convert_565_matches_reference)
+{
+    auto const pixels = random_pixels(row_length);
+    std::vector<uint16_t> src(pixels.begin(), pixels.end());
+
+    for (auto const swap_rb : {false, true})
+    {
+        std::vector<uint32_t> expected(row_length), actual(row_length);
+
+        reference.convert_565(expected.data(), src.data(), src.size(), swap_rb);
+        kernels.convert_565(actual.data(), src.data(), src.size(), swap_rb);
+
+        EXPECT_THAT(actual, ContainerEq(expected)) << "swap_rb " << swap_rb;
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Supported,
+    PixelKernels,
+    ValuesIn(mgl::supported_pixel_kernels()),
+    [](TestParamInfo<mgl::PixelKernels const*> const& info) { return std::string{info.param->name}; });
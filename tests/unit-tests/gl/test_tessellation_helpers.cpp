@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/gl/tessellation_helpers.h"
+
+#include "mir/test/doubles/mock_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <vector>
+
+namespace mgl = mir::gl;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+geom::Size const buffer_size{100, 50};
+
+struct TessellationHelpers : Test
+{
+    TessellationHelpers()
+    {
+        ON_CALL(renderable, buffer()).WillByDefault(Return(buffer));
+    }
+
+    void show(geom::Rectangle const& src_bounds, geom::Rectangle const& position)
+    {
+        ON_CALL(renderable, src_bounds()).WillByDefault(Return(src_bounds));
+        ON_CALL(renderable, screen_position()).WillByDefault(Return(position));
+    }
+
+    std::shared_ptr<mtd::StubBuffer> const buffer{std::make_shared<mtd::StubBuffer>(buffer_size)};
+    NiceMock<mtd::MockRenderable> renderable;
+};
+
+auto texcoords(mgl::Primitive const& primitive) -> std::vector<GLfloat>
+{
+    std::vector<GLfloat> result;
+    for (auto const& vertex : primitive.vertices)
+        result.insert(end(result), std::begin(vertex.texcoord), std::end(vertex.texcoord));
+    return result;
+}
+
+auto positions(mgl::Primitive const& primitive) -> std::vector<GLfloat>
+{
+    std::vector<GLfloat> result;
+    for (auto const& vertex : primitive.vertices)
+        result.insert(end(result), std::begin(vertex.position), std::begin(vertex.position) + 2);
+    return result;
+}
+
+// The vertices are a triangle strip: top left, bottom left, top right, bottom right
+auto corners(GLfloat left, GLfloat top, GLfloat right, GLfloat bottom)
+{
+    return ElementsAre(
+        FloatEq(left), FloatEq(top),
+        FloatEq(left), FloatEq(bottom),
+        FloatEq(right), FloatEq(top),
+        FloatEq(right), FloatEq(bottom));
+}
+}
+
+TEST_F(TessellationHelpers, whole_buffer_maps_to_whole_texture)
+{
+    show({{0, 0}, buffer_size}, {{10, 20}, buffer_size});
+
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    EXPECT_THAT(positions(primitive), corners(10, 20, 110, 70));
+    EXPECT_THAT(texcoords(primitive), corners(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+TEST_F(TessellationHelpers, crop_samples_only_the_source)
+{
+    show({{20, 10}, {50, 25}}, {{0, 0}, {50, 25}});
+
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    EXPECT_THAT(positions(primitive), corners(0, 0, 50, 25));
+    EXPECT_THAT(texcoords(primitive), corners(0.2f, 0.2f, 0.7f, 0.7f));
+}
+
+TEST_F(TessellationHelpers, scale_stretches_the_whole_texture_over_the_position)
+{
+    show({{0, 0}, buffer_size}, {{0, 0}, {200, 100}});
+
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    EXPECT_THAT(positions(primitive), corners(0, 0, 200, 100));
+    EXPECT_THAT(texcoords(primitive), corners(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+TEST_F(TessellationHelpers, crop_and_scale_stretches_the_source_over_the_position)
+{
+    show({{20, 10}, {50, 25}}, {{0, 0}, {100, 50}});
+
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {});
+
+    EXPECT_THAT(positions(primitive), corners(0, 0, 100, 50));
+    EXPECT_THAT(texcoords(primitive), corners(0.2f, 0.2f, 0.7f, 0.7f));
+}
+
+TEST_F(TessellationHelpers, part_of_a_cropped_and_scaled_renderable_samples_the_matching_part_of_the_source)
+{
+    show({{20, 10}, {50, 25}}, {{0, 0}, {100, 50}});
+
+    // The bottom right quarter of the renderable
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {{50, 25}, {50, 25}}, {});
+
+    EXPECT_THAT(positions(primitive), corners(50, 25, 100, 50));
+    EXPECT_THAT(texcoords(primitive), corners(0.45f, 0.45f, 0.7f, 0.7f));
+}
+
+TEST_F(TessellationHelpers, offset_moves_vertices_but_not_texcoords)
+{
+    show({{20, 10}, {50, 25}}, {{10, 10}, {100, 50}});
+
+    auto const primitive = mgl::tessellate_renderable_into_rectangle(renderable, {5, 5});
+
+    EXPECT_THAT(positions(primitive), corners(5, 5, 105, 55));
+    EXPECT_THAT(texcoords(primitive), corners(0.2f, 0.2f, 0.7f, 0.7f));
+}
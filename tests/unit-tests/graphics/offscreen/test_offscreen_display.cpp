@@ -3,6 +3,7 @@
 #include "src/server/graphics/offscreen/display.h"
 #include "mir/graphics/default_display_configuration_policy.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "src/server/report/null_report_factory.h"
 
 #include "mir/test/doubles/mock_egl.h"
@@ -19,6 +20,7 @@ namespace mgo=mir::graphics::offscreen;
 namespace mtd=mir::test::doubles;
 namespace mr = mir::report;
 namespace mt = mir::test;
+namespace mrs = mir::renderer::software;
 
 namespace
 {
@@ -59,7 +61,8 @@ TEST_F(OffscreenDisplayTest, uses_basic_platform_egl_native_display)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        false};
 }
 
 TEST_F(OffscreenDisplayTest, orientation_normal)
@@ -68,7 +71,8 @@ TEST_F(OffscreenDisplayTest, orientation_normal)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        false};
 
     int count = 0;
     display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
@@ -86,7 +90,8 @@ TEST_F(OffscreenDisplayTest, never_enables_predictive_bypass)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        false};
 
     int groups = 0;
     display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group){
@@ -97,6 +102,36 @@ TEST_F(OffscreenDisplayTest, never_enables_predictive_bypass)
     EXPECT_TRUE(groups);
 }
 
+TEST_F(OffscreenDisplayTest, counts_each_post_as_a_frame_on_its_output)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        false};
+
+    std::vector<unsigned> output_ids;
+    display.configuration()->for_each_output([&](mg::DisplayConfigurationOutput const& output)
+        {
+            output_ids.push_back(output.id.as_value());
+        });
+    ASSERT_THAT(output_ids.size(), Eq(1u));
+
+    auto const before = display.last_frame_on(output_ids[0]);
+    display.for_each_display_sync_group([](mg::DisplaySyncGroup& group)
+        {
+            group.post();
+            group.post();
+        });
+    auto const after = display.last_frame_on(output_ids[0]);
+
+    EXPECT_THAT(after.msc, Eq(before.msc + 2));
+    EXPECT_THAT(after.ust.clock_id, Eq(CLOCK_MONOTONIC));
+    EXPECT_THAT(after.ust.nanoseconds, Gt(before.ust.nanoseconds));
+}
+
 TEST_F(OffscreenDisplayTest, makes_fbo_current_rendering_target)
 {
     using namespace ::testing;
@@ -121,7 +156,8 @@ TEST_F(OffscreenDisplayTest, makes_fbo_current_rendering_target)
     mgo::Display display{
         native_display,
         std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-        mr::null_display_report()};
+        mr::null_display_report(),
+        false};
 
     Mock::VerifyAndClearExpectations(&mock_gl);
 
@@ -170,6 +206,95 @@ TEST_F(OffscreenDisplayTest, restores_previous_state_on_fbo_setup_failure)
         mgo::Display display(
             native_display,
             std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
-            mr::null_display_report());
+            mr::null_display_report(),
+            false);
     }, std::runtime_error);
 }
+
+TEST_F(OffscreenDisplayTest, uploads_what_the_cpu_drew_into_the_fbo)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        false};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto const render_target = dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer());
+            ASSERT_THAT(render_target, NotNull());
+
+            auto const height = render_target->size().height.as_int();
+            auto const stride = render_target->stride().as_int();
+            auto const pixels = render_target->map_for_write();
+
+            EXPECT_CALL(mock_gl, glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _, 0));
+            // Only the damaged rows, flipped as GL rows go bottom up; each band's span in one call per row
+            EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+            EXPECT_CALL(mock_gl, glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 2, height - 1 - 10, 8, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels + 10 * stride + 2 * 4));
+            EXPECT_CALL(mock_gl, glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 2, height - 1 - 11, 8, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels + 11 * stride + 2 * 4));
+            EXPECT_CALL(mock_gl, glTexSubImage2D(
+                GL_TEXTURE_2D, 0, 0, height - 1 - 20, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels + 20 * stride));
+            EXPECT_CALL(mock_gl, glFinish()).Times(0);
+
+            render_target->swap_buffers({{{2, 10}, {3, 2}}, {{7, 10}, {3, 2}}, {{0, 20}, {1, 1}}});
+
+            Mock::VerifyAndClearExpectations(&mock_gl);
+            EXPECT_THAT(render_target->buffer_age(), Eq(1));
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, cpu_only_outputs_are_not_drawn_through_gl)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(mock_gl, glGenFramebuffers(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        true};
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            EXPECT_THAT(dynamic_cast<mir::renderer::gl::RenderTarget*>(db.native_display_buffer()), IsNull());
+
+            auto const render_target = dynamic_cast<mrs::RenderTarget*>(db.native_display_buffer());
+            ASSERT_THAT(render_target, NotNull());
+
+            render_target->map_for_write();
+            render_target->swap_buffers({{{0, 0}, render_target->size()}});
+            EXPECT_THAT(render_target->buffer_age(), Eq(1));
+        });
+    });
+}
+
+TEST_F(OffscreenDisplayTest, does_not_upload_frames_drawn_with_gl)
+{
+    using namespace ::testing;
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        false};
+
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            auto const render_target = mt::as_render_target(db);
+            render_target->make_current();
+            render_target->bind();
+            render_target->swap_buffers();
+            render_target->release_current();
+        });
+    });
+}
@@ -199,3 +199,31 @@ TEST_F(ShmBufferTest, uploads_abgr_8888_correctly)
     PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_abgr_8888);
     buf.gl_bind_to_texture();
 }
+
+TEST_F(ShmBufferTest, updates_only_damaged_rows_of_texture)
+{
+    auto const stride = size.width.as_int() * MIR_BYTES_PER_PIXEL(mir_pixel_format_argb_8888);
+    auto const first_row = static_cast<char*>(stub_shm_file->fake_mapping);
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 10,
+                                         size.width.as_int(), 20,
+                                         GL_BGRA_EXT, GL_UNSIGNED_BYTE,
+                                         first_row + 10 * stride));
+    EXPECT_CALL(mock_gl, glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 100,
+                                         size.width.as_int(), 1,
+                                         GL_BGRA_EXT, GL_UNSIGNED_BYTE,
+                                         first_row + 100 * stride));
+#endif
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_argb_8888);
+    buf.update_texture({{{5, 10}, {10, 15}}, {{50, 20}, {10, 10}}, {{0, 100}, {1, 1}}});
+}
+
+TEST_F(ShmBufferTest, does_not_update_texture_outside_buffer)
+{
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    PlatformlessShmBuffer buf(std::make_unique<StubShmFile>(), size, mir_pixel_format_argb_8888);
+    buf.update_texture({{{0, size.height.as_int()}, {10, 10}}});
+}
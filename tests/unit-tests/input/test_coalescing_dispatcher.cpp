@@ -0,0 +1,216 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/input/coalescing_dispatcher.h"
+
+#include "mir/events/event_builders.h"
+
+#include "mir/test/event_matchers.h"
+#include "mir/test/doubles/mock_input_dispatcher.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/test/doubles/advanceable_clock.h"
+#include "mir/test/fake_shared.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mt::doubles;
+
+using namespace ::testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct CoalescingDispatcher : public testing::Test
+{
+    void advance_by(mir::time::Duration step)
+    {
+        clock->advance_by(step);
+        alarm_factory.advance_by(step);
+    }
+
+    std::chrono::nanoseconds now() const
+    {
+        return clock->now().time_since_epoch();
+    }
+
+    mir::EventUPtr a_motion_event(float x, float y, float dx, float dy, MirPointerButtons buttons = 0)
+    {
+        return mev::make_event(pointer_device, now(), std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, buttons, x, y, 0.0f, 0.0f, dx, dy);
+    }
+
+    mir::EventUPtr a_scroll_event(float vscroll)
+    {
+        return mev::make_event(pointer_device, now(), std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            mir_pointer_action_motion, 0, 0.0f, 0.0f, 0.0f, vscroll, 0.0f, 0.0f);
+    }
+
+    mir::EventUPtr a_button_down_event()
+    {
+        return mev::make_event(pointer_device, now(), std::vector<uint8_t>{}, mir_input_event_modifier_none,
+            mir_pointer_action_button_down, mir_pointer_button_primary, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    mir::EventUPtr a_key_down_event()
+    {
+        return mev::make_event(keyboard_device, now(), std::vector<uint8_t>{}, mir_keyboard_action_down,
+            0, 0, mir_input_event_modifier_none);
+    }
+
+    mir::EventUPtr a_touch_event(MirTouchAction action, float x, float y)
+    {
+        auto ev = mev::make_event(touch_device, now(), std::vector<uint8_t>{}, mir_input_event_modifier_none);
+        mev::add_touch(*ev, 0, action, mir_touch_tooltype_finger, x, y, 1.0f, 1.0f, 1.0f, 1.0f);
+        return ev;
+    }
+
+    MirInputDeviceId const pointer_device = 3;
+    MirInputDeviceId const keyboard_device = 4;
+    MirInputDeviceId const touch_device = 5;
+    mir::time::Duration const frame_interval = std::chrono::duration_cast<mir::time::Duration>(1s) / 60;
+
+    std::shared_ptr<mtd::AdvanceableClock> const clock = std::make_shared<mtd::AdvanceableClock>();
+    mtd::FakeAlarmFactory alarm_factory;
+    std::shared_ptr<mtd::MockInputDispatcher> const next_dispatcher = std::make_shared<mtd::MockInputDispatcher>();
+    mi::CoalescingDispatcher dispatcher{next_dispatcher, mt::fake_shared(alarm_factory), clock, frame_interval};
+};
+}
+
+TEST_F(CoalescingDispatcher, merges_relative_motion_until_the_frame_deadline)
+{
+    EXPECT_CALL(*next_dispatcher, dispatch(_)).Times(0);
+
+    dispatcher.dispatch(a_motion_event(11, 12, 1, 2));
+    advance_by(2ms);
+    dispatcher.dispatch(a_motion_event(14, 16, 3, 4));
+    advance_by(2ms);
+    dispatcher.dispatch(a_motion_event(19, 22, 5, 6));
+
+    Mock::VerifyAndClearExpectations(next_dispatcher.get());
+    EXPECT_CALL(*next_dispatcher, dispatch(AllOf(mt::PointerEventWithPosition(19, 22), mt::PointerEventWithDiff(9, 12))))
+        .Times(1);
+
+    advance_by(frame_interval);
+}
+
+TEST_F(CoalescingDispatcher, sums_scroll_events)
+{
+    dispatcher.dispatch(a_scroll_event(1.0f));
+    dispatcher.dispatch(a_scroll_event(2.5f));
+
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerAxisChange(mir_pointer_axis_vscroll, 3.5f)))
+        .Times(1);
+
+    advance_by(frame_interval + 1ms);
+}
+
+TEST_F(CoalescingDispatcher, delivers_pending_motion_before_a_button_press)
+{
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithDiff(4, 6)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::ButtonDownEvent(0, 0)));
+
+    dispatcher.dispatch(a_motion_event(1, 2, 1, 2));
+    dispatcher.dispatch(a_motion_event(4, 6, 3, 4));
+    dispatcher.dispatch(a_button_down_event());
+}
+
+TEST_F(CoalescingDispatcher, delivers_pending_motion_before_a_key_press)
+{
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithDiff(1, 2)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::KeyDownEvent()));
+
+    dispatcher.dispatch(a_motion_event(1, 2, 1, 2));
+    dispatcher.dispatch(a_key_down_event());
+}
+
+TEST_F(CoalescingDispatcher, does_not_merge_motion_across_a_button_state_change)
+{
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithDiff(1, 2)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::PointerEventWithDiff(3, 4)));
+
+    dispatcher.dispatch(a_motion_event(1, 2, 1, 2));
+    dispatcher.dispatch(a_motion_event(4, 6, 3, 4, mir_pointer_button_primary));
+
+    advance_by(frame_interval + 1ms);
+}
+
+TEST_F(CoalescingDispatcher, delivers_touch_down_and_up_immediately)
+{
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchEvent(10, 10)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchUpEvent(10, 10)));
+
+    dispatcher.dispatch(a_touch_event(mir_touch_action_down, 10, 10));
+    dispatcher.dispatch(a_touch_event(mir_touch_action_up, 10, 10));
+}
+
+TEST_F(CoalescingDispatcher, delivers_moving_touches_once_per_frame)
+{
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchEvent(10, 10)));
+    dispatcher.dispatch(a_touch_event(mir_touch_action_down, 10, 10));
+    Mock::VerifyAndClearExpectations(next_dispatcher.get());
+
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchMovementEvent())).Times(1);
+
+    // Too close together to predict from
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 20, 10));
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 30, 10));
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 40, 10));
+
+    advance_by(frame_interval + 1ms);
+}
+
+TEST_F(CoalescingDispatcher, predicts_moving_touches_towards_the_display_time)
+{
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 100, 50));
+    advance_by(8ms);
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 108, 50));
+
+    // Moving 1px/ms, predicted half the 8ms between samples ahead
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchContact(0, mir_touch_action_change, 112, 50))).Times(1);
+
+    advance_by(10ms);
+}
+
+TEST_F(CoalescingDispatcher, does_not_predict_touches_flushed_by_other_events)
+{
+    InSequence seq;
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::TouchContact(0, mir_touch_action_change, 108, 50)));
+    EXPECT_CALL(*next_dispatcher, dispatch(mt::KeyDownEvent()));
+
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 100, 50));
+    advance_by(8ms);
+    dispatcher.dispatch(a_touch_event(mir_touch_action_change, 108, 50));
+    dispatcher.dispatch(a_key_down_event());
+}
+
+TEST_F(CoalescingDispatcher, discards_pending_events_when_stopped)
+{
+    EXPECT_CALL(*next_dispatcher, dispatch(_)).Times(0);
+    EXPECT_CALL(*next_dispatcher, stop());
+
+    dispatcher.dispatch(a_motion_event(1, 2, 1, 2));
+    dispatcher.stop();
+
+    advance_by(frame_interval + 1ms);
+}
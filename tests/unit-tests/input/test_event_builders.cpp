@@ -283,3 +283,29 @@ TEST_F(InputEventBuilder, when_deserialized_input_device_state_event_has_supplie
         EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 2, i), Eq(pressed_keys[i]));
     }
 }
+
+TEST_F(InputEventBuilder, event_larger_than_inline_storage_survives_copy_and_serialization)
+{
+    std::vector<uint32_t> pressed_keys;
+    for (uint32_t key = 0; key != 500; ++key)
+        pressed_keys.push_back(key);
+
+    auto ev = mev::make_event(timestamp,
+                              mir_pointer_button_primary,
+                              mir_input_event_modifier_none,
+                              0.0f,
+                              0.0f,
+                              {mev::InputDeviceState{MirInputDeviceId{1}, pressed_keys, 0}});
+
+    auto const copy = mev::clone_event(*ev);
+    ev.reset();
+
+    auto const deserialized_event = MirEvent::deserialize(MirEvent::serialize(copy.get()));
+
+    auto ids_event = mir_event_get_input_device_state_event(deserialized_event.get());
+    ASSERT_THAT(mir_input_device_state_event_device_pressed_keys_count(ids_event, 0), Eq(pressed_keys.size()));
+    for (uint32_t i = 0; i != pressed_keys.size(); ++i)
+    {
+        EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 0, i), Eq(pressed_keys[i]));
+    }
+}
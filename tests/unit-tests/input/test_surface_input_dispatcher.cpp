@@ -96,6 +96,18 @@ struct StubInputScene : public mtd::StubInputScene
         });
     }
 
+    auto input_surface_at(geom::Point point) const -> std::shared_ptr<mi::Surface> override
+    {
+        std::shared_ptr<mi::Surface> top_target;
+        surfaces.for_each(
+            [&](std::shared_ptr<ms::Surface> const& surface)
+            {
+                if (surface->input_area_contains(point))
+                    top_target = surface;
+            });
+        return top_target;
+    }
+
     void add_observer(std::shared_ptr<ms::Observer> const& new_observer) override
     {
         assert(observer == nullptr);
@@ -112,7 +124,7 @@ struct StubInputScene : public mtd::StubInputScene
         observer.reset();
     }
     
-    mir::ThreadSafeList<std::shared_ptr<ms::Surface>> surfaces;
+    mir::ThreadSafeList<std::shared_ptr<ms::Surface>> mutable surfaces;
 
     std::shared_ptr<ms::Observer> observer;
 };
@@ -177,3 +177,41 @@ TEST_F(MessageProcessorReport, logs_incomplete_calls_on_destruction)
     report.received_invocation(this, 1, __PRETTY_FUNCTION__);
 }
 
+
+TEST_F(MessageProcessorReport, summarises_latency_of_each_method_periodically)
+{
+    using namespace std::chrono;
+    mir::time::Timestamp a_time;
+
+    EXPECT_CALL(clock, now()).Times(8)
+        .WillOnce(Return(a_time))
+        .WillOnce(Return(a_time + microseconds(10)))
+        .WillOnce(Return(a_time + milliseconds(500)))
+        .WillOnce(Return(a_time + milliseconds(500) + microseconds(100)))
+        .WillOnce(Return(a_time + milliseconds(800)))
+        .WillOnce(Return(a_time + milliseconds(800) + microseconds(30)))
+        .WillOnce(Return(a_time + seconds(1)))
+        .WillOnce(Return(a_time + seconds(1) + microseconds(20)));
+
+    EXPECT_CALL(logger, log(
+        ml::Severity::informational,
+        HasSubstr("elapsed="),
+        "frontend::MessageProcessor")).Times(4);
+    EXPECT_CALL(logger, log(
+        ml::Severity::informational,
+        "method=submit_buffer(), calls=3, mean=20µs, worst=30µs",
+        "frontend::MessageProcessor")).Times(1);
+    EXPECT_CALL(logger, log(
+        ml::Severity::informational,
+        "method=connect(), calls=1, mean=100µs, worst=100µs",
+        "frontend::MessageProcessor")).Times(1);
+
+    report.received_invocation(this, 1, "submit_buffer");
+    report.completed_invocation(this, 1, true);
+    report.received_invocation(this, 2, "connect");
+    report.completed_invocation(this, 2, true);
+    report.received_invocation(this, 3, "submit_buffer");
+    report.completed_invocation(this, 3, true);
+    report.received_invocation(this, 4, "submit_buffer");
+    report.completed_invocation(this, 4, true);
+}
@@ -189,3 +189,26 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, reports_worst_frame_time_of_each_display)
+{
+    const void* const id = "My Screen";
+
+    report.started();
+
+    // The first report only takes a sample, so put the slow frame after it
+    int const slow_frame = 80;
+    for (int f = 0; f < 200 && !recorder->last_message_contains("averaged"); ++f)
+    {
+        report.began_frame(id);
+        clock->advance_by(chrono::microseconds(f == slow_frame ? 25000 : 4000));
+        report.rendered_frame(id);
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(12000));
+    }
+
+    EXPECT_TRUE(recorder->last_message_contains("worst frame 25.000 ms"))
+        << recorder->last_message();
+
+    report.stopped();
+}
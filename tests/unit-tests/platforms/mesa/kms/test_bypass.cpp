@@ -95,6 +95,27 @@ TEST_F(BypassMatchTest, offset_fullscreen_window_not_bypassed)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
 }
 
+TEST_F(BypassMatchTest, scaled_fullscreen_window_not_bypassed)
+{
+    struct ScaledRenderable : mtd::FakeRenderable
+    {
+        using mtd::FakeRenderable::FakeRenderable;
+
+        geom::Rectangle src_bounds() const override
+        {
+            return {{0, 0}, {1280, 720}};
+        }
+    };
+
+    mgm::BypassMatch matcher(primary_monitor);
+
+    mg::RenderableList list{
+        std::make_shared<ScaledRenderable>(0, 0, 1920, 1200)
+    };
+
+    EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
+}
+
 TEST_F(BypassMatchTest, obscured_fullscreen_window_not_bypassed)
 {
     mgm::BypassMatch matcher(primary_monitor);
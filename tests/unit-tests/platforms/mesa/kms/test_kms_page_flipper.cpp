@@ -125,7 +125,7 @@ TEST_F(KMSPageFlipperTest, wait_for_flip_handles_drm_event)
     /* Fake a DRM event */
     mock_drm.generate_event_on(drm_device);
 
-    page_flipper.wait_for_flip(crtc_id);
+    EXPECT_TRUE(page_flipper.wait_for_flip(crtc_id).vsync);
 }
 
 TEST_F(KMSPageFlipperTest, wait_for_flip_reports_vsync)
@@ -0,0 +1,369 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/renderers/sw/renderer.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const marker = 0x12345678;
+
+class StubSoftwareDisplayBuffer : public mtd::StubDisplayBuffer,
+                                  public mrs::RenderTarget
+{
+public:
+    StubSoftwareDisplayBuffer(geom::Rectangle const& area, MirPixelFormat format = mir_pixel_format_xrgb_8888)
+        : StubDisplayBuffer{area},
+          area{area},
+          format{format},
+          pixels(area.size.width.as_int() * area.size.height.as_int(), marker)
+    {
+    }
+
+    unsigned char* map_for_write() override { return reinterpret_cast<unsigned char*>(pixels.data()); }
+    geom::Size size() const override { return area.size; }
+    geom::Stride stride() const override { return geom::Stride{area.size.width.as_int() * 4}; }
+    MirPixelFormat pixel_format() const override { return format; }
+    int buffer_age() const override { return age; }
+    void swap_buffers(geom::Region const& damage) override
+    {
+        ++frames;
+        last_damage = damage;
+    }
+
+    /// The pixel at a point in screen coordinates
+    uint32_t at(int x, int y) const
+    {
+        return pixels[(y - area.top_left.y.as_int()) * area.size.width.as_int() + x - area.top_left.x.as_int()];
+    }
+
+    geom::Rectangle const area;
+    MirPixelFormat const format;
+    std::vector<uint32_t> pixels;
+    int age{0};
+    int frames{0};
+    geom::Region last_damage;
+};
+
+class CountingBuffer : public mtd::StubBuffer
+{
+public:
+    CountingBuffer(geom::Size const& size, MirPixelFormat format, uint32_t colour)
+        : StubBuffer{mg::BufferProperties{size, format, mg::BufferUsage::software}}
+    {
+        std::vector<uint32_t> const pixels(size.width.as_int() * size.height.as_int(), colour);
+        write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+    }
+
+    void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
+    {
+        ++reads;
+        StubBuffer::read(do_with_pixels);
+    }
+
+    int reads{0};
+};
+
+/// A renderable drawing part of a (possibly differently sized) buffer
+class ScaledRenderable : public mtd::FakeRenderable
+{
+public:
+    ScaledRenderable(geom::Rectangle const& position, geom::Rectangle const& src)
+        : FakeRenderable{position},
+          src{src}
+    {
+    }
+
+    geom::Rectangle src_bounds() const override
+    {
+        return src;
+    }
+
+    geom::Rectangle const src;
+};
+
+/// A renderable with a surface transformation
+class TransformedRenderable : public mtd::FakeRenderable
+{
+public:
+    TransformedRenderable(geom::Rectangle const& position, glm::mat4 const& transform)
+        : FakeRenderable{position},
+          transform{transform}
+    {
+    }
+
+    glm::mat4 transformation() const override
+    {
+        return transform;
+    }
+
+    glm::mat4 const transform;
+};
+
+auto renderable_of(
+    geom::Rectangle const& position,
+    uint32_t colour,
+    MirPixelFormat format = mir_pixel_format_argb_8888,
+    float alpha = 1.0f) -> std::shared_ptr<mtd::FakeRenderable>
+{
+    bool const opaque = format == mir_pixel_format_xrgb_8888 || format == mir_pixel_format_xbgr_8888;
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha, opaque);
+    renderable->set_buffer(std::make_shared<CountingBuffer>(position.size, format, colour));
+    return renderable;
+}
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const screen{{0, 0}, {64, 48}};
+    StubSoftwareDisplayBuffer display_buffer{screen};
+    mrs::Renderer renderer{display_buffer};
+};
+}
+
+TEST_F(SoftwareRenderer, draws_renderables_where_they_are_placed)
+{
+    renderer.render({renderable_of({{10, 20}, {4, 3}}, 0xff00ff00, mir_pixel_format_xrgb_8888)});
+
+    EXPECT_THAT(display_buffer.at(10, 20), Eq(0xff00ff00u));
+    EXPECT_THAT(display_buffer.at(13, 22), Eq(0xff00ff00u));
+    EXPECT_THAT(display_buffer.at(14, 22), Eq(0u));
+    EXPECT_THAT(display_buffer.at(9, 20), Eq(0u));
+    EXPECT_THAT(display_buffer.frames, Eq(1));
+}
+
+TEST_F(SoftwareRenderer, clears_what_nothing_covers_to_transparent_black)
+{
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0u)));
+}
+
+TEST_F(SoftwareRenderer, converts_buffers_to_the_output_format)
+{
+    // Blue in abgr is at the top of the pixel, but at the bottom in xrgb
+    renderer.render({renderable_of(screen, 0xffff0000, mir_pixel_format_abgr_8888)});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0xff0000ffu)));
+}
+
+TEST_F(SoftwareRenderer, forces_buffers_without_alpha_opaque)
+{
+    renderer.render({renderable_of(screen, 0x00123456, mir_pixel_format_xrgb_8888, 0.5f)});
+
+    // Half of an opaque 0x123456 over black
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0x80091a2bu));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_renderables_over_those_below)
+{
+    renderer.render({
+        renderable_of(screen, 0xffffffff, mir_pixel_format_xrgb_8888),
+        renderable_of({{0, 0}, {8, 8}}, 0x80000000)});
+
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0xff7f7f7fu));
+    EXPECT_THAT(display_buffer.at(8, 8), Eq(0xffffffffu));
+}
+
+TEST_F(SoftwareRenderer, scales_renderables_to_their_position)
+{
+    auto const renderable = std::make_shared<ScaledRenderable>(
+        geom::Rectangle{{0, 0}, {8, 8}},
+        geom::Rectangle{{0, 0}, {2, 2}});
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{{2, 2}, mir_pixel_format_xrgb_8888, mg::BufferUsage::software});
+    uint32_t const pixels[] = {0xff000001, 0xff000002, 0xff000003, 0xff000004};
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels), sizeof pixels);
+    renderable->set_buffer(buffer);
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0xff000001u));
+    EXPECT_THAT(display_buffer.at(7, 0), Eq(0xff000002u));
+    EXPECT_THAT(display_buffer.at(3, 7), Eq(0xff000003u));
+    EXPECT_THAT(display_buffer.at(4, 4), Eq(0xff000004u));
+}
+
+TEST_F(SoftwareRenderer, translates_renderables_by_their_transformation)
+{
+    auto const renderable = std::make_shared<TransformedRenderable>(
+        geom::Rectangle{{0, 0}, {4, 4}},
+        glm::translate(glm::mat4(1), glm::vec3{5, 2, 0}));
+    renderable->set_buffer(std::make_shared<CountingBuffer>(geom::Size{4, 4}, mir_pixel_format_xrgb_8888, 0xff00ff00));
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.at(5, 2), Eq(0xff00ff00u));
+    EXPECT_THAT(display_buffer.at(8, 5), Eq(0xff00ff00u));
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.at(9, 2), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, rotates_renderables_about_their_centre)
+{
+    // 8x4, centred on (14, 12); turned a quarter it covers x in [12, 16) and y in [8, 16)
+    auto const renderable = std::make_shared<TransformedRenderable>(
+        geom::Rectangle{{10, 10}, {8, 4}},
+        glm::rotate(glm::mat4(1), glm::half_pi<float>(), glm::vec3{0, 0, 1}));
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{{8, 4}, mir_pixel_format_xrgb_8888, mg::BufferUsage::software});
+    std::vector<uint32_t> pixels(8 * 4);
+    for (auto i = 0u; i != pixels.size(); ++i)
+        pixels[i] = 0xff000000 | i;
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof(uint32_t));
+    renderable->set_buffer(buffer);
+
+    renderer.render({renderable});
+
+    // The bottom left of the buffer ends up at the top left, its top right at the bottom right
+    EXPECT_THAT(display_buffer.at(12, 8), Eq(0xff000000u | (3 * 8 + 0)));
+    EXPECT_THAT(display_buffer.at(15, 15), Eq(0xff000000u | (0 * 8 + 7)));
+    EXPECT_THAT(display_buffer.at(10, 10), Eq(0u));
+    EXPECT_THAT(display_buffer.at(16, 12), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, only_draws_the_visible_region_of_a_renderable)
+{
+    auto const renderable = renderable_of(screen, 0xffffffff, mir_pixel_format_xrgb_8888);
+
+    renderer.set_visible_region(renderable->id(), geom::Region{{{0, 0}, {4, 4}}});
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.at(3, 3), Eq(0xffffffffu));
+    EXPECT_THAT(display_buffer.at(4, 4), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, redraws_only_damage_when_the_buffer_holds_the_last_frame)
+{
+    renderer.render({});
+    std::fill(display_buffer.pixels.begin(), display_buffer.pixels.end(), marker);
+    display_buffer.age = 1;
+
+    renderer.set_damage(geom::Rectangles{{{4, 4}, {2, 2}}});
+    renderer.render({renderable_of(screen, 0xffffffff, mir_pixel_format_xrgb_8888)});
+
+    EXPECT_THAT(display_buffer.at(4, 4), Eq(0xffffffffu));
+    EXPECT_THAT(display_buffer.at(5, 5), Eq(0xffffffffu));
+    EXPECT_THAT(display_buffer.at(6, 6), Eq(marker));
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(marker));
+}
+
+TEST_F(SoftwareRenderer, repairs_older_buffers_with_the_damage_since)
+{
+    renderer.render({});
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {2, 2}}});
+    renderer.render({});
+    std::fill(display_buffer.pixels.begin(), display_buffer.pixels.end(), marker);
+    display_buffer.age = 2;
+
+    renderer.set_damage(geom::Rectangles{{{10, 10}, {2, 2}}});
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.at(0, 0), Eq(0u));
+    EXPECT_THAT(display_buffer.at(10, 10), Eq(0u));
+    EXPECT_THAT(display_buffer.at(5, 5), Eq(marker));
+}
+
+TEST_F(SoftwareRenderer, redraws_everything_into_a_buffer_of_unknown_age)
+{
+    renderer.render({});
+    std::fill(display_buffer.pixels.begin(), display_buffer.pixels.end(), marker);
+    display_buffer.age = 0;
+
+    renderer.set_damage(geom::Rectangles{{{4, 4}, {2, 2}}});
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.pixels, Each(Eq(0u)));
+}
+
+TEST_F(SoftwareRenderer, reads_buffers_outside_the_damage)
+{
+    auto const renderable = renderable_of({{20, 20}, {4, 4}}, 0xffffffff);
+    auto const buffer = std::static_pointer_cast<CountingBuffer>(renderable->buffer());
+    renderer.render({});
+    display_buffer.age = 1;
+
+    renderer.set_damage(geom::Rectangles{{{0, 0}, {2, 2}}});
+    renderer.render({renderable});
+
+    EXPECT_THAT(buffer->reads, Eq(1));
+    EXPECT_THAT(display_buffer.at(20, 20), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, draws_in_screen_coordinates_of_the_viewport)
+{
+    geom::Rectangle const second_output{{64, 0}, {32, 32}};
+    StubSoftwareDisplayBuffer second_buffer{second_output, mir_pixel_format_xbgr_8888};
+    mrs::Renderer second_renderer{second_buffer};
+
+    second_renderer.render({renderable_of({{60, 0}, {8, 8}}, 0xff0000ff, mir_pixel_format_xrgb_8888)});
+
+    EXPECT_THAT(second_buffer.at(64, 0), Eq(0xffff0000u));
+    EXPECT_THAT(second_buffer.at(67, 7), Eq(0xffff0000u));
+    EXPECT_THAT(second_buffer.at(68, 0), Eq(0u));
+}
+
+TEST_F(SoftwareRenderer, tells_the_target_what_it_redrew_in_buffer_coordinates)
+{
+    geom::Rectangle const second_output{{64, 16}, {32, 32}};
+    StubSoftwareDisplayBuffer second_buffer{second_output};
+    mrs::Renderer second_renderer{second_buffer};
+
+    second_renderer.render({});
+    EXPECT_THAT(second_buffer.last_damage, Eq(geom::Region{{{0, 0}, second_output.size}}));
+
+    second_buffer.age = 1;
+    second_renderer.set_damage(geom::Rectangles{{{70, 20}, {2, 2}}});
+    second_renderer.render({});
+    EXPECT_THAT(second_buffer.last_damage, Eq(geom::Region{{{6, 4}, {2, 2}}}));
+}
+
+TEST(SoftwareRendererTarget, throws_for_display_buffers_the_cpu_cannot_draw_into)
+{
+    mtd::StubDisplayBuffer display_buffer{{{0, 0}, {64, 48}}};
+
+    EXPECT_THROW(mrs::Renderer{display_buffer}, std::logic_error);
+}
+
+TEST(SoftwareRendererTarget, throws_for_output_formats_it_cannot_draw)
+{
+    StubSoftwareDisplayBuffer display_buffer{{{0, 0}, {64, 48}}, mir_pixel_format_rgb_565};
+
+    EXPECT_THROW(mrs::Renderer{display_buffer}, std::runtime_error);
+}
@@ -68,6 +68,7 @@ public:
     MOCK_METHOD1(client_surface_close_requested, void(ms::Surface const*));
     MOCK_METHOD2(cursor_image_set_to, void(ms::Surface const*, mir::graphics::CursorImage const& image));
     MOCK_METHOD1(cursor_image_removed, void(ms::Surface const*));
+    MOCK_METHOD2(input_region_set_to, void(ms::Surface const*, std::vector<geom::Rectangle> const&));
 };
 
 struct BasicSurfaceTest : public testing::Test
@@ -446,6 +447,42 @@ TEST_F(BasicSurfaceTest, disables_input_when_setting_input_region_with_empty_rec
     EXPECT_FALSE(surface.input_area_contains(rect.top_left));
 }
 
+TEST_F(BasicSurfaceTest, input_region_may_extend_beyond_surface)
+{
+    surface.set_input_region({{{-10, -10}, {100, 100}}});
+
+    EXPECT_TRUE(surface.input_area_contains(rect.top_left - geom::Displacement{10, 10}));
+    EXPECT_TRUE(surface.input_area_contains(rect.bottom_right()));
+    EXPECT_FALSE(surface.input_area_contains(rect.top_left - geom::Displacement{11, 11}));
+}
+
+TEST_F(BasicSurfaceTest, input_area_bounds_cover_surface_and_input_region)
+{
+    EXPECT_THAT(surface.input_area_bounds(), testing::Eq(rect));
+
+    surface.set_input_region({{{-10, -10}, {5, 5}}, {{2, 3}, {20, 1}}});
+
+    EXPECT_THAT(surface.input_bounds(), testing::Eq(rect));
+    EXPECT_THAT(surface.input_area_bounds(),
+        testing::Eq(geom::Rectangle{rect.top_left - geom::Displacement{10, 10}, {32, 19}}));
+
+    surface.set_input_region({geom::Rectangle()});
+
+    EXPECT_THAT(surface.input_area_bounds(), testing::Eq(rect));
+}
+
+TEST_F(BasicSurfaceTest, notifies_about_input_region_changes)
+{
+    using namespace testing;
+    std::vector<geom::Rectangle> const region{{{1, 1}, {2, 2}}};
+    auto const mock_surface_observer = std::make_shared<NiceMock<MockSurfaceObserver>>();
+
+    EXPECT_CALL(*mock_surface_observer, input_region_set_to(&surface, region));
+
+    surface.add_observer(mock_surface_observer);
+    surface.set_input_region(region);
+}
+
 TEST_F(BasicSurfaceTest, reception_mode_is_normal_by_default)
 {
     EXPECT_EQ(mi::InputReceptionMode::normal, surface.reception_mode());
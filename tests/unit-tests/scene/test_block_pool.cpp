@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/scene/block_pool.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <thread>
+
+namespace ms = mir::scene;
+using namespace testing;
+
+namespace
+{
+struct Payload
+{
+    int values[8];
+};
+}
+
+TEST(BlockPool, recycles_memory_of_destroyed_objects)
+{
+    auto const pool = std::make_shared<ms::BlockPool>(4);
+    ms::PooledAllocator<Payload> const allocator{pool};
+
+    auto first = std::allocate_shared<Payload>(allocator);
+    void const* const first_address = first.get();
+    first.reset();
+
+    auto const second = std::allocate_shared<Payload>(allocator);
+
+    EXPECT_THAT(second.get(), Eq(first_address));
+}
+
+TEST(BlockPool, gives_distinct_memory_to_live_objects)
+{
+    auto const pool = std::make_shared<ms::BlockPool>(4);
+    ms::PooledAllocator<Payload> const allocator{pool};
+
+    auto const first = std::allocate_shared<Payload>(allocator);
+    auto const second = std::allocate_shared<Payload>(allocator);
+
+    EXPECT_THAT(second.get(), Ne(first.get()));
+}
+
+TEST(BlockPool, keeps_no_more_than_the_maximum_free_blocks)
+{
+    auto const pool = std::make_shared<ms::BlockPool>(1);
+
+    auto const first = pool->allocate(sizeof(Payload));
+    auto const second = pool->allocate(sizeof(Payload));
+    pool->deallocate(first, sizeof(Payload));
+    pool->deallocate(second, sizeof(Payload));
+
+    auto const recycled = pool->allocate(sizeof(Payload));
+    EXPECT_THAT(recycled, Eq(first));
+    pool->deallocate(recycled, sizeof(Payload));
+}
+
+TEST(BlockPool, objects_can_be_released_on_another_thread)
+{
+    auto const pool = std::make_shared<ms::BlockPool>(4);
+    ms::PooledAllocator<Payload> const allocator{pool};
+
+    auto object = std::allocate_shared<Payload>(allocator);
+    void const* const address = object.get();
+
+    std::thread{[&object] { object.reset(); }}.join();
+
+    auto const recycled = std::allocate_shared<Payload>(allocator);
+    EXPECT_THAT(recycled.get(), Eq(address));
+}
+
+TEST(BlockPool, objects_keep_the_pool_alive)
+{
+    auto pool = std::make_shared<ms::BlockPool>(4);
+    auto object = std::allocate_shared<Payload>(ms::PooledAllocator<Payload>{pool});
+    std::weak_ptr<ms::BlockPool> const weak_pool = pool;
+
+    pool.reset();
+    EXPECT_FALSE(weak_pool.expired());
+
+    object.reset();
+    EXPECT_TRUE(weak_pool.expired());
+}
@@ -225,3 +225,52 @@ TEST_F(GLPixelBufferTest, returns_data_from_rgba_buffer_texture)
     EXPECT_EQ(width - 1,
               static_cast<uint32_t const*>(data)[width * height - 1]);
 }
+
+TEST_F(GLPixelBufferTest, collects_fills_in_the_order_they_were_made)
+{
+    using namespace testing;
+    geom::Size const first_size{51, 71};
+    geom::Size const second_size{20, 10};
+
+    NiceMock<mtd::MockGLBuffer> second_buffer;
+    ON_CALL(second_buffer, size())
+        .WillByDefault(Return(second_size));
+    ON_CALL(mock_gl, glReadPixels(_, _, _, _, _, _, _))
+        .WillByDefault(FillPixels());
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+    ASSERT_THAT(pixels.max_pending(), Ge(2u));
+
+    pixels.fill_from(mock_buffer);
+    pixels.fill_from(second_buffer);
+
+    auto data = pixels.as_argb_8888();
+    EXPECT_EQ(first_size, pixels.size());
+    EXPECT_EQ(first_size.width.as_uint32_t() * (first_size.height.as_uint32_t() - 1),
+              static_cast<uint32_t const*>(data)[0]);
+
+    data = pixels.as_argb_8888();
+    EXPECT_EQ(second_size, pixels.size());
+    EXPECT_EQ(geom::Stride{second_size.width.as_uint32_t() * 4}, pixels.stride());
+    EXPECT_EQ(second_size.width.as_uint32_t() * (second_size.height.as_uint32_t() - 1),
+              static_cast<uint32_t const*>(data)[0]);
+}
+
+TEST_F(GLPixelBufferTest, drops_the_oldest_fill_when_too_many_are_pending)
+{
+    using namespace testing;
+    geom::Size const newer_size{20, 10};
+
+    NiceMock<mtd::MockGLBuffer> newer_buffer;
+    ON_CALL(newer_buffer, size())
+        .WillByDefault(Return(newer_size));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    pixels.fill_from(mock_buffer);
+    for (auto i = 0u; i != pixels.max_pending(); ++i)
+        pixels.fill_from(newer_buffer);
+
+    pixels.as_argb_8888();
+    EXPECT_EQ(newer_size, pixels.size());
+}
@@ -152,3 +152,39 @@ TEST_F(RenderingTrackerTest, throws_when_passed_inactive_compositor_id)
         tracker.rendered_in(compositor_id2);
     }, std::logic_error);
 }
+
+TEST_F(RenderingTrackerTest, reports_every_presented_frame_surface_was_rendered_in)
+{
+    using namespace testing;
+
+    std::set<mc::CompositorID> const compositors{compositor_id1};
+    tracker.active_compositors(compositors);
+
+    auto presentation_time = std::chrono::steady_clock::now();
+    for (int i = 0; i != 3; ++i)
+    {
+        presentation_time += std::chrono::milliseconds{16};
+        tracker.rendered_in(compositor_id1);
+        EXPECT_TRUE(tracker.frame_presented_in(compositor_id1, presentation_time));
+    }
+}
+
+TEST_F(RenderingTrackerTest, throttles_presented_frames_surface_was_not_rendered_in)
+{
+    using namespace testing;
+
+    std::set<mc::CompositorID> const compositors{compositor_id1, compositor_id2};
+    tracker.active_compositors(compositors);
+
+    auto const start = std::chrono::steady_clock::now();
+    tracker.rendered_in(compositor_id1);
+    EXPECT_TRUE(tracker.frame_presented_in(compositor_id1, start));
+    EXPECT_FALSE(tracker.throttled_frame_due(start + std::chrono::milliseconds{16}));
+
+    tracker.occluded_in(compositor_id1);
+    EXPECT_FALSE(tracker.frame_presented_in(compositor_id1, start + std::chrono::milliseconds{16}));
+    EXPECT_FALSE(tracker.frame_presented_in(compositor_id2, start + std::chrono::milliseconds{32}));
+    EXPECT_TRUE(tracker.throttled_frame_due(start + std::chrono::seconds{1}));
+    EXPECT_FALSE(tracker.throttled_frame_due(start + std::chrono::milliseconds{1016}));
+    EXPECT_TRUE(tracker.throttled_frame_due(start + std::chrono::seconds{2}));
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "src/server/scene/surface_index.h"
+
+#include "mir/test/doubles/stub_scene_surface.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace ms = mir::scene;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+struct RectangularSurface : mtd::StubSceneSurface
+{
+    explicit RectangularSurface(geom::Rectangle const& bounds) :
+        bounds{bounds}
+    {
+    }
+
+    geom::Rectangle input_bounds() const override { return bounds; }
+    bool input_area_contains(geom::Point const& point) const override
+    {
+        return accepts_input && bounds.contains(point);
+    }
+
+    geom::Rectangle bounds;
+    bool accepts_input{true};
+};
+
+struct SurfaceIndex : Test
+{
+    auto add_surface(geom::Rectangle const& bounds) -> std::shared_ptr<RectangularSurface>
+    {
+        auto const surface = std::make_shared<RectangularSurface>(bounds);
+        index.insert(surface);
+        return surface;
+    }
+
+    ms::SurfaceIndex index;
+};
+}
+
+TEST_F(SurfaceIndex, finds_nothing_when_empty)
+{
+    EXPECT_THAT(index.surface_at({10, 10}), IsNull());
+}
+
+TEST_F(SurfaceIndex, finds_surface_containing_point)
+{
+    auto const surface = add_surface({{100, 100}, {50, 50}});
+
+    EXPECT_THAT(index.surface_at({120, 120}), Eq(surface));
+    EXPECT_THAT(index.surface_at({99, 120}), IsNull());
+    EXPECT_THAT(index.surface_at({150, 120}), IsNull());
+}
+
+TEST_F(SurfaceIndex, finds_topmost_of_overlapping_surfaces)
+{
+    auto const bottom = add_surface({{0, 0}, {300, 300}});
+    auto const top = add_surface({{200, 200}, {300, 300}});
+
+    EXPECT_THAT(index.surface_at({250, 250}), Eq(top));
+    EXPECT_THAT(index.surface_at({100, 100}), Eq(bottom));
+}
+
+TEST_F(SurfaceIndex, raised_surface_is_found_above_others)
+{
+    auto const bottom = add_surface({{0, 0}, {300, 300}});
+    auto const top = add_surface({{200, 200}, {300, 300}});
+
+    index.raise(bottom.get());
+
+    EXPECT_THAT(index.surface_at({250, 250}), Eq(bottom));
+}
+
+TEST_F(SurfaceIndex, skips_surfaces_whose_input_area_excludes_point)
+{
+    auto const bottom = add_surface({{0, 0}, {300, 300}});
+    auto const top = add_surface({{0, 0}, {300, 300}});
+    top->accepts_input = false;
+
+    EXPECT_THAT(index.surface_at({10, 10}), Eq(bottom));
+}
+
+TEST_F(SurfaceIndex, finds_surface_at_new_position_after_update)
+{
+    auto const surface = add_surface({{0, 0}, {100, 100}});
+
+    surface->bounds = {{1000, 1000}, {100, 100}};
+    index.update(surface.get());
+
+    EXPECT_THAT(index.surface_at({50, 50}), IsNull());
+    EXPECT_THAT(index.surface_at({1050, 1050}), Eq(surface));
+}
+
+TEST_F(SurfaceIndex, erased_surface_is_not_found)
+{
+    auto const surface = add_surface({{0, 0}, {100, 100}});
+
+    index.erase(surface.get());
+
+    EXPECT_THAT(index.surface_at({50, 50}), IsNull());
+}
+
+TEST_F(SurfaceIndex, does_not_keep_surfaces_alive)
+{
+    auto surface = add_surface({{0, 0}, {100, 100}});
+    std::weak_ptr<RectangularSurface> const weak_surface = surface;
+
+    surface.reset();
+
+    EXPECT_THAT(weak_surface.lock(), IsNull());
+    EXPECT_THAT(index.surface_at({50, 50}), IsNull());
+}
+
+TEST_F(SurfaceIndex, finds_surfaces_at_negative_coordinates)
+{
+    auto const surface = add_surface({{-300, -300}, {100, 100}});
+
+    EXPECT_THAT(index.surface_at({-250, -250}), Eq(surface));
+    EXPECT_THAT(index.surface_at({-150, -150}), IsNull());
+    EXPECT_THAT(index.surface_at({50, 50}), IsNull());
+}
+
+TEST_F(SurfaceIndex, finds_surfaces_spanning_many_cells)
+{
+    auto const huge = add_surface({{-10000, -10000}, {20000, 20000}});
+    auto const small = add_surface({{100, 100}, {10, 10}});
+
+    EXPECT_THAT(index.surface_at({105, 105}), Eq(small));
+    EXPECT_THAT(index.surface_at({9000, -9000}), Eq(huge));
+
+    index.raise(huge.get());
+
+    EXPECT_THAT(index.surface_at({105, 105}), Eq(huge));
+}
+
+TEST_F(SurfaceIndex, surface_moved_between_bucketed_and_oversized_is_still_found)
+{
+    auto const surface = add_surface({{0, 0}, {100, 100}});
+
+    surface->bounds = {{0, 0}, {20000, 20000}};
+    index.update(surface.get());
+    EXPECT_THAT(index.surface_at({15000, 15000}), Eq(surface));
+
+    surface->bounds = {{500, 500}, {100, 100}};
+    index.update(surface.get());
+    EXPECT_THAT(index.surface_at({15000, 15000}), IsNull());
+    EXPECT_THAT(index.surface_at({550, 550}), Eq(surface));
+}
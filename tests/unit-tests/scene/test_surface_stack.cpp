@@ -30,6 +30,8 @@
 #include "mir/test/doubles/stub_buffer_stream_factory.h"
 #include "mir/test/doubles/stub_renderable.h"
 #include "mir/test/doubles/mock_buffer_stream.h"
+#include "mir/test/doubles/fake_alarm_factory.h"
+#include "mir/test/doubles/advanceable_clock.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -734,6 +736,63 @@ TEST_F(SurfaceStack, exposes_rendered_surface)
     elements2.back()->rendered();
 }
 
+TEST_F(SurfaceStack, tells_rendered_surface_its_frame_was_presented)
+{
+    using namespace testing;
+
+    auto const mock_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    auto const surface = std::make_shared<ms::BasicSurface>(
+        std::string("stub"),
+        geom::Rectangle{{},{}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { mock_stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+
+    stack.register_compositor(compositor_id);
+    stack.add_surface(surface, default_params.input_mode);
+
+    auto const elements = stack.scene_elements_for(compositor_id);
+    ASSERT_THAT(elements.size(), Eq(1u));
+    elements.back()->rendered();
+
+    mc::PresentedFrame const frame{{7, mg::Frame::Timestamp::now(CLOCK_MONOTONIC)}, std::chrono::milliseconds{16}};
+    EXPECT_CALL(*mock_stream, frame_presented(Field(&mc::PresentedFrame::frame, Field(&mg::Frame::msc, Eq(7))), true));
+
+    stack.frame_presented(compositor_id, frame);
+}
+
+TEST_F(SurfaceStack, tells_surfaces_of_throttled_frames_while_the_scene_is_idle)
+{
+    using namespace testing;
+
+    auto const alarm_factory = std::make_shared<mtd::FakeAlarmFactory>();
+    auto const clock = std::make_shared<mtd::AdvanceableClock>();
+    ms::SurfaceStack idle_stack{report, alarm_factory, clock};
+
+    auto const mock_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    auto const surface = std::make_shared<ms::BasicSurface>(
+        std::string("stub"),
+        geom::Rectangle{{},{}},
+        mir_pointer_unconfined,
+        std::list<ms::StreamInfo> { { mock_stream, {}, {} } },
+        std::shared_ptr<mg::CursorImage>(),
+        report);
+
+    idle_stack.register_compositor(compositor_id);
+    idle_stack.add_surface(surface, default_params.input_mode);
+
+    // Nothing is composited, but the surface still hears about a frame once a second
+    EXPECT_CALL(*mock_stream, frame_presented(_, false)).Times(2);
+
+    // (FakeAlarm only fires once time has passed its deadline)
+    for (int i = 0; i != 2; ++i)
+    {
+        clock->advance_by(std::chrono::milliseconds{1001});
+        alarm_factory->advance_by(std::chrono::milliseconds{1001});
+    }
+}
+
 TEST_F(SurfaceStack, occludes_surface_when_unregistering_all_compositors_that_rendered_it)
 {
     using namespace testing;
@@ -770,6 +829,27 @@ TEST_F(SurfaceStack, occludes_surface_when_unregistering_all_compositors_that_re
     stack.unregister_compositor(compositor_id3);
 }
 
+TEST_F(SurfaceStack, visibility_change_from_unregistering_a_compositor_can_modify_the_stack)
+{
+    using namespace testing;
+
+    stack.register_compositor(compositor_id);
+
+    auto const mock_surface = std::make_shared<MockConfigureSurface>();
+    stack.add_surface(mock_surface, default_params.input_mode);
+    stack.add_surface(stub_surface1, default_params.input_mode);
+
+    // Without any compositor left the surface becomes occluded, and a shell may react to that
+    EXPECT_CALL(*mock_surface, configure(mir_window_attrib_visibility, mir_window_visibility_occluded))
+        .WillOnce(InvokeWithoutArgs([&] { stack.raise(mock_surface); return mir_window_visibility_occluded; }));
+
+    stack.unregister_compositor(compositor_id);
+
+    std::vector<std::shared_ptr<mi::Surface>> order;
+    stack.for_each([&](std::shared_ptr<mi::Surface> const& surface) { order.push_back(surface); });
+    EXPECT_THAT(order, ElementsAre(Eq(stub_surface1), Eq(mock_surface)));
+}
+
 TEST_F(SurfaceStack, observer_can_trigger_state_change_within_notification)
 {
     using namespace ::testing;
@@ -986,6 +1066,50 @@ TEST_F(SurfaceStack, returns_top_visible_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, surface_under_cursor_follows_moves_and_raises)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+    EXPECT_THAT(stack.input_surface_at({50, 50}), Eq(stub_surface2));
+
+    stub_surface2->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+
+    stub_surface1->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+
+    stack.raise(stub_surface1);
+
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface1));
+
+    stack.remove_surface(stub_surface1);
+
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+}
+
+TEST_F(SurfaceStack, surface_under_cursor_includes_input_region_beyond_the_surface)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface1->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({990, 990}).get(), IsNull());
+
+    stub_surface1->set_input_region({{{-20, -20}, {140, 140}}});
+
+    EXPECT_THAT(stack.surface_at({990, 990}), Eq(stub_surface1));
+    EXPECT_THAT(stack.input_surface_at({1110, 1110}), Eq(stub_surface1));
+}
+
 TEST_F(SurfaceStack, raise_surfaces_to_top)
 {
     stack.add_surface(stub_surface1, default_params.input_mode);
@@ -1027,3 +1151,61 @@ TEST_F(SurfaceStack, raise_surfaces_to_top)
             SceneElementForStream(stub_buffer_stream2),
             SceneElementForStream(stub_buffer_stream3)));
 }
+
+TEST_F(SurfaceStack, for_each_callback_can_modify_the_stack)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    int count{0};
+    stack.for_each(
+        [&](std::shared_ptr<mi::Surface> const&)
+        {
+            ++count;
+            stack.remove_surface(stub_surface2);
+            stack.raise(stub_surface1);
+        });
+
+    // The enumeration sees the stack as it was when it started...
+    EXPECT_THAT(count, Eq(2));
+    // ...and the changes are visible afterwards
+    EXPECT_THAT(
+        stack.scene_elements_for(compositor_id),
+        ElementsAre(SceneElementForStream(stub_buffer_stream1)));
+}
+
+TEST_F(SurfaceStack, readers_see_consistent_stack_while_it_changes)
+{
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistencies{0};
+
+    auto const reader = std::async(std::launch::async, [&]
+        {
+            while (!done)
+            {
+                auto const elements = stack.scene_elements_for(compositor_id);
+                if (elements.size() > 2)
+                    ++inconsistencies;
+
+                int surfaces{0};
+                stack.for_each([&](std::shared_ptr<mi::Surface> const&) { ++surfaces; });
+                if (surfaces > 2)
+                    ++inconsistencies;
+            }
+        });
+
+    for (int i = 0; i != 1000; ++i)
+    {
+        stack.add_surface(stub_surface1, default_params.input_mode);
+        stack.add_surface(stub_surface2, default_params.input_mode);
+        stack.raise(stub_surface1);
+        stack.remove_surface(stub_surface1);
+        stack.remove_surface(stub_surface2);
+    }
+
+    done = true;
+    reader.wait();
+
+    EXPECT_THAT(inconsistencies, Eq(0));
+    EXPECT_THAT(stack.scene_elements_for(compositor_id), IsEmpty());
+}
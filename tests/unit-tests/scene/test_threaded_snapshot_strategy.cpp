@@ -46,12 +46,18 @@ namespace
 class MockPixelBuffer : public ms::PixelBuffer
 {
 public:
+    MockPixelBuffer()
+    {
+        ON_CALL(*this, max_pending())
+            .WillByDefault(testing::Return(1));
+    }
     ~MockPixelBuffer() noexcept {}
 
     MOCK_METHOD1(fill_from, void(mg::Buffer& buffer));
     MOCK_METHOD0(as_argb_8888, void const*());
     MOCK_CONST_METHOD0(size, geom::Size());
     MOCK_CONST_METHOD0(stride, geom::Stride());
+    MOCK_CONST_METHOD0(max_pending, unsigned int());
 };
 
 struct NamedThreadBufferStream : mtd::StubBufferStream
@@ -112,6 +118,53 @@ TEST_F(ThreadedSnapshotStrategyTest, takes_snapshot)
     EXPECT_EQ(pixels, snapshot.pixels);
 }
 
+TEST_F(ThreadedSnapshotStrategyTest, starts_queued_snapshots_before_collecting_the_one_before)
+{
+    using namespace testing;
+
+    NiceMock<MockPixelBuffer> pixel_buffer;
+    ON_CALL(pixel_buffer, max_pending())
+        .WillByDefault(Return(2));
+
+    mt::Signal first_fill_started;
+    mt::Signal rest_scheduled;
+    mt::Signal all_taken;
+    std::atomic<int> taken{0};
+
+    {
+        InSequence s;
+        EXPECT_CALL(pixel_buffer, fill_from(_))
+            .WillOnce(InvokeWithoutArgs(
+                [&]
+                {
+                    first_fill_started.raise();
+                    rest_scheduled.wait_for(std::chrono::seconds{5});
+                }));
+        EXPECT_CALL(pixel_buffer, fill_from(_));
+        EXPECT_CALL(pixel_buffer, as_argb_8888());
+        EXPECT_CALL(pixel_buffer, fill_from(_));
+        EXPECT_CALL(pixel_buffer, as_argb_8888());
+        EXPECT_CALL(pixel_buffer, as_argb_8888());
+    }
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    auto const snapshot_taken =
+        [&](ms::Snapshot const&)
+        {
+            if (++taken == 3)
+                all_taken.raise();
+        };
+
+    strategy.take_snapshot_of(mt::fake_shared(buffer_access), snapshot_taken);
+    first_fill_started.wait_for(std::chrono::seconds{5});
+    strategy.take_snapshot_of(mt::fake_shared(buffer_access), snapshot_taken);
+    strategy.take_snapshot_of(mt::fake_shared(buffer_access), snapshot_taken);
+    rest_scheduled.raise();
+
+    EXPECT_TRUE(all_taken.wait_for(std::chrono::seconds{5}));
+}
+
 #ifndef MIR_DONT_USE_PTHREAD_GETNAME_NP
 TEST_F(ThreadedSnapshotStrategyTest, names_snapshot_thread)
 {
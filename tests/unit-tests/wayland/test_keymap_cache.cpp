@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/keymap_cache.h"
+
+#include "mir/input/keymap.h"
+
+#include <xkbcommon/xkbcommon.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <memory>
+#include <string>
+
+#ifndef F_GET_SEALS
+#define F_GET_SEALS 1034
+#define F_SEAL_WRITE 0x0008
+#endif
+
+namespace mf = mir::frontend;
+namespace mi = mir::input;
+
+using namespace testing;
+
+namespace
+{
+auto contents_of(mf::CompiledKeymap const& keymap) -> std::string
+{
+    auto const mapping = mmap(nullptr, keymap.size(), PROT_READ, MAP_PRIVATE, keymap.fd(), 0);
+    if (mapping == MAP_FAILED)
+        return {};
+
+    std::string const result{static_cast<char const*>(mapping), keymap.size()};
+    munmap(mapping, keymap.size());
+    return result;
+}
+
+auto text_of(mf::CompiledKeymap const& keymap) -> std::string
+{
+    std::unique_ptr<char, void(*)(void*)> const text{
+        xkb_keymap_get_as_string(keymap.keymap(), XKB_KEYMAP_FORMAT_TEXT_V1),
+        free};
+    return text.get();
+}
+}
+
+TEST(KeymapCache, the_same_names_share_one_compiled_keymap)
+{
+    mf::KeymapCache cache;
+
+    auto const first = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+    auto const second = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+
+    EXPECT_THAT(second, Eq(first));
+}
+
+TEST(KeymapCache, different_names_get_different_keymaps)
+{
+    mf::KeymapCache cache;
+
+    auto const us = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+    auto const gb = cache.keymap_for(mi::Keymap{"pc105", "gb", "", ""});
+
+    EXPECT_THAT(gb, Ne(us));
+    EXPECT_THAT(text_of(*gb), Ne(text_of(*us)));
+}
+
+TEST(KeymapCache, file_holds_the_terminated_keymap_text)
+{
+    mf::KeymapCache cache;
+
+    auto const keymap = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+
+    EXPECT_THAT(contents_of(*keymap), Eq(text_of(*keymap) + '\0'));
+}
+
+TEST(KeymapCache, file_cannot_be_written)
+{
+    mf::KeymapCache cache;
+
+    auto const keymap = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+
+    // Keymap files are only sealed where the kernel supports memfd
+    auto const seals = fcntl(keymap->fd(), F_GET_SEALS);
+    if (seals == -1)
+        return;
+
+    EXPECT_THAT(seals & F_SEAL_WRITE, Ne(0));
+    EXPECT_THAT(mmap(nullptr, keymap->size(), PROT_WRITE, MAP_SHARED, keymap->fd(), 0), Eq(MAP_FAILED));
+}
+
+TEST(KeymapCache, device_keymap_matching_a_named_keymap_shares_it)
+{
+    mf::KeymapCache cache;
+
+    auto const named = cache.keymap_for(mi::Keymap{"pc105", "us", "", ""});
+    auto const text = text_of(*named);
+    auto const from_device = cache.keymap_for(text.c_str(), text.size() + 1);
+
+    EXPECT_THAT(from_device, Eq(named));
+}
+
+TEST(KeymapCache, the_same_device_keymap_is_only_compiled_once)
+{
+    mf::KeymapCache cache;
+
+    auto const text = text_of(*cache.keymap_for(mi::Keymap{"pc105", "de", "", ""}));
+    mf::KeymapCache device_cache;
+
+    auto const first = device_cache.keymap_for(text.c_str(), text.size());
+    auto const second = device_cache.keymap_for(text.c_str(), text.size() + 1);
+
+    EXPECT_THAT(second, Eq(first));
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/linux_dmabuf.h"
+
+#include "mir/graphics/buffer.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <wayland-server-core.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const argb8888 = 0x34325241; // DRM_FORMAT_ARGB8888
+uint64_t const linear = 0;
+
+struct StubImportedDmaBuf : mg::ImportedDmaBuf
+{
+    std::shared_ptr<mg::Buffer> buffer(std::function<void()>&&, std::function<void()>&&) override
+    {
+        ++buffers;
+        return std::make_shared<mtd::StubBuffer>();
+    }
+
+    int buffers{0};
+};
+
+struct StubWaylandAllocator : mg::WaylandAllocator
+{
+    void bind_display(wl_display*, std::shared_ptr<mir::Executor>) override
+    {
+    }
+
+    std::shared_ptr<mg::Buffer> buffer_from_resource(
+        wl_resource*,
+        std::function<void()>&&,
+        std::function<void()>&&) override
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<mg::ImportedDmaBuf> import_dmabuf(mg::DmaBufAttributes const& attributes) override
+    {
+        ++imports;
+        if (!import)
+            return WaylandAllocator::import_dmabuf(attributes);
+
+        return import;
+    }
+
+    std::shared_ptr<StubImportedDmaBuf> import;
+    int imports{0};
+};
+
+struct LinuxDmabuf : Test
+{
+    LinuxDmabuf()
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets))
+            throw std::runtime_error{"Failed to create socketpair"};
+
+        client = wl_client_create(display, sockets[0]);
+        // Every client has its wl_display object, which will do as a parent for our buffers
+        parent = wl_client_get_object(client, 1);
+    }
+
+    ~LinuxDmabuf()
+    {
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+        close(sockets[1]);
+    }
+
+    /// A "dma-buf" the CPU path can read; it only needs to be mmap()able
+    auto dmabuf_with(std::vector<uint32_t> const& pixels) -> mir::Fd
+    {
+        mir::Fd fd{memfd_create("test-dmabuf", MFD_CLOEXEC)};
+        auto const bytes = pixels.size() * sizeof(uint32_t);
+        if (ftruncate(fd, bytes) || write(fd, pixels.data(), bytes) != static_cast<ssize_t>(bytes))
+            throw std::runtime_error{"Failed to fill memfd"};
+        return fd;
+    }
+
+    auto attributes_for(mir::Fd const& fd, geom::Size size, uint32_t stride) -> mg::DmaBufAttributes
+    {
+        mg::DmaBufAttributes attributes;
+        attributes.size = size;
+        attributes.fourcc = argb8888;
+        attributes.modifier = linear;
+        attributes.planes.push_back({fd, 0, stride});
+        return attributes;
+    }
+
+    wl_display* const display{wl_display_create()};
+    int sockets[2];
+    wl_client* client;
+    wl_resource* parent;
+
+    std::shared_ptr<StubWaylandAllocator> const allocator{std::make_shared<StubWaylandAllocator>()};
+};
+}
+
+TEST_F(LinuxDmabuf, cpu_can_read_only_tightly_packed_single_plane_buffers)
+{
+    auto const fd = dmabuf_with(std::vector<uint32_t>(16));
+
+    EXPECT_TRUE(mf::DmaBufBuffer::cpu_readable(attributes_for(fd, {4, 4}, 16)));
+    EXPECT_FALSE(mf::DmaBufBuffer::cpu_readable(attributes_for(fd, {2, 4}, 16)));
+
+    auto two_planes = attributes_for(fd, {4, 4}, 16);
+    two_planes.planes.push_back({fd, 0, 16});
+    EXPECT_FALSE(mf::DmaBufBuffer::cpu_readable(two_planes));
+
+    auto tiled = attributes_for(fd, {4, 4}, 16);
+    tiled.modifier = 1;
+    EXPECT_FALSE(mf::DmaBufBuffer::cpu_readable(tiled));
+}
+
+TEST_F(LinuxDmabuf, uses_the_platform_import_when_there_is_one)
+{
+    allocator->import = std::make_shared<StubImportedDmaBuf>();
+    auto const buffer = new mf::DmaBufBuffer{
+        client, parent, 0, attributes_for(dmabuf_with(std::vector<uint32_t>(16)), {4, 4}, 16), true, allocator};
+
+    EXPECT_THAT(buffer->mir_buffer([]{}, []{}), NotNull());
+    EXPECT_THAT(allocator->import->buffers, Eq(1));
+}
+
+TEST_F(LinuxDmabuf, imports_once_and_reuses_the_import_for_later_commits)
+{
+    allocator->import = std::make_shared<StubImportedDmaBuf>();
+    auto const buffer = new mf::DmaBufBuffer{
+        client, parent, 0, attributes_for(dmabuf_with(std::vector<uint32_t>(16)), {4, 4}, 16), true, allocator};
+
+    buffer->mir_buffer([]{}, []{});
+    buffer->mir_buffer([]{}, []{});
+    buffer->mir_buffer([]{}, []{});
+
+    EXPECT_THAT(allocator->imports, Eq(1));
+    EXPECT_THAT(allocator->import->buffers, Eq(3));
+}
+
+TEST_F(LinuxDmabuf, reads_pixels_with_the_cpu_when_the_platform_cannot_import)
+{
+    std::vector<uint32_t> const pixels{0xff000000, 0xff0000ff, 0xff00ff00, 0xffff0000};
+    auto const buffer = new mf::DmaBufBuffer{
+        client, parent, 0, attributes_for(dmabuf_with(pixels), {2, 2}, 8), true, allocator};
+
+    auto const mir_buffer = buffer->mir_buffer([]{}, []{});
+    auto const pixel_source = dynamic_cast<mrs::PixelSource*>(mir_buffer->native_buffer_base());
+
+    ASSERT_THAT(pixel_source, NotNull());
+    EXPECT_THAT(mir_buffer->size(), Eq(geom::Size{2, 2}));
+    EXPECT_THAT(mir_buffer->pixel_format(), Eq(mir_pixel_format_argb_8888));
+
+    std::vector<uint32_t> read(4);
+    pixel_source->read([&](unsigned char const* data) { memcpy(read.data(), data, 16); });
+    EXPECT_THAT(read, Eq(pixels));
+}
+
+TEST_F(LinuxDmabuf, only_tries_the_platform_import_until_it_fails)
+{
+    auto const buffer = new mf::DmaBufBuffer{
+        client, parent, 0, attributes_for(dmabuf_with(std::vector<uint32_t>(16)), {4, 4}, 16), true, allocator};
+
+    buffer->mir_buffer([]{}, []{});
+    buffer->mir_buffer([]{}, []{});
+
+    EXPECT_THAT(allocator->imports, Eq(1));
+}
+
+TEST_F(LinuxDmabuf, cpu_buffers_are_consumed_on_first_read_and_released_on_destruction)
+{
+    auto const buffer = new mf::DmaBufBuffer{
+        client, parent, 0, attributes_for(dmabuf_with(std::vector<uint32_t>(16)), {4, 4}, 16), false, allocator};
+
+    int consumed{0};
+    bool released{false};
+    auto mir_buffer = buffer->mir_buffer([&]{ ++consumed; }, [&]{ released = true; });
+    auto const pixel_source = dynamic_cast<mrs::PixelSource*>(mir_buffer->native_buffer_base());
+
+    pixel_source->read([](unsigned char const*) {});
+    pixel_source->read([](unsigned char const*) {});
+    EXPECT_THAT(consumed, Eq(1));
+    EXPECT_FALSE(released);
+
+    mir_buffer.reset();
+    EXPECT_TRUE(released);
+    EXPECT_THAT(allocator->imports, Eq(0));
+}
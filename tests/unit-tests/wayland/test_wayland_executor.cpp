@@ -26,6 +26,9 @@
 #include "mir/test/fd_utils.h"
 #include "mir/test/auto_unblock_thread.h"
 
+#include <atomic>
+#include <numeric>
+
 namespace mt = mir::test;
 namespace mf = mir::frontend;
 
@@ -159,3 +162,61 @@ TEST_F(WaylandExecutorTest, spawning_is_threadsafe)
 
     EXPECT_THAT(counter, Eq(thread_count));
 }
+
+TEST_F(WaylandExecutorTest, one_dispatch_runs_all_queued_tasks)
+{
+    mf::WaylandExecutor executor{the_event_loop};
+
+    int executed{0};
+    for (int i = 0; i != 10; ++i)
+        executor.spawn([&executed]() { ++executed; });
+
+    wl_event_loop_dispatch(the_event_loop, 0);
+
+    EXPECT_THAT(executed, Eq(10));
+    EXPECT_THAT(event_loop_fd, Not(FdIsReadable()));
+}
+
+TEST_F(WaylandExecutorTest, tasks_spawned_from_other_threads_all_run_in_the_order_each_thread_spawned_them)
+{
+    using namespace std::literals::chrono_literals;
+
+    auto executor = std::make_shared<mf::WaylandExecutor>(the_event_loop);
+
+    int const thread_count{4};
+    int const tasks_per_thread{10000};
+    std::vector<std::vector<int>> executed(thread_count);
+    std::atomic<int> remaining{thread_count * tasks_per_thread};
+
+    {
+        std::vector<mt::AutoJoinThread> threads;
+        for (auto i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back(
+                [executor, &executed, &remaining, i]()
+                {
+                    for (auto task = 0; task < tasks_per_thread; ++task)
+                    {
+                        executor->spawn(
+                            [&executed, &remaining, i, task]()
+                            {
+                                executed[i].push_back(task);
+                                --remaining;
+                            });
+                    }
+                });
+        }
+
+        auto const deadline = std::chrono::steady_clock::now() + 10s;
+        while (remaining && std::chrono::steady_clock::now() < deadline)
+        {
+            if (mt::fd_becomes_readable(event_loop_fd, 100ms))
+                wl_event_loop_dispatch(the_event_loop, 0);
+        }
+    }
+
+    std::vector<int> expected(tasks_per_thread);
+    std::iota(expected.begin(), expected.end(), 0);
+    for (auto const& tasks : executed)
+        EXPECT_THAT(tasks, ContainerEq(expected));
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wlshmbuffer.h"
+
+#include "mir/executor.h"
+#include "mir/fd.h"
+#include "mir/renderer/sw/pixel_source.h"
+
+#include <wayland-server-core.h>
+#include <wayland-client.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct ImmediateExecutor : mir::Executor
+{
+    void spawn(std::function<void()>&& work) override
+    {
+        work();
+    }
+};
+
+/// A wl_shm buffer created by a real client connection, so libwayland's shm implementation backs it
+struct WlShmBuffer : Test
+{
+    WlShmBuffer()
+    {
+        int sockets[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets))
+            throw std::runtime_error{"Failed to create socketpair"};
+
+        wl_display_init_shm(display);
+        client = wl_client_create(display, sockets[0]);
+        client_display = wl_display_connect_to_fd(sockets[1]);
+
+        // wl_shm is the only global, so it is the first one advertised
+        registry = wl_display_get_registry(client_display);
+        shm = static_cast<wl_shm*>(wl_registry_bind(registry, 1, &wl_shm_interface, 1));
+
+        if (ftruncate(pool_fd, pool_bytes))
+            throw std::runtime_error{"Failed to size shm pool"};
+        pixels = static_cast<uint32_t*>(mmap(nullptr, pool_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, pool_fd, 0));
+        if (pixels == MAP_FAILED)
+            throw std::runtime_error{"Failed to map shm pool"};
+
+        pool = wl_shm_create_pool(shm, pool_fd, pool_bytes);
+        client_buffer = wl_shm_pool_create_buffer(pool, 0, 2, 2, 8, WL_SHM_FORMAT_ARGB8888);
+        process_client_requests();
+
+        buffer = wl_client_get_object(client, wl_proxy_get_id(reinterpret_cast<wl_proxy*>(client_buffer)));
+    }
+
+    ~WlShmBuffer()
+    {
+        wl_buffer_destroy(client_buffer);
+        wl_shm_pool_destroy(pool);
+        wl_shm_destroy(shm);
+        wl_registry_destroy(registry);
+        process_client_requests();
+
+        munmap(pixels, pool_bytes);
+        wl_display_disconnect(client_display);
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+    }
+
+    void process_client_requests()
+    {
+        wl_display_flush(client_display);
+        wl_event_loop_dispatch(wl_display_get_event_loop(display), 0);
+        wl_display_flush_clients(display);
+    }
+
+    auto read_pixels(mg::Buffer& mir_buffer) -> std::vector<uint32_t>
+    {
+        auto const pixel_source = dynamic_cast<mrs::PixelSource*>(mir_buffer.native_buffer_base());
+        if (!pixel_source)
+            throw std::logic_error{"WlShmBuffer is not a PixelSource"};
+
+        std::vector<uint32_t> result(4);
+        pixel_source->read([&](unsigned char const* data) { memcpy(result.data(), data, 16); });
+        return result;
+    }
+
+    static int const pool_bytes = 16;
+
+    wl_display* const display{wl_display_create()};
+    wl_client* client;
+    wl_display* client_display;
+    wl_registry* registry;
+    wl_shm* shm;
+    mir::Fd const pool_fd{memfd_create("test-shm-pool", MFD_CLOEXEC)};
+    uint32_t* pixels;
+    wl_shm_pool* pool;
+    wl_buffer* client_buffer;
+    wl_resource* buffer;
+
+    std::shared_ptr<mir::Executor> const executor{std::make_shared<ImmediateExecutor>()};
+};
+}
+
+TEST_F(WlShmBuffer, reattaching_a_held_buffer_samples_its_new_contents)
+{
+    std::vector<uint32_t> const first{0xff000000, 0xff0000ff, 0xff00ff00, 0xffff0000};
+    std::vector<uint32_t> const second{0xffffffff, 0xff00ffff, 0xffff00ff, 0xffffff00};
+
+    ASSERT_THAT(buffer, NotNull());
+
+    memcpy(pixels, first.data(), pool_bytes);
+    auto const first_commit = mf::WlShmBuffer::mir_buffer_from_wl_buffer(buffer, executor, []{});
+    EXPECT_THAT(read_pixels(*first_commit), Eq(first));
+
+    // The client redraws and reattaches while the compositor still holds the first commit
+    memcpy(pixels, second.data(), pool_bytes);
+    auto const second_commit = mf::WlShmBuffer::mir_buffer_from_wl_buffer(buffer, executor, []{});
+
+    EXPECT_THAT(second_commit->id(), Ne(first_commit->id()));
+    EXPECT_THAT(read_pixels(*second_commit), Eq(second));
+}
+
+TEST_F(WlShmBuffer, each_commit_is_consumed_separately)
+{
+    int first_consumed{0}, second_consumed{0};
+
+    auto const first_commit =
+        mf::WlShmBuffer::mir_buffer_from_wl_buffer(buffer, executor, [&]{ ++first_consumed; });
+    auto const second_commit =
+        mf::WlShmBuffer::mir_buffer_from_wl_buffer(buffer, executor, [&]{ ++second_consumed; });
+
+    read_pixels(*second_commit);
+    EXPECT_THAT(first_consumed, Eq(0));
+    EXPECT_THAT(second_consumed, Eq(1));
+
+    read_pixels(*first_commit);
+    EXPECT_THAT(first_consumed, Eq(1));
+    EXPECT_THAT(second_consumed, Eq(1));
+}
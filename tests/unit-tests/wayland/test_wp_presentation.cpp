@@ -0,0 +1,241 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wp_presentation.h"
+
+#include <wayland-server-core.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+
+using namespace testing;
+
+namespace
+{
+uint32_t const presented = mw::PresentationFeedback::Opcode::presented;
+uint32_t const discarded = mw::PresentationFeedback::Opcode::discarded;
+
+struct Event
+{
+    uint32_t object;
+    uint32_t opcode;
+    std::vector<uint32_t> args;
+};
+
+auto operator==(Event const& event, std::pair<uint32_t, uint32_t> const& object_and_opcode) -> bool
+{
+    return event.object == object_and_opcode.first && event.opcode == object_and_opcode.second;
+}
+
+auto event(uint32_t object, uint32_t opcode) -> std::pair<uint32_t, uint32_t>
+{
+    return {object, opcode};
+}
+
+struct WpPresentation : Test
+{
+    WpPresentation()
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0, sockets))
+            throw std::runtime_error{"Failed to create socketpair"};
+
+        client = wl_client_create(display, sockets[0]);
+        // Every client has its wl_display object, which will do as a parent for our feedback
+        parent = wl_client_get_object(client, 1);
+    }
+
+    ~WpPresentation()
+    {
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+        close(sockets[1]);
+    }
+
+    auto feedback() -> std::shared_ptr<mf::WpPresentationFeedback>
+    {
+        return std::make_shared<mf::WpPresentationFeedback>(client, parent, next_id++);
+    }
+
+    /// The events the client has been sent about its feedback objects, straight off the wire
+    auto feedback_events() -> std::vector<Event>
+    {
+        wl_display_flush_clients(display);
+
+        std::vector<uint32_t> words;
+        uint32_t buffer[256];
+        ssize_t bytes;
+        while ((bytes = read(sockets[1], buffer, sizeof buffer)) > 0)
+            words.insert(words.end(), buffer, buffer + bytes / sizeof(uint32_t));
+
+        std::vector<Event> events;
+        for (auto word = words.begin(); word != words.end();)
+        {
+            auto const object = word[0];
+            auto const size = word[1] >> 16;
+            auto const opcode = word[1] & 0xffff;
+            std::vector<uint32_t> const args{word + 2, word + size / sizeof(uint32_t)};
+            word += size / sizeof(uint32_t);
+
+            // Skip the wl_display.delete_id events that follow each feedback being destroyed
+            if (object != 1)
+                events.push_back({object, opcode, args});
+        }
+        return events;
+    }
+
+    static auto now() -> mc::PresentedFrame
+    {
+        return mc::PresentedFrame::untimed(std::chrono::steady_clock::now());
+    }
+
+    wl_display* const display{wl_display_create()};
+    int sockets[2];
+    wl_client* client;
+    wl_resource* parent;
+    uint32_t next_id{2};
+
+    // Never dereferenced; it just has to be a non-null buffer
+    wl_resource* const buffer{reinterpret_cast<wl_resource*>(&next_id)};
+    std::experimental::optional<wl_resource*> const no_buffer;
+    std::experimental::optional<wl_resource*> const null_buffer{nullptr};
+};
+}
+
+TEST_F(WpPresentation, feedback_for_shown_content_is_presented_when_the_output_showed_it)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+
+    mc::PresentedFrame const frame{
+        {42, {CLOCK_MONOTONIC, std::chrono::seconds{5} + std::chrono::nanoseconds{250}}},
+        std::chrono::nanoseconds{16666666}};
+    feedbacks.frame_presented(frame, true, 1);
+
+    auto const events = feedback_events();
+    ASSERT_THAT(events, ElementsAre(event(2, presented)));
+    // tv_sec_hi, tv_sec_lo, tv_nsec, refresh, seq_hi, seq_lo, flags
+    EXPECT_THAT(events[0].args, ElementsAre(0u, 5u, 250u, 16666666u, 0u, 42u, 0u));
+}
+
+TEST_F(WpPresentation, feedback_for_content_shown_at_vblank_is_flagged_as_timed_by_the_hardware)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+
+    mg::Frame shown_at_vblank{(int64_t{1} << 32) + 7, {CLOCK_MONOTONIC, std::chrono::seconds{1}}};
+    shown_at_vblank.vsync = true;
+    feedbacks.frame_presented({shown_at_vblank, std::chrono::nanoseconds{16666666}}, true, 1);
+
+    auto const events = feedback_events();
+    ASSERT_THAT(events, ElementsAre(event(2, presented)));
+    // seq_hi, seq_lo, flags
+    EXPECT_THAT(events[0].args[4], Eq(1u));
+    EXPECT_THAT(events[0].args[5], Eq(7u));
+    EXPECT_THAT(events[0].args[6], Eq(
+        mw::PresentationFeedback::Kind::vsync |
+        mw::PresentationFeedback::Kind::hw_clock |
+        mw::PresentationFeedback::Kind::hw_completion));
+}
+
+TEST_F(WpPresentation, feedback_waits_through_throttled_frames_until_its_content_is_shown)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback(), feedback()}, buffer, 1);
+
+    feedbacks.frame_presented(now(), false, 0);
+    EXPECT_THAT(feedback_events(), IsEmpty());
+
+    feedbacks.frame_presented(now(), true, 1);
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, presented), event(3, presented)));
+}
+
+TEST_F(WpPresentation, feedback_is_only_sent_once)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+
+    feedbacks.frame_presented(now(), true, 1);
+    feedbacks.frame_presented(now(), true, 1);
+    feedbacks.frame_presented(now(), false, 1);
+
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, presented)));
+}
+
+TEST_F(WpPresentation, showing_later_content_discards_feedback_for_content_that_was_never_shown)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+    feedbacks.commit({feedback()}, buffer, 2);
+
+    feedbacks.frame_presented(now(), true, 2);
+
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, discarded), event(3, presented)));
+}
+
+TEST_F(WpPresentation, feedback_for_content_committed_after_the_shown_content_waits_to_be_shown)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+    feedbacks.commit({feedback()}, buffer, 2);
+
+    feedbacks.frame_presented(now(), true, 1);
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, presented)));
+
+    feedbacks.frame_presented(now(), true, 2);
+    EXPECT_THAT(feedback_events(), ElementsAre(event(3, presented)));
+}
+
+TEST_F(WpPresentation, commit_without_a_buffer_discards_its_own_feedback_only)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+    feedbacks.commit({feedback()}, no_buffer, 1);
+
+    feedbacks.frame_presented(now(), true, 1);
+
+    EXPECT_THAT(feedback_events(), ElementsAre(event(3, discarded), event(2, presented)));
+}
+
+TEST_F(WpPresentation, commit_of_a_null_buffer_discards_all_feedback)
+{
+    mf::PresentationFeedbacks feedbacks;
+    feedbacks.commit({feedback()}, buffer, 1);
+    feedbacks.commit({feedback()}, null_buffer, 1);
+
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, discarded), event(3, discarded)));
+}
+
+TEST_F(WpPresentation, outstanding_feedback_is_discarded_when_the_surface_goes_away)
+{
+    {
+        mf::PresentationFeedbacks feedbacks;
+        feedbacks.commit({feedback()}, buffer, 1);
+    }
+
+    EXPECT_THAT(feedback_events(), ElementsAre(event(2, discarded)));
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wp_viewporter.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using std::experimental::optional;
+using std::experimental::nullopt;
+
+namespace
+{
+using Source = mf::SurfaceViewport::Source;
+
+optional<uint32_t> const bad_size{mw::Viewport::Error::bad_size};
+optional<uint32_t> const out_of_buffer{mw::Viewport::Error::out_of_buffer};
+
+geom::Size const buffer_size{640, 480};
+
+struct SurfaceViewport : Test
+{
+    void set_source(Source const& source)
+    {
+        viewport.commit(optional<Source>{source}, nullopt);
+    }
+
+    void set_destination(geom::Size const& destination)
+    {
+        viewport.commit(nullopt, optional<geom::Size>{destination});
+    }
+
+    auto error_code(optional<geom::Size> const& buffer) -> optional<uint32_t>
+    {
+        if (auto const error = viewport.error(buffer))
+            return error.value().code;
+        return nullopt;
+    }
+
+    mf::SurfaceViewport viewport;
+};
+}
+
+TEST_F(SurfaceViewport, without_a_viewport_the_surface_is_the_buffer)
+{
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(buffer_size));
+    EXPECT_FALSE(viewport.source_bounds());
+    EXPECT_FALSE(viewport.destination());
+    EXPECT_FALSE(viewport.error(buffer_size));
+}
+
+TEST_F(SurfaceViewport, source_alone_sets_surface_size)
+{
+    set_source({10, 20, 100, 50});
+
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(geom::Size{100, 50}));
+    EXPECT_THAT(viewport.source_bounds().value(), Eq(geom::Rectangle{{10, 20}, {100, 50}}));
+    EXPECT_FALSE(viewport.error(buffer_size));
+}
+
+TEST_F(SurfaceViewport, destination_sets_surface_size)
+{
+    set_source({10, 20, 100, 50});
+    set_destination({300, 150});
+
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(geom::Size{300, 150}));
+    EXPECT_THAT(viewport.destination().value(), Eq(geom::Size{300, 150}));
+}
+
+TEST_F(SurfaceViewport, destination_alone_scales_the_whole_buffer)
+{
+    set_destination({320, 240});
+
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(geom::Size{320, 240}));
+    EXPECT_FALSE(viewport.source_bounds());
+}
+
+TEST_F(SurfaceViewport, fractional_source_is_widened_to_whole_pixels)
+{
+    set_source({10.5, 20.25, 99.75, 49.5});
+    set_destination({200, 100});
+
+    EXPECT_THAT(viewport.source_bounds().value(), Eq(geom::Rectangle{{10, 20}, {101, 50}}));
+    EXPECT_FALSE(viewport.error(buffer_size));
+}
+
+TEST_F(SurfaceViewport, fractional_source_size_without_destination_is_bad_size)
+{
+    set_source({0, 0, 99.5, 50});
+
+    EXPECT_THAT(error_code(nullopt), Eq(bad_size));
+    EXPECT_THAT(error_code(buffer_size), Eq(bad_size));
+}
+
+TEST_F(SurfaceViewport, fractional_source_position_without_destination_is_fine)
+{
+    set_source({0.5, 0.5, 100, 50});
+
+    EXPECT_FALSE(viewport.error(buffer_size));
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(geom::Size{100, 50}));
+}
+
+TEST_F(SurfaceViewport, source_outside_the_buffer_is_out_of_buffer)
+{
+    set_source({600, 0, 100, 50});
+
+    EXPECT_THAT(error_code(buffer_size), Eq(out_of_buffer));
+    EXPECT_THAT(error_code(geom::Size{700, 480}), Eq(optional<uint32_t>{}));
+}
+
+TEST_F(SurfaceViewport, source_is_not_checked_against_a_buffer_that_is_not_known_yet)
+{
+    set_source({600, 0, 100, 50});
+
+    EXPECT_FALSE(viewport.error(nullopt));
+}
+
+TEST_F(SurfaceViewport, commit_without_changes_keeps_the_viewport)
+{
+    set_source({10, 20, 100, 50});
+    set_destination({300, 150});
+
+    viewport.commit(nullopt, nullopt);
+
+    EXPECT_THAT(viewport.source_bounds().value(), Eq(geom::Rectangle{{10, 20}, {100, 50}}));
+    EXPECT_THAT(viewport.destination().value(), Eq(geom::Size{300, 150}));
+}
+
+TEST_F(SurfaceViewport, committing_unset_state_removes_it)
+{
+    set_source({10, 20, 100, 50});
+    set_destination({300, 150});
+
+    viewport.commit(optional<Source>{}, optional<geom::Size>{});
+
+    EXPECT_FALSE(viewport.source_bounds());
+    EXPECT_FALSE(viewport.destination());
+    EXPECT_THAT(viewport.surface_size(buffer_size), Eq(buffer_size));
+}
+
+TEST_F(SurfaceViewport, without_a_viewport_surface_damage_is_buffer_damage)
+{
+    std::vector<geom::Rectangle> const buffer_damage{{{1, 2}, {3, 4}}};
+    std::vector<geom::Rectangle> const surface_damage{{{5, 6}, {7, 8}}};
+
+    EXPECT_THAT(
+        viewport.damage_in_buffer(buffer_damage, surface_damage, buffer_size),
+        ElementsAre(buffer_damage[0], surface_damage[0]));
+}
+
+TEST_F(SurfaceViewport, surface_damage_on_a_scaled_surface_damages_the_whole_buffer)
+{
+    set_destination({320, 240});
+    std::vector<geom::Rectangle> const buffer_damage{{{1, 2}, {3, 4}}};
+    std::vector<geom::Rectangle> const surface_damage{{{5, 6}, {7, 8}}};
+
+    EXPECT_THAT(
+        viewport.damage_in_buffer(buffer_damage, surface_damage, buffer_size),
+        ElementsAre(buffer_damage[0], geom::Rectangle{{0, 0}, buffer_size}));
+}
+
+TEST_F(SurfaceViewport, buffer_damage_on_a_scaled_surface_is_kept)
+{
+    set_destination({320, 240});
+    std::vector<geom::Rectangle> const buffer_damage{{{1, 2}, {3, 4}}};
+
+    EXPECT_THAT(viewport.damage_in_buffer(buffer_damage, {}, buffer_size), ElementsAre(buffer_damage[0]));
+}